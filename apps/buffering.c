@@ -55,8 +55,38 @@
 #include "playback.h"
 #endif
 
+#ifdef BUFFERING_TRACE
+#include <sys/time.h>
+#endif
+#ifdef BUFFERING_MMAP
+#include <sys/mman.h>
+#include <signal.h>
+#include <errno.h>
+#endif
+
 #define GUARD_BUFSIZE   (32*1024)
 
+#ifdef BUFFERING_MMAP
+/* Mapped handles see their file through a window that moves along as it is
+   read, so that no file stays mapped in full. Windows start on a multiple
+   of MAP_ALIGN, which is a multiple of any page size. */
+#define MAP_WINDOW      (1024*1024)
+#define MAP_ALIGN       (64*1024)
+#define MAX_MAPPED      8
+
+static struct map_window {
+    bool used;
+    bool copy;                 /* Read into memory instead of mapped */
+    volatile bool fault;       /* Pages went missing under the mapping */
+    char * volatile start;     /* The window, NULL if none */
+    char * volatile spare;     /* Zero pages to patch it with, if mapped */
+    size_t len;                /* Length of the window */
+    size_t pos;                /* File position of start */
+} map_windows[MAX_MAPPED];
+
+static struct sigaction old_sigbus;
+#endif
+
 /* Define LOGF_ENABLE to enable logf output in this file */
 /* #define LOGF_ENABLE */
 #include "logf.h"
@@ -84,6 +114,9 @@
 
 /* amount of data to read in one read() call */
 #define BUFFERING_DEFAULT_FILECHUNK      (1024*32)
+/* Read size while the disk is spinning anyway and nobody asked us to back
+   off - fewer, larger requests get more out of each spin-up */
+#define BUFFERING_ACTIVE_FILECHUNK       (1024*128)
 
 #define BUF_HANDLE_MASK                  0x7FFFFFFF
 
@@ -104,9 +137,172 @@ struct memory_handle {
     volatile size_t available; /* Available bytes to read from buffer */
     size_t offset;             /* Offset at which we started reading the file */
     struct memory_handle *next;
+#ifdef BUFFERING_MMAP
+    struct map_window *map;    /* Window of the file, or NULL if in the ring */
+    size_t mapsize;            /* File size when it was opened */
+#endif
 };
 /* invariant: filesize == offset + available + filerem */
 
+#ifdef BUFFERING_MMAP
+/* A mapped handle has all of its file available from the start and only
+   its header lives in the ring. Its offset and data are 0 and ridx/widx are
+   file positions rather than buffer indexes; filerem is 0. Its fd stays
+   open for moving the window. */
+#define HANDLE_MAPPED(h) ((h)->map != NULL)
+#else
+#define HANDLE_MAPPED(h) false
+#endif
+
+#ifdef BUFFERING_MMAP
+/* Moves a window to hold size bytes from file position pos of fd. Once the
+   file has changed size or pages went missing under the window, which the
+   SIGBUS handler notes instead of letting the reader crash, the file is
+   read() into the windows instead of mapped. A file mapped window gets as
+   many zero pages next to it for the handler to patch holes with, since
+   the handler itself can't create any mapping. */
+static bool map_window(struct map_window *w, int fd, size_t mapsize,
+                       size_t pos, size_t size)
+{
+    size_t start = pos & ~(MAP_ALIGN - 1);
+    char *old = w->start;
+    char *old_spare = w->spare;
+    char *p, *spare = NULL;
+
+    /* the end of the file still gets a window */
+    if (start >= mapsize)
+        start = (mapsize - 1) & ~(MAP_ALIGN - 1);
+
+    size_t len = MIN(MAX(pos + size - start, MAP_WINDOW), mapsize - start);
+
+    if (!w->copy && (w->fault || (size_t)filesize(fd) != mapsize)) {
+        logf("mapped file changed, reading it instead");
+        w->copy = true;
+    }
+
+    if (w->copy) {
+        /* whatever is gone reads as zeros */
+        p = mmap(NULL, len, PROT_READ | PROT_WRITE,
+                 MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+        if (p != MAP_FAILED
+            && (lseek(fd, start, SEEK_SET) < 0 || read(fd, p, len) < 0)) {
+            munmap(p, len);
+            p = MAP_FAILED;
+        }
+    } else {
+        spare = mmap(NULL, len, PROT_READ,
+                     MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE, -1, 0);
+        p = MAP_FAILED;
+        if (spare != MAP_FAILED) {
+            p = mmap(NULL, len, PROT_READ, MAP_PRIVATE, fd, start);
+            if (p == MAP_FAILED)
+                munmap(spare, len);
+        }
+#ifdef MADV_SEQUENTIAL
+        if (p != MAP_FAILED)
+            madvise(p, len, MADV_SEQUENTIAL);
+#endif
+    }
+
+    if (p == MAP_FAILED)
+        return false;
+
+    /* the SIGBUS handler must never see a half updated window */
+    w->start = NULL;
+    w->spare = NULL;
+    if (old)
+        munmap(old, w->len);
+    if (old_spare)
+        munmap(old_spare, w->len);
+    w->len = len;
+    w->pos = start;
+    w->fault = false;
+    w->spare = spare;
+    w->start = p;
+    return true;
+}
+
+static void map_release(struct map_window *w)
+{
+    char *old = w->start;
+    char *old_spare = w->spare;
+
+    w->start = NULL;
+    w->spare = NULL;
+    if (old)
+        munmap(old, w->len);
+    if (old_spare)
+        munmap(old_spare, w->len);
+    w->used = false;
+}
+
+/* Returns the data at file position pos of a mapped handle, moving its
+   window first if it doesn't hold size bytes from there. Pointers into the
+   window stay valid until the window moves, which only bufread() and
+   bufgetdata() on the same handle do. */
+static const char * map_data(const struct memory_handle *h, size_t pos,
+                             size_t size)
+{
+    struct map_window *w = h->map;
+
+    if (w->fault || pos < w->pos || pos + size > w->pos + w->len) {
+        if (!map_window(w, h->fd, h->mapsize, pos, size))
+            return NULL;
+    }
+
+    return w->start + (pos - w->pos);
+}
+
+/* A file that shrinks or disappears under a window raises SIGBUS when the
+   missing pages are touched. Move the window's zero pages over the missing
+   chunk and let map_window() read the file from then on. mremap() only
+   moves existing pages, so nothing gets allocated here. Faults elsewhere
+   are passed on to the handler we replaced. */
+static void map_sigbus(int sig, siginfo_t *si, void *context)
+{
+    char *addr = si->si_addr;
+    int saved_errno = errno;
+    int i;
+
+    for (i = 0; i < MAX_MAPPED; i++) {
+        struct map_window *w = &map_windows[i];
+        char *start = w->start;
+        char *spare = w->spare;
+
+        if (start && spare && addr >= start && addr < start + w->len) {
+            size_t off = (addr - start) & ~(MAP_ALIGN - 1);
+            if (mremap(spare + off, MIN(MAP_ALIGN, w->len - off),
+                       MIN(MAP_ALIGN, w->len - off),
+                       MREMAP_MAYMOVE | MREMAP_FIXED,
+                       start + off) != MAP_FAILED) {
+                w->fault = true;
+                errno = saved_errno;
+                return;
+            }
+        }
+    }
+
+    errno = saved_errno;
+
+    if (old_sigbus.sa_flags & SA_SIGINFO) {
+        old_sigbus.sa_sigaction(sig, si, context);
+    } else if (old_sigbus.sa_handler != SIG_DFL
+               && old_sigbus.sa_handler != SIG_IGN) {
+        old_sigbus.sa_handler(sig);
+    } else {
+        /* die the way we would have without us: the signal stays blocked
+           in here, so it is delivered with the default action as soon as
+           we return */
+        struct sigaction dfl;
+        memset(&dfl, 0, sizeof(dfl));
+        dfl.sa_handler = SIG_DFL;
+        sigemptyset(&dfl.sa_mask);
+        sigaction(SIGBUS, &dfl, NULL);
+        raise(SIGBUS);
+    }
+}
+#endif /* BUFFERING_MMAP */
+
 
 struct buf_message_data
 {
@@ -136,6 +332,9 @@ static int num_handles;  /* number of handles in the list */
 
 static int base_handle_id;
 
+/* Set while another thread needs the storage more than we do */
+static volatile bool storage_backed_off = false;
+
 /* Main lock for adding / removing handles */
 static struct mutex llist_mutex SHAREDBSS_ATTR;
 
@@ -166,6 +365,8 @@ enum
                             fill at its earliest convenience */
     Q_HANDLE_ADDED,      /* Inform the buffering thread that a handle was added,
                             (which means the disk is spinning) */
+    Q_RESUME_FILL,       /* The storage is no longer backed off, carry on
+                            with the fill it interrupted */
 };
 
 /* Buffering thread */
@@ -176,6 +377,87 @@ static unsigned int buffering_thread_id = 0;
 static struct event_queue buffering_queue SHAREDBSS_ATTR;
 static struct queue_sender_list buffering_queue_sender_list SHAREDBSS_ATTR;
 
+#ifdef BUFFERING_TRACE
+/*
+EVENT TRACE
+===========
+
+A ring of the most recent buffering events with microsecond timestamps, so
+that a rebuffer or a stall can be looked at in the context of what happened
+before it. buffering_trace_dump writes it out as text; tools/bufftrace.py
+turns that into a timeline.
+
+Events are logged from whichever thread causes them. Threads on hosted
+targets only switch at kernel calls, so claiming a slot needs no lock.
+*/
+#define BUFFERING_TRACE_SIZE 8192 /* events, must be a power of 2 */
+
+enum trace_event
+{
+    TRACE_ADD = 0,   /* a = type, b = bytes the handle will hold */
+    TRACE_MOVE,      /* a = distance, b = data bytes moved with the header */
+    TRACE_SHRINK,    /* a = bytes freed ahead of the data */
+    TRACE_CLOSE,     /* a = bytes buffered, b = bytes never buffered */
+    TRACE_SEEK,      /* a = file position, b = 1 if it needs a rebuffer */
+    TRACE_REBUFFER,  /* a = file position, b = previous start of the data */
+    TRACE_READ,      /* a = bytes read, b = microseconds spent in read() */
+    TRACE_READ_FAIL, /* a = bytes asked for, b = 1 on error, 0 at the end
+                        of the file */
+    TRACE_WATERMARK, /* a = useful bytes, b = watermark they were checked
+                        against before sending BUFFER_EVENT_BUFFER_LOW */
+    TRACE_NUM_EVENTS
+};
+
+static const char * const trace_event_names[TRACE_NUM_EVENTS] =
+{
+    [TRACE_ADD]       = "add",
+    [TRACE_MOVE]      = "move",
+    [TRACE_SHRINK]    = "shrink",
+    [TRACE_CLOSE]     = "close",
+    [TRACE_SEEK]      = "seek",
+    [TRACE_REBUFFER]  = "rebuffer",
+    [TRACE_READ]      = "read",
+    [TRACE_READ_FAIL] = "readfail",
+    [TRACE_WATERMARK] = "watermark",
+};
+
+static struct trace_entry
+{
+    uint64_t time;      /* microseconds since buffering_init */
+    int32_t  handle_id;
+    uint32_t a, b;
+    uint8_t  event;
+} trace_ring[BUFFERING_TRACE_SIZE];
+
+static unsigned int trace_count;    /* events logged in total */
+static struct timeval trace_epoch;
+
+static uint64_t trace_time(void)
+{
+    struct timeval tv;
+    gettimeofday(&tv, NULL);
+    return (uint64_t)(tv.tv_sec - trace_epoch.tv_sec) * 1000000 +
+           (tv.tv_usec - trace_epoch.tv_usec);
+}
+
+static void trace_event(enum trace_event event, int handle_id,
+                        size_t a, size_t b)
+{
+    struct trace_entry *e =
+        &trace_ring[trace_count++ & (BUFFERING_TRACE_SIZE - 1)];
+    e->time = trace_time();
+    e->handle_id = handle_id;
+    e->a = a;
+    e->b = b;
+    e->event = event;
+}
+
+#define TRACE(event, handle_id, a, b) \
+    trace_event(TRACE_##event, (handle_id), (a), (b))
+#else
+#define TRACE(event, handle_id, a, b)
+#endif /* BUFFERING_TRACE */
+
 
 
 /* Ring buffer helper functions */
@@ -319,6 +601,11 @@ static struct memory_handle *add_handle(size_t data_size, bool can_wrap,
     /* Handle data can be waited for by default */
     new_handle->signaled = 0;
 
+#ifdef BUFFERING_MMAP
+    /* Data goes in the ring unless bufopen maps it */
+    new_handle->map = NULL;
+#endif
+
     /* only advance the buffer write index of the size of the struct */
     buf_widx = ringbuf_add(buf_widx, sizeof(struct memory_handle));
 
@@ -551,6 +838,7 @@ static bool move_handle(struct memory_handle **h, size_t *delta,
     /* Update the caller with the new location of h and the distance moved */
     *h = dest;
     *delta = final_delta;
+    TRACE(MOVE, dest->id, final_delta, data_size);
     return true;
 }
 
@@ -564,6 +852,7 @@ buffer_is_low   : Returns true if the amount of useful data in the buffer is low
 buffer_handle   : Buffer data for a handle
 rebuffer_handle : Seek to a nonbuffered part of a handle by rebuffering the data
 shrink_handle   : Free buffer space by moving a handle
+handle_priority : Rank a handle by how soon its data will be needed
 fill_buffer     : Call buffer_handle for all handles that have data to buffer
 
 These functions are used by the buffering thread to manage buffer space.
@@ -600,10 +889,12 @@ static void update_data_counters(struct data_counters *dc)
 
     m = first_handle;
     while (m) {
-        buffered += m->available;
-        /* wasted could come out larger than the buffer size if ridx's are
-           overlapping data ahead of their handles' buffered data */
-        wasted += ringbuf_sub(m->ridx, m->data);
+        if (!HANDLE_MAPPED(m)) {
+            buffered += m->available;
+            /* wasted could come out larger than the buffer size if ridx's are
+               overlapping data ahead of their handles' buffered data */
+            wasted += ringbuf_sub(m->ridx, m->data);
+        }
         remaining += m->filerem;
 
         if (m->id == base_handle_id)
@@ -680,10 +971,13 @@ static bool buffer_handle(int handle_id, size_t to_buffer)
         return true;
     }
 
+    size_t filechunk = (storage_disk_is_active() && !storage_backed_off) ?
+                    BUFFERING_ACTIVE_FILECHUNK : BUFFERING_DEFAULT_FILECHUNK;
+
     while (h->filerem > 0 && !stop)
     {
         /* max amount to copy */
-        ssize_t copy_n = MIN( MIN(h->filerem, BUFFERING_DEFAULT_FILECHUNK),
+        ssize_t copy_n = MIN( MIN(h->filerem, filechunk),
                              buffer_len - h->widx);
         uintptr_t offset = h->next ? ringbuf_offset(h->next) : buf_ridx;
         ssize_t overlap = ringbuf_add_cross(h->widx, copy_n, offset) + 1;
@@ -699,7 +993,16 @@ static bool buffer_handle(int handle_id, size_t to_buffer)
             return false; /* no space for read */
 
         /* rc is the actual amount read */
+#ifdef BUFFERING_TRACE
+        uint64_t start = trace_time();
+#endif
         int rc = read(h->fd, &buffer[h->widx], copy_n);
+#ifdef BUFFERING_TRACE
+        if (rc > 0)
+            TRACE(READ, handle_id, rc, trace_time() - start);
+        else
+            TRACE(READ_FAIL, handle_id, copy_n, rc < 0);
+#endif
 
         if (rc <= 0) {
             /* Some kind of filesystem error, maybe recoverable if not codec */
@@ -731,8 +1034,10 @@ static bool buffer_handle(int handle_id, size_t to_buffer)
         }
 
         if (to_buffer == 0) {
-            /* Normal buffering - check queue */
-            if(!queue_empty(&buffering_queue))
+            /* Normal buffering - check queue and stop between reads if the
+               storage is wanted elsewhere; fill_buffer decides whether this
+               handle is urgent enough to continue anyway */
+            if (!queue_empty(&buffering_queue) || storage_backed_off)
                 break;
         } else {
             if (to_buffer <= (size_t)rc)
@@ -762,11 +1067,18 @@ static bool close_handle(int handle_id)
 
     /* If the handle is not found, it is closed */
     if (h) {
+        TRACE(CLOSE, handle_id, h->available, h->filerem);
+
         if (h->fd >= 0) {
             close(h->fd);
             h->fd = -1;
         }
 
+#ifdef BUFFERING_MMAP
+        if (HANDLE_MAPPED(h))
+            map_release(h->map);
+#endif
+
         /* rm_handle returns true unless the handle somehow persists after
            exit */
         retval = rm_handle(h);
@@ -783,7 +1095,11 @@ static void shrink_handle(struct memory_handle *h)
     if (!h)
         return;
 
-    if (h->type == TYPE_PACKET_AUDIO) {
+    if (HANDLE_MAPPED(h)) {
+        /* nothing in the ring besides the struct and nowhere to move it
+           without crossing the data of the handle before */
+        return;
+    } else if (h->type == TYPE_PACKET_AUDIO) {
         /* only move the handle struct */
         /* data is pinned by default - if we start moving packet audio,
            the semantics will determine whether or not data is movable
@@ -797,6 +1113,7 @@ static void shrink_handle(struct memory_handle *h)
         h->data = ringbuf_add(h->data, delta);
         h->available -= delta;
         h->offset += delta;
+        TRACE(SHRINK, h->id, delta, 0);
     } else {
         /* metadata handle: we can move all of it */
         if (h->pinned || !h->next || h->filerem != 0)
@@ -814,6 +1131,7 @@ static void shrink_handle(struct memory_handle *h)
         h->data = ringbuf_add(h->data, delta);
         h->ridx = ringbuf_add(h->ridx, delta);
         h->widx = ringbuf_add(h->widx, delta);
+        TRACE(SHRINK, h->id, delta, 0);
 
         if (h->type == TYPE_ID3 && h->filesize == sizeof(struct mp3entry)) {
             /* when moving an mp3entry we need to readjust its pointers. */
@@ -828,34 +1146,91 @@ static void shrink_handle(struct memory_handle *h)
     }
 }
 
+/* Buffering order, most urgent first */
+enum handle_priority
+{
+    PRIO_PLAYING = 0, /* Audio being decoded and what it still depends on */
+    PRIO_METADATA,    /* Metadata and codecs of the following tracks */
+    PRIO_AUDIO,       /* Audio of the following tracks */
+    PRIO_EXTRAS,      /* Album art and cuesheets - nothing waits for them */
+    PRIO_COUNT
+};
+
+/* Rank a handle. Handles are in track order in the list, so anything before
+   the base handle belongs to the playing track or an earlier one and is
+   needed now. */
+static enum handle_priority handle_priority(const struct memory_handle *h,
+                                            bool after_base)
+{
+    switch (h->type)
+    {
+    case TYPE_CUESHEET:
+    case TYPE_BITMAP:
+        return PRIO_EXTRAS;
+    case TYPE_ID3:
+    case TYPE_CODEC:
+        return after_base ? PRIO_METADATA : PRIO_PLAYING;
+    default:
+        return after_base ? PRIO_AUDIO : PRIO_PLAYING;
+    }
+}
+
 /* Fill the buffer by buffering as much data as possible for handles that still
-   have data left to buffer
+   have data left to buffer, most urgent handles first and in track order
+   within the same priority.
    Return whether or not to continue filling after this */
 static bool fill_buffer(void)
 {
     logf("fill_buffer()");
     struct memory_handle *m = first_handle;
+    int prio;
 
     shrink_handle(m);
 
-    while (queue_empty(&buffering_queue) && m) {
-        if (m->filerem > 0) {
-            if (!buffer_handle(m->id, 0)) {
-                m = NULL;
-                break;
+    for (prio = PRIO_PLAYING; prio < PRIO_COUNT; prio++) {
+        /* Without a base handle the first audio handle is the one that
+           will be played */
+        bool after_base = false;
+        bool have_base = find_handle(base_handle_id) != NULL;
+
+        for (m = first_handle; m; m = m->next) {
+            if (!queue_empty(&buffering_queue))
+                return true;
+
+            if (handle_priority(m, after_base) == (enum handle_priority)prio
+                && m->filerem > 0) {
+                /* When asked to back off, only keep the playing track's
+                   audio from running dry. Otherwise rest until
+                   buf_back_off_storage() lets go or the buffer runs low. */
+                if (storage_backed_off &&
+                    (prio != PRIO_PLAYING || !buffer_is_low()))
+                    return false;
+
+                if (!buffer_handle(m->id, 0)) {
+                    /* out of space - nothing else can be buffered */
+                    storage_sleep();
+                    return false;
+                }
+
+                /* Stopped for a reason other than being done */
+                if (m->filerem > 0 && storage_backed_off)
+                    return true;
             }
+
+            if (have_base ? m->id == base_handle_id :
+                (m->type == TYPE_PACKET_AUDIO ||
+                 m->type == TYPE_ATOMIC_AUDIO))
+                after_base = true;
         }
-        m = m->next;
     }
 
-    if (m) {
+    if (!queue_empty(&buffering_queue))
         return true;
-    } else {
-        /* only spin the disk down if the filling wasn't interrupted by an
-           event arriving in the queue. */
-        storage_sleep();
-        return false;
-    }
+
+    /* only spin the disk down if the filling wasn't interrupted by an
+       event arriving in the queue. */
+    storage_sleep();
+    return false;
 }
 
 #ifdef HAVE_ALBUMART
@@ -920,6 +1295,76 @@ management functions for all the actual handle management work.
 */
 
 
+#ifdef BUFFERING_MMAP
+/* Open an audio handle that reads straight from the file mapped into memory
+   instead of buffering it. fd is consumed unless ERR_FILE_ERROR is returned,
+   in which case the caller may still buffer the file the usual way. */
+static int bufopen_mapped(int fd, const char *file, size_t size,
+                          size_t offset, enum data_type type)
+{
+    struct map_window *w = NULL;
+    int i;
+
+    if (size == 0)
+        return ERR_FILE_ERROR;
+
+    mutex_lock(&llist_mutex);
+    for (i = 0; i < MAX_MAPPED; i++) {
+        if (!map_windows[i].used) {
+            w = &map_windows[i];
+            w->used = true;
+            w->copy = false;
+            w->fault = false;
+            break;
+        }
+    }
+    mutex_unlock(&llist_mutex);
+
+    /* too many mapped already, buffer this one */
+    if (!w)
+        return ERR_FILE_ERROR;
+
+    if (!map_window(w, fd, size, offset < size ? offset : 0, 0)) {
+        w->used = false;
+        return ERR_FILE_ERROR;
+    }
+
+    mutex_lock(&llist_mutex);
+
+    struct memory_handle *h = add_handle(0, true, false);
+    if (!h) {
+        map_release(w);
+        mutex_unlock(&llist_mutex);
+        close(fd);
+        return ERR_BUFFER_FULL;
+    }
+
+    int handle_id = h->id;
+    strlcpy(h->path, file, MAX_PATH);
+    h->fd = fd;
+    h->type = type;
+    h->map = w;
+    h->mapsize = size;
+    h->filesize = size;
+    h->filerem = 0;
+    h->offset = 0;
+    h->data = 0;
+    h->ridx = offset;
+    h->widx = size;
+    h->available = size;
+
+    TRACE(ADD, handle_id, type, size);
+
+    mutex_unlock(&llist_mutex);
+
+    logf("bufopen: new mapped hdl %d", handle_id);
+
+    /* Everything is there already */
+    send_event(BUFFER_EVENT_FINISHED, &handle_id);
+    return handle_id;
+}
+
+#endif /* BUFFERING_MMAP */
 /* Reserve space in the buffer for a file.
    filename: name of the file to open
    offset: offset at which to start buffering the file, useful when the first
@@ -963,6 +1408,7 @@ int bufopen(const char *file, size_t offset, enum data_type type,
             buf_widx = ringbuf_add(buf_widx, sizeof(struct mp3entry));
 
             h->filerem = sizeof(struct mp3entry);
+            TRACE(ADD, handle_id, type, h->filesize - h->offset);
 
             /* Inform the buffering thread that we added a handle */
             LOGFQUEUE("buffering > Q_HANDLE_ADDED %d", handle_id);
@@ -1002,6 +1448,15 @@ int bufopen(const char *file, size_t offset, enum data_type type,
     if (adjusted_offset > size)
         adjusted_offset = 0;
 
+#ifdef BUFFERING_MMAP
+    if (type == TYPE_PACKET_AUDIO || type == TYPE_ATOMIC_AUDIO) {
+        handle_id = bufopen_mapped(fd, file, size, adjusted_offset, type);
+        if (handle_id != ERR_FILE_ERROR)
+            return handle_id;
+        /* Could not map it - buffer it in the ring as usual */
+    }
+#endif
+
     /* Reserve extra space because alignment can move data forward */
     size_t padded_size = STORAGE_PAD(size-adjusted_offset);
 
@@ -1065,6 +1520,9 @@ int bufopen(const char *file, size_t offset, enum data_type type,
         h->filerem = size - adjusted_offset;
     }
 
+    if (handle_id >= 0)
+        TRACE(ADD, handle_id, type, h->filesize - h->offset);
+
     mutex_unlock(&llist_mutex);
 
     if (type == TYPE_CUESHEET) {
@@ -1129,6 +1587,7 @@ int bufalloc(const void *src, size_t size, enum data_type type)
         h->widx = buf_widx;
         h->available = size;
         h->type = type;
+        TRACE(ADD, handle_id, type, size);
     }
 
     mutex_unlock(&llist_mutex);
@@ -1164,6 +1623,8 @@ static void rebuffer_handle(int handle_id, size_t newpos)
         return;
     }
 
+    TRACE(REBUFFER, handle_id, newpos, h->offset);
+
     /* When seeking foward off of the buffer, if it is a short seek attempt to
        avoid rebuffering the whole track, just read enough to satisfy */
     if (newpos > h->offset &&
@@ -1248,11 +1709,14 @@ static int seek_handle(struct memory_handle *h, size_t newpos)
         /* access before or after buffered data and not to end of file or file
            is not buffered to the end-- a rebuffer is needed. */
         struct buf_message_data parm = { h->id, newpos };
+        TRACE(SEEK, h->id, newpos, 1);
         return queue_send(&buffering_queue, Q_REBUFFER_HANDLE,
                           (intptr_t)&parm);
     }
     else {
-        h->ridx = ringbuf_add(h->data, newpos - h->offset);
+        TRACE(SEEK, h->id, newpos, 0);
+        h->ridx = HANDLE_MAPPED(h) ? newpos :
+                        ringbuf_add(h->data, newpos - h->offset);
     }
 
     return 0;
@@ -1329,7 +1793,7 @@ static struct memory_handle *prep_bufdata(int handle_id, size_t *size,
         realsize = avail + h->filerem;
 
     if (guardbuf_limit && h->type == TYPE_PACKET_AUDIO
-            && realsize > GUARD_BUFSIZE) {
+            && realsize > GUARD_BUFSIZE && !HANDLE_MAPPED(h)) {
         logf("data request > guardbuf");
         /* If more than the size of the guardbuf is requested and this is a
          * bufgetdata, limit to guard_bufsize over the end of the buffer */
@@ -1381,6 +1845,16 @@ ssize_t bufread(int handle_id, size_t size, void *dest)
     if (!h)
         return ERR_HANDLE_NOT_FOUND;
 
+#ifdef BUFFERING_MMAP
+    if (HANDLE_MAPPED(h)) {
+        const char *p = map_data(h, h->ridx, adjusted_size);
+        if (!p)
+            return ERR_FILE_ERROR;
+        memcpy(dest, p, adjusted_size);
+        return adjusted_size;
+    }
+#endif
+
     if (h->ridx + adjusted_size > buffer_len) {
         /* the data wraps around the end of the buffer */
         size_t read = buffer_len - h->ridx;
@@ -1401,6 +1875,7 @@ ssize_t bufread(int handle_id, size_t size, void *dest)
    much as possible.
    The guard buffer may be used to provide the requested size. This means it's
    unsafe to request more than the size of the guard buffer.
+   With BUFFERING_MMAP, a request for 0 bytes returns at most MAP_WINDOW.
 */
 ssize_t bufgetdata(int handle_id, size_t size, void **data)
 {
@@ -1411,6 +1886,22 @@ ssize_t bufgetdata(int handle_id, size_t size, void **data)
     if (!h)
         return ERR_HANDLE_NOT_FOUND;
 
+#ifdef BUFFERING_MMAP
+    if (HANDLE_MAPPED(h)) {
+        /* "as much as possible" is what one window holds, not the rest of
+           the file */
+        if (size == 0 && adjusted_size > MAP_WINDOW)
+            adjusted_size = MAP_WINDOW;
+        /* the window moves to hold all of it linearly */
+        const char *p = map_data(h, h->ridx, adjusted_size);
+        if (!p)
+            return ERR_FILE_ERROR;
+        if (data)
+            *data = (void *)p;
+        return adjusted_size;
+    }
+#endif
+
     if (h->ridx + adjusted_size > buffer_len) {
         /* the data wraps around the end of the buffer :
            use the guard buffer to provide the requested amount of data. */
@@ -1445,6 +1936,30 @@ ssize_t bufgettail(int handle_id, size_t size, void **data)
     if (size > GUARD_BUFSIZE)
         return ERR_INVALID_VALUE;
 
+#ifdef BUFFERING_MMAP
+    if (HANDLE_MAPPED(h)) {
+        struct map_window *w = h->map;
+        size_t pos;
+        if (size > h->widx)
+            size = h->widx;
+        pos = h->widx - size;
+        if (!w->fault && pos >= w->pos && h->widx <= w->pos + w->len) {
+            *data = w->start + (pos - w->pos);
+            return size;
+        }
+        /* leave the window where it is: the caller may still be holding a
+           pointer from bufgetdata() into it */
+        ssize_t rc = -1;
+        if (lseek(h->fd, pos, SEEK_SET) >= 0)
+            rc = read(h->fd, guard_buffer, size);
+        if (rc < 0)
+            return ERR_FILE_ERROR;
+        memset(guard_buffer + rc, 0, size - rc);
+        *data = guard_buffer;
+        return size;
+    }
+#endif
+
     tidx = ringbuf_sub(h->widx, size);
 
     if (tidx + size > buffer_len) {
@@ -1474,6 +1989,13 @@ ssize_t bufcuttail(int handle_id, size_t size)
 
     h->available -= adjusted_size;
     h->filesize -= adjusted_size;
+
+    if (HANDLE_MAPPED(h)) {
+        /* keep the mapping, only the end of the data moves */
+        h->widx -= adjusted_size;
+        return adjusted_size;
+    }
+
     h->widx = ringbuf_sub(h->widx, adjusted_size);
     if (h == cur_handle)
         buf_widx = h->widx;
@@ -1590,7 +2112,15 @@ void buf_back_off_storage(bool back_off)
 {
     int priority = back_off ?
         IO_PRIORITY_BACKGROUND : IO_PRIORITY_IMMEDIATE;
+    bool resume = storage_backed_off && !back_off;
+    storage_backed_off = back_off;
     thread_set_io_priority(buffering_thread_id, priority);
+
+    /* fill_buffer() stopped filling while backed off */
+    if (resume) {
+        LOGFQUEUE("buffering > Q_RESUME_FILL");
+        queue_post(&buffering_queue, Q_RESUME_FILL, 0);
+    }
 }
 #endif
 
@@ -1642,6 +2172,7 @@ static void NORETURN_ATTR buffering_thread(void)
                 else if (num_handles > 0 && conf_watermark > 0) {
                     update_data_counters(NULL);
                     if (data_counters.useful >= BUF_WATERMARK) {
+                        TRACE(WATERMARK, -1, data_counters.useful, BUF_WATERMARK);
                         send_event(BUFFER_EVENT_BUFFER_LOW, NULL);
                     }
                 }
@@ -1671,6 +2202,11 @@ static void NORETURN_ATTR buffering_thread(void)
                 filling = true;
                 break;
 
+            case Q_RESUME_FILL:
+                LOGFQUEUE("buffering < Q_RESUME_FILL");
+                filling = true;
+                break;
+
             case SYS_TIMEOUT:
                 LOGFQUEUE_SYS_TIMEOUT("buffering < SYS_TIMEOUT");
                 break;
@@ -1706,6 +2242,7 @@ static void NORETURN_ATTR buffering_thread(void)
             if (data_counters.useful < BUF_WATERMARK) {
                 /* The buffer is low and we're idle, just watching the levels
                    - call the callbacks to get new data */
+                TRACE(WATERMARK, -1, data_counters.useful, BUF_WATERMARK);
                 send_event(BUFFER_EVENT_BUFFER_LOW, NULL);
 
                 /* Continue anything else we haven't finished - it might
@@ -1724,6 +2261,19 @@ void buffering_init(void)
 {
     mutex_init(&llist_mutex);
 
+#ifdef BUFFERING_MMAP
+    struct sigaction sa;
+    memset(&sa, 0, sizeof(sa));
+    sa.sa_sigaction = map_sigbus;
+    sa.sa_flags = SA_SIGINFO;
+    sigemptyset(&sa.sa_mask);
+    sigaction(SIGBUS, &sa, &old_sigbus);
+#endif
+
+#ifdef BUFFERING_TRACE
+    gettimeofday(&trace_epoch, NULL);
+#endif
+
     /* Thread should absolutely not respond to USB because if it waits first,
        then it cannot properly service the handles and leaks will happen -
        this is a worker thread and shouldn't need to care about any system
@@ -1792,3 +2342,38 @@ void buffering_get_debugdata(struct buffering_debug *dbgdata)
     dbgdata->useful_data = dc.useful;
     dbgdata->watermark = BUF_WATERMARK;
 }
+
+#ifdef BUFFERING_TRACE
+/* Write the event trace to a text file, oldest event first, one event per
+   line: time in seconds with microseconds, event, handle id and the two
+   event values.
+   Returns the number of events written or a negative value on error. */
+int buffering_trace_dump(const char *path)
+{
+    unsigned int count = trace_count;
+    unsigned int i = count > BUFFERING_TRACE_SIZE ?
+                        count - BUFFERING_TRACE_SIZE : 0;
+    int fd = creat(path, 0666);
+
+    if (fd < 0)
+        return -1;
+
+    fdprintf(fd, "# buffering trace: time_s event handle a b\n");
+
+    if (i > 0)
+        fdprintf(fd, "# %u earlier events dropped\n", i);
+
+    for (; i < count; i++) {
+        const struct trace_entry *e =
+            &trace_ring[i & (BUFFERING_TRACE_SIZE - 1)];
+        fdprintf(fd, "%lu.%06lu %s %ld %lu %lu\n",
+                 (unsigned long)(e->time / 1000000),
+                 (unsigned long)(e->time % 1000000),
+                 trace_event_names[e->event], (long)e->handle_id,
+                 (unsigned long)e->a, (unsigned long)e->b);
+    }
+
+    close(fd);
+    return count > BUFFERING_TRACE_SIZE ? BUFFERING_TRACE_SIZE : (int)count;
+}
+#endif /* BUFFERING_TRACE */
@@ -134,4 +134,19 @@ struct buffering_debug {
 };
 void buffering_get_debugdata(struct buffering_debug *dbgdata);
 
+#if (CONFIG_PLATFORM & PLATFORM_HOSTED) && defined(__linux__) \
+    && !defined(BUFFERING_NO_MMAP)
+/* Serve audio handles straight from mmap()ed windows of their files instead
+   of copying them into the buffer; the OS page cache does the buffering. Define
+   BUFFERING_NO_MMAP to always use the buffer. Linux only, for mremap(). */
+#define BUFFERING_MMAP
+#endif
+
+#if (CONFIG_PLATFORM & PLATFORM_HOSTED)
+/* Keep a trace of buffering events that can be written out for analysis
+   with tools/bufftrace.py */
+#define BUFFERING_TRACE
+int buffering_trace_dump(const char *path);
+#endif
+
 #endif
@@ -90,6 +90,7 @@ static struct event_queue codec_queue SHAREDBSS_ATTR;
 static struct queue_sender_list codec_queue_sender_list SHAREDBSS_ATTR;
 static long codec_stack[(DEFAULT_STACK_SIZE + 0x2000)/sizeof(long)] IBSS_ATTR;
 static const char codec_thread_name[] = "codec";
+static void *direct_buf = NULL; /* PCM buffer window handed to the codec */
 
 static void unload_codec(void);
 
@@ -210,6 +211,29 @@ void codec_thread_do_callback(void (*fn)(void), unsigned int *id)
 
 /** --- codec API callbacks --- **/
 
+/* Wait for space for up to *count samples in the PCM buffer. Returns NULL
+   if a message arrived that the codec should handle first. */
+static void * codec_pcmbuf_wait_buffer(int *count)
+{
+    while (1)
+    {
+        void *dest = pcmbuf_request_buffer(count);
+
+        if (dest != NULL)
+            return dest;
+
+        cancel_cpu_boost();
+
+        /* It will be awhile before space is available but we want
+           "instant" response to any message */
+        queue_wait_w_tmo(&codec_queue, NULL, HZ/20);
+
+        if (!queue_empty(&codec_queue) &&
+            codec_check_queue__have_msg() < 0)
+            return NULL;
+    }
+}
+
 static void codec_pcmbuf_insert_callback(
         const void *ch1, const void *ch2, int count)
 {
@@ -219,23 +243,10 @@ static void codec_pcmbuf_insert_callback(
     {
         int out_count = dsp_output_count(ci.dsp, count);
         int inp_count;
-        char *dest;
-
-        while (1)
-        {
-            if ((dest = pcmbuf_request_buffer(&out_count)) != NULL)
-                break;
-
-            cancel_cpu_boost();
+        char *dest = codec_pcmbuf_wait_buffer(&out_count);
 
-            /* It will be awhile before space is available but we want
-               "instant" response to any message */
-            queue_wait_w_tmo(&codec_queue, NULL, HZ/20);
-
-            if (!queue_empty(&codec_queue) &&
-                codec_check_queue__have_msg() < 0)
-                return;
-        }
+        if (dest == NULL)
+            return;
 
         /* Get the real input_size for output_size bytes, guarding
          * against resampling buffer overflows. */
@@ -259,6 +270,42 @@ static void codec_pcmbuf_insert_callback(
     }
 }
 
+/* Zero-copy output: when the DSP would not change the samples, the codec
+   may decode straight into the PCM buffer. Returns NULL if it can't, in
+   which case the codec uses pcmbuf_insert as usual. Otherwise *count is
+   set to how many samples (in the codec's own format) fit. */
+static void * codec_pcmbuf_request_direct_callback(int *count)
+{
+    int frame_bytes = dsp_direct_frame_bytes(ci.dsp);
+    int out_count;
+
+    if (frame_bytes == 0)
+        return NULL;
+
+    /* The window is sized in 16-bit stereo output samples, while the codec
+       writes its own format there before it is narrowed in place */
+    if (frame_bytes < 4)
+        frame_bytes = 4;
+
+    out_count = *count * frame_bytes / 4;
+
+    direct_buf = codec_pcmbuf_wait_buffer(&out_count);
+
+    *count = out_count * 4 / frame_bytes;
+    return direct_buf;
+}
+
+static void codec_pcmbuf_commit_direct_callback(int count)
+{
+    if (count <= 0 || direct_buf == NULL)
+        return;
+
+    dsp_process_direct(ci.dsp, direct_buf, count);
+    direct_buf = NULL;
+
+    pcmbuf_write_complete(count, ci.id3->elapsed, ci.id3->offset);
+}
+
 /* helper function, not a callback */
 static bool codec_advance_buffer_counters(size_t amount)
 {
@@ -615,6 +662,8 @@ void codec_thread_init(void)
                                                              CODEC_IDX_AUDIO);
     ci.codec_get_buffer = codec_get_buffer_callback;
     ci.pcmbuf_insert    = codec_pcmbuf_insert_callback;
+    ci.pcmbuf_request_direct = codec_pcmbuf_request_direct_callback;
+    ci.pcmbuf_commit_direct  = codec_pcmbuf_commit_direct_callback;
     ci.set_elapsed      = audio_codec_update_elapsed;
     ci.read_filebuf     = codec_filebuf_callback;
     ci.request_buffer   = codec_request_buffer_callback;
@@ -73,7 +73,7 @@ static size_t codec_size;
 
 extern void* plugin_get_audio_buffer(size_t *buffer_size);
 
-#if (CONFIG_PLATFORM & PLATFORM_NATIVE) && defined(HAVE_RECORDING)
+#if (CONFIG_PLATFORM & PLATFORM_NATIVE)
 #undef open
 static int open(const char* pathname, int flags, ...)
 {
@@ -89,6 +89,8 @@ struct codec_api ci = {
     NULL, /* struct dsp_config *dsp */
     NULL, /* codec_get_buffer */
     NULL, /* pcmbuf_insert */
+    NULL, /* pcmbuf_request_direct */
+    NULL, /* pcmbuf_commit_direct */
     NULL, /* set_elapsed */
     NULL, /* read_filebuf */
     NULL, /* request_buffer */
@@ -118,6 +120,7 @@ struct codec_api ci = {
 
     commit_dcache,
     commit_discard_dcache,
+    commit_discard_idcache,
 
     /* strings and memory */
     strcpy,
@@ -138,6 +141,13 @@ struct codec_api ci = {
 
     (qsort_func)qsort,
 
+    /* file */
+    (open_func)PREFIX(open),
+    PREFIX(close),
+    (read_func)PREFIX(read),
+    PREFIX(lseek),
+    (write_func)PREFIX(write),
+
 #ifdef RB_PROFILE
     profile_thread,
     profstop,
@@ -152,13 +162,6 @@ struct codec_api ci = {
     enc_finish_chunk,
     enc_get_pcm_data,
     enc_unget_pcm_data,
-
-    /* file */
-    (open_func)PREFIX(open),
-    PREFIX(close),
-    (read_func)PREFIX(read),
-    PREFIX(lseek),
-    (write_func)PREFIX(write),
     round_value_to_list32,
 
 #endif /* HAVE_RECORDING */
@@ -166,7 +169,7 @@ struct codec_api ci = {
     /* new stuff at the end, sort into place next time
        the API gets incompatible */
 
-    commit_discard_idcache,
+    NULL, /* report_heap_peak */
 };
 
 void codec_get_full_path(char *path, const char *codec_root_fn)
@@ -75,12 +75,12 @@
 #define CODEC_ENC_MAGIC 0x52454E43 /* RENC */
 
 /* increase this every time the api struct changes */
-#define CODEC_API_VERSION 44
+#define CODEC_API_VERSION 47
 
 /* update this to latest version if a change to the api struct breaks
    backwards compatibility (and please take the opportunity to sort in any
    new function which are "waiting" at the end of the function table) */
-#define CODEC_MIN_API_VERSION 43
+#define CODEC_MIN_API_VERSION 46
 
 /* reasons for calling codec main entrypoint */
 enum codec_entry_call_reason {
@@ -122,6 +122,11 @@ struct codec_api {
     /* Insert PCM data into audio buffer for playback. Playback will start
        automatically. */
     void (*pcmbuf_insert)(const void *ch1, const void *ch2, int count);
+    /* Decode straight into the PCM buffer when the DSP would leave the
+       samples unchanged. Returns NULL if that isn't possible, else a window
+       for up to <count> samples to be handed back by pcmbuf_commit_direct. */
+    void * (*pcmbuf_request_direct)(int *count);
+    void (*pcmbuf_commit_direct)(int count);
     /* Set song position in WPS (value in ms). */
     void (*set_elapsed)(unsigned long value);
     
@@ -171,6 +176,7 @@ struct codec_api {
 
     void (*commit_dcache)(void);
     void (*commit_discard_dcache)(void);
+    void (*commit_discard_idcache)(void);
 
     /* strings and memory */
     char* (*strcpy)(char *dst, const char *src);
@@ -194,6 +200,13 @@ struct codec_api {
     void (*qsort)(void *base, size_t nmemb, size_t size,
                   int(*compar)(const void *, const void *));
 
+    /* file */
+    int (*open)(const char* pathname, int flags, ...);
+    int (*close)(int fd);
+    ssize_t (*read)(int fd, void* buf, size_t count);
+    off_t (*lseek)(int fd, off_t offset, int whence);
+    ssize_t (*write)(int fd, const void* buf, size_t count);
+
 #ifdef RB_PROFILE
     void (*profile_thread)(void);
     void (*profstop)(void);
@@ -209,12 +222,6 @@ struct codec_api {
     unsigned char * (*enc_get_pcm_data)(size_t size);
     size_t          (*enc_unget_pcm_data)(size_t size);
 
-    /* file */
-    int (*open)(const char* pathname, int flags, ...);
-    int (*close)(int fd);
-    ssize_t (*read)(int fd, void* buf, size_t count);
-    off_t (*lseek)(int fd, off_t offset, int whence);
-    ssize_t (*write)(int fd, const void* buf, size_t count);
     int (*round_value_to_list32)(unsigned long value,
                                  const unsigned long list[],
                                  int count,
@@ -223,7 +230,10 @@ struct codec_api {
 
     /* new stuff at the end, sort into place next time
        the API gets incompatible */
-    void (*commit_discard_idcache)(void);
+
+    /* told the peak use of codec_malloc() and friends on CODEC_UNLOAD,
+       may be NULL */
+    void (*report_heap_peak)(size_t bytes);
 };
 
 /* codec header */
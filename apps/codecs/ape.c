@@ -45,9 +45,31 @@ static uint32_t seektablebuf[MAX_SEEKPOINTS];
 
 #define INPUT_CHUNKSIZE     (32*1024)
 
-/* 1024*4 = 4096 bytes per channel */
-static int32_t decoded0[BLOCKS_PER_LOOP] IBSS_ATTR;
-static int32_t decoded1[BLOCKS_PER_LOOP] IBSS_ATTR;
+/* The codec thread reads the bitstream of a chunk (the entropy decoder) and
+   the codec pipeline runs the filters and predictor over it. Where that runs
+   in parallel, the bitstream of the next chunk is read meanwhile, so there
+   are two chunks and everything the stages share lives in IRAM. */
+#ifdef CODEC_PIPELINE_THREADED
+#define NUM_CHUNKS          2
+static struct ape_ctx_t ape_ctx IBSS_ATTR;
+#else
+#define NUM_CHUNKS          1
+#endif
+
+struct ape_chunk
+{
+    struct ape_ctx_t* ape_ctx;
+    int32_t* decoded0;
+    int32_t* decoded1;
+    int count;
+    int frameflags;
+    bool newframe;      /* first chunk of a frame, reset the filters */
+};
+
+static struct ape_chunk chunks[NUM_CHUNKS] IBSS_ATTR;
+
+/* 1024*4 = 4096 bytes per channel and chunk */
+static int32_t decoded[NUM_CHUNKS][MAX_CHANNELS][BLOCKS_PER_LOOP] IBSS_ATTR;
 
 #define MAX_SUPPORTED_SEEKTABLE_SIZE 5000
 
@@ -126,12 +148,57 @@ static void ape_resume(struct ape_ctx_t* ape_ctx, size_t resume_offset,
     }
 }
 
+/* Second stage of the pipeline */
+static void ape_filter_chunk(void *block)
+{
+    struct ape_chunk* chunk = block;
+
+    if (chunk->newframe)
+        init_frame_filters(chunk->ape_ctx);
+
+    decode_chunk_filters(chunk->ape_ctx, chunk->frameflags,
+                         chunk->decoded0, chunk->decoded1, chunk->count);
+}
+
+/* Hand a decoded chunk to the pcm buffer */
+static void ape_output_chunk(struct ape_chunk* chunk, uint32_t samplerate,
+                             uint32_t* samplesdone, uint32_t* samplestoskip)
+{
+    uint32_t blocks = chunk->count;
+
+    if (*samplestoskip > 0) {
+        if (*samplestoskip < blocks) {
+            ci->pcmbuf_insert(chunk->decoded0 + *samplestoskip,
+                              chunk->decoded1 + *samplestoskip,
+                              blocks - *samplestoskip);
+            *samplestoskip = 0;
+        } else {
+            *samplestoskip -= blocks;
+        }
+    } else {
+        ci->pcmbuf_insert(chunk->decoded0, chunk->decoded1, blocks);
+    }
+
+    *samplesdone += blocks;
+
+    if (!*samplestoskip) {
+        /* Update the elapsed-time indicator */
+        ci->set_elapsed((*samplesdone*10)/(samplerate/100));
+    }
+}
+
 /* this is the codec entry point */
 enum codec_status codec_main(enum codec_entry_call_reason reason)
 {
     if (reason == CODEC_LOAD) {
         /* Generic codec initialisation */
         ci->configure(DSP_SET_SAMPLE_DEPTH, APE_OUTPUT_DEPTH-1);
+
+        if (!codec_pipeline_init(ape_filter_chunk))
+            return CODEC_ERROR;
+    }
+    else if (reason == CODEC_UNLOAD) {
+        codec_pipeline_quit();
     }
 
     return CODEC_OK;
@@ -140,7 +207,13 @@ enum codec_status codec_main(enum codec_entry_call_reason reason)
 /* this is called for each file to process */
 enum codec_status codec_run(void)
 {
+#ifndef CODEC_PIPELINE_THREADED
     struct ape_ctx_t ape_ctx;
+#endif
+    struct ape_chunk* chunk;
+    struct ape_chunk* inflight = NULL;
+    int k = 0;
+    bool newframe;
     uint32_t samplesdone;
     uint32_t elapsedtime;
     size_t bytesleft;
@@ -151,8 +224,6 @@ enum codec_status codec_run(void)
     int nblocks;
     int bytesconsumed;
     unsigned char* inbuffer;
-    uint32_t blockstodecode;
-    int res;
     int firstbyte;
     size_t resume_offset;
     intptr_t param;
@@ -223,6 +294,13 @@ enum codec_status codec_run(void)
     elapsedtime = (samplesdone*10)/(ape_ctx.samplerate/100);
     ci->set_elapsed(elapsedtime);
 
+    for (k = 0; k < NUM_CHUNKS; k++) {
+        chunks[k].ape_ctx = &ape_ctx;
+        chunks[k].decoded0 = decoded[k][0];
+        chunks[k].decoded1 = decoded[k][1];
+    }
+    k = 0;
+
     /* Initialise the buffer */
     inbuffer = ci->request_buffer(&bytesleft, INPUT_CHUNKSIZE);
 
@@ -238,8 +316,10 @@ frame_start:
 
         ape_ctx.currentframeblocks = nblocks;
 
-        /* Initialise the frame decoder */
-        init_frame_decoder(&ape_ctx, inbuffer, &firstbyte, &bytesconsumed);
+        /* Initialise the frame decoder - the filters are reset by the
+           second stage when it gets to the first chunk of the frame */
+        init_frame_entropy(&ape_ctx, inbuffer, &firstbyte, &bytesconsumed);
+        newframe = true;
 
         ci->advance_buffer(bytesconsumed);
         inbuffer = ci->request_buffer(&bytesleft, INPUT_CHUNKSIZE);
@@ -261,6 +341,10 @@ frame_start:
                     &newfilepos,
                     &samplestoskip))
                 {
+                    /* Drop the chunk still in the second stage */
+                    codec_pipeline_wait();
+                    inflight = NULL;
+
                     samplesdone = currentframe * ape_ctx.blocksperframe;
 
                     /* APE's bytestream is weird... */
@@ -279,52 +363,55 @@ frame_start:
                 ci->seek_complete();
             }
 
-            blockstodecode = MIN(BLOCKS_PER_LOOP, nblocks);
+            chunk = &chunks[k];
+            chunk->count = MIN(BLOCKS_PER_LOOP, nblocks);
+            chunk->frameflags = ape_ctx.frameflags;
+            chunk->newframe = newframe;
+            newframe = false;
 
-            if ((res = decode_chunk(&ape_ctx, inbuffer, &firstbyte,
-                                    &bytesconsumed,
-                                    decoded0, decoded1,
-                                    blockstodecode)) < 0)
-            {
-                /* Frame decoding error, abort */
-                LOGF("APE: Frame %lu, error %d\n",(unsigned long)currentframe,res);
-                return CODEC_ERROR;
-            }
-
-            ci->yield();
-
-            if (samplestoskip > 0) {
-                if (samplestoskip < blockstodecode) {
-                    ci->pcmbuf_insert(decoded0 + samplestoskip, 
-                                      decoded1 + samplestoskip, 
-                                      blockstodecode - samplestoskip);
-                    samplestoskip = 0;
-                } else {
-                    samplestoskip -= blockstodecode;
-                }
-            } else {
-                ci->pcmbuf_insert(decoded0, decoded1, blockstodecode);
-            }
-        
-            samplesdone += blockstodecode;
-
-            if (!samplestoskip) {
-                /* Update the elapsed-time indicator */
-                elapsedtime = (samplesdone*10)/(ape_ctx.samplerate/100);
-                ci->set_elapsed(elapsedtime);
-            }
+            decode_chunk_entropy(&ape_ctx, inbuffer, &firstbyte,
+                                 &bytesconsumed,
+                                 chunk->decoded0, chunk->decoded1,
+                                 chunk->count);
 
             ci->advance_buffer(bytesconsumed);
             inbuffer = ci->request_buffer(&bytesleft, INPUT_CHUNKSIZE);
 
             /* Decrement the block count */
-            nblocks -= blockstodecode;
+            nblocks -= chunk->count;
+
+            /* Output the chunk before this one once the second stage is
+               done with it, then give it this one */
+            codec_pipeline_wait();
+
+            if (inflight)
+                ape_output_chunk(inflight, ape_ctx.samplerate,
+                                 &samplesdone, &samplestoskip);
+
+            codec_pipeline_start(chunk);
+
+#if NUM_CHUNKS > 1
+            inflight = chunk;
+            k ^= 1;
+#else
+            ape_output_chunk(chunk, ape_ctx.samplerate,
+                             &samplesdone, &samplestoskip);
+#endif
+
+            ci->yield();
         }
 
         currentframe++;
     }
 
+    codec_pipeline_wait();
+
+    if (inflight)
+        ape_output_chunk(inflight, ape_ctx.samplerate,
+                         &samplesdone, &samplestoskip);
+
 done:
+    codec_pipeline_wait();
     LOGF("APE: Decoded %lu samples\n",(unsigned long)samplesdone);
     return CODEC_OK;
 }
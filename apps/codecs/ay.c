@@ -51,6 +51,7 @@ enum codec_status codec_run(void)
     size_t n;
     int track, is_multitrack;
     intptr_t param;
+    int16_t *out;
     uint32_t elapsed_time;
 
     /* reset values */
@@ -117,14 +118,15 @@ next_track:
         }
 
         /* Generate audio buffer */
-        err = Ay_play(&ay_emu, CHUNK_SIZE, samples);
+        out = codec_pcmbuf_request(samples, CHUNK_SIZE >> 1);
+        err = Ay_play(&ay_emu, CHUNK_SIZE, out);
         if (err || Track_ended(&ay_emu)) {
             track++;
             if (track >= ay_emu.track_count) break;
             goto next_track;
         }
 
-        ci->pcmbuf_insert(samples, NULL, CHUNK_SIZE >> 1);
+        codec_pcmbuf_commit(out, CHUNK_SIZE >> 1);
 
         /* Set elapsed time for one track files */
         if (!is_multitrack) {
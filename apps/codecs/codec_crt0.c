@@ -21,6 +21,7 @@
 
 #include "config.h"
 #include "codecs.h"
+#include "codeclib.h"
 
 struct codec_api *ci DATA_ATTR;
 
@@ -63,7 +64,16 @@ enum codec_status codec_start(enum codec_entry_call_reason reason)
     /* Note: If for any reason codec_main would not be called with CODEC_LOAD
      * because the above code failed then it must not be ever be called with
      * any other value and some strategy to avoid doing so must be conceived */
-    return codec_main(reason);
+    enum codec_status status = codec_main(reason);
+
+    if (reason == CODEC_UNLOAD)
+    {
+        codec_heap_dump();
+        if (ci->report_heap_peak)
+            ci->report_heap_peak(codec_heap_peak());
+    }
+
+    return status;
 }
 
 #if defined(CPU_ARM) && (CONFIG_PLATFORM & PLATFORM_NATIVE)
@@ -23,6 +23,7 @@ Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA 02110, USA
 */
 
 #include <inttypes.h>
+#include <stdbool.h>
 #include <string.h>
 
 #include "demac.h"
@@ -60,14 +61,17 @@ static filter_int filterbuf1280[(1280*3 + FILTER_HISTORY_SIZE) * 2]
                   IBSS_ATTR_DEMAC_INSANEBUF MEM_ALIGN_ATTR;
                   /* 17408 or 34816 bytes */
 
-void init_frame_decoder(struct ape_ctx_t* ape_ctx,
-                        unsigned char* inbuffer, int* firstbyte,
-                        int* bytesconsumed)
+/* Whether a frame is decoded as mono: real mono and pseudo-stereo, where the
+   right channel is a copy of the left */
+static inline bool mono_frame(struct ape_ctx_t* ape_ctx, int frameflags)
 {
-    init_entropy_decoder(ape_ctx, inbuffer, firstbyte, bytesconsumed);
-    //printf("CRC=0x%08x\n",ape_ctx->CRC);
-    //printf("Flags=0x%08x\n",ape_ctx->frameflags);
+    return (ape_ctx->channels==1) || ((frameflags
+        & (APE_FRAMECODE_PSEUDO_STEREO|APE_FRAMECODE_STEREO_SILENCE))
+        == APE_FRAMECODE_PSEUDO_STEREO);
+}
 
+void init_frame_filters(struct ape_ctx_t* ape_ctx)
+{
     init_predictor_decoder(&ape_ctx->predictor);
 
     switch (ape_ctx->compressiontype)
@@ -92,11 +96,41 @@ void init_frame_decoder(struct ape_ctx_t* ape_ctx,
     }
 }
 
-int ICODE_ATTR_DEMAC decode_chunk(struct ape_ctx_t* ape_ctx,
-                                  unsigned char* inbuffer, int* firstbyte,
-                                  int* bytesconsumed,
-                                  int32_t* decoded0, int32_t* decoded1,
-                                  int count)
+void init_frame_entropy(struct ape_ctx_t* ape_ctx,
+                        unsigned char* inbuffer, int* firstbyte,
+                        int* bytesconsumed)
+{
+    init_entropy_decoder(ape_ctx, inbuffer, firstbyte, bytesconsumed);
+    //printf("CRC=0x%08x\n",ape_ctx->CRC);
+    //printf("Flags=0x%08x\n",ape_ctx->frameflags);
+}
+
+void init_frame_decoder(struct ape_ctx_t* ape_ctx,
+                        unsigned char* inbuffer, int* firstbyte,
+                        int* bytesconsumed)
+{
+    init_frame_entropy(ape_ctx, inbuffer, firstbyte, bytesconsumed);
+    init_frame_filters(ape_ctx);
+}
+
+void ICODE_ATTR_DEMAC decode_chunk_entropy(struct ape_ctx_t* ape_ctx,
+                                           unsigned char* inbuffer,
+                                           int* firstbyte,
+                                           int* bytesconsumed,
+                                           int32_t* decoded0,
+                                           int32_t* decoded1,
+                                           int count)
+{
+    entropy_decode(ape_ctx, inbuffer, firstbyte, bytesconsumed,
+                   decoded0, mono_frame(ape_ctx, ape_ctx->frameflags) ?
+                             NULL : decoded1, count);
+}
+
+void ICODE_ATTR_DEMAC decode_chunk_filters(struct ape_ctx_t* ape_ctx,
+                                           int frameflags,
+                                           int32_t* decoded0,
+                                           int32_t* decoded1,
+                                           int count)
 {
     int32_t left, right;
 #ifdef ROCKBOX
@@ -106,16 +140,10 @@ int ICODE_ATTR_DEMAC decode_chunk(struct ape_ctx_t* ape_ctx,
     #define SCALE(x) (x)
 #endif
          
-    if ((ape_ctx->channels==1) || ((ape_ctx->frameflags
-        & (APE_FRAMECODE_PSEUDO_STEREO|APE_FRAMECODE_STEREO_SILENCE))
-        == APE_FRAMECODE_PSEUDO_STEREO)) {
-
-        entropy_decode(ape_ctx, inbuffer, firstbyte, bytesconsumed,
-                       decoded0, NULL, count);
-
-        if (ape_ctx->frameflags & APE_FRAMECODE_MONO_SILENCE) {
+    if (mono_frame(ape_ctx, frameflags)) {
+        if (frameflags & APE_FRAMECODE_MONO_SILENCE) {
             /* We are pure silence, so we're done. */
-            return 0;
+            return;
         }
 
         switch (ape_ctx->compressiontype)
@@ -161,13 +189,10 @@ int ICODE_ATTR_DEMAC decode_chunk(struct ape_ctx_t* ape_ctx,
         }
 #endif
     } else { /* Stereo */
-        entropy_decode(ape_ctx, inbuffer, firstbyte, bytesconsumed,
-                       decoded0, decoded1, count);
-
-        if ((ape_ctx->frameflags & APE_FRAMECODE_STEREO_SILENCE)
+        if ((frameflags & APE_FRAMECODE_STEREO_SILENCE)
             == APE_FRAMECODE_STEREO_SILENCE) {
             /* We are pure silence, so we're done. */
-            return 0;
+            return;
         }
 
         /* Apply filters - compression type 1000 doesn't have any */
@@ -212,5 +237,17 @@ int ICODE_ATTR_DEMAC decode_chunk(struct ape_ctx_t* ape_ctx,
             *(decoded1++) = SCALE(right);
         }
     }
+}
+
+int ICODE_ATTR_DEMAC decode_chunk(struct ape_ctx_t* ape_ctx,
+                                  unsigned char* inbuffer, int* firstbyte,
+                                  int* bytesconsumed,
+                                  int32_t* decoded0, int32_t* decoded1,
+                                  int count)
+{
+    decode_chunk_entropy(ape_ctx, inbuffer, firstbyte, bytesconsumed,
+                         decoded0, decoded1, count);
+    decode_chunk_filters(ape_ctx, ape_ctx->frameflags,
+                         decoded0, decoded1, count);
     return 0;
 }
@@ -38,6 +38,26 @@ int decode_chunk(struct ape_ctx_t* ape_ctx,
                  int32_t* decoded0, int32_t* decoded1, 
                  int count);
 
+/* init_frame_decoder() and decode_chunk() in two halves, for decoders that
+   read the bitstream of one chunk while the filters of the chunk before run
+   elsewhere. The filters only need the frame flags from the time the chunk
+   was read. */
+void init_frame_entropy(struct ape_ctx_t* ape_ctx,
+                        unsigned char* inbuffer, int* firstbyte,
+                        int* bytesconsumed);
+
+void init_frame_filters(struct ape_ctx_t* ape_ctx);
+
+void decode_chunk_entropy(struct ape_ctx_t* ape_ctx,
+                          unsigned char* inbuffer, int* firstbyte,
+                          int* bytesconsumed,
+                          int32_t* decoded0, int32_t* decoded1,
+                          int count);
+
+void decode_chunk_filters(struct ape_ctx_t* ape_ctx, int frameflags,
+                          int32_t* decoded0, int32_t* decoded1,
+                          int count);
+
 uint32_t ape_initcrc(void);
 uint32_t ape_updatecrc(unsigned char *block, int count, uint32_t crc);
 uint32_t ape_finishcrc(uint32_t crc);
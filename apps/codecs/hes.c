@@ -49,6 +49,7 @@ enum codec_status codec_run(void)
     uint8_t *buf;
     size_t n;
     intptr_t param;
+    int16_t *out;
     int track = 0;
     
     DEBUGF("HES: next_track\n");
@@ -94,14 +95,15 @@ next_track:
         }
 
         /* Generate audio buffer */
-        err = Hes_play(&hes_emu, CHUNK_SIZE, samples);
+        out = codec_pcmbuf_request(samples, CHUNK_SIZE >> 1);
+        err = Hes_play(&hes_emu, CHUNK_SIZE, out);
         if (err || Track_ended(&hes_emu)) {
             track++;
             if (track >= hes_emu.track_count) break;
             goto next_track;
         }
 
-        ci->pcmbuf_insert(samples, NULL, CHUNK_SIZE >> 1);
+        codec_pcmbuf_commit(out, CHUNK_SIZE >> 1);
     }
 
     return CODEC_OK;
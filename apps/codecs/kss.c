@@ -50,6 +50,7 @@ enum codec_status codec_run(void)
     size_t n;
     int track;
     intptr_t param;
+    int16_t *out;
 
     /* reset values */
     track = 0;
@@ -97,14 +98,15 @@ next_track:
         }
 
         /* Generate audio buffer */
-        err = Kss_play(&kss_emu, CHUNK_SIZE, samples);
+        out = codec_pcmbuf_request(samples, CHUNK_SIZE >> 1);
+        err = Kss_play(&kss_emu, CHUNK_SIZE, out);
         if (err || Track_ended(&kss_emu)) {
             track++;
             if (track >= kss_emu.track_count) break;
             goto next_track;
         }
 
-        ci->pcmbuf_insert(samples, NULL, CHUNK_SIZE >> 1);
+        codec_pcmbuf_commit(out, CHUNK_SIZE >> 1);
     }
 
     return CODEC_OK;
@@ -25,20 +25,51 @@
 #include "codecs.h"
 #include "dsp.h"
 #include "codeclib.h"
+#include "tlsf.h"
 #include "metadata.h"
 
-/* The following variables are used by codec_malloc() to make use of free RAM
- * within the statically allocated codec buffer. */
-static size_t mem_ptr = 0;
-static size_t bufsize = 0;
-static unsigned char* mallocbuf = NULL;
+/* The codec heap is a TLSF pool over the codec buffer, set up anew by every
+ * codec_init(). Each block starts with a header, which keeps blocks aligned to
+ * CACHEALIGN_SIZE like the old bump allocator did and remembers their size
+ * for codec_realloc() and the statistics. Debug builds also keep a list of
+ * the blocks in use for codec_heap_dump(). */
+struct heap_block
+{
+    void *base;                 /* what TLSF returned */
+    size_t size;                /* size asked for */
+#ifdef DEBUG
+    void *caller;
+    struct heap_block *prev;
+    struct heap_block *next;
+#endif
+};
+
+#define HEAP_BLOCK_OVERHEAD (sizeof(struct heap_block) + CACHEALIGN_SIZE - 1)
+
+static void *heap = NULL;
+static size_t heap_size = 0;
+static size_t heap_used = 0;    /* bytes in use right now */
+static size_t heap_peak = 0;    /* most bytes in use since the codec loaded */
+static int heap_blocks = 0;
+#ifdef DEBUG
+static struct heap_block *heap_list = NULL;
+#endif
 
 int codec_init(void)
 {
     /* codec_get_buffer() aligns the resulting point to CACHEALIGN_SIZE. */
-    mem_ptr = 0;
-    mallocbuf = (unsigned char *)ci->codec_get_buffer((size_t *)&bufsize);
-  
+    heap = ci->codec_get_buffer(&heap_size);
+
+    /* Forget the pool left by the last track, TLSF would take it over */
+    destroy_memory_pool(heap);
+    if (init_memory_pool(heap_size, heap) == (size_t)-1)
+        return -1;
+
+    heap_used = 0;
+    heap_blocks = 0;
+#ifdef DEBUG
+    heap_list = NULL;
+#endif
     return 0;
 }
 
@@ -50,46 +81,171 @@ void codec_set_replaygain(const struct mp3entry *id3)
     ci->configure(DSP_SET_ALBUM_PEAK, id3->album_peak);
 }
 
+/* For codecs producing one buffer of interleaved or mono samples at a time:
+ * returns where to decode the next count samples. That is the PCM buffer
+ * itself when the DSP has nothing to do and there is room for all count
+ * samples, otherwise it is buf. Hand the result to codec_pcmbuf_commit()
+ * once the samples are there; it is fine not to if they are dropped.
+ * Hosts that don't set pcmbuf_request_direct always get buf back. */
+static void *pcmbuf_window = NULL;
+
+void * codec_pcmbuf_request(void *buf, int count)
+{
+    int n = count;
+    void *window;
+
+    if (ci->pcmbuf_request_direct == NULL)
+        return buf;
+
+    window = ci->pcmbuf_request_direct(&n);
+
+    if (window == NULL || n < count)
+        return buf;
+
+    pcmbuf_window = window;
+    return window;
+}
+
+void codec_pcmbuf_commit(const void *buf, int count)
+{
+    if (buf == pcmbuf_window)
+    {
+        pcmbuf_window = NULL;
+        ci->pcmbuf_commit_direct(count);
+    }
+    else
+    {
+        ci->pcmbuf_insert(buf, NULL, count);
+    }
+}
+
 /* Various "helper functions" common to all the xxx2wav decoder plugins  */
 
 
-void* codec_malloc(size_t size)
+static void *heap_alloc(size_t size, void *caller)
 {
-    void* x;
+    struct heap_block *b;
+    void *base;
+    uintptr_t ptr;
 
-    if (mem_ptr + (long)size > bufsize)
+    if (heap == NULL)
         return NULL;
-    
-    x=&mallocbuf[mem_ptr];
-    
-    /* Keep memory aligned to CACHEALIGN_SIZE. */
-    mem_ptr += (size + (CACHEALIGN_SIZE-1)) & ~(CACHEALIGN_SIZE-1);
 
-    return(x);
+    base = malloc_ex(size + HEAP_BLOCK_OVERHEAD, heap);
+    if (base == NULL)
+        return NULL;
+
+    ptr = ((uintptr_t)base + sizeof(struct heap_block) + CACHEALIGN_SIZE - 1)
+          & ~(uintptr_t)(CACHEALIGN_SIZE - 1);
+    b = (struct heap_block *)ptr - 1;
+    b->base = base;
+    b->size = size;
+#ifdef DEBUG
+    b->caller = caller;
+    b->prev = NULL;
+    b->next = heap_list;
+    if (heap_list)
+        heap_list->prev = b;
+    heap_list = b;
+#else
+    (void)caller;
+#endif
+
+    heap_used += size;
+    heap_blocks++;
+    if (heap_used > heap_peak)
+        heap_peak = heap_used;
+
+    return (void *)ptr;
+}
+
+void* codec_malloc(size_t size)
+{
+    return heap_alloc(size, __builtin_return_address(0));
 }
 
 void* codec_calloc(size_t nmemb, size_t size)
 {
     void* x;
-    x = codec_malloc(nmemb*size);
+    x = heap_alloc(nmemb*size, __builtin_return_address(0));
     if (x == NULL)
         return NULL;
     ci->memset(x,0,nmemb*size);
     return(x);
 }
 
-void codec_free(void* ptr) {
-    (void)ptr;
+void codec_free(void* ptr)
+{
+    struct heap_block *b;
+
+    if (ptr == NULL)
+        return;
+
+    b = (struct heap_block *)ptr - 1;
+    heap_used -= b->size;
+    heap_blocks--;
+#ifdef DEBUG
+    if (b->prev)
+        b->prev->next = b->next;
+    else
+        heap_list = b->next;
+    if (b->next)
+        b->next->prev = b->prev;
+#endif
+    free_ex(b->base, heap);
 }
 
 void* codec_realloc(void* ptr, size_t size)
 {
     void* x;
-    (void)ptr;
-    x = codec_malloc(size);
+
+    if (ptr == NULL)
+        return heap_alloc(size, __builtin_return_address(0));
+
+    /* TLSF could grow the block in place, but not without moving the data
+     * off its alignment, so always move */
+    x = heap_alloc(size, __builtin_return_address(0));
+    if (x == NULL)
+        return NULL;
+    ci->memcpy(x, ptr, MIN(size, ((struct heap_block *)ptr - 1)->size));
+    codec_free(ptr);
     return(x);
 }
 
+size_t codec_heap_used(void)
+{
+    return heap_used;
+}
+
+size_t codec_heap_peak(void)
+{
+    return heap_peak;
+}
+
+/* Logs the high-water mark of the codec heap, and in debug builds every block
+ * still allocated and who allocated it */
+#if defined(DEBUG) || defined(SIMULATOR)
+#define HEAPF DEBUGF
+#else
+#define HEAPF LOGF
+#endif
+
+void codec_heap_dump(void)
+{
+#ifdef DEBUG
+    struct heap_block *b;
+#endif
+
+    HEAPF("codec heap: peak %lu of %lu bytes, %lu bytes in %d blocks in use\n",
+          (unsigned long)heap_peak, (unsigned long)heap_size,
+          (unsigned long)heap_used, heap_blocks);
+#ifdef DEBUG
+    for (b = heap_list; b; b = b->next)
+        DEBUGF("  %p %8lu bytes, from %p\n", (void *)(b + 1),
+               (unsigned long)b->size, b->caller);
+#endif
+}
+
 size_t strlen(const char *s)
 {
     return(ci->strlen(s));
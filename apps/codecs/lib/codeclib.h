@@ -28,6 +28,7 @@
 #include "codecs.h"
 #include "mdct.h"
 #include "fft.h"
+#include "pipeline.h"
 
 extern struct codec_api *ci;
 
@@ -47,6 +48,9 @@ void* codec_malloc(size_t size);
 void* codec_calloc(size_t nmemb, size_t size);
 void* codec_realloc(void* ptr, size_t size);
 void codec_free(void* ptr);
+size_t codec_heap_used(void);
+size_t codec_heap_peak(void);
+void codec_heap_dump(void);
 
 void *memcpy(void *dest, const void *src, size_t n);
 void *memset(void *s, int c, size_t n);
@@ -152,6 +156,8 @@ static inline unsigned int bs_generic(unsigned int v, int mode)
 
 int codec_init(void);
 void codec_set_replaygain(const struct mp3entry *id3);
+void * codec_pcmbuf_request(void *buf, int count);
+void codec_pcmbuf_commit(const void *buf, int count);
 
 #ifdef RB_PROFILE
 void __cyg_profile_func_enter(void *this_fn, void *call_site)
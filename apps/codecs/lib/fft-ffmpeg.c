@@ -55,6 +55,7 @@
 /* asm-optimised functions and/or macros */
 #include "fft-ffmpeg_arm.h"
 #include "fft-ffmpeg_cf.h"
+#include "fft-ffmpeg_sse.h"
 
 #ifndef ICODE_ATTR_TREMOR_MDCT
 #define ICODE_ATTR_TREMOR_MDCT ICODE_ATTR
@@ -275,6 +276,15 @@ static inline FFTComplex* TRANSFORM_ZERO(FFTComplex * z, unsigned int n)
 }
 #endif
 
+#ifndef FFT_FFMPEG_INCL_OPTIMISED_TRANSFORM_PAIR
+/* Two consecutive TRANSFORM_W10()s (twiddles w and w+step), or
+   TRANSFORM_W01()s (twiddles w and w-step) */
+#define TRANSFORM_W10_PAIR(z, n, w, step) \
+    TRANSFORM_W10(TRANSFORM_W10((z), (n), (w)), (n), (w)+(step))
+#define TRANSFORM_W01_PAIR(z, n, w, step) \
+    TRANSFORM_W01(TRANSFORM_W01((z), (n), (w)), (n), (w)-(step))
+#endif
+
 /* z[0...8n-1], w[1...2n-1] */
 static void pass(FFTComplex *z_arg, unsigned int STEP_arg, unsigned int n_arg) ICODE_ATTR_TREMOR_MDCT;
 static void pass(FFTComplex *z_arg, unsigned int STEP_arg, unsigned int n_arg)
@@ -293,20 +303,16 @@ static void pass(FFTComplex *z_arg, unsigned int STEP_arg, unsigned int n_arg)
     w += STEP;
     /* first pass forwards through sincos_lookup0*/
     do {
-        z = TRANSFORM_W10(z,n,w);
-        w += STEP;
-        z = TRANSFORM_W10(z,n,w);
-        w += STEP;
+        z = TRANSFORM_W10_PAIR(z,n,w,STEP);
+        w += 2*STEP;
     } while(LIKELY(w < w_end));
     /* second half: pass backwards through sincos_lookup0*/
     /* wim and wre are now in opposite places so ordering now [0],[1] */
     w_end=sincos_lookup0;
     while(LIKELY(w>w_end))
     {
-        z = TRANSFORM_W01(z,n,w);
-        w -= STEP;
-        z = TRANSFORM_W01(z,n,w);
-        w -= STEP;
+        z = TRANSFORM_W01_PAIR(z,n,w,STEP);
+        w -= 2*STEP;
     }
 }
 
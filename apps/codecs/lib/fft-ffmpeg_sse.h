@@ -0,0 +1,88 @@
+/***************************************************************************
+ *             __________               __   ___.
+ *   Open      \______   \ ____   ____ |  | _\_ |__   _______  ___
+ *   Source     |       _//  _ \_/ ___\|  |/ /| __ \ /  _ \  \/  /
+ *   Jukebox    |    |   (  <_> )  \___|    < | \_\ (  <_> > <  <
+ *   Firmware   |____|_  /\____/ \___  >__|_ \|___  /\____/__/\_ \
+ *                     \/            \/     \/    \/            \/
+ * $Id$
+ *
+ * Copyright (C) 2012 The Rockbox Project
+ *
+ * SSE4.1 optimisations for ffmpeg's fft (used in fft-ffmpeg.c) on hosted x86
+ * builds compiled with -msse4.1 or a -march that has it. The results are
+ * bit-exact with the generic C version; lib/rbcodec/test/ffttest checks that
+ * they are. Plain SSE2 has no signed 32x32->64 bit multiply, and emulating
+ * it makes this slower than the scalar code.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This software is distributed on an "AS IS" basis, WITHOUT WARRANTY OF ANY
+ * KIND, either express or implied.
+ *
+ ****************************************************************************/
+
+#if (CONFIG_PLATFORM & PLATFORM_HOSTED) && defined(__SSE4_1__)
+#include <smmintrin.h>
+
+/* Four lanes of MULT31(a, b) */
+static inline __m128i fft_mult31_epi32(__m128i a, __m128i b)
+{
+    __m128i even = _mm_mul_epi32(a, b);
+    __m128i odd = _mm_mul_epi32(_mm_srli_epi64(a, 32), _mm_srli_epi64(b, 32));
+    __m128i hi = _mm_blend_epi16(_mm_srli_epi64(even, 32), odd, 0xcc);
+    return _mm_slli_epi32(hi, 1);
+}
+
+/* Swap re and im of both complex values */
+#define FFT_SWAP_REIM(x) _mm_shuffle_epi32((x), _MM_SHUFFLE(2, 3, 0, 1))
+
+/* Two TRANSFORM()s, on z[0] with w0 and on z[1] with w1 */
+static inline FFTComplex* transform_pair_sse(FFTComplex *z, unsigned int n,
+                                             FFTSample wre0, FFTSample wim0,
+                                             FFTSample wre1, FFTSample wim1)
+{
+    const __m128i neg_im = _mm_set_epi32(-1, 1, -1, 1);
+    const __m128i neg_re = _mm_set_epi32(1, -1, 1, -1);
+    const __m128i wre = _mm_set_epi32(wre1, wre1, wre0, wre0);
+    const __m128i wim = _mm_set_epi32(wim1, wim1, wim0, wim0);
+    __m128i a0 = _mm_loadu_si128((__m128i *)&z[0]);
+    __m128i a1 = _mm_loadu_si128((__m128i *)&z[n]);
+    __m128i a2 = _mm_loadu_si128((__m128i *)&z[n*2]);
+    __m128i a3 = _mm_loadu_si128((__m128i *)&z[n*3]);
+    __m128i t12, t56, sum, diff;
+
+    /* XPROD31_R: t1 = re*wre + im*wim, t2 = im*wre - re*wim */
+    t12 = _mm_add_epi32(fft_mult31_epi32(a2, wre),
+                        _mm_sign_epi32(fft_mult31_epi32(FFT_SWAP_REIM(a2), wim),
+                                       neg_im));
+    /* XNPROD31_R: t5 = re*wre - im*wim, t6 = im*wre + re*wim */
+    t56 = _mm_add_epi32(fft_mult31_epi32(a3, wre),
+                        _mm_sign_epi32(fft_mult31_epi32(FFT_SWAP_REIM(a3), wim),
+                                       neg_re));
+
+    /* BUTTERFLIES: (t1 + t5, t2 + t6) for a0/a2, (t2 - t6, t5 - t1) for
+     * a1/a3 */
+    sum = _mm_add_epi32(t12, t56);
+    diff = _mm_sign_epi32(FFT_SWAP_REIM(_mm_sub_epi32(t12, t56)), neg_im);
+
+    _mm_storeu_si128((__m128i *)&z[0], _mm_add_epi32(a0, sum));
+    _mm_storeu_si128((__m128i *)&z[n*2], _mm_sub_epi32(a0, sum));
+    _mm_storeu_si128((__m128i *)&z[n], _mm_add_epi32(a1, diff));
+    _mm_storeu_si128((__m128i *)&z[n*3], _mm_sub_epi32(a1, diff));
+
+    return z+2;
+}
+
+#define FFT_FFMPEG_INCL_OPTIMISED_TRANSFORM_PAIR
+#define TRANSFORM_W10_PAIR(z, n, w, step) \
+    transform_pair_sse((z), (n), (w)[1], (w)[0], ((w)+(step))[1], \
+                       ((w)+(step))[0])
+#define TRANSFORM_W01_PAIR(z, n, w, step) \
+    transform_pair_sse((z), (n), (w)[0], (w)[1], ((w)-(step))[0], \
+                       ((w)-(step))[1])
+
+#endif /* PLATFORM_HOSTED && __SSE4_1__ */
@@ -0,0 +1,204 @@
+/***************************************************************************
+ *             __________               __   ___.
+ *   Open      \______   \ ____   ____ |  | _\_ |__   _______  ___
+ *   Source     |       _//  _ \_/ ___\|  |/ /| __ \ /  _ \  \/  /
+ *   Jukebox    |    |   (  <_> )  \___|    < | \_\ (  <_> > <  <
+ *   Firmware   |____|_  /\____/ \___  >__|_ \|___  /\____/__/\_ \
+ *                     \/            \/     \/    \/            \/
+ * $Id$
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This software is distributed on an "AS IS" basis, WITHOUT WARRANTY OF ANY
+ * KIND, either express or implied.
+ *
+ ****************************************************************************/
+
+#include "codeclib.h"
+#include "pipeline.h"
+
+static void (*stage_func)(void *block) IBSS_ATTR;
+
+#if NUM_CORES > 1
+/* The second stage is a thread on the COP, like the libmad synthesis
+ * thread that this grew out of */
+
+static void * volatile stage_block IBSS_ATTR;
+static volatile bool stage_die IBSS_ATTR;
+static bool stage_busy; /* only used by the codec thread */
+static struct semaphore stage_done_sem IBSS_ATTR;
+static struct semaphore stage_pending_sem IBSS_ATTR;
+
+static int stage_stack[DEFAULT_STACK_SIZE/sizeof(int)] IBSS_ATTR;
+static unsigned int stage_thread_id;
+
+static void stage_thread(void)
+{
+    while (1) {
+        ci->semaphore_wait(&stage_pending_sem, TIMEOUT_BLOCK);
+
+        if (stage_die)
+            break;
+
+        stage_func(stage_block);
+        ci->semaphore_release(&stage_done_sem);
+    }
+
+    /* The stage may have kept state in cached DRAM; don't leave dirty lines
+     * behind for whatever gets loaded there next */
+    ci->commit_discard_dcache();
+}
+
+bool codec_pipeline_init(void (*stage)(void *block))
+{
+    stage_func = stage;
+    stage_die = false;
+    stage_busy = false;
+
+    ci->semaphore_init(&stage_done_sem, 1, 0);
+    ci->semaphore_init(&stage_pending_sem, 1, 0);
+
+    stage_thread_id = ci->create_thread(stage_thread, stage_stack,
+                                        sizeof(stage_stack), 0, "codec stage"
+                                        IF_PRIO(, PRIORITY_PLAYBACK)
+                                        IF_COP(, COP));
+
+    return stage_thread_id != 0;
+}
+
+void codec_pipeline_quit(void)
+{
+    if (stage_thread_id == 0)
+        return;
+
+    codec_pipeline_wait();
+    stage_die = true;
+    ci->semaphore_release(&stage_pending_sem);
+    ci->thread_wait(stage_thread_id);
+    stage_thread_id = 0;
+    ci->commit_discard_dcache();
+}
+
+void codec_pipeline_start(void *block)
+{
+    stage_block = block;
+    stage_busy = true;
+    ci->semaphore_release(&stage_pending_sem);
+}
+
+void codec_pipeline_wait(void)
+{
+    if (stage_busy) {
+        ci->semaphore_wait(&stage_done_sem, TIMEOUT_BLOCK);
+        stage_busy = false;
+    }
+}
+
+#elif defined(CODEC_PIPELINE_THREADED)
+/* SDL builds: a host thread, which really runs in parallel. It only ever
+ * calls the stage function, never into the Rockbox kernel. */
+#include <pthread.h>
+
+static pthread_t stage_thread_id;
+static bool stage_running;
+static pthread_mutex_t stage_mutex = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t stage_cond = PTHREAD_COND_INITIALIZER;
+static void *stage_block;
+static bool stage_pending;
+static bool stage_die;
+
+static void * stage_thread(void *arg)
+{
+    (void)arg;
+
+    pthread_mutex_lock(&stage_mutex);
+
+    while (1) {
+        while (!stage_pending && !stage_die)
+            pthread_cond_wait(&stage_cond, &stage_mutex);
+
+        if (stage_die)
+            break;
+
+        pthread_mutex_unlock(&stage_mutex);
+        stage_func(stage_block);
+        pthread_mutex_lock(&stage_mutex);
+
+        stage_pending = false;
+        pthread_cond_broadcast(&stage_cond);
+    }
+
+    pthread_mutex_unlock(&stage_mutex);
+    return NULL;
+}
+
+bool codec_pipeline_init(void (*stage)(void *block))
+{
+    stage_func = stage;
+    stage_pending = false;
+    stage_die = false;
+
+    stage_running =
+        pthread_create(&stage_thread_id, NULL, stage_thread, NULL) == 0;
+    return stage_running;
+}
+
+void codec_pipeline_quit(void)
+{
+    if (!stage_running)
+        return;
+
+    pthread_mutex_lock(&stage_mutex);
+    while (stage_pending)
+        pthread_cond_wait(&stage_cond, &stage_mutex);
+    stage_die = true;
+    pthread_cond_broadcast(&stage_cond);
+    pthread_mutex_unlock(&stage_mutex);
+
+    pthread_join(stage_thread_id, NULL);
+    stage_running = false;
+}
+
+void codec_pipeline_start(void *block)
+{
+    pthread_mutex_lock(&stage_mutex);
+    stage_block = block;
+    stage_pending = true;
+    pthread_cond_broadcast(&stage_cond);
+    pthread_mutex_unlock(&stage_mutex);
+}
+
+void codec_pipeline_wait(void)
+{
+    pthread_mutex_lock(&stage_mutex);
+    while (stage_pending)
+        pthread_cond_wait(&stage_cond, &stage_mutex);
+    pthread_mutex_unlock(&stage_mutex);
+}
+
+#else /* !CODEC_PIPELINE_THREADED */
+/* One core: both stages run in turn on the codec thread */
+
+bool codec_pipeline_init(void (*stage)(void *block))
+{
+    stage_func = stage;
+    return true;
+}
+
+void codec_pipeline_quit(void)
+{
+}
+
+void codec_pipeline_start(void *block)
+{
+    stage_func(block);
+}
+
+void codec_pipeline_wait(void)
+{
+}
+
+#endif /* NUM_CORES */
@@ -0,0 +1,50 @@
+/***************************************************************************
+ *             __________               __   ___.
+ *   Open      \______   \ ____   ____ |  | _\_ |__   _______  ___
+ *   Source     |       _//  _ \_/ ___\|  |/ /| __ \ /  _ \  \/  /
+ *   Jukebox    |    |   (  <_> )  \___|    < | \_\ (  <_> > <  <
+ *   Firmware   |____|_  /\____/ \___  >__|_ \|___  /\____/__/\_ \
+ *                     \/            \/     \/    \/            \/
+ * $Id$
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This software is distributed on an "AS IS" basis, WITHOUT WARRANTY OF ANY
+ * KIND, either express or implied.
+ *
+ ****************************************************************************/
+
+#ifndef CODECLIB_PIPELINE_H_INCLUDED
+#define CODECLIB_PIPELINE_H_INCLUDED
+
+#include <stdbool.h>
+#include "config.h"
+
+/* Two stage decoding pipeline. The codec thread does the first stage of a
+ * block (typically parsing the bitstream) while the second stage
+ * (transforms, filters, synthesis) of the block before it runs on the COP,
+ * or on a host thread in the SDL builds. The codec hands a block to the
+ * second stage with codec_pipeline_start() and waits for it to finish with
+ * codec_pipeline_wait(). Where there is no second core, start runs the
+ * second stage right away and wait does nothing.
+ *
+ * With CODEC_PIPELINE_THREADED the codec has to double buffer whatever the
+ * two stages share, and on the PortalPlayer targets that has to be in IRAM
+ * or SHAREDBSS_ATTR memory since the caches of the two cores don't see
+ * each other's writes. */
+#if NUM_CORES > 1 || ((CONFIG_PLATFORM & PLATFORM_SDL) && !defined(_WIN32))
+#define CODEC_PIPELINE_THREADED
+#endif
+
+/* Call on CODEC_LOAD and CODEC_UNLOAD */
+bool codec_pipeline_init(void (*stage)(void *block));
+void codec_pipeline_quit(void);
+
+/* The second stage must be idle, i.e. waited for since the last start */
+void codec_pipeline_start(void *block);
+void codec_pipeline_wait(void);
+
+#endif /* CODECLIB_PIPELINE_H_INCLUDED */
@@ -1,5 +1,5 @@
 #include "os_types.h"
-#include <tlsf.h>
+#include "codeclib.h"
 
 #if defined(CPU_ARM) || defined(CPU_COLDFIRE) || defined(CPU_MIPS)
 #include <setjmp.h>
@@ -11,23 +11,15 @@ extern jmp_buf rb_jump_buf;
 #define LONGJMP(x)  return NULL
 #endif
 
+/* Everything comes from the codec heap, which starts out empty every track */
 void ogg_malloc_init(void)
 {
-    size_t bufsize;
-    void* buf = ci->codec_get_buffer(&bufsize);
-    init_memory_pool(bufsize, buf);
-}
-
-void ogg_malloc_destroy()
-{
-    size_t bufsize;
-    void* buf = ci->codec_get_buffer(&bufsize);
-    destroy_memory_pool(buf);
+    codec_init();
 }
 
 void *ogg_malloc(size_t size)
 {
-    void* x = tlsf_malloc(size);
+    void* x = codec_malloc(size);
 
     if (x == NULL)
         LONGJMP(1);
@@ -37,7 +29,7 @@ void *ogg_malloc(size_t size)
 
 void *ogg_calloc(size_t nmemb, size_t size)
 {
-    void *x = tlsf_calloc(nmemb, size);
+    void *x = codec_calloc(nmemb, size);
 
     if (x == NULL)
         LONGJMP(1);
@@ -47,7 +39,7 @@ void *ogg_calloc(size_t nmemb, size_t size)
 
 void *ogg_realloc(void *ptr, size_t size)
 {
-    void *x = tlsf_realloc(ptr, size);
+    void *x = codec_realloc(ptr, size);
 
     if (x == NULL)
         LONGJMP(1);
@@ -57,7 +49,7 @@ void *ogg_realloc(void *ptr, size_t size)
 
 void ogg_free(void* ptr)
 {
-    tlsf_free(ptr);
+    codec_free(ptr);
 }
 
 #ifdef TREMOR_USE_IRAM
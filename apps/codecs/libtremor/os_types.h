@@ -42,7 +42,6 @@
 #define _ogg_free    ogg_free
 
 void ogg_malloc_init(void);
-void ogg_malloc_destroy(void);
 void *ogg_malloc(size_t size);
 void *ogg_calloc(size_t nmemb, size_t size);
 void *ogg_realloc(void *ptr, size_t size);
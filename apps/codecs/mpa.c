@@ -25,25 +25,24 @@
 
 CODEC_HEADER
 
-#if NUM_CORES > 1 && !defined(MPEGPLAYER)
-#define MPA_SYNTH_ON_COP
+#if defined(CODEC_PIPELINE_THREADED) && !defined(MPEGPLAYER)
+#define MPA_SYNTH_THREADED
 #endif
 
 static struct mad_stream stream IBSS_ATTR;
 static struct mad_frame frame IBSS_ATTR;
 static struct mad_synth synth IBSS_ATTR;
 
-#ifdef MPA_SYNTH_ON_COP
-static volatile short die IBSS_ATTR = 0;          /*thread should die*/
-
+#ifdef MPA_SYNTH_THREADED
 #if (CONFIG_CPU == PP5024) || (CONFIG_CPU == PP5022)
 static mad_fixed_t sbsample_prev[2][36][32] IBSS_ATTR;
+/* What the synth stage works from, since mad_frame_decode() rewrites
+   frame.header while it runs */
+static struct mad_frame synth_frame IBSS_ATTR;
 #else
 static mad_fixed_t sbsample_prev[2][36][32] SHAREDBSS_ATTR; 
+static struct mad_frame synth_frame SHAREDBSS_ATTR;
 #endif
-
-static struct semaphore synth_done_sem IBSS_ATTR;
-static struct semaphore synth_pending_sem IBSS_ATTR;
 #endif
 
 #define INPUT_CHUNK_SIZE   8192
@@ -62,7 +61,7 @@ static void init_mad(void)
     ci->memset(&frame , 0, sizeof(struct mad_frame));
     ci->memset(&synth , 0, sizeof(struct mad_synth));
 
-#ifdef MPA_SYNTH_ON_COP
+#ifdef MPA_SYNTH_THREADED
     frame.sbsample_prev = &sbsample_prev;
     frame.sbsample      = &sbsample;
 #else
@@ -197,108 +196,358 @@ static void set_elapsed(struct mp3entry* id3)
     ci->set_elapsed(elapsed);
 }
 
-#ifdef MPA_SYNTH_ON_COP
-
-/*
- * Run the synthesis filter on the COProcessor 
- */
-
-static int mad_synth_thread_stack[DEFAULT_STACK_SIZE/sizeof(int)] IBSS_ATTR;
-
-static const unsigned char * const mad_synth_thread_name = "mp3dec";
-static unsigned int mad_synth_thread_id = 0;
-
-
-static void mad_synth_thread(void)
+/* Seek index: the file offset of every idx.stride-th frame, recorded while
+ * decoding straight through from the first frame. All frames of a stream
+ * hold the same number of samples, so the index leads to the exact frame
+ * for any time instead of an estimate from the Xing TOC or the bitrate.
+ * Long tracks keep it in a sidecar file (<track>.idx) so it is there for
+ * later seeks and resumes; tools/mpaindex.py creates these in advance. */
+#define INDEX_ENTRIES      4096          /* the stride doubles when full */
+#define INDEX_MIN_STRIDE   16            /* frames */
+#define INDEX_MIN_LENGTH   (10*60*1000)  /* ms, shorter tracks don't get a
+                                            sidecar */
+#define INDEX_MAGIC        0x5849504d    /* "MPIX" */
+#define INDEX_SUFFIX       ".idx"
+#define INDEX_PREROLL      32            /* frames, most that a seek will
+                                            decode before the target */
+/* Layer III frames take up to 511 bytes of main data from the frames before
+   them. Decoding has to start far enough back for that to be complete. */
+#define INDEX_RESERVOIR    (511 + 4 + 2 + 32)
+
+/* The sidecar is this header followed by the entries, all little endian */
+struct index_header {
+    uint32_t magic;
+    uint32_t filesize;      /* of the whole file */
+    uint32_t first_frame;   /* id3->first_frame_offset */
+    uint32_t frame_samples; /* samples per frame */
+    uint32_t stride;        /* frames per entry */
+    uint32_t frames;        /* frames covered */
+};
+
+static struct index_header idx;
+static uint32_t index_offsets[INDEX_ENTRIES];
+static unsigned long index_saved; /* frames covered by the sidecar */
+static long cur_frame;            /* number of the frame being decoded,
+                                     -1 if not known */
+
+/* kbit/s for MPEG 1 and MPEG 2/2.5 layer I, II and III */
+static const unsigned short index_bitrates[2][3][15] = {
+    { {0, 32, 64, 96, 128, 160, 192, 224, 256, 288, 320, 352, 384, 416, 448},
+      {0, 32, 48, 56,  64,  80,  96, 112, 128, 160, 192, 224, 256, 320, 384},
+      {0, 32, 40, 48,  56,  64,  80,  96, 112, 128, 160, 192, 224, 256, 320} },
+    { {0, 32, 48, 56,  64,  80,  96, 112, 128, 144, 160, 176, 192, 224, 256},
+      {0,  8, 16, 24,  32,  40,  48,  56,  64,  80,  96, 112, 128, 144, 160},
+      {0,  8, 16, 24,  32,  40,  48,  56,  64,  80,  96, 112, 128, 144, 160} }
+};
+static const unsigned short index_freqs[3] = { 44100, 48000, 32000 };
+
+/* Returns the length of the frame whose header is at buf, 0 if there is no
+ * valid header */
+static unsigned int frame_length(const unsigned char *buf)
 {
-    while(1) {
-        ci->semaphore_release(&synth_done_sem);
-        ci->semaphore_wait(&synth_pending_sem, TIMEOUT_BLOCK);
-        
-        if(die)
-            break;
-
-        mad_synth_frame(&synth, &frame);
-    }    
+    unsigned long header = ((unsigned long)buf[0] << 24) | (buf[1] << 16) |
+                           (buf[2] << 8) | buf[3];
+    unsigned int version = (header >> 19) & 3; /* 0: 2.5, 2: 2, 3: 1 */
+    unsigned int layer   = 4 - ((header >> 17) & 3);
+    unsigned int bitrate = (header >> 12) & 15;
+    unsigned int freq    = (header >> 10) & 3;
+    unsigned int padding = (header >> 9) & 1;
+    unsigned int lsf     = version != 3;
+
+    if ((header & 0xffe00000) != 0xffe00000 || version == 1 || layer == 4 ||
+        bitrate == 0 || bitrate == 15 || freq == 3)
+        return 0;
+
+    bitrate = index_bitrates[lsf][layer - 1][bitrate] * 1000;
+    freq = index_freqs[freq] >> (lsf + (version == 0));
+
+    if (layer == 1)
+        return (12 * bitrate / freq + padding) * 4;
+    else if (layer == 3 && lsf)
+        return 72 * bitrate / freq + padding;
+    else
+        return 144 * bitrate / freq + padding;
 }
 
-/* wait for the synth thread to go idle which indicates a PCM frame has been
- * synthesized */
-static inline void mad_synth_thread_wait_pcm(void)
+static void index_reset(void)
 {
-    ci->semaphore_wait(&synth_done_sem, TIMEOUT_BLOCK);
+    idx.magic         = INDEX_MAGIC;
+    idx.filesize      = ci->filesize;
+    idx.first_frame   = ci->id3->first_frame_offset;
+    idx.frame_samples = 0;
+    idx.stride        = INDEX_MIN_STRIDE;
+    idx.frames        = 0;
+    index_saved = 0;
 }
 
-/* increment the done semaphore - used after a wait for idle to preserve the
- * semaphore count */
-static inline void mad_synth_thread_unwait_pcm(void)
+static bool index_path(char *buf)
 {
-    ci->semaphore_release(&synth_done_sem);
+    if (ci->strlen(ci->id3->path) + sizeof(INDEX_SUFFIX) > MAX_PATH)
+        return false;
+
+    ci->strcpy(buf, ci->id3->path);
+    ci->strcat(buf, INDEX_SUFFIX);
+    return true;
 }
 
-/* after synth thread has gone idle - switch decoded frames and commence
- * synthesis on it */
-static void mad_synth_thread_ready(void)
+static void index_load(void)
 {
-    mad_fixed_t (*temp)[2][36][32];
+    char path[MAX_PATH];
+    struct index_header hdr;
+    uint32_t *p = (uint32_t *)&hdr;
+    unsigned long count;
+    unsigned int i;
+    int fd;
 
-    /*circular buffer that holds 2 frames' samples*/
-    temp=frame.sbsample;
-    frame.sbsample = frame.sbsample_prev;
-    frame.sbsample_prev=temp;
+    index_reset();
+
+    if (ci->id3->length < INDEX_MIN_LENGTH || !index_path(path))
+        return;
+
+    fd = ci->open(path, O_RDONLY);
+    if (fd < 0)
+        return;
+
+    if (ci->read(fd, &hdr, sizeof(hdr)) != sizeof(hdr))
+        goto done;
+
+    for (i = 0; i < sizeof(hdr) / sizeof(*p); i++)
+        p[i] = letoh32(p[i]);
+
+    /* Only use it if it's for this version of the file */
+    if (hdr.magic != idx.magic || hdr.filesize != idx.filesize ||
+        hdr.first_frame != idx.first_frame || hdr.frame_samples == 0 ||
+        hdr.stride < INDEX_MIN_STRIDE || (hdr.stride & (hdr.stride - 1)))
+        goto done;
+
+    count = (hdr.frames + hdr.stride - 1) / hdr.stride;
+    if (count > INDEX_ENTRIES ||
+        ci->read(fd, index_offsets, count * sizeof(uint32_t)) !=
+            (ssize_t)(count * sizeof(uint32_t)))
+        goto done;
+
+    for (i = 0; i < count; i++)
+        index_offsets[i] = letoh32(index_offsets[i]);
 
-    ci->semaphore_release(&synth_pending_sem);
+    idx = hdr;
+    index_saved = hdr.frames;
+
+done:
+    ci->close(fd);
 }
 
-static bool mad_synth_thread_create(void)
+/* Called when a track stops. The index is only written when it has grown,
+ * so listening to a track again doesn't write anything. */
+static void index_save(void)
 {
-    ci->semaphore_init(&synth_done_sem, 1, 0);
-    ci->semaphore_init(&synth_pending_sem, 1, 0);
-       
-    mad_synth_thread_id = ci->create_thread(mad_synth_thread, 
-                            mad_synth_thread_stack,
-                            sizeof(mad_synth_thread_stack), 0,
-                            mad_synth_thread_name 
-                            IF_PRIO(, PRIORITY_PLAYBACK)
-                            IF_COP(, COP));
-    
-    if (mad_synth_thread_id == 0)
-        return false;
+    char path[MAX_PATH];
+    struct index_header hdr = idx;
+    uint32_t *p = (uint32_t *)&hdr;
+    uint32_t buf[64];
+    unsigned long count, i, n;
+    bool ok;
+    int fd;
 
-    return true;
+    if (idx.frames <= index_saved || ci->id3->length < INDEX_MIN_LENGTH ||
+        !index_path(path))
+        return;
+
+    fd = ci->open(path, O_WRONLY|O_CREAT|O_TRUNC, 0666);
+    if (fd < 0)
+        return;
+
+    for (i = 0; i < sizeof(hdr) / sizeof(*p); i++)
+        p[i] = htole32(p[i]);
+
+    ok = ci->write(fd, &hdr, sizeof(hdr)) == sizeof(hdr);
+
+    count = (idx.frames + idx.stride - 1) / idx.stride;
+    for (i = 0; ok && i < count; i += n) {
+        unsigned long j;
+
+        n = MIN(count - i, ARRAYLEN(buf));
+        for (j = 0; j < n; j++)
+            buf[j] = htole32(index_offsets[i + j]);
+
+        ok = ci->write(fd, buf, n * sizeof(uint32_t)) ==
+                (ssize_t)(n * sizeof(uint32_t));
+    }
+
+    ci->close(fd);
+
+    /* A short file fails the size check when it is loaded */
+    if (ok)
+        index_saved = idx.frames;
 }
 
-static void mad_synth_thread_quit(void)
+/* Called for each frame libmad got through, including those whose main data
+ * was missing after a seek. Extends the index when decoding continues where
+ * it ends, and checks the loaded entries against the stream otherwise. */
+static void index_frame_done(void)
 {
-    /* mop up COP thread */
-    die = 1;
-    ci->semaphore_release(&synth_pending_sem);
-    ci->thread_wait(mad_synth_thread_id);
-    ci->commit_discard_dcache();
+    unsigned long offset = ci->curpos + (stream.this_frame - stream.buffer);
+    unsigned long samples = 32 * MAD_NSBSAMPLES(&frame.header);
+    unsigned long n = cur_frame;
+
+    if (cur_frame < 0)
+        return;
+
+    if (idx.frames == 0) {
+        idx.frame_samples = samples;
+    } else if (samples != idx.frame_samples) {
+        cur_frame = -1;
+        return;
+    }
+
+    if (n < idx.frames) {
+        if (n % idx.stride == 0 && index_offsets[n / idx.stride] != offset) {
+            /* The sidecar doesn't match the file */
+            index_reset();
+            cur_frame = -1;
+            return;
+        }
+    } else if (n == idx.frames) {
+        if (n % idx.stride == 0) {
+            if (n / idx.stride == INDEX_ENTRIES) {
+                unsigned int i;
+
+                for (i = 0; i < INDEX_ENTRIES / 2; i++)
+                    index_offsets[i] = index_offsets[2 * i];
+
+                idx.stride *= 2;
+            }
+
+            index_offsets[n / idx.stride] = offset;
+        }
+
+        idx.frames++;
+    }
+
+    cur_frame++;
 }
-#else
-static inline void mad_synth_thread_ready(void)
+
+/* Walks the frame headers from the entry at or before frame <first> up to
+ * frame <last>, storing the offsets of the frames from <first> on in
+ * ring[frame % INDEX_PREROLL]. Stops early at <offset> if that is reached.
+ * Returns the frame it stopped at, or -1 if the headers don't match the
+ * index, which is then dropped. */
+static long index_walk(unsigned long first, unsigned long last,
+                       unsigned long offset, unsigned long *ring)
 {
-     mad_synth_frame(&synth, &frame);
+    unsigned long n = first - first % idx.stride;
+
+    if (!ci->seek_buffer(index_offsets[n / idx.stride]))
+        return -1;
+
+    while (1) {
+        size_t size;
+        unsigned char *buf = ci->request_buffer(&size, 4);
+        unsigned int len = size >= 4 ? frame_length(buf) : 0;
+
+        if (len == 0) {
+            index_reset();
+            return -1;
+        }
+
+        if (ring && n >= first)
+            ring[n % INDEX_PREROLL] = ci->curpos;
+
+        if (n == last || (unsigned long)ci->curpos >= offset)
+            return n;
+
+        ci->advance_buffer(len);
+        n++;
+    }
 }
 
-static inline bool mad_synth_thread_create(void)
+/* Returns the first sample of the frame starting at or after <offset>, or -1
+ * if the index doesn't reach that far */
+static int64_t index_find(unsigned long offset)
 {
-    return true;
+    long n;
+
+    if (idx.frames == 0)
+        return -1;
+
+    /* Last entry at or before offset */
+    for (n = (idx.frames - 1) / idx.stride; n > 0; n--) {
+        if (index_offsets[n] <= offset)
+            break;
+    }
+
+    n = index_walk(n * idx.stride, idx.frames - 1, offset, NULL);
+    if (n < 0 || (unsigned long)ci->curpos < offset)
+        return -1;
+
+    return (int64_t)n * idx.frame_samples;
 }
 
-static inline void mad_synth_thread_quit(void)
+/* Positions the buffer for decoding to reach <sample> (counted from the
+ * start of the first frame) with the bit reservoir and the synthesis filter
+ * state complete. Returns the number of samples to drop, or -1 if the index
+ * doesn't cover the position. */
+static long index_seek(int64_t sample)
 {
+    unsigned long ring[INDEX_PREROLL];
+    unsigned long target, first, start;
+
+    if (idx.frames == 0 || sample < 0 ||
+        sample / idx.frame_samples >= idx.frames)
+        return -1;
+
+    target = sample / idx.frame_samples;
+    first = target >= INDEX_PREROLL ? target - (INDEX_PREROLL - 1) : 0;
+
+    if (index_walk(first, target, (unsigned long)-1, ring) < 0)
+        return -1;
+
+    /* The frame before the target has to decode completely for its overlap
+       and filter state, so start where all of its main data is available */
+    start = first;
+    if (target >= first + 2) {
+        unsigned long prev = ring[(target - 1) % INDEX_PREROLL];
+
+        for (start = target - 2; start > first; start--) {
+            if (ring[start % INDEX_PREROLL] + INDEX_RESERVOIR <= prev)
+                break;
+        }
+    }
+
+    if (!ci->seek_buffer(ring[start % INDEX_PREROLL]))
+        return -1;
+
+    cur_frame = start;
+    return sample - (int64_t)start * idx.frame_samples;
 }
 
-static inline void mad_synth_thread_wait_pcm(void)
+/*
+ * The synthesis filter is the second stage of the codec pipeline. With a
+ * second core (or host thread) it runs there while the next frame is being
+ * decoded.
+ */
+static void mad_synth_stage(void *block)
 {
+    mad_synth_frame(&synth, (struct mad_frame *)block);
 }
 
-static inline void mad_synth_thread_unwait_pcm(void)
+/* after the synth stage has gone idle - switch decoded frames and commence
+ * synthesis on it */
+static void mad_synth_thread_ready(void)
 {
+#ifdef MPA_SYNTH_THREADED
+    mad_fixed_t (*temp)[2][36][32];
+
+    /*circular buffer that holds 2 frames' samples*/
+    temp=frame.sbsample;
+    frame.sbsample = frame.sbsample_prev;
+    frame.sbsample_prev=temp;
+
+    synth_frame = frame;
+    codec_pipeline_start(&synth_frame);
+#else
+    codec_pipeline_start(&frame);
+#endif
 }
-#endif /* MPA_SYNTH_ON_COP */
 
 /* this is the codec entry point */
 enum codec_status codec_main(enum codec_entry_call_reason reason)
@@ -311,12 +560,12 @@ enum codec_status codec_main(enum codec_entry_call_reason reason)
         ci->configure(DSP_SET_SAMPLE_DEPTH, MAD_F_FRACBITS);
 
         /* does nothing on 1 processor systems except return true */
-        if(!mad_synth_thread_create())
+        if(!codec_pipeline_init(mad_synth_stage))
             return CODEC_ERROR;
     }
     else if (reason == CODEC_UNLOAD) {
-        /* mop up COP thread - MT only */
-        mad_synth_thread_quit();
+        /* mop up the synth thread - MT only */
+        codec_pipeline_quit();
     }
 
     return CODEC_OK;
@@ -335,6 +584,7 @@ enum codec_status codec_run(void)
     unsigned long current_frequency = 0;
     int framelength;
     int padding = MAD_BUFFER_GUARD; /* to help mad decode the last frame */
+    int64_t resume;
     intptr_t param;
 
     /* Reinitializing seems to be necessary to avoid playback quircks when seeking. */
@@ -345,13 +595,9 @@ enum codec_status codec_run(void)
     ci->configure(DSP_SWITCH_FREQUENCY, ci->id3->frequency);
     current_frequency = ci->id3->frequency;
     codec_set_replaygain(ci->id3);
-    
-    if (ci->id3->offset) {
-        ci->seek_buffer(ci->id3->offset);
-        set_elapsed(ci->id3);
-    }
-    else
-        ci->seek_buffer(ci->id3->first_frame_offset);
+
+    index_load();
+    cur_frame = -1;
 
     if (ci->id3->lead_trim >= 0 && ci->id3->tail_trim >= 0) {
         stop_skip = ci->id3->tail_trim - mpeg_latency[ci->id3->layer];
@@ -375,13 +621,30 @@ enum codec_status codec_run(void)
         padding = MAD_BUFFER_GUARD;
     }
 
-    samplesdone = ((int64_t)ci->id3->elapsed) * current_frequency / 1000;
+    /* Resume at the exact frame if the index covers the offset */
+    resume = ci->id3->offset ? index_find(ci->id3->offset) : 0;
+    samples_to_skip = resume > start_skip ? index_seek(resume) : -1;
 
-    /* Don't skip any samples unless we start at the beginning. */
-    if (samplesdone > 0)
-        samples_to_skip = 0;
-    else
-        samples_to_skip = start_skip;
+    if (samples_to_skip >= 0) {
+        samplesdone = resume - start_skip;
+        ci->set_elapsed((samplesdone * 1000) / current_frequency);
+    } else {
+        if (resume > start_skip || resume < 0) {
+            ci->seek_buffer(ci->id3->offset);
+            set_elapsed(ci->id3);
+        } else {
+            ci->seek_buffer(ci->id3->first_frame_offset);
+            cur_frame = 0;
+        }
+
+        samplesdone = ((int64_t)ci->id3->elapsed) * current_frequency / 1000;
+
+        /* Don't skip any samples unless we start at the beginning. */
+        if (samplesdone > 0)
+            samples_to_skip = 0;
+        else
+            samples_to_skip = start_skip;
+    }
 
     framelength = 0;
 
@@ -396,17 +659,22 @@ enum codec_status codec_run(void)
             int newpos;
 
             /*make sure the synth thread is idle before seeking - MT only*/
-            mad_synth_thread_wait_pcm();
-            mad_synth_thread_unwait_pcm();
+            codec_pipeline_wait();
 
             samplesdone = ((int64_t)param)*current_frequency/1000;
 
             if (param == 0) {
                 newpos = ci->id3->first_frame_offset;
                 samples_to_skip = start_skip;
+                cur_frame = 0;
+            } else if ((samples_to_skip =
+                            index_seek(samplesdone + start_skip)) >= 0) {
+                /* The index has put the buffer in place */
+                newpos = ci->curpos;
             } else {
                 newpos = get_file_pos(param);
                 samples_to_skip = 0;
+                cur_frame = -1;
             }
 
             if (!ci->seek_buffer(newpos))
@@ -444,19 +712,28 @@ enum codec_status codec_run(void)
                 stream.error = 0; /* Must get new inputbuffer next time */
                 file_end++;
                 continue;
+            } else if (stream.error == MAD_ERROR_BADDATAPTR) {
+                /* A frame without its bit reservoir after a seek. It gives
+                   no output, so it doesn't count towards the skip. */
+                index_frame_done();
+                if (samples_to_skip >= 32 * MAD_NSBSAMPLES(&frame.header))
+                    samples_to_skip -= 32 * MAD_NSBSAMPLES(&frame.header);
+                continue;
             } else if (MAD_RECOVERABLE(stream.error)) {
                 /* Probably syncing after a seek */
+                cur_frame = -1;
                 continue;
             } else {
                 /* Some other unrecoverable error */
-               return CODEC_ERROR;
+                codec_pipeline_wait();
+                return CODEC_ERROR;
             }
         }
 
         /* Do the pcmbuf insert here. Note, this is the PREVIOUS frame's pcm
            data (not the one just decoded above). When we exit the decoding
            loop we will need to process the final frame that was decoded. */
-        mad_synth_thread_wait_pcm();
+        codec_pipeline_wait();
 
         if (framelength > 0) {
             
@@ -472,6 +749,8 @@ enum codec_status codec_run(void)
         /* Initiate PCM synthesis on the COP (MT) or perform it here (ST) */
         mad_synth_thread_ready();
 
+        index_frame_done();
+
         /* Check if sample rate and stereo settings changed in this frame. */
         if (frame.header.samplerate != current_frequency) {
             current_frequency = frame.header.samplerate;
@@ -496,10 +775,11 @@ enum codec_status codec_run(void)
         stream.error = 0; /* Must get new inputbuffer next time */
         file_end = 0;
 
-        framelength = synth.pcm.length - samples_to_skip;
-        if (framelength < 0) {
+        /* synth.pcm.length isn't known yet when synthesis runs in parallel */
+        framelength = 32 * MAD_NSBSAMPLES(&frame.header) - samples_to_skip;
+        if (framelength <= 0) {
             framelength = 0;
-            samples_to_skip -= synth.pcm.length;
+            samples_to_skip -= 32 * MAD_NSBSAMPLES(&frame.header);
         }
 
         samplesdone += framelength;
@@ -507,8 +787,7 @@ enum codec_status codec_run(void)
     }
 
     /* wait for synth idle - MT only*/
-    mad_synth_thread_wait_pcm();
-    mad_synth_thread_unwait_pcm();
+    codec_pipeline_wait();
 
     /* Finish the remaining decoded frame.
        Cut the required samples from the end. */
@@ -517,5 +796,7 @@ enum codec_status codec_run(void)
                           framelength - stop_skip);
     }
 
+    index_save();
+
     return CODEC_OK;
 }
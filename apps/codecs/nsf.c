@@ -54,6 +54,7 @@ enum codec_status codec_run(void)
     int track, is_multitrack;
     uint32_t elapsed_time;
     intptr_t param;
+    int16_t *out;
 
     track = is_multitrack = 0;
     elapsed_time = 0;
@@ -115,14 +116,15 @@ next_track:
         }
 
         /* Generate audio buffer */
-        err = Nsf_play(&nsf_emu, CHUNK_SIZE, samples);
+        out = codec_pcmbuf_request(samples, CHUNK_SIZE >> 1);
+        err = Nsf_play(&nsf_emu, CHUNK_SIZE, out);
         if (err || Track_ended(&nsf_emu)) {
             track++;
             if (track >= nsf_emu.track_count) break;
             goto next_track;
         }
 
-        ci->pcmbuf_insert(samples, NULL, CHUNK_SIZE >> 1);
+        codec_pcmbuf_commit(out, CHUNK_SIZE >> 1);
 
         /* Set elapsed time for one track files */
         if (is_multitrack == 0) {
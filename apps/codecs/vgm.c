@@ -50,6 +50,7 @@ enum codec_status codec_run(void)
     uint8_t *buf;
     size_t n;
     intptr_t param;
+    int16_t *out;
 
     uint32_t elapsed_time = 0;
 
@@ -129,10 +130,11 @@ enum codec_status codec_run(void)
         }
 
         /* Generate audio buffer */
-        err = Vgm_play(&vgm_emu, CHUNK_SIZE, samples);
+        out = codec_pcmbuf_request(samples, CHUNK_SIZE >> 1);
+        err = Vgm_play(&vgm_emu, CHUNK_SIZE, out);
         if (err || Track_ended(&vgm_emu)) break;
 
-        ci->pcmbuf_insert(samples, NULL, CHUNK_SIZE >> 1);
+        codec_pcmbuf_commit(out, CHUNK_SIZE >> 1);
 
         elapsed_time += (CHUNK_SIZE / 2) * 10 / 441;
         ci->set_elapsed(elapsed_time);
@@ -22,9 +22,6 @@
 #include "codeclib.h"
 #include "libtremor/ivorbisfile.h"
 #include "libtremor/ogg.h"
-#ifdef SIMULATOR
-#include <tlsf.h>
-#endif
 
 CODEC_HEADER
 
@@ -242,16 +239,6 @@ enum codec_status codec_run(void)
 
     error = CODEC_OK;
 done:
-#if 0 /* defined(SIMULATOR) */
-    {
-        size_t bufsize;
-        void* buf = ci->codec_get_buffer(&bufsize);
-
-        DEBUGF("Vorbis: Memory max: %zu\n", get_max_size(buf));
-    }
-#endif
-    ogg_malloc_destroy();
-
     /* Clean things up for the next track */
     vf.dataoffsets = NULL;
     vf.offsets = NULL;
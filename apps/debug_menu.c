@@ -42,6 +42,7 @@
 #include "list.h"
 #include "statusbar.h"
 #include "dir.h"
+#include "filefuncs.h"
 #include "panic.h"
 #include "screens.h"
 #include "misc.h"
@@ -88,6 +89,7 @@
 #include "pcmbuf.h"
 #include "buffering.h"
 #include "playback.h"
+#include "dsp.h"
 #if defined(HAVE_SPDIF_OUT) || defined(HAVE_SPDIF_IN)
 #include "spdif.h"
 #endif
@@ -568,6 +570,63 @@ static bool dbg_buflib_allocs(void)
     return simplelist_show_list(&info);
 }
 
+#if CONFIG_CODEC == SWCODEC && defined(DSP_PROFILE)
+static int dsp_profile_callback(int action, struct gui_synclist *lists)
+{
+    (void)lists;
+    struct dsp_config *dsp =
+        (struct dsp_config *)dsp_configure(NULL, DSP_MYDSP, CODEC_IDX_AUDIO);
+    const struct dsp_profile_stage *p = dsp_profile_get(dsp);
+    uint64_t total = 0;
+    int i;
+
+    if (action == ACTION_STD_OK)
+        dsp_profile_reset(dsp);
+
+    for (i = 0; i < DSP_PROFILE_NUM_STAGES; i++)
+        total += p[i].time;
+
+    simplelist_set_line_count(0);
+    simplelist_addline(SIMPLELIST_ADD_LINE, "Total: %lu ms (OK resets)",
+                       (unsigned long)(total / 1000000));
+
+    for (i = 0; i < DSP_PROFILE_NUM_STAGES; i++)
+    {
+        if (p[i].samples == 0)
+            continue;
+
+        int pct = total ? (int)(p[i].time * 100 / total) : 0;
+#if (CONFIG_PLATFORM & PLATFORM_NATIVE)
+        /* cycles per sample at the current clock */
+        unsigned long per_smp = p[i].time * (FREQ / 100000) / p[i].samples
+                                    / 10000;
+        const char *unit = "c/smp";
+#else
+        unsigned long per_smp = p[i].time / p[i].samples;
+        const char *unit = "ns/smp";
+#endif
+        simplelist_addline(SIMPLELIST_ADD_LINE, "%-10s %3d%% %5lu %s",
+                           dsp_profile_stage_name(i), pct, per_smp, unit);
+    }
+
+    if (action == ACTION_NONE || action == ACTION_STD_OK)
+        action = ACTION_REDRAW;
+    return action;
+}
+
+static bool dbg_dsp_profile(void)
+{
+    struct simplelist_info info;
+    simplelist_info_init(&info, "DSP profile", DSP_PROFILE_NUM_STAGES + 1,
+                         NULL);
+    info.action_callback = dsp_profile_callback;
+    info.hide_selection = true;
+    info.scroll_all = true;
+    info.timeout = HZ/2;
+    return simplelist_show_list(&info);
+}
+#endif /* SWCODEC && DSP_PROFILE */
+
 #if (CONFIG_PLATFORM & PLATFORM_NATIVE)
 static const char* dbg_partitions_getname(int selected_item, void *data,
                                           char *buffer, size_t buffer_len)
@@ -1583,6 +1642,29 @@ static bool dbg_disk_info(void)
     info.scroll_all = true;
     return simplelist_show_list(&info);
 }
+
+static int fat_cache_callback(int btn, struct gui_synclist *lists)
+{
+    (void)lists;
+    struct fat_cache_stats stats;
+    fat_get_cache_stats(&stats);
+    simplelist_set_line_count(0);
+    simplelist_addline(SIMPLELIST_ADD_LINE, "Hits: %lu", stats.hits);
+    simplelist_addline(SIMPLELIST_ADD_LINE, "Misses: %lu", stats.misses);
+    simplelist_addline(SIMPLELIST_ADD_LINE, "Written back: %lu sectors",
+             stats.writebacks);
+    return btn;
+}
+
+static bool dbg_fat_cache_info(void)
+{
+    struct simplelist_info info;
+    simplelist_info_init(&info, "FAT Cache Info", 3, NULL);
+    info.action_callback = fat_cache_callback;
+    info.hide_selection = true;
+    info.scroll_all = true;
+    return simplelist_show_list(&info);
+}
 #endif /* PLATFORM_NATIVE */
 
 #ifdef HAVE_DIRCACHE
@@ -1604,19 +1686,120 @@ static int dircache_callback(int btn, struct gui_synclist *lists)
              dircache_get_build_ticks() / HZ);
     simplelist_addline(SIMPLELIST_ADD_LINE, "Entry count: %d",
              dircache_get_entry_count());
+#ifdef HAVE_DIRCACHE_INDEX
+    simplelist_addline(SIMPLELIST_ADD_LINE, "Index size: %d B",
+             dircache_get_index_size());
+#endif
     return btn;
 }
 
 static bool dbg_dircache_info(void)
 {
     struct simplelist_info info;
-    simplelist_info_init(&info, "Dircache Info", 7, NULL);
+    simplelist_info_init(&info, "Dircache Info", 8, NULL);
     info.action_callback = dircache_callback;
     info.hide_selection = true;
     info.scroll_all = true;
     return simplelist_show_list(&info);
 }
 
+#ifdef HAVE_DIRCACHE_INDEX
+/* Compares path lookups through the index with walking the cache, using
+ * up to DIRCACHE_BENCH_PATHS files spread over the whole tree */
+#define DIRCACHE_BENCH_PATHS 256
+
+struct dircache_bench {
+    int handle;     /* DIRCACHE_BENCH_PATHS paths of MAX_PATH */
+    int count;
+    int skip;       /* files to skip between two samples */
+    int left;
+};
+
+static void dircache_bench_collect(struct dircache_bench *b, char *path)
+{
+    size_t len = strlen(path);
+    struct dirent *entry;
+    DIR *dir = opendir(len ? path : "/");
+
+    if (!dir)
+        return;
+
+    while (b->count < DIRCACHE_BENCH_PATHS && (entry = readdir(dir)))
+    {
+        struct dirinfo info = dir_get_info(dir, entry);
+
+        if (!strcmp((char *)entry->d_name, ".")
+            || !strcmp((char *)entry->d_name, ".."))
+            continue;
+
+        snprintf(path + len, MAX_PATH - len, "/%s", entry->d_name);
+        if (info.attribute & ATTR_DIRECTORY)
+            dircache_bench_collect(b, path);
+        else if (b->left-- == 0)
+        {
+            char (*paths)[MAX_PATH] = core_get_data(b->handle);
+            strlcpy(paths[b->count++], path, MAX_PATH);
+            b->left = b->skip;
+        }
+    }
+
+    path[len] = '\0';
+    closedir(dir);
+}
+
+/* Returns the lookups per second */
+static long dircache_bench_rate(struct dircache_bench *b, bool use_index)
+{
+    long lookups = 0;
+    long start = current_tick;
+
+    dircache_use_index(use_index);
+    while (TIME_BEFORE(current_tick, start + HZ))
+    {
+        /* the allocation may move while yielding */
+        char (*paths)[MAX_PATH] = core_get_data(b->handle);
+        for (int i = 0; i < b->count; i++)
+            dircache_get_entry_id(paths[i]);
+        lookups += b->count;
+        yield();
+    }
+    dircache_use_index(true);
+
+    return lookups * HZ / (current_tick - start);
+}
+
+static bool dbg_dircache_bench(void)
+{
+    struct dircache_bench b;
+    char path[MAX_PATH] = "";
+
+    if (!dircache_is_enabled() || !dircache_get_index_size())
+    {
+        splash(HZ, "Dircache or its index not ready");
+        return false;
+    }
+
+    b.handle = core_alloc("dircache bench", DIRCACHE_BENCH_PATHS*MAX_PATH);
+    if (b.handle <= 0)
+    {
+        splash(HZ, "Out of memory");
+        return false;
+    }
+
+    splash(0, "Benchmarking...");
+    b.count = b.left = 0;
+    b.skip = dircache_get_entry_count() / DIRCACHE_BENCH_PATHS;
+    dircache_bench_collect(&b, path);
+
+    long walk = dircache_bench_rate(&b, false);
+    long index = dircache_bench_rate(&b, true);
+    core_free(b.handle);
+
+    splashf(HZ*5, "%d paths: walk %ld/s, index %ld/s", b.count, walk, index);
+    return false;
+}
+#endif /* HAVE_DIRCACHE_INDEX */
+
 #endif /* HAVE_DIRCACHE */
 
 #ifdef HAVE_TAGCACHE
@@ -1916,6 +2099,20 @@ static bool dbg_screendump(void)
 
 extern bool write_metadata_log;
 
+#ifdef BUFFERING_TRACE
+static bool dbg_buffering_trace(void)
+{
+    int count = buffering_trace_dump("/buffering_trace.txt");
+
+    if (count < 0)
+        splash(HZ, "Could not write /buffering_trace.txt");
+    else
+        splashf(HZ, "Wrote %d events to /buffering_trace.txt", count);
+
+    return false;
+}
+#endif
+
 static bool dbg_metadatalog(void)
 {
     write_metadata_log = !write_metadata_log;
@@ -2184,6 +2381,7 @@ static const struct {
 #endif
 #if (CONFIG_PLATFORM & PLATFORM_NATIVE)
         { "View disk info", dbg_disk_info },
+        { "View FAT cache info", dbg_fat_cache_info },
 #if (CONFIG_STORAGE & STORAGE_ATA)
         { "Dump ATA identify info", dbg_identify_info},
 #endif
@@ -2192,12 +2390,18 @@ static const struct {
 #ifdef HAVE_DIRCACHE
         { "View dircache info", dbg_dircache_info },
 #endif
+#ifdef HAVE_DIRCACHE_INDEX
+        { "Benchmark dircache lookups", dbg_dircache_bench },
+#endif
 #ifdef HAVE_TAGCACHE
         { "View database info", dbg_tagcache_info },
 #endif
 #ifdef HAVE_LCD_BITMAP
 #if CONFIG_CODEC == SWCODEC
         { "View buffering thread", dbg_buffering_thread },
+#ifdef BUFFERING_TRACE
+        { "Dump buffering trace", dbg_buffering_trace },
+#endif
 #elif !defined(SIMULATOR)
         { "View audio thread", dbg_audio_thread },
 #endif
@@ -2206,6 +2410,9 @@ static const struct {
 #endif /* PM_DEBUG */
 #endif /* HAVE_LCD_BITMAP */
         { "View buflib allocs", dbg_buflib_allocs },
+#if CONFIG_CODEC == SWCODEC && defined(DSP_PROFILE)
+        { "View DSP profile", dbg_dsp_profile },
+#endif
 #ifndef SIMULATOR
 #if CONFIG_TUNER
         { "FM Radio", dbg_fm_radio },
@@ -124,6 +124,11 @@ static int timestretch_callback(int action,const struct menu_item_ex *this_item)
     MENUITEM_SETTING(dithering_enabled,
                      &global_settings.dithering_enabled, lowlatency_callback);
 
+#ifdef HAVE_POLYPHASE_RESAMPLER
+    MENUITEM_SETTING(resampler_hq,
+                     &global_settings.resampler_hq, lowlatency_callback);
+#endif
+
     /* compressor submenu */
     MENUITEM_SETTING(compressor_threshold,
                      &global_settings.compressor_threshold, lowlatency_callback);
@@ -181,6 +186,9 @@ MAKE_MENU(sound_settings, ID2P(LANG_SOUND_SETTINGS), NULL, Icon_Audio,
 #endif
 #if CONFIG_CODEC == SWCODEC
           ,&crossfeed_menu, &equalizer_menu, &dithering_enabled
+#ifdef HAVE_POLYPHASE_RESAMPLER
+          ,&resampler_hq
+#endif
 #ifdef HAVE_PITCHSCREEN
           ,&timestretch_enabled
 #endif
@@ -41,6 +41,7 @@
 #include "audio.h"
 #include "voice_thread.h"
 #include "dsp.h"
+#include "spsc_queue.h"
 
 /* This is the target fill size of chunks on the pcm buffer
    Can be any number of samples but power of two sizes make for faster and
@@ -98,8 +99,11 @@ static struct chunkdesc *pcmbuf_descriptors;
 static unsigned int pcmbuf_desc_count;
 static unsigned int position_key = 1;
 
-static size_t chunk_ridx;
-static size_t chunk_widx;
+/* Committed chunks, one slot per descriptor. The codec thread produces and
+   the PCM callback consumes them. On hosted targets the callback runs on its
+   own OS thread, possibly on another core, so handing chunks over must not
+   rely on the callback being an interrupt. */
+static struct spsc_queue chunk_queue;
 
 static size_t pcmbuf_bytes_waiting;
 static struct chunkdesc *current_desc;
@@ -178,17 +182,23 @@ extern void audio_pcmbuf_sync_position(void);
 
 /**************************************/
 
+/* Byte index of the oldest committed chunk, the one playing if any */
+static FORCE_INLINE size_t chunk_ridx(void)
+{
+    return spsc_queue_read_slot(&chunk_queue) * PCMBUF_CHUNK_SIZE;
+}
+
+/* Byte index of the chunk being filled */
+static FORCE_INLINE size_t chunk_widx(void)
+{
+    return spsc_queue_write_slot(&chunk_queue) * PCMBUF_CHUNK_SIZE;
+}
+
 /* Return number of commited bytes in buffer (committed chunks count as
    a full chunk even if only partially filled) */
 static size_t pcmbuf_unplayed_bytes(void)
 {
-    size_t ridx = chunk_ridx;
-    size_t widx = chunk_widx;
-
-    if (ridx > widx)
-        widx += pcmbuf_size;
-
-    return widx - ridx;
+    return spsc_queue_count(&chunk_queue) * PCMBUF_CHUNK_SIZE;
 }
 
 /* Returns TRUE if amount of data is under the target fill size */
@@ -251,7 +261,7 @@ static struct chunkdesc * index_chunkdesc_offs(size_t index, int offset)
    data is below the threshold */
 static void commit_chunks(size_t threshold)
 {
-    size_t index = chunk_widx;
+    size_t index = chunk_widx();
     size_t end_index = index + pcmbuf_bytes_waiting;
 
     /* Copy to the beginning of the buffer all data that must wrap */
@@ -270,7 +280,8 @@ static void commit_chunks(size_t threshold)
 
         /* Advance the current write chunk and make it available to the
            PCM callback */
-        chunk_widx = index = index_next(index);
+        spsc_queue_publish(&chunk_queue);
+        index = index_next(index);
         desc = index_chunkdesc(index);
 
         /* Reset it before using it */
@@ -344,7 +355,7 @@ static void boost_codec_thread(int pcm_fill_state)
 static void * get_write_buffer(size_t *size)
 {
     /* Obtain current chunk fill address */
-    size_t index = chunk_widx + pcmbuf_bytes_waiting;
+    size_t index = chunk_widx() + pcmbuf_bytes_waiting;
     size_t index_end = pcmbuf_size + PCMBUF_GUARD_SIZE;
 
     /* Get count to the end of the buffer where a wrap will happen +
@@ -361,7 +372,7 @@ static void * get_write_buffer(size_t *size)
    write position info to the first chunk */
 static void commit_write_buffer(size_t size, unsigned long elapsed, off_t offset)
 {
-    struct chunkdesc *desc = index_chunkdesc(chunk_widx);
+    struct chunkdesc *desc = index_chunkdesc(chunk_widx());
     stamp_chunk(desc, elapsed, offset);
 
     /* Add this data and commit if one or more chunks are ready */
@@ -485,7 +496,7 @@ static unsigned int get_next_required_pcmbuf_chunks(void)
 static void init_buffer_state(void)
 {
     /* Reset counters */
-    chunk_ridx = chunk_widx = 0;
+    spsc_queue_init(&chunk_queue, pcmbuf_desc_count);
     pcmbuf_bytes_waiting = 0;
 
     /* Reset first descriptor */
@@ -539,7 +550,7 @@ size_t pcmbuf_init(unsigned char *bufend)
    immediately if the buffer is empty or the index is invalid */
 static void pcmbuf_monitor_track_change_ex(size_t index, int offset)
 {
-    if (chunk_ridx != chunk_widx && index != INVALID_BUF_INDEX)
+    if (chunk_ridx() != chunk_widx() && index != INVALID_BUF_INDEX)
     {
         /* If monitoring, set flag in specified chunk */
         index_chunkdesc_offs(index, offset)->is_end = 1;
@@ -554,7 +565,7 @@ static void pcmbuf_monitor_track_change_ex(size_t index, int offset)
 /* Clear end of track and optionally the positioning info for all data */
 static void pcmbuf_cancel_track_change(bool position)
 {
-    size_t index = chunk_ridx;
+    size_t index = chunk_ridx();
 
     while (1)
     {
@@ -565,7 +576,7 @@ static void pcmbuf_cancel_track_change(bool position)
         if (position)
             desc->pos_key = 0;
 
-        if (index == chunk_widx)
+        if (index == chunk_widx())
             break;
 
         index = index_next(index);
@@ -579,7 +590,7 @@ void pcmbuf_monitor_track_change(bool monitor)
     pcm_play_lock();
 
     if (monitor)
-        pcmbuf_monitor_track_change_ex(chunk_widx, -1);
+        pcmbuf_monitor_track_change_ex(chunk_widx(), -1);
     else
         pcmbuf_cancel_track_change(false);
 
@@ -697,7 +708,7 @@ void pcmbuf_start_track_change(enum pcm_track_change_type type)
 static void pcmbuf_pcm_callback(const void **start, size_t *size)
 {
     /*- Process the chunk that just finished -*/
-    size_t index = chunk_ridx;
+    size_t index = chunk_ridx();
     struct chunkdesc *desc = current_desc;
 
     if (desc)
@@ -707,11 +718,12 @@ static void pcmbuf_pcm_callback(const void **start, size_t *size)
             audio_pcmbuf_track_change(true);
 
         /* Free it for reuse */
-        chunk_ridx = index = index_next(index);
+        spsc_queue_consume(&chunk_queue);
+        index = index_next(index);
     }
 
     /*- Process the new one -*/
-    if (index != chunk_widx && !fade_out_complete)
+    if (index != chunk_widx() && !fade_out_complete)
     {
         current_desc = desc = index_chunkdesc(index);
 
@@ -733,7 +745,7 @@ void pcmbuf_play_start(void)
     logf("pcmbuf_play_start");
 
     if (mixer_channel_status(PCM_MIXER_CHAN_PLAYBACK) == CHANNEL_STOPPED &&
-        chunk_widx != chunk_ridx)
+        chunk_widx() != chunk_ridx())
     {
         current_desc = NULL;
         mixer_channel_play_data(PCM_MIXER_CHAN_PLAYBACK, pcmbuf_pcm_callback,
@@ -786,7 +798,7 @@ static size_t crossfade_find_index(size_t index, size_t size)
         size_t i = ALIGN_DOWN(index, PCMBUF_CHUNK_SIZE);
         size += index - i;
 
-        while (i != chunk_widx)
+        while (i != chunk_widx())
         {
             size_t desc_size = index_chunkdesc(i)->size;
  
@@ -804,7 +816,7 @@ static size_t crossfade_find_index(size_t index, size_t size)
 /* Align the needed buffer area up to the end of existing data */
 static size_t crossfade_find_buftail(size_t buffer_rem, size_t buffer_need)
 {
-    crossfade_index = chunk_ridx;
+    crossfade_index = chunk_ridx();
 
     if (buffer_rem > buffer_need)
     {
@@ -905,7 +917,7 @@ static size_t crossfade_mix_fade(int factor, size_t size, void *buf,
         {
             index = index_next(index);
 
-            if (index == chunk_widx)
+            if (index == chunk_widx())
             {
                 /* End of existing data */
                 *out_index = INVALID_BUF_INDEX;
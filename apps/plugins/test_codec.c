@@ -263,6 +263,18 @@ static void pcmbuf_insert_null(const void *ch1, const void *ch2, int count)
     rb->reset_poweroff_timer();
 }
 
+/* All output goes through pcmbuf_insert so it is checksummed and timed */
+static void * pcmbuf_request_direct(int *count)
+{
+    (void)count;
+    return NULL;
+}
+
+static void pcmbuf_commit_direct(int count)
+{
+    (void)count;
+}
+
 /*
  *  Helper function used when the file is larger then the available memory. 
  *  Rebuffers the file by setting the start of the audio buffer to be 
@@ -545,6 +557,9 @@ static void init_ci(void)
         ci.pcmbuf_insert = pcmbuf_insert_null;
     }
 
+    ci.pcmbuf_request_direct = pcmbuf_request_direct;
+    ci.pcmbuf_commit_direct = pcmbuf_commit_direct;
+
     ci.set_elapsed = set_elapsed;
     ci.read_filebuf = read_filebuf;
     ci.request_buffer = request_buffer;
@@ -581,6 +596,13 @@ static void init_ci(void)
 
     ci.qsort = rb->qsort;
 
+    /* file */
+    ci.open = rb->open;
+    ci.close = rb->close;
+    ci.read = rb->read;
+    ci.lseek = rb->lseek;
+    ci.write = rb->write;
+
 #ifdef RB_PROFILE
     ci.profile_thread = rb->profile_thread;
     ci.profstop = rb->profstop;
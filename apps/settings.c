@@ -996,6 +996,9 @@ void settings_apply(bool read_disk)
     }
 
     dsp_dither_enable(global_settings.dithering_enabled);
+#ifdef HAVE_POLYPHASE_RESAMPLER
+    dsp_resampler_hq_enable(global_settings.resampler_hq);
+#endif
 #ifdef HAVE_PITCHSCREEN
     dsp_timestretch_enable(global_settings.timestretch_enabled);
 #endif
@@ -352,6 +352,9 @@ struct user_settings
     int  keyclick;          /* keyclick volume */
     int  keyclick_repeats;  /* keyclick on repeats */
     bool dithering_enabled;
+#ifdef HAVE_POLYPHASE_RESAMPLER
+    bool resampler_hq;      /* band-limited instead of linear resampling */
+#endif
 #ifdef HAVE_PITCHSCREEN
     bool timestretch_enabled;
 #endif
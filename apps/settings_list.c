@@ -1475,6 +1475,12 @@ const struct settings_list settings[] = {
     OFFON_SETTING(F_SOUNDSETTING, dithering_enabled, LANG_DITHERING, false,
                   "dithering enabled", dsp_dither_enable),
 
+#ifdef HAVE_POLYPHASE_RESAMPLER
+    /* resampler quality */
+    OFFON_SETTING(F_SOUNDSETTING, resampler_hq, LANG_RESAMPLER_HQ, false,
+                  "high quality resampling", dsp_resampler_hq_enable),
+#endif
+
 #ifdef HAVE_PITCHSCREEN
     /* timestretch */
     OFFON_SETTING(F_SOUNDSETTING, timestretch_enabled, LANG_TIMESTRETCH, false,
@@ -88,6 +88,16 @@
 #include "eeprom_settings.h"
 #endif
 
+#ifdef TAGCACHE_COLUMNS
+#include <sys/mman.h>
+#endif
+
+#ifdef TAGCACHE_PARALLEL_SCAN
+#include <pthread.h>
+#include <unistd.h> /* sysconf() */
+#include "rbunicode.h"
+#endif
+
 #ifdef __PCTOOL__
 #define yield() do { } while(0)
 #define sim_sleep(timeout) do { } while(0)
@@ -116,6 +126,7 @@ static long tempbuf_pos;
 #define TAGCACHE_IS_SORTED(tag) (BIT_N(tag) & TAGCACHE_SORTED_TAGS)
 #define TAGCACHE_IS_NUMERIC_OR_NONUNIQUE(tag) \
     (BIT_N(tag) & (TAGCACHE_NUMERIC_TAGS | ~TAGCACHE_UNIQUE_TAGS))
+#define TAGCACHE_IS_SEEK_INDEXED(tag) (BIT_N(tag) & TAGCACHE_SEEK_INDEX_TAGS)
 /* Tags we want to get sorted (loaded to the tempbuf). */
 #define TAGCACHE_SORTED_TAGS ((1LU << tag_artist) | (1LU << tag_album) | \
     (1LU << tag_genre) | (1LU << tag_composer) | (1LU << tag_comment) | \
@@ -126,15 +137,23 @@ static long tempbuf_pos;
     (1LU << tag_genre) | (1LU << tag_composer) | (1LU << tag_comment) | \
     (1LU << tag_albumartist) | (1LU << tag_grouping))
 
+/* Tags that get a seek index in the ram cache (see build_seek_indices()).
+ * Must be unique tags since only those can be filtered on. */
+#define TAGCACHE_SEEK_INDEX_TAGS TAGCACHE_UNIQUE_TAGS
+
 /* String presentation of the tags defined in tagcache.h. Must be in correct order! */
 static const char *tags_str[] = { "artist", "album", "genre", "title", 
     "filename", "composer", "comment", "albumartist", "grouping", "year", 
     "discnumber", "tracknumber", "bitrate", "length", "playcount", "rating", 
-    "playtime", "lastplayed", "commitid", "mtime", "lastoffset" };
+    "playtime", "lastplayed", "commitid", "mtime", "lastoffset", "filesize" };
 
 /* Status information of the tagcache. */
 static struct tagcache_stat tc_stat;
 
+/* Changes to what searches return since boot, see
+ * tagcache_get_change_serial(). */
+static long change_serial, runtime_change_serial;
+
 /* Queue commands. */
 enum tagcache_queue {
     Q_STOP_SCAN = 0,
@@ -189,6 +208,8 @@ struct master_header {
     int32_t serial; /* Increasing counting number */
     int32_t commitid; /* Number of commits so far */
     int32_t dirty;
+    int32_t fragmented; /* Tags appended out of order or deleted since
+                           the tag files were last sorted */
 };
 
 /* For the endianess correction */
@@ -196,10 +217,10 @@ static const char * const tagfile_entry_ec   = "ll";
 /**
  Note: This should be (1 + TAG_COUNT) amount of l's.
  */
-static const char * const index_entry_ec     = "llllllllllllllllllllll";
+static const char * const index_entry_ec     = "lllllllllllllllllllllll";
 
 static const char * const tagcache_header_ec = "lll";
-static const char * const master_header_ec   = "llllll";
+static const char * const master_header_ec   = "lllllll";
 
 static struct master_header current_tcmh;
 
@@ -208,6 +229,9 @@ static struct master_header current_tcmh;
 struct ramcache_header {
     char *tags[TAG_COUNT];       /* Tag file content (not including filename tag) */
     int entry_count[TAG_COUNT];  /* Number of entries in the indices. */
+    int32_t *seek_index[TAG_COUNT]; /* Entry ids sorted by tag seek */
+    int seek_index_count;        /* Number of ids in every seek index */
+    bool seek_index_valid;       /* False once a tag seek has changed */
     struct index_entry indices[0]; /* Master index file content */
 };
 
@@ -254,6 +278,14 @@ static long commit_entry_count;
 static long lookup_buffer_depth;
 static struct tempbuf_searchidx **lookup;
 
+#ifdef __PCTOOL__
+/* Hash table of the tags in the buffer by their crc, holding the buffer
+ * index + 1 of every tag. Large libraries have too many unique tags to
+ * compare every new tag against all of them. */
+static int32_t *tempbuf_hash;
+static unsigned long tempbuf_hash_mask;
+#endif
+
 /* Used when building the temporary file. */
 static int cachefd = -1, filenametag_fd;
 static int total_entry_count = 0;
@@ -385,6 +417,285 @@ static bool do_timed_yield(void)
 }
 #endif
 
+#ifdef TAGCACHE_COLUMNS
+/**
+ * The column file holds the master index as one array per tag, with the
+ * numeric data or tag seek of every entry, plus an array of the entry flags,
+ * followed by verbatim copies of the tag files. Everything is in native
+ * byte order and 4 byte aligned, so the file is used straight from the
+ * mapping without any parsing, and tag seeks index the tag file copies like
+ * they index the tag files.
+ *
+ * Like the ram cache, the mapping is updated along with the master index
+ * and tag files, and the file is rebuilt after a commit. A replaced mapping
+ * stays around until the next one is replaced, as a search running on
+ * another thread may still be reading from it.
+ */
+struct column_header {
+    int32_t magic;                  /* TAGCACHE_COLUMNS_MAGIC */
+    struct master_header mh;        /* Master header the columns belong to */
+    uint32_t seek[TAG_COUNT];       /* Offset of the column of every tag */
+    uint32_t flag;                  /* Offset of the flag column */
+    uint32_t data[TAG_COUNT];       /* Offset of the tag file copies */
+    uint32_t data_size[TAG_COUNT];  /* Sizes of the tag files */
+};
+
+static struct column_header *columns;
+static size_t columns_size;
+static struct column_header *old_columns;
+static size_t old_columns_size;
+
+#define COLUMN(tag)      ((int32_t *)((char *)columns + columns->seek[tag]))
+#define COLUMN_FLAGS     ((int32_t *)((char *)columns + columns->flag))
+#define COLUMN_DATA(tag) ((char *)columns + columns->data[tag])
+
+static void columns_get_index(int idxid, struct index_entry *idx)
+{
+    int tag;
+
+    for (tag = 0; tag < TAG_COUNT; tag++)
+        idx->tag_seek[tag] = COLUMN(tag)[idxid];
+    idx->flag = COLUMN_FLAGS[idxid];
+}
+
+static void columns_put_index(int idxid, const struct index_entry *idx)
+{
+    int tag;
+
+    for (tag = 0; tag < TAG_COUNT; tag++)
+        COLUMN(tag)[idxid] = idx->tag_seek[tag];
+    COLUMN_FLAGS[idxid] = idx->flag;
+}
+
+/* Returns the tag file entry at seek, NULL if it isn't inside the file. */
+static struct tagfile_entry *columns_tag(int tag, long seek)
+{
+    struct tagfile_entry *tfe;
+    long size = columns->data_size[tag];
+
+    if (TAGCACHE_IS_NUMERIC(tag) || seek < (long)sizeof(struct tagcache_header)
+        || seek + (long)sizeof(struct tagfile_entry) > size)
+        return NULL;
+
+    tfe = (struct tagfile_entry *)(COLUMN_DATA(tag) + seek);
+    if (tfe->tag_length <= 0
+        || seek + (long)sizeof(struct tagfile_entry) + tfe->tag_length > size)
+        return NULL;
+
+    return tfe;
+}
+
+/* Stops using the mapping and unmaps the one replaced before it. */
+static void retire_columns(void)
+{
+    if (!columns)
+        return;
+
+    if (old_columns)
+        munmap(old_columns, old_columns_size);
+
+    old_columns = columns;
+    old_columns_size = columns_size;
+    columns = NULL;
+    columns_size = 0;
+}
+
+/* Maps the column file if it belongs to the database on disk. */
+static bool map_columns(void)
+{
+    struct column_header *hdr;
+    struct master_header tcmh;
+    struct tagcache_header tch;
+    size_t size;
+    int fd, tag;
+
+    if ( (fd = open_master_fd(&tcmh, false)) < 0)
+        return false;
+    close(fd);
+
+    fd = open(TAGCACHE_FILE_COLUMNS, O_RDWR);
+    if (fd < 0)
+        return false;
+
+    size = filesize(fd);
+    if (size < sizeof(struct column_header))
+    {
+        close(fd);
+        return false;
+    }
+
+    hdr = mmap(NULL, size, PROT_READ|PROT_WRITE, MAP_SHARED, fd, 0);
+    close(fd);
+    if (hdr == MAP_FAILED)
+        return false;
+
+    if (hdr->magic != TAGCACHE_COLUMNS_MAGIC
+        || memcmp(&hdr->mh, &tcmh, sizeof(struct master_header))
+        || hdr->flag + tcmh.tch.entry_count * sizeof(int32_t) > size)
+    {
+        logf("column file outdated");
+        goto failure;
+    }
+
+    for (tag = 0; tag < TAG_COUNT; tag++)
+    {
+        if (hdr->seek[tag] + tcmh.tch.entry_count * sizeof(int32_t) > size)
+            goto failure;
+
+        if (TAGCACHE_IS_NUMERIC(tag))
+            continue;
+
+        if ( (fd = open_tag_fd(&tch, tag, false)) < 0)
+            goto failure;
+
+        /* The copy must have the same header and size. */
+        if ((size_t)filesize(fd) != hdr->data_size[tag]
+            || hdr->data[tag] + hdr->data_size[tag] > size
+            || memcmp((char *)hdr + hdr->data[tag], &tch,
+                      sizeof(struct tagcache_header)))
+        {
+            logf("column file outdated: %d", tag);
+            close(fd);
+            goto failure;
+        }
+        close(fd);
+    }
+
+    columns = hdr;
+    columns_size = size;
+    logf("column file mapped: %ld entries", (long)tcmh.tch.entry_count);
+
+    return true;
+
+failure:
+    munmap(hdr, size);
+    return false;
+}
+
+/* Writes the column file from the master index and the tag files. */
+static bool build_columns(void)
+{
+    struct column_header hdr;
+    struct master_header tcmh;
+    struct tagcache_header tch;
+    struct index_entry idx;
+    int tagfd[TAG_COUNT];
+    int masterfd, fd = -1, tag, i;
+    size_t size;
+    char *map = MAP_FAILED;
+    bool ret = false;
+
+    logf("building column file");
+
+    for (tag = 0; tag < TAG_COUNT; tag++)
+        tagfd[tag] = -1;
+
+    if ( (masterfd = open_master_fd(&tcmh, false)) < 0)
+        return false;
+
+    /* Lay out the file. */
+    memset(&hdr, 0, sizeof hdr);
+    hdr.magic = TAGCACHE_COLUMNS_MAGIC;
+    hdr.mh = tcmh;
+    size = sizeof(struct column_header);
+
+    for (tag = 0; tag < TAG_COUNT; tag++)
+    {
+        hdr.seek[tag] = size;
+        size += tcmh.tch.entry_count * sizeof(int32_t);
+    }
+    hdr.flag = size;
+    size += tcmh.tch.entry_count * sizeof(int32_t);
+
+    for (tag = 0; tag < TAG_COUNT; tag++)
+    {
+        if (TAGCACHE_IS_NUMERIC(tag))
+            continue;
+
+        if ( (tagfd[tag] = open_tag_fd(&tch, tag, false)) < 0)
+            goto cleanup;
+
+        hdr.data[tag] = size;
+        hdr.data_size[tag] = filesize(tagfd[tag]);
+        size += ALIGN_UP(hdr.data_size[tag], 4);
+    }
+
+    fd = open(TAGCACHE_FILE_COLUMNS_TEMP, O_RDWR | O_CREAT | O_TRUNC, 0666);
+    if (fd < 0 || ftruncate(fd, size) < 0)
+    {
+        logf("column file create failed");
+        goto cleanup;
+    }
+
+    map = mmap(NULL, size, PROT_READ|PROT_WRITE, MAP_SHARED, fd, 0);
+    if (map == MAP_FAILED)
+        goto cleanup;
+
+    for (i = 0; i < tcmh.tch.entry_count; i++)
+    {
+        if (ecread_index_entry(masterfd, &idx) != sizeof(struct index_entry))
+        {
+            logf("read error #15");
+            goto cleanup;
+        }
+
+        for (tag = 0; tag < TAG_COUNT; tag++)
+            ((int32_t *)(map + hdr.seek[tag]))[i] = idx.tag_seek[tag];
+        ((int32_t *)(map + hdr.flag))[i] = idx.flag;
+    }
+
+    for (tag = 0; tag < TAG_COUNT; tag++)
+    {
+        if (tagfd[tag] < 0)
+            continue;
+
+        lseek(tagfd[tag], 0, SEEK_SET);
+        if (read(tagfd[tag], map + hdr.data[tag], hdr.data_size[tag])
+            != (ssize_t)hdr.data_size[tag])
+        {
+            logf("read error #16");
+            goto cleanup;
+        }
+    }
+
+    memcpy(map, &hdr, sizeof hdr);
+    ret = true;
+
+cleanup:
+    if (map != MAP_FAILED)
+        munmap(map, size);
+    if (fd >= 0)
+        close(fd);
+
+    /* A mapped old file stays intact when it is replaced. */
+    if (ret)
+        ret = rename(TAGCACHE_FILE_COLUMNS_TEMP, TAGCACHE_FILE_COLUMNS) == 0;
+    if (!ret)
+        remove(TAGCACHE_FILE_COLUMNS_TEMP);
+    for (tag = 0; tag < TAG_COUNT; tag++)
+    {
+        if (tagfd[tag] >= 0)
+            close(tagfd[tag]);
+    }
+    close(masterfd);
+
+    return ret;
+}
+
+/* Maps the column file, building it first if it is missing or outdated. */
+static void load_columns(void)
+{
+    retire_columns();
+
+    /* Byte swapped databases are only read the slow way. */
+    if (!tc_stat.ready || tc_stat.econ)
+        return;
+
+    if (!map_columns() && build_columns())
+        map_columns();
+}
+#endif /* TAGCACHE_COLUMNS */
+
 #if defined(HAVE_TC_RAMCACHE) && defined(HAVE_DIRCACHE)
 /* find the ramcache entry corresponding to the file indicated by
  * filename and dc (it's corresponding dircache id). */
@@ -434,6 +745,24 @@ static long find_entry_ram(const char *filename, int dc)
 }
 #endif
 
+#ifdef TAGCACHE_COLUMNS
+static long find_entry_columns(const char *filename)
+{
+    long pos = sizeof(struct tagcache_header);
+    struct tagfile_entry *tfe;
+
+    while ( (tfe = columns_tag(tag_filename, pos)) != NULL)
+    {
+        if (!strcmp(filename, tfe->tag_data))
+            return tfe->idx_id;
+
+        pos += sizeof(struct tagfile_entry) + tfe->tag_length;
+    }
+
+    return -4;
+}
+#endif
+
 static long find_entry_disk(const char *filename_raw, bool localfd)
 {
     struct tagcache_header tch;
@@ -457,6 +786,11 @@ static long find_entry_disk(const char *filename_raw, bool localfd)
     if (!tc_stat.ready)
         return -2;
     
+#ifdef TAGCACHE_COLUMNS
+    if (columns)
+        return find_entry_columns(filename);
+#endif
+
     fd = filenametag_fd;
     if (fd < 0 || localfd)
     {
@@ -597,6 +931,15 @@ static bool get_index(int masterfd, int idxid,
             return true;
         }
     }
+#elif defined(TAGCACHE_COLUMNS)
+    if (columns && use_ram && idxid < columns->mh.tch.entry_count)
+    {
+        if (COLUMN_FLAGS[idxid] & FLAG_DELETED)
+            return false;
+
+        columns_get_index(idxid, idx);
+        return true;
+    }
 #else
     (void)use_ram;
 #endif
@@ -665,6 +1008,10 @@ static bool write_index(int masterfd, int idxid, struct index_entry *idx)
             | (idx_ram->flag & (0xffff0000 | FLAG_DIRCACHE));
     }
 #endif
+#ifdef TAGCACHE_COLUMNS
+    if (columns && idxid < columns->mh.tch.entry_count)
+        columns_put_index(idxid, idx);
+#endif
     
     lseek(masterfd, idxid * sizeof(struct index_entry) 
           + sizeof(struct master_header), SEEK_SET);
@@ -753,6 +1100,20 @@ static bool retrieve(struct tagcache_search *tcs, struct index_entry *idx,
         }
     }
 #endif
+#ifdef TAGCACHE_COLUMNS
+    if (columns)
+    {
+        struct tagfile_entry *ep = columns_tag(tag, seek);
+        if (!ep)
+        {
+            logf("Retrieve failed");
+            return false;
+        }
+
+        strlcpy(buf, ep->tag_data, size);
+        return true;
+    }
+#endif
     
     if (!open_files(tcs, tag))
         return false;
@@ -1044,6 +1405,26 @@ static bool check_clauses(struct tagcache_search *tcs,
             }
         }
         else
+#endif
+#ifdef TAGCACHE_COLUMNS
+        if (columns)
+        {
+            if (!TAGCACHE_IS_NUMERIC(clause->tag))
+            {
+                struct tagfile_entry *tfe;
+                int tag = clause->tag;
+                if (tag == tag_virt_basename)
+                    tag = tag_filename;
+
+                tfe = columns_tag(tag, seek);
+                /* Check if entry has been deleted. */
+                if (!tfe || tfe->tag_data[0] == '\0')
+                    return false;
+
+                str = tfe->tag_data;
+            }
+        }
+        else
 #endif
         {
             struct tagfile_entry tfe;
@@ -1139,6 +1520,115 @@ static bool add_uniqbuf(struct tagcache_search *tcs, unsigned long id)
     return true;
 }
 
+#ifdef HAVE_TC_RAMCACHE
+/**
+ * Returns the first position in list[lo..hi) at which the tag seek is
+ * >= value or, for tag < 0, at which the entry id is >= value.
+ */
+static int seek_index_bound(const int32_t *list, int lo, int hi,
+                            int tag, int32_t value)
+{
+    while (lo < hi)
+    {
+        int mid = (lo + hi) / 2;
+        int32_t key = tag < 0 ? list[mid]
+                              : ramcache_hdr->indices[list[mid]].tag_seek[tag];
+        
+        if (key < value)
+            lo = mid + 1;
+        else
+            hi = mid;
+    }
+    
+    return lo;
+}
+
+/* Seek of the given string in a unique tag loaded to ram, or -1. */
+static int32_t find_tag_seek_ram(int tag, const char *str)
+{
+    char *p = ramcache_hdr->tags[tag] + sizeof(struct tagcache_header);
+    int i;
+    
+    for (i = 0; i < ramcache_hdr->entry_count[tag]; i++)
+    {
+        struct tagfile_entry *tfe = (struct tagfile_entry *)p;
+        
+        if (!strcasecmp(tfe->tag_data, str))
+            return p - ramcache_hdr->tags[tag];
+        
+        p += sizeof(struct tagfile_entry) + tfe->tag_length;
+    }
+    
+    return -1;
+}
+
+/**
+ * Find the entries a ram search can match from the seek index of its
+ * most selective filter or "is" clause. Returns NULL if there is nothing
+ * to narrow the search with and every entry has to be checked.
+ */
+static const int32_t *find_candidates_ram(struct tagcache_search *tcs,
+                                          int *count)
+{
+    const int32_t *best = NULL;
+    int32_t seek;
+    int clause_count = tcs->clause_count;
+    int i, tag, lo, hi;
+    
+    if (!ramcache_hdr->seek_index_valid)
+        return NULL;
+    
+    /* With a logical-or no single clause has to match. */
+    for (i = 0; i < tcs->clause_count; i++)
+    {
+        if (tcs->clause[i]->type == clause_logical_or)
+            clause_count = 0;
+    }
+    
+    for (i = -tcs->filter_count; i < clause_count; i++)
+    {
+        if (i < 0)
+        {
+            tag = tcs->filter_tag[-i - 1];
+            seek = tcs->filter_seek[-i - 1];
+        }
+        else
+        {
+            struct tagcache_search_clause *clause = tcs->clause[i];
+            
+            tag = clause->tag;
+            if (clause->type != clause_is || clause->numeric
+                || !TAGCACHE_IS_SEEK_INDEXED(tag))
+                continue;
+            
+            seek = find_tag_seek_ram(tag, clause->str);
+            if (seek < 0)
+            {
+                /* Nothing can match. */
+                *count = 0;
+                return ramcache_hdr->seek_index[tag];
+            }
+        }
+        
+        if (!TAGCACHE_IS_SEEK_INDEXED(tag))
+            continue;
+        
+        lo = seek_index_bound(ramcache_hdr->seek_index[tag], 0,
+                              ramcache_hdr->seek_index_count, tag, seek);
+        hi = seek_index_bound(ramcache_hdr->seek_index[tag], lo,
+                              ramcache_hdr->seek_index_count, tag, seek + 1);
+        
+        if (best == NULL || hi - lo < *count)
+        {
+            best = &ramcache_hdr->seek_index[tag][lo];
+            *count = hi - lo;
+        }
+    }
+    
+    return best;
+}
+#endif /* HAVE_TC_RAMCACHE */
+
 static bool build_lookup_list(struct tagcache_search *tcs)
 {
     struct index_entry entry;
@@ -1153,12 +1643,36 @@ static bool build_lookup_list(struct tagcache_search *tcs)
 # endif
         )
     {
+        const int32_t *candidates;
+        int candidate_count, k;
+        
         move_lock++; /* lock because below makes a pointer to movable data */
-        for (i = tcs->seek_pos; i < current_tcmh.tch.entry_count; i++)
+        
+        /* Only visit the entries that can match, in index order. */
+        candidates = find_candidates_ram(tcs, &candidate_count);
+        if (candidates)
+            k = seek_index_bound(candidates, 0, candidate_count, -1,
+                                 tcs->seek_pos);
+        else
+            k = tcs->seek_pos;
+        
+        for (;; k++)
         {
             struct tagcache_seeklist_entry *seeklist;
+            struct index_entry *idx;
+            
+            if (!candidates)
+                i = k;
+            else if (k < candidate_count)
+                i = candidates[k];
+            else
+                i = current_tcmh.tch.entry_count;
+            
+            if (i >= current_tcmh.tch.entry_count)
+                break;
+            
             /* idx points to movable data, don't yield or reload */
-            struct index_entry *idx = &ramcache_hdr->indices[i];
+            idx = &ramcache_hdr->indices[i];
             if (tcs->seek_list_count == SEEK_LIST_SIZE)
                 break ;
             
@@ -1199,7 +1713,64 @@ static bool build_lookup_list(struct tagcache_search *tcs)
         return tcs->seek_list_count > 0;
     }
 #endif
-    
+
+#ifdef TAGCACHE_COLUMNS
+    if (columns)
+    {
+        const int32_t *flags = COLUMN_FLAGS;
+        const int32_t *seeks = COLUMN(tcs->type);
+        const int32_t *filters[TAGCACHE_MAX_FILTERS];
+
+        for (j = 0; j < tcs->filter_count; j++)
+            filters[j] = COLUMN(tcs->filter_tag[j]);
+
+        for (i = tcs->seek_pos; i < columns->mh.tch.entry_count; i++)
+        {
+            struct tagcache_seeklist_entry *seeklist;
+
+            if (tcs->seek_list_count == SEEK_LIST_SIZE)
+                break ;
+
+            /* Skip deleted files. */
+            if (flags[i] & FLAG_DELETED)
+                continue;
+
+            /* Go through all filters.. */
+            for (j = 0; j < tcs->filter_count; j++)
+            {
+                if (filters[j][i] != tcs->filter_seek[j])
+                    break ;
+            }
+
+            if (j < tcs->filter_count)
+                continue ;
+
+            /* Check for conditions. */
+            if (tcs->clause_count > 0)
+            {
+                columns_get_index(i, &entry);
+                if (!check_clauses(tcs, &entry, tcs->clause, tcs->clause_count))
+                    continue;
+            }
+
+            /* Add to the seek list if not already in uniq buffer. */
+            if (!add_uniqbuf(tcs, seeks[i]))
+                continue;
+
+            /* Lets add it. */
+            seeklist = &tcs->seeklist[tcs->seek_list_count];
+            seeklist->seek = seeks[i];
+            seeklist->flag = flags[i];
+            seeklist->idx_id = i;
+            tcs->seek_list_count++;
+        }
+
+        tcs->seek_pos = i;
+
+        return tcs->seek_list_count > 0;
+    }
+#endif
+    
     if (tcs->masterfd < 0)
     {
         struct master_header tcmh;
@@ -1264,6 +1835,10 @@ static void remove_files(void)
     tc_stat.ready = false;
     tc_stat.ramcache = false;
     tc_stat.econ = false;
+#ifdef TAGCACHE_COLUMNS
+    retire_columns();
+    remove(TAGCACHE_FILE_COLUMNS);
+#endif
     remove(TAGCACHE_FILE_MASTER);
     for (i = 0; i < TAG_COUNT; i++)
     {
@@ -1552,6 +2127,28 @@ static bool get_next(struct tagcache_search *tcs)
         }
     }
 #endif
+#ifdef TAGCACHE_COLUMNS
+    if (columns)
+    {
+        struct tagfile_entry *ep = columns_tag(tcs->type, tcs->position);
+        if (!ep)
+        {
+            logf("read error #5");
+            tcs->valid = false;
+            return false;
+        }
+
+        tcs->result_len = strlcpy(buf, ep->tag_data, sizeof(buf)) + 1;
+        tcs->result = buf;
+        tcs->idx_id = ep->idx_id;
+        tcs->ramresult = false;
+
+        /* Increase position for the next run. This may get overwritten. */
+        tcs->position += sizeof(struct tagfile_entry) + ep->tag_length;
+
+        return true;
+    }
+#endif
     
     if (!open_files(tcs, tcs->type))
     {
@@ -1640,6 +2237,11 @@ static bool update_master_header(void)
     ecwrite(fd, &myhdr, 1, master_header_ec, tc_stat.econ);
     close(fd);
     
+#ifdef TAGCACHE_COLUMNS
+    if (columns)
+        columns->mh = myhdr;
+#endif
+
     return true;
 }
 
@@ -1794,27 +2396,20 @@ static int check_if_empty(char **tag)
     entry.tag_offset[tag] = offset; \
     entry.tag_length[tag] = check_if_empty(data); \
     offset += entry.tag_length[tag]
-/* GCC 3.4.6 for Coldfire can choose to inline this function. Not a good
- * idea, as it uses lots of stack and is called from a recursive function
- * (check_dir).
+/* Checks whether a file needs to be read into the database: it must be
+ * supported and either new or modified since it was added. A file counts as
+ * modified when its mtime or size differ from the ones in the database.
+ * Modified files are deleted from the database here.
  */
-static void __attribute__ ((noinline)) add_tagcache(char *path,
-                                                    unsigned long mtime
+static bool __attribute__ ((noinline)) check_tagcache_file(const char *path,
+                                                    unsigned long mtime,
+                                                    long size
 #if defined(HAVE_TC_RAMCACHE) && defined(HAVE_DIRCACHE)
                                                     ,int dc
 #endif
                                                    )
 {
-    struct mp3entry id3;
-    struct temp_file_entry entry;
-    bool ret;
-    int fd;
     int idx_id = -1;
-    char tracknumfix[3];
-    int offset = 0;
-    int path_length = strlen(path);
-    bool has_albumartist;
-    bool has_grouping;
 
 #ifdef SIMULATOR
     /* Crude logging for the sim - to aid in debugging */
@@ -1828,19 +2423,19 @@ static void __attribute__ ((noinline)) add_tagcache(char *path,
 #endif
 
     if (cachefd < 0)
-        return ;
+        return false;
 
     /* Check for overlength file path. */
-    if (path_length > TAG_MAXLEN)
+    if (strlen(path) > TAG_MAXLEN)
     {
         /* Path can't be shortened. */
         logf("Too long path: %s", path);
-        return ;
+        return false;
     }
     
     /* Check if the file is supported. */
     if (probe_file_format(path) == AFMT_UNKNOWN)
-        return ;
+        return false;
     
     /* Check if the file is already cached. */
 #if defined(HAVE_TC_RAMCACHE) && defined(HAVE_DIRCACHE)
@@ -1862,13 +2457,14 @@ static void __attribute__ ((noinline)) add_tagcache(char *path,
         if (!get_index(-1, idx_id, &idx, true))
         {
             logf("failed to retrieve index entry");
-            return ;
+            return false;
         }
         
-        if ((unsigned long)idx.tag_seek[tag_mtime] == mtime)
+        if ((unsigned long)idx.tag_seek[tag_mtime] == mtime
+            && idx.tag_seek[tag_filesize] == (int32_t)size)
         {
             /* No changes to file. */
-            return ;
+            return false;
         }
         
         /* Metadata might have been changed. Delete the entry. */
@@ -1876,69 +2472,89 @@ static void __attribute__ ((noinline)) add_tagcache(char *path,
         if (!delete_entry(idx_id))
         {
             logf("delete_entry failed: %d", idx_id);
-            return ;
+            return false;
         }
     }
-    
+
+    return true;
+}
+
+/* Reads the metadata of a file. Touches no tagcache state, so it may run in
+ * the scanner's worker threads. */
+static bool read_tagcache_metadata(struct mp3entry *id3, const char *path)
+{
+    bool ret;
+    int fd;
+
     fd = open(path, O_RDONLY);
     if (fd < 0)
     {
         logf("open fail: %s", path);
-        return ;
+        return false;
     }
 
-    memset(&id3, 0, sizeof(struct mp3entry));
-    memset(&entry, 0, sizeof(struct temp_file_entry));
-    memset(&tracknumfix, 0, sizeof(tracknumfix));
-    ret = get_metadata(&id3, fd, path);
+    memset(id3, 0, sizeof(struct mp3entry));
+    ret = get_metadata(id3, fd, path);
     close(fd);
 
-    if (!ret)
-        return ;
+    return ret;
+}
+
+/* Appends a file and its metadata to the temporary db file. */
+static void add_tagcache_entry(char *path, unsigned long mtime, long size,
+                               struct mp3entry *id3)
+{
+    struct temp_file_entry entry;
+    int offset = 0;
+    bool has_albumartist;
+    bool has_grouping;
+
+    memset(&entry, 0, sizeof(struct temp_file_entry));
 
     logf("-> %s", path);
     
-    if (id3.tracknum <= 0)              /* Track number missing? */
+    if (id3->tracknum <= 0)             /* Track number missing? */
     {
-        id3.tracknum = -1;
+        id3->tracknum = -1;
     }
     
     /* Numeric tags */
-    entry.tag_offset[tag_year] = id3.year;
-    entry.tag_offset[tag_discnumber] = id3.discnum;
-    entry.tag_offset[tag_tracknumber] = id3.tracknum;
-    entry.tag_offset[tag_length] = id3.length;
-    entry.tag_offset[tag_bitrate] = id3.bitrate;
+    entry.tag_offset[tag_year] = id3->year;
+    entry.tag_offset[tag_discnumber] = id3->discnum;
+    entry.tag_offset[tag_tracknumber] = id3->tracknum;
+    entry.tag_offset[tag_length] = id3->length;
+    entry.tag_offset[tag_bitrate] = id3->bitrate;
     entry.tag_offset[tag_mtime] = mtime;
+    entry.tag_offset[tag_filesize] = size;
     
     /* String tags. */
-    has_albumartist = id3.albumartist != NULL
-        && strlen(id3.albumartist) > 0;
-    has_grouping = id3.grouping != NULL
-        && strlen(id3.grouping) > 0;
+    has_albumartist = id3->albumartist != NULL
+        && strlen(id3->albumartist) > 0;
+    has_grouping = id3->grouping != NULL
+        && strlen(id3->grouping) > 0;
 
     ADD_TAG(entry, tag_filename, &path);
-    ADD_TAG(entry, tag_title, &id3.title);
-    ADD_TAG(entry, tag_artist, &id3.artist);
-    ADD_TAG(entry, tag_album, &id3.album);
-    ADD_TAG(entry, tag_genre, &id3.genre_string);
-    ADD_TAG(entry, tag_composer, &id3.composer);
-    ADD_TAG(entry, tag_comment, &id3.comment);
+    ADD_TAG(entry, tag_title, &id3->title);
+    ADD_TAG(entry, tag_artist, &id3->artist);
+    ADD_TAG(entry, tag_album, &id3->album);
+    ADD_TAG(entry, tag_genre, &id3->genre_string);
+    ADD_TAG(entry, tag_composer, &id3->composer);
+    ADD_TAG(entry, tag_comment, &id3->comment);
     if (has_albumartist)
     {
-        ADD_TAG(entry, tag_albumartist, &id3.albumartist);
+        ADD_TAG(entry, tag_albumartist, &id3->albumartist);
     }
     else
     {
-        ADD_TAG(entry, tag_albumartist, &id3.artist);
+        ADD_TAG(entry, tag_albumartist, &id3->artist);
     }
     if (has_grouping)
     {
-        ADD_TAG(entry, tag_grouping, &id3.grouping);
+        ADD_TAG(entry, tag_grouping, &id3->grouping);
     }
     else
     {
-        ADD_TAG(entry, tag_grouping, &id3.title);
+        ADD_TAG(entry, tag_grouping, &id3->title);
     }
     entry.data_length = offset;
     
@@ -1947,31 +2563,58 @@ static void __attribute__ ((noinline)) add_tagcache(char *path,
     
     /* And tags also... Correct order is critical */
     write_item(path);
-    write_item(id3.title);
-    write_item(id3.artist);
-    write_item(id3.album);
-    write_item(id3.genre_string);
-    write_item(id3.composer);
-    write_item(id3.comment);
+    write_item(id3->title);
+    write_item(id3->artist);
+    write_item(id3->album);
+    write_item(id3->genre_string);
+    write_item(id3->composer);
+    write_item(id3->comment);
     if (has_albumartist)
     {
-        write_item(id3.albumartist);
+        write_item(id3->albumartist);
     }
     else
     {
-        write_item(id3.artist);
+        write_item(id3->artist);
     }
     if (has_grouping)
     {
-        write_item(id3.grouping);
+        write_item(id3->grouping);
     }
     else
     {
-        write_item(id3.title);
+        write_item(id3->title);
     }
     total_entry_count++;    
 }
 
+/* GCC 3.4.6 for Coldfire can choose to inline this function. Not a good
+ * idea, as it uses lots of stack and is called from a recursive function
+ * (check_dir).
+ */
+static void __attribute__ ((noinline)) add_tagcache(char *path,
+                                                    unsigned long mtime,
+                                                    long size
+#if defined(HAVE_TC_RAMCACHE) && defined(HAVE_DIRCACHE)
+                                                    ,int dc
+#endif
+                                                   )
+{
+    struct mp3entry id3;
+
+    if (!check_tagcache_file(path, mtime, size
+#if defined(HAVE_TC_RAMCACHE) && defined(HAVE_DIRCACHE)
+                             , dc
+#endif
+                            ))
+        return ;
+
+    if (!read_tagcache_metadata(&id3, path))
+        return ;
+
+    add_tagcache_entry(path, mtime, size, &id3);
+}
+
 static bool tempbuf_insert(char *str, int id, int idx_id, bool unique)
 {
     struct tempbuf_searchidx *index = (struct tempbuf_searchidx *)tempbuf;
@@ -1980,6 +2623,9 @@ static bool tempbuf_insert(char *str, int id, int idx_id, bool unique)
     unsigned crc32;
     unsigned *crcbuf = (unsigned *)&tempbuf[tempbuf_size-4];
     char buf[TAG_MAXLEN+32];
+#ifdef __PCTOOL__
+    unsigned long slot = 0;
+#endif
     
     for (i = 0; str[i] != '\0' && i < (int)sizeof(buf)-1; i++)
         buf[i] = tolower(str[i]);
@@ -1989,9 +2635,16 @@ static bool tempbuf_insert(char *str, int id, int idx_id, bool unique)
     
     if (unique)
     {
+#ifdef __PCTOOL__
+        for (slot = crc32 & tempbuf_hash_mask; tempbuf_hash[slot] > 0;
+             slot = (slot + 1) & tempbuf_hash_mask)
+        {
+            i = tempbuf_hash[slot] - 1;
+#else
         /* Check if the crc does not exist -> entry does not exist for sure. */
         for (i = 0; i < tempbufidx; i++)
         {
+#endif
             if (crcbuf[-i] != crc32)
                 continue;
             
@@ -2038,6 +2691,10 @@ static bool tempbuf_insert(char *str, int id, int idx_id, bool unique)
     index[tempbufidx].str = &tempbuf[tempbuf_pos];
     memcpy(index[tempbufidx].str, str, len);
     tempbuf_pos += len;
+#ifdef __PCTOOL__
+    if (unique)
+        tempbuf_hash[slot] = tempbufidx + 1;
+#endif
     tempbufidx++;
     
     return true;
@@ -2062,14 +2719,11 @@ static int compare(const void *p1, const void *p2)
     return strncasecmp(e1->str, e2->str, TAG_MAXLEN);
 }
 
-static int tempbuf_sort(int fd)
+/* Generate reverse lookup entries. */
+static bool tempbuf_link_ids(void)
 {
-    struct tempbuf_searchidx *index = (struct tempbuf_searchidx *)tempbuf;
-    struct tagfile_entry fe;
     int i;
-    int length;
     
-    /* Generate reverse lookup entries. */
     for (i = 0; i < lookup_buffer_depth; i++)
     {
         struct tempbuf_id_list *idlist;
@@ -2080,30 +2734,37 @@ static int tempbuf_sort(int fd)
         if (lookup[i]->idlist.id == i)
             continue;
         
-        idlist = &lookup[i]->idlist;
-        while (idlist->next != NULL)
-            idlist = idlist->next;
-        
         tempbuf_left -= sizeof(struct tempbuf_id_list);
         if (tempbuf_left - 4 < 0)
-            return -1;
+            return false;
         
-        idlist->next = (struct tempbuf_id_list *)&tempbuf[tempbuf_pos];
         if (tempbuf_pos & 0x03)
         {
             tempbuf_pos = (tempbuf_pos & ~0x03) + 0x04;
             tempbuf_left -= 3;
-            idlist->next = (struct tempbuf_id_list *)&tempbuf[tempbuf_pos];
         }
+        idlist = (struct tempbuf_id_list *)&tempbuf[tempbuf_pos];
         tempbuf_pos += sizeof(struct tempbuf_id_list);
         
-        idlist = idlist->next;
+        /* The order of the ids doesn't matter. Link the id right after the
+         * first one instead of walking to the end of a list that can hold
+         * every track of the database, e.g. for an empty comment. */
         idlist->id = i;
-        idlist->next = NULL;
+        idlist->next = lookup[i]->idlist.next;
+        lookup[i]->idlist.next = idlist;
 
         do_timed_yield();
     }
     
+    return true;
+}
+
+/* Sort the buffer and point the lookup list at the sorted entries. */
+static void tempbuf_qsort(void)
+{
+    struct tempbuf_searchidx *index = (struct tempbuf_searchidx *)tempbuf;
+    int i;
+    
     qsort(index, tempbufidx, sizeof(struct tempbuf_searchidx), compare);
     memset(lookup, 0, lookup_buffer_depth * sizeof(struct tempbuf_searchidx **));
     
@@ -2118,49 +2779,171 @@ static int tempbuf_sort(int fd)
                 lookup[idlist->id] = &index[i];
             idlist = idlist->next;
         }
-        
-        index[i].seek = lseek(fd, 0, SEEK_CUR);
-        length = strlen(index[i].str) + 1;
-        fe.tag_length = length;
-        fe.idx_id = index[i].idx_id;
-        
-        /* Check the chunk alignment. */
-        if ((fe.tag_length + sizeof(struct tagfile_entry)) 
-            % TAGFILE_ENTRY_CHUNK_LENGTH)
-        {
-            fe.tag_length += TAGFILE_ENTRY_CHUNK_LENGTH - 
-                ((fe.tag_length + sizeof(struct tagfile_entry)) 
-                 % TAGFILE_ENTRY_CHUNK_LENGTH);
-        }
-        
+    }
+}
+
+/* Write one tag to the current position of fd and remember where it went. */
+static int tempbuf_write_entry(int fd, struct tempbuf_searchidx *entry)
+{
+    struct tagfile_entry fe;
+    int length;
+    
+    entry->seek = lseek(fd, 0, SEEK_CUR);
+    length = strlen(entry->str) + 1;
+    fe.tag_length = length;
+    fe.idx_id = entry->idx_id;
+    
+    /* Check the chunk alignment. */
+    if ((fe.tag_length + sizeof(struct tagfile_entry)) 
+        % TAGFILE_ENTRY_CHUNK_LENGTH)
+    {
+        fe.tag_length += TAGFILE_ENTRY_CHUNK_LENGTH - 
+            ((fe.tag_length + sizeof(struct tagfile_entry)) 
+             % TAGFILE_ENTRY_CHUNK_LENGTH);
+    }
+    
 #ifdef TAGCACHE_STRICT_ALIGN
-        /* Make sure the entry is long aligned. */
-        if (index[i].seek & 0x03)
-        {
-            logf("tempbuf_sort: alignment error!");
-            return -3;
-        }
+    /* Make sure the entry is long aligned. */
+    if (entry->seek & 0x03)
+    {
+        logf("tempbuf_write_entry: alignment error!");
+        return -3;
+    }
 #endif
-        
-        if (ecwrite(fd, &fe, 1, tagfile_entry_ec, tc_stat.econ) !=
-            sizeof(struct tagfile_entry))
+    
+    if (ecwrite(fd, &fe, 1, tagfile_entry_ec, tc_stat.econ) !=
+        sizeof(struct tagfile_entry))
+    {
+        logf("tempbuf_write_entry: write error #1");
+        return -1;
+    }
+    
+    if (write(fd, entry->str, length) != length)
+    {
+        logf("tempbuf_write_entry: write error #2");
+        return -2;
+    }
+    
+    /* Write some padding. */
+    if (fe.tag_length - length > 0)
+        write(fd, "XXXXXXXX", fe.tag_length - length);
+    
+    return 0;
+}
+
+static int tempbuf_sort(int fd)
+{
+    struct tempbuf_searchidx *index = (struct tempbuf_searchidx *)tempbuf;
+    int i, rc;
+    
+    if (!tempbuf_link_ids())
+        return -1;
+    
+    tempbuf_qsort();
+    
+    for (i = 0; i < tempbufidx; i++)
+    {
+        rc = tempbuf_write_entry(fd, &index[i]);
+        if (rc < 0)
+            return rc;
+    }
+
+    return i;
+}
+
+/**
+ * Merge the new tags in the buffer into an existing tag file without
+ * moving any of the tags already in it. Tags already present in a unique
+ * tag file are reused, all others are appended to the end of the file.
+ * The file stays sorted except for the appended tail, so the tags in the
+ * master index need no updating.
+ *
+ * Returns the number of tags appended or < 0 on error.
+ */
+static int tempbuf_merge(int fd, const struct tagcache_header *tch,
+                         bool unique)
+{
+    struct tempbuf_searchidx *index = (struct tempbuf_searchidx *)tempbuf;
+    struct tempbuf_searchidx key;
+    char buf[TAG_MAXLEN+32];
+    int i, rc;
+    int appended = 0;
+    
+    if (!tempbuf_link_ids())
+        return -1;
+    
+    tempbuf_qsort();
+    
+    if (unique)
+    {
+        /* Look up every existing tag among the new ones. */
+        key.str = buf;
+        lseek(fd, sizeof(struct tagcache_header), SEEK_SET);
+        for (i = 0; i < tch->entry_count; i++)
         {
-            logf("tempbuf_sort: write error #1");
-            return -1;
+            struct tagfile_entry entry;
+            int lo, hi;
+            int loc = lseek(fd, 0, SEEK_CUR);
+            
+            if (ecread_tagfile_entry(fd, &entry) != sizeof(struct tagfile_entry))
+            {
+                logf("merge: read error #1");
+                return -1;
+            }
+            
+            if (entry.tag_length >= (int)sizeof(buf))
+            {
+                logf("merge: too long tag");
+                return -1;
+            }
+            
+            if (read(fd, buf, entry.tag_length) != entry.tag_length)
+            {
+                logf("merge: read error #2");
+                return -1;
+            }
+            
+            /* Skip deleted entries. */
+            if (buf[0] == '\0')
+                continue;
+            
+            /* Binary search, the buffer is sorted now. */
+            lo = 0;
+            hi = tempbufidx - 1;
+            while (lo <= hi)
+            {
+                int mid = (lo + hi) / 2;
+                int cmp = compare(&key, &index[mid]);
+                
+                if (cmp == 0)
+                {
+                    if (index[mid].seek < 0)
+                        index[mid].seek = loc;
+                    break;
+                }
+                
+                if (cmp < 0)
+                    hi = mid - 1;
+                else
+                    lo = mid + 1;
+            }
         }
+    }
+    
+    lseek(fd, 0, SEEK_END);
+    for (i = 0; i < tempbufidx; i++)
+    {
+        if (index[i].seek >= 0)
+            continue;
         
-        if (write(fd, index[i].str, length) != length)
-        {
-            logf("tempbuf_sort: write error #2");
-            return -2;
-        }
+        rc = tempbuf_write_entry(fd, &index[i]);
+        if (rc < 0)
+            return rc;
         
-        /* Write some padding. */
-        if (fe.tag_length - length > 0)
-            write(fd, "XXXXXXXX", fe.tag_length - length);
+        appended++;
     }
-
-    return i;
+    
+    return appended;
 }
     
 inline static struct tempbuf_searchidx* tempbuf_locate(int id)
@@ -2304,6 +3087,8 @@ static bool build_numeric_indices(struct tagcache_header *h, int tmpfd)
              * - Full identical match is required
              * 
              * If tag_filename matches, no further checking necessary.
+             * Neither if tag_mtime and tag_filesize match, as the file
+             * has then been moved or renamed.
              * 
              * For string hashes: tag_artist, tag_album, tag_title
              * - All three of these must match
@@ -2316,8 +3101,12 @@ static bool build_numeric_indices(struct tagcache_header *h, int tmpfd)
                 if (tfe->tag_offset[tag_length] != idx.tag_seek[tag_length])
                     continue;
                 
-                /* Now it's time to do the hash matching. */
-                if (tfe->tag_offset[tag_filename] != idx.tag_seek[tag_filename])
+                /* Now it's time to do the hash matching. A file that has
+                 * been moved or renamed has kept its mtime and size. */
+                if (tfe->tag_offset[tag_filename] != idx.tag_seek[tag_filename]
+                    && (tfe->tag_offset[tag_mtime] != idx.tag_seek[tag_mtime]
+                     || tfe->tag_offset[tag_filesize]
+                        != idx.tag_seek[tag_filesize]))
                 {
                     int match_count = 0;
                     
@@ -2360,6 +3149,7 @@ static bool build_numeric_indices(struct tagcache_header *h, int tmpfd)
                 }
                 
                 logf("Entry resurrected");
+                break;
             }
         }
         
@@ -2419,12 +3209,16 @@ static bool build_numeric_indices(struct tagcache_header *h, int tmpfd)
 }
 
 /**
+ * With merge set, sorted tag files are only appended to (see
+ * tempbuf_merge()) instead of being loaded, resorted and rewritten.
+ *
  * Return values:
  *     > 0   success
  *    == 0   temporary failure
  *     < 0   fatal error
  */
-static int build_index(int index_type, struct tagcache_header *h, int tmpfd)
+static int build_index(int index_type, struct tagcache_header *h, int tmpfd,
+                       bool merge)
 {
     int i;
     struct tagcache_header tch;
@@ -2445,7 +3239,9 @@ static int build_index(int index_type, struct tagcache_header *h, int tmpfd)
     masterfd = open_master_fd(&tcmh, false);
     if (masterfd >= 0)
     {
-        commit_entry_count += tcmh.tch.entry_count;
+        /* Old tags are only loaded when the tag file is resorted. */
+        if (!merge)
+            commit_entry_count += tcmh.tch.entry_count;
         close(masterfd);
     }
     else
@@ -2453,7 +3249,7 @@ static int build_index(int index_type, struct tagcache_header *h, int tmpfd)
 
     /* Open the index file, which contains the tag names. */
     fd = open_tag_fd(&tch, index_type, true);
-    if (fd >= 0)
+    if (fd >= 0 && !merge)
     {
         logf("tch.datasize=%ld", tch.datasize);
         lookup_buffer_depth = 1 +
@@ -2502,6 +3298,23 @@ static int build_index(int index_type, struct tagcache_header *h, int tmpfd)
     tempbuf_pos += lookup_buffer_depth * sizeof(void **);
     memset(lookup, 0, lookup_buffer_depth * sizeof(void **));
     
+#ifdef __PCTOOL__
+    /* Keep the hash table at most half full. */
+    for (tempbuf_hash_mask = 1;
+         tempbuf_hash_mask < (unsigned long)commit_entry_count * 2;
+         tempbuf_hash_mask <<= 1);
+    
+    tempbuf_hash = (int32_t *)&tempbuf[tempbuf_pos];
+    tempbuf_pos += tempbuf_hash_mask * sizeof(int32_t);
+    if ((size_t)tempbuf_pos > tempbuf_size)
+    {
+        logf("Buffer way too small!");
+        return 0;
+    }
+    memset(tempbuf_hash, 0, tempbuf_hash_mask * sizeof(int32_t));
+    tempbuf_hash_mask--;
+#endif
+    
     /* And calculate the remaining data space used mainly for storing
      * tag data (strings). */
     tempbuf_left = tempbuf_size - tempbuf_pos - 8;
@@ -2518,7 +3331,12 @@ static int build_index(int index_type, struct tagcache_header *h, int tmpfd)
          * it entirely into memory so we can resort it later for use with
          * chunked browsing.
          */
-        if (TAGCACHE_IS_SORTED(index_type))
+        if (merge && TAGCACHE_IS_SORTED(index_type))
+        {
+            /* Only new tags are loaded, tempbuf_merge() finds the old ones. */
+            logf("merging tags...");
+        }
+        else if (TAGCACHE_IS_SORTED(index_type))
         {
             logf("loading tags...");
             for (i = 0; i < tch.entry_count; i++)
@@ -2714,9 +3532,23 @@ static int build_index(int index_type, struct tagcache_header *h, int tmpfd)
         }
         logf("done");
 
-        /* Sort the buffer data and write it to the index file. */
-        lseek(fd, sizeof(struct tagcache_header), SEEK_SET);
-        /**
+        if (merge)
+        {
+            /* Existing tags keep their place, so the master index too. */
+            i = tempbuf_merge(fd, &tch, TAGCACHE_IS_UNIQUE(index_type));
+            if (i < 0)
+            {
+                error = true;
+                goto error_exit;
+            }
+            logf("appended %d tags", i);
+            tempbufidx = tch.entry_count + i;
+            goto update_new;
+        }
+
+        /* Sort the buffer data and write it to the index file. */
+        lseek(fd, sizeof(struct tagcache_header), SEEK_SET);
+        /**
          * We need to truncate the index file now. There can be junk left
          * at the end of file (however, we _should_ always follow the
          * entry_count and don't crash with that).
@@ -2790,6 +3622,7 @@ static int build_index(int index_type, struct tagcache_header *h, int tmpfd)
      * Walk through the temporary file containing the new tags.
      */
     // build_normal_index(h, tmpfd, masterfd, idx);
+    update_new:
     logf("updating new indices...");
     lseek(masterfd, masterfd_pos, SEEK_SET);
     lseek(tmpfd, sizeof(struct tagcache_header), SEEK_SET);
@@ -2921,6 +3754,7 @@ static bool commit(void)
     int i, len, rc;
     int tmpfd;
     int masterfd;
+    bool merge = false;
 #ifdef HAVE_DIRCACHE
     bool dircache_buffer_stolen = false;
 #endif
@@ -2973,6 +3807,9 @@ static bool commit(void)
 #ifdef HAVE_TC_RAMCACHE
     tc_stat.ramcache = false;
 #endif
+#ifdef TAGCACHE_COLUMNS
+    retire_columns();
+#endif
     
     read_lock++;
     
@@ -3017,6 +3854,19 @@ static bool commit(void)
     
     logf("commit %ld entries...", tch.entry_count);
     
+    /**
+     * Merge the new entries into the existing tag files unless that
+     * would leave too much of them out of order.
+     */
+    if (tc_stat.ready && (masterfd = open_master_fd(&tcmh, false)) >= 0)
+    {
+        close(masterfd);
+        merge = (tcmh.fragmented + tch.entry_count) * TAGCACHE_FRAGMENT_DIV
+                < tcmh.tch.entry_count;
+        logf("fragmented: %ld/%ld -> %s", tcmh.fragmented,
+             tcmh.tch.entry_count, merge ? "merge" : "rebuild");
+    }
+    
     /* Mark DB dirty so it will stay disabled if commit fails. */
     current_tcmh.dirty = true;
     update_master_header();
@@ -3034,7 +3884,7 @@ static bool commit(void)
             continue;
         
         tc_stat.commit_step++;
-        ret = build_index(i, &tch, tmpfd);
+        ret = build_index(i, &tch, tmpfd, merge);
         if (ret <= 0)
         {
             close(tmpfd);
@@ -3076,6 +3926,11 @@ static bool commit(void)
         + tch.datasize;
     tcmh.dirty = false;
     tcmh.commitid++;
+    change_serial++;
+    if (merge)
+        tcmh.fragmented += tch.entry_count;
+    else
+        tcmh.fragmented = 0;
 
     lseek(masterfd, 0, SEEK_SET);
     ecwrite(masterfd, &tcmh, 1, master_header_ec, tc_stat.econ);
@@ -3104,19 +3959,83 @@ static bool commit(void)
     if (tc_stat.ramcache_allocated > 0)
         tagcache_start_scan();
 #endif
+#ifdef TAGCACHE_COLUMNS
+    load_columns();
+#endif
     
     read_lock--;
     
     return true;
 }
 
+#ifdef __PCTOOL__
+/**
+ * Returns the buffer size build_index() needs for the largest tag file
+ * the next commit sorts, with all of its tags in memory. There is plenty of
+ * memory on a PC, so very large libraries are built in one go instead of
+ * running out of buffer like on the players.
+ */
+static size_t tempbuf_needed(void)
+{
+    struct tagcache_header tch;
+    struct master_header tcmh;
+    char buf[MAX_PATH];
+    long entries = 0, tagdata = 0, tmpdata = 0;
+    int fd, tag;
+    
+    fd = open(TAGCACHE_FILE_TEMP, O_RDONLY);
+    if (fd >= 0)
+    {
+        if (read(fd, &tch, sizeof tch) == sizeof tch)
+            entries += tch.entry_count;
+        tmpdata = filesize(fd);
+        close(fd);
+    }
+    
+    fd = open(TAGCACHE_FILE_MASTER, O_RDONLY);
+    if (fd >= 0)
+    {
+        if (read(fd, &tcmh, sizeof tcmh) == sizeof tcmh)
+            entries += tcmh.tch.entry_count;
+        close(fd);
+    }
+    
+    for (tag = 0; tag < TAG_COUNT; tag++)
+    {
+        if (TAGCACHE_IS_NUMERIC(tag))
+            continue;
+        
+        snprintf(buf, sizeof buf, TAGCACHE_FILE_INDEX, tag);
+        fd = open(buf, O_RDONLY);
+        if (fd >= 0)
+        {
+            tagdata = MAX(tagdata, filesize(fd));
+            close(fd);
+        }
+    }
+    
+    /* Every tag costs a buffer entry, a lookup entry, a crc, an id list
+     * entry and hash table space. The strings fit in the files. */
+    entries += tagdata / TAGFILE_ENTRY_CHUNK_LENGTH + 2;
+    return entries * (sizeof(struct tempbuf_searchidx)
+                      + sizeof(struct tempbuf_searchidx *) + sizeof(unsigned)
+                      + sizeof(struct tempbuf_id_list) + 4
+                      + 4 * sizeof(int32_t))
+           + tmpdata + tagdata;
+}
+#endif
+
 static int tempbuf_handle;
 static void allocate_tempbuf(void)
 {
     /* Yeah, malloc would be really nice now :) */
 #ifdef __PCTOOL__
-    tempbuf_size = 32*1024*1024;
+    tempbuf_size = MAX(tempbuf_needed(), 32*1024*1024);
+    tempbuf_size = ALIGN_UP(tempbuf_size, 4);
+    logf("tempbuf: %ld KiB", (long)(tempbuf_size / 1024));
     tempbuf = malloc(tempbuf_size);
+    if (!tempbuf)
+        tempbuf_size = 0;
 #else
     tempbuf_handle = core_alloc_maximum("tc tempbuf", &tempbuf_size, NULL);
     tempbuf = core_get_data(tempbuf_handle);
@@ -3287,6 +4206,7 @@ long tagcache_increase_serial(void)
         sleep(1);
     
     old = current_tcmh.serial++;
+    runtime_change_serial++;
     queue_command(CMD_UPDATE_MASTER_HEADER, 0, 0, 0);
     
     return old;
@@ -3294,6 +4214,7 @@ long tagcache_increase_serial(void)
 
 void tagcache_update_numeric(int idx_id, int tag, long data)
 {
+    runtime_change_serial++;
     queue_command(CMD_UPDATE_NUMERIC, idx_id, tag, data);
 }
 #endif /* !__PCTOOL__ */
@@ -3518,6 +4439,7 @@ bool tagcache_import_changelog(void)
     }
     
     write_lock--;
+    runtime_change_serial++;
     
     update_master_header();
     
@@ -3618,13 +4540,22 @@ static bool delete_entry(long idx_id)
     struct master_header myhdr;
     char buf[TAG_MAXLEN+32];
     int in_use[TAG_COUNT];
+    int tombstones = 0;
     
     logf("delete_entry(): %ld", idx_id);
     
 #ifdef HAVE_TC_RAMCACHE
-    /* At first mark the entry removed from ram cache. */
+    /* At first mark the entry removed from ram cache. Its tag seeks get
+     * replaced by hashes below, which would upset the seek indices. */
     if (tc_stat.ramcache)
+    {
         ramcache_hdr->indices[idx_id].flag |= FLAG_DELETED;
+        ramcache_hdr->seek_index_valid = false;
+    }
+#endif
+#ifdef TAGCACHE_COLUMNS
+    if (columns && idx_id < columns->mh.tch.entry_count)
+        COLUMN_FLAGS[idx_id] |= FLAG_DELETED;
 #endif
     
     if ( (masterfd = open_master_fd(&myhdr, true) ) < 0)
@@ -3643,6 +4574,7 @@ static bool delete_entry(long idx_id)
         goto cleanup;
     }
     
+    change_serial++;
     myidx.flag |= FLAG_DELETED;
     lseek(masterfd, -sizeof(struct index_entry), SEEK_CUR);
     if (ecwrite_index_entry(masterfd, &myidx) != sizeof(struct index_entry))
@@ -3760,6 +4692,14 @@ static bool delete_entry(long idx_id)
             tagentry->tag_data[0] = '\0';
         }
 #endif
+#ifdef TAGCACHE_COLUMNS
+        if (columns)
+        {
+            struct tagfile_entry *tagentry = columns_tag(tag, oldseek);
+            if (tagentry)
+                tagentry->tag_data[0] = '\0';
+        }
+#endif
         
         /* Open the index file, which contains the tag names. */
         if (fd < 0)
@@ -3780,12 +4720,26 @@ static bool delete_entry(long idx_id)
         
         /* Write first data byte in tag as \0 */
         write(fd, "", 1);
+        if (TAGCACHE_IS_SORTED(tag))
+            tombstones++;
     
         /* Now tag data has been removed */
         close(fd);
         fd = -1;
     }
     
+    /* The next commit rebuilds the tag files if too many tags are gone. */
+    if (tombstones > 0)
+    {
+        myhdr.fragmented += tombstones;
+        lseek(masterfd, 0, SEEK_SET);
+        ecwrite(masterfd, &myhdr, 1, master_header_ec, tc_stat.econ);
+#ifdef TAGCACHE_COLUMNS
+        if (columns)
+            columns->mh = myhdr;
+#endif
+    }
+    
     /* Write index entry back into master index. */
     lseek(masterfd, sizeof(struct master_header) +
           (idx_id * sizeof(struct index_entry)), SEEK_SET);
@@ -3794,6 +4748,10 @@ static bool delete_entry(long idx_id)
         logf("delete_entry(): write_error #2");
         goto cleanup;
     }
+#ifdef TAGCACHE_COLUMNS
+    if (columns && idx_id < columns->mh.tch.entry_count)
+        columns_put_index(idx_id, &myidx);
+#endif
     
     close(masterfd);
     
@@ -3838,7 +4796,12 @@ static void fix_ramcache(void* old_addr, void* new_addr)
 {
     ptrdiff_t offpos = new_addr - old_addr;
     for (int i = 0; i < TAG_COUNT; i++)
+    {
         ramcache_hdr->tags[i] += offpos;
+        if (ramcache_hdr->seek_index[i])
+            ramcache_hdr->seek_index[i] = (void *)ramcache_hdr->seek_index[i]
+                                          + offpos;
+    }
 }
 
 static int move_cb(int handle, void* current, void* new)
@@ -3860,7 +4823,8 @@ static struct buflib_callbacks ops = {
 static bool allocate_tagcache(void)
 {
     struct master_header tcmh;
-    int fd;
+    int fd, tag;
+    size_t seek_index_size = 0;
 
     /* Load the header. */
     if ( (fd = open_master_fd(&tcmh, false)) < 0)
@@ -3871,12 +4835,19 @@ static bool allocate_tagcache(void)
     
     close(fd);
     
+    for (tag = 0; tag < TAG_COUNT; tag++)
+    {
+        if (TAGCACHE_IS_SEEK_INDEXED(tag))
+            seek_index_size += tcmh.tch.entry_count * sizeof(int32_t);
+    }
+    
     /** 
      * Now calculate the required cache size plus 
      * some extra space for alignment fixes. 
      */
     tc_stat.ramcache_allocated = tcmh.tch.datasize + 256 + TAGCACHE_RESERVE +
-        sizeof(struct ramcache_header) + TAG_COUNT*sizeof(void *);
+        sizeof(struct ramcache_header) + TAG_COUNT*sizeof(void *) +
+        seek_index_size;
     int handle = core_alloc_ex("tc ramcache", tc_stat.ramcache_allocated, &ops);
     ramcache_hdr = core_get_data(handle);
     memset(ramcache_hdr, 0, sizeof(struct ramcache_header));
@@ -3970,6 +4941,85 @@ static bool tagcache_dumpsave(void)
 }
 # endif
 
+static int seek_index_tag; /* Tag of the seek index being sorted */
+
+static int seek_index_compare(const void *p1, const void *p2)
+{
+    int32_t id1 = *(const int32_t *)p1;
+    int32_t id2 = *(const int32_t *)p2;
+    int32_t seek1 = ramcache_hdr->indices[id1].tag_seek[seek_index_tag];
+    int32_t seek2 = ramcache_hdr->indices[id2].tag_seek[seek_index_tag];
+    
+    do_timed_yield();
+    
+    if (seek1 != seek2)
+        return seek1 < seek2 ? -1 : 1;
+    
+    return id1 - id2;
+}
+
+/**
+ * Build a seek index for every tag in TAGCACHE_SEEK_INDEX_TAGS: the ids of
+ * all entries not deleted, sorted by tag seek and then id. Entries matching
+ * a filter are then found by binary search instead of by scanning the
+ * whole master index (see find_candidates_ram()). The indices go to p and
+ * are left out if they don't fit in bytesleft.
+ */
+static void build_seek_indices(char *p, long *bytesleft)
+{
+    int32_t *list;
+    long size = 0;
+    int count = 0;
+    int i, tag;
+    
+    ramcache_hdr->seek_index_valid = false;
+    for (tag = 0; tag < TAG_COUNT; tag++)
+        ramcache_hdr->seek_index[tag] = NULL;
+    
+    for (i = 0; i < current_tcmh.tch.entry_count; i++)
+    {
+        if (!(ramcache_hdr->indices[i].flag & FLAG_DELETED))
+            count++;
+    }
+    
+    for (tag = 0; tag < TAG_COUNT; tag++)
+    {
+        if (TAGCACHE_IS_SEEK_INDEXED(tag))
+            size += count * sizeof(int32_t);
+    }
+    
+    if (size + 4 > *bytesleft)
+    {
+        logf("no room for seek indices");
+        return;
+    }
+    *bytesleft -= size + 4;
+    
+    p = (char *)((long)p & ~0x03) + 0x04;
+    for (tag = 0; tag < TAG_COUNT; tag++)
+    {
+        if (!TAGCACHE_IS_SEEK_INDEXED(tag))
+            continue;
+        
+        list = (int32_t *)p;
+        for (i = 0; i < current_tcmh.tch.entry_count; i++)
+        {
+            if (!(ramcache_hdr->indices[i].flag & FLAG_DELETED))
+                *list++ = i;
+        }
+        
+        seek_index_tag = tag;
+        qsort(p, count, sizeof(int32_t), seek_index_compare);
+        
+        ramcache_hdr->seek_index[tag] = (int32_t *)p;
+        p = (char *)list;
+    }
+    
+    ramcache_hdr->seek_index_count = count;
+    ramcache_hdr->seek_index_valid = true;
+    logf("seek indices built: %d entries", count);
+}
+
 static bool load_tagcache(void)
 {
     struct tagcache_header *tch;
@@ -4184,6 +5234,8 @@ static bool load_tagcache(void)
         close(fd);
     }
     
+    build_seek_indices(p, &bytesleft);
+    
     tc_stat.ramcache_used = tc_stat.ramcache_allocated - bytesleft;
     logf("tagcache loaded into ram!");
 
@@ -4428,7 +5480,8 @@ static bool check_dir(const char *dirname, int add_files)
             tc_stat.curentry = curpath;
             
             /* Add a new entry to the temporary db file. */
-            add_tagcache(curpath, (info.wrtdate << 16) | info.wrttime
+            add_tagcache(curpath, (info.wrtdate << 16) | info.wrttime,
+                         info.size
 #if defined(HAVE_TC_RAMCACHE) && defined(HAVE_DIRCACHE)
                          , dir->internal_entry
 #endif
@@ -4448,6 +5501,472 @@ static bool check_dir(const char *dirname, int add_files)
 
     return success;
 }
+#ifdef TAGCACHE_PARALLEL_SCAN
+/* Parallel scan for new files.
+ *
+ * Walker threads go through the directories and put the files they find
+ * into a ring of jobs. The tagcache thread checks the jobs against the
+ * database in ring order, reader threads read the metadata of the files
+ * that need it, and the tagcache thread writes the results to the temp file,
+ * again in ring order. Everything that touches the database stays on the
+ * tagcache thread.
+ *
+ * Every search root and every directory right below a search root is a unit
+ * of work of its own for the walkers, so all volumes (which show up below
+ * the root on multivolume targets) are walked at the same time.
+ */
+enum scan_job_state {
+    SCAN_JOB_FREE = 0,  /* Unused or being filled by a walker */
+    SCAN_JOB_WALKED,    /* Waiting for check_tagcache_file() */
+    SCAN_JOB_QUEUED,    /* Waiting for a reader */
+    SCAN_JOB_READING,
+    SCAN_JOB_DONE,      /* Metadata read, waiting to be written */
+    SCAN_JOB_SKIP,      /* Nothing to write */
+};
+
+struct scan_job {
+    enum scan_job_state state;
+    bool ok;                    /* Metadata could be read */
+    unsigned long mtime;
+    long size;
+    char path[TAG_MAXLEN+1];
+    struct mp3entry id3;
+};
+
+struct scan_dir {
+    struct scan_dir *next;
+    int add_files;
+    bool root;                  /* Subdirectories become units of their own */
+    char path[];
+};
+
+static struct {
+    pthread_mutex_t lock;
+    pthread_cond_t walk_cond;   /* A job was freed or a dir was queued */
+    pthread_cond_t read_cond;   /* A job was queued for the readers */
+#ifdef __PCTOOL__
+    pthread_cond_t main_cond;   /* A job was walked or read */
+#endif
+    struct scan_job *jobs;
+    /* Positions in the ring, they only ever grow.
+     * write_pos <= read_pos <= check_pos <= walk_pos */
+    unsigned long walk_pos;     /* Next job for the walkers */
+    unsigned long check_pos;    /* Next job for check_tagcache_file() */
+    unsigned long read_pos;     /* Next job for the readers */
+    unsigned long write_pos;    /* Next job to write to the temp file */
+    struct scan_dir *dirs;      /* Dirs not taken by a walker yet */
+    int walkers;                /* Walker threads running */
+    int walking;                /* Walkers busy with a dir */
+    volatile bool abort;
+    bool done;                  /* Readers may quit */
+    bool failed;                /* A search root couldn't be walked */
+} scan;
+
+#define SCAN_JOB(pos) (&scan.jobs[(pos) % TAGCACHE_SCAN_QUEUE])
+
+/* The lock must be held by the caller of the following three */
+static void scan_wake_main(void)
+{
+#ifdef __PCTOOL__
+    pthread_cond_signal(&scan.main_cond);
+#endif
+}
+
+/* The tagcache thread of the application shares its OS thread with the
+ * other rockbox threads, so it must not block in pthread_cond_wait(). */
+static void scan_wait_main(bool busy)
+{
+#ifdef __PCTOOL__
+    if (!busy)
+        pthread_cond_wait(&scan.main_cond, &scan.lock);
+#else
+    pthread_mutex_unlock(&scan.lock);
+    if (busy)
+        yield();
+    else
+        sleep(1);
+    pthread_mutex_lock(&scan.lock);
+#endif
+}
+
+static void scan_queue_dir(const char *path, int add_files, bool root)
+{
+    struct scan_dir *dir = malloc(sizeof(struct scan_dir) + strlen(path) + 1);
+    if (!dir)
+    {
+        logf("tagcache: no memory to scan %s", path);
+        scan.failed = true;
+        return;
+    }
+
+    dir->add_files = add_files;
+    dir->root = root;
+    strcpy(dir->path, path);
+    dir->next = scan.dirs;
+    scan.dirs = dir;
+    pthread_cond_broadcast(&scan.walk_cond);
+}
+
+/* Moves the readers past the jobs that need no reading */
+static void scan_skip_checked(void)
+{
+    bool moved = false;
+
+    while (scan.read_pos < scan.check_pos &&
+           SCAN_JOB(scan.read_pos)->state == SCAN_JOB_SKIP)
+    {
+        scan.read_pos++;
+        moved = true;
+    }
+
+    if (moved)
+        scan_wake_main();
+}
+
+static void scan_add_file(const char *path, unsigned long mtime, long size)
+{
+    struct scan_job *job;
+
+    /* Path can't be shortened. */
+    if (strlen(path) > TAG_MAXLEN)
+    {
+        logf("Too long path: %s", path);
+        return;
+    }
+
+    pthread_mutex_lock(&scan.lock);
+    while (scan.walk_pos - scan.write_pos >= TAGCACHE_SCAN_QUEUE
+           && !scan.abort)
+        pthread_cond_wait(&scan.walk_cond, &scan.lock);
+
+    if (scan.abort)
+    {
+        pthread_mutex_unlock(&scan.lock);
+        return;
+    }
+
+    job = SCAN_JOB(scan.walk_pos++);
+    pthread_mutex_unlock(&scan.lock);
+
+    strcpy(job->path, path);
+    job->mtime = mtime;
+    job->size = size;
+
+    pthread_mutex_lock(&scan.lock);
+    job->state = SCAN_JOB_WALKED;
+    scan_wake_main();
+    pthread_mutex_unlock(&scan.lock);
+}
+
+/* check_dir() for the walkers, path is the walker's own buffer */
+static bool scan_walk_dir(char *path, size_t size, int add_files, bool root)
+{
+    DIR *dir;
+    int len;
+    bool success = false;
+    int ignore, unignore;
+
+    dir = opendir(path);
+    if (!dir)
+    {
+        logf("tagcache: opendir(%s) failed", path);
+        return false;
+    }
+    /* check for a database.ignore and database.unignore */
+    check_ignore(path, &ignore, &unignore);
+
+    /* don't do anything if both ignore and unignore are there */
+    if (ignore != unignore)
+        add_files = unignore;
+
+    while (!scan.abort)
+    {
+        struct dirent *entry = readdir(dir);
+        if (entry == NULL)
+        {
+            success = true;
+            break;
+        }
+
+        if (!strcmp((char *)entry->d_name, ".") ||
+            !strcmp((char *)entry->d_name, ".."))
+            continue;
+
+        struct dirinfo info = dir_get_info(dir, entry);
+
+        len = strlen(path);
+        /* don't add an extra / for path == / */
+        if (len <= 1) len = 0;
+        snprintf(&path[len], size - len, "/%s", entry->d_name);
+
+        pthread_mutex_lock(&scan.lock);
+        processed_dir_count++;
+        pthread_mutex_unlock(&scan.lock);
+
+        if (info.attribute & ATTR_DIRECTORY)
+        {
+#ifdef APPLICATION
+            /* don't follow symlinks to dirs, but try to add it as a search
+             * root, see check_dir() */
+            if (info.attribute & ATTR_LINK)
+            {
+                pthread_mutex_lock(&scan.lock);
+                if (add_search_root(path))
+                {
+                    struct search_roots_ll *this = &roots_ll;
+                    while (this->next)
+                        this = this->next;
+                    scan_queue_dir(this->path, true, true);
+                }
+                pthread_mutex_unlock(&scan.lock);
+            }
+            else
+#endif
+            if (root)
+            {
+                pthread_mutex_lock(&scan.lock);
+                scan_queue_dir(path, add_files, false);
+                pthread_mutex_unlock(&scan.lock);
+            }
+            else
+                scan_walk_dir(path, size, add_files, false);
+        }
+        else if (add_files)
+            scan_add_file(path, (info.wrtdate << 16) | info.wrttime,
+                          info.size);
+
+        path[len] = '\0';
+    }
+
+    closedir(dir);
+
+    return success;
+}
+
+static void *scan_walker(void *arg)
+{
+    char path[TAG_MAXLEN+32];
+    (void)arg;
+
+    pthread_mutex_lock(&scan.lock);
+    while (!scan.abort)
+    {
+        struct scan_dir *dir = scan.dirs;
+        if (!dir)
+        {
+            /* Nobody may queue anything anymore */
+            if (!scan.walking)
+                break;
+
+            pthread_cond_wait(&scan.walk_cond, &scan.lock);
+            continue;
+        }
+
+        scan.dirs = dir->next;
+        scan.walking++;
+        pthread_mutex_unlock(&scan.lock);
+
+        strlcpy(path, dir->path, sizeof(path));
+        bool ok = scan_walk_dir(path, sizeof(path), dir->add_files, dir->root);
+
+        pthread_mutex_lock(&scan.lock);
+        if (!ok && dir->root)
+            scan.failed = true;
+        scan.walking--;
+        free(dir);
+    }
+
+    scan.walkers--;
+    pthread_cond_broadcast(&scan.walk_cond);
+    scan_wake_main();
+    pthread_mutex_unlock(&scan.lock);
+
+    return NULL;
+}
+
+static void *scan_reader(void *arg)
+{
+    (void)arg;
+
+    pthread_mutex_lock(&scan.lock);
+    while (!scan.done)
+    {
+        scan_skip_checked();
+
+        if (scan.read_pos < scan.check_pos)
+        {
+            struct scan_job *job = SCAN_JOB(scan.read_pos++);
+            job->state = SCAN_JOB_READING;
+            pthread_mutex_unlock(&scan.lock);
+
+            bool ok = read_tagcache_metadata(&job->id3, job->path);
+
+            pthread_mutex_lock(&scan.lock);
+            job->ok = ok;
+            job->state = SCAN_JOB_DONE;
+            scan_wake_main();
+        }
+        else
+            pthread_cond_wait(&scan.read_cond, &scan.lock);
+    }
+    pthread_mutex_unlock(&scan.lock);
+
+    return NULL;
+}
+
+/* Scans the search roots into the temp file. Returns false if the threads
+ * couldn't be started, *success is false if the scan was aborted or a search
+ * root couldn't be walked. */
+static bool scan_parallel(bool *success)
+{
+    pthread_t walkers[TAGCACHE_SCAN_WALKERS];
+    pthread_t readers[TAGCACHE_SCAN_READERS];
+    int num_walkers = 0, num_readers = 0, max_readers, i;
+    long cpus = sysconf(_SC_NPROCESSORS_ONLN);
+
+    max_readers = cpus > 0 ? MIN(cpus * 2, TAGCACHE_SCAN_READERS) : 2;
+
+    memset(&scan, 0, sizeof(scan));
+    scan.jobs = calloc(TAGCACHE_SCAN_QUEUE, sizeof(struct scan_job));
+    if (!scan.jobs)
+        return false;
+
+    pthread_mutex_init(&scan.lock, NULL);
+    pthread_cond_init(&scan.walk_cond, NULL);
+    pthread_cond_init(&scan.read_cond, NULL);
+#ifdef __PCTOOL__
+    pthread_cond_init(&scan.main_cond, NULL);
+#endif
+
+    /* Load the default codepage table before the readers would race for
+     * it. Metadata in other codepages (SMAF only) may still make them load
+     * another table at the same time, which only garbles those tags. */
+    iso_decode(NULL, NULL, -1, 0);
+
+    pthread_mutex_lock(&scan.lock);
+    scan_queue_dir(roots_ll.path, true, true);
+
+    for (i = 0; i < TAGCACHE_SCAN_WALKERS; i++)
+    {
+        if (!pthread_create(&walkers[num_walkers], NULL, scan_walker, NULL))
+            num_walkers++;
+    }
+    scan.walkers = num_walkers;
+
+    for (i = 0; i < max_readers; i++)
+    {
+        if (!pthread_create(&readers[num_readers], NULL, scan_reader, NULL))
+            num_readers++;
+    }
+
+    if (!num_walkers || !num_readers)
+    {
+        logf("tagcache: no scan threads");
+        scan.abort = true;
+    }
+    else
+        logf("tagcache: scanning with %d walkers and %d readers",
+             num_walkers, num_readers);
+
+    while (!scan.abort)
+    {
+        struct scan_job *job;
+        bool busy = false;
+
+        /* Check the walked files against the database. */
+        while (scan.check_pos < scan.walk_pos &&
+               (job = SCAN_JOB(scan.check_pos))->state == SCAN_JOB_WALKED)
+        {
+            pthread_mutex_unlock(&scan.lock);
+            bool read = check_tagcache_file(job->path, job->mtime,
+                                            job->size
+#if defined(HAVE_TC_RAMCACHE) && defined(HAVE_DIRCACHE)
+                                            , -1
+#endif
+                                           );
+            pthread_mutex_lock(&scan.lock);
+
+            job->state = read ? SCAN_JOB_QUEUED : SCAN_JOB_SKIP;
+            scan.check_pos++;
+            if (read)
+                pthread_cond_signal(&scan.read_cond);
+            else
+                scan_skip_checked();
+            busy = true;
+        }
+
+        /* Add the read files to the temp file in the order they were
+         * walked. */
+        while (scan.write_pos < scan.read_pos &&
+               ((job = SCAN_JOB(scan.write_pos))->state == SCAN_JOB_DONE ||
+                job->state == SCAN_JOB_SKIP))
+        {
+            if (job->state == SCAN_JOB_DONE && job->ok)
+            {
+                pthread_mutex_unlock(&scan.lock);
+                tc_stat.curentry = job->path;
+
+                add_tagcache_entry(job->path, job->mtime, job->size,
+                                   &job->id3);
+
+                /* Wait until current path for debug screen is read and
+                 * unset. */
+                while (tc_stat.syncscreen && tc_stat.curentry != NULL)
+                    yield();
+
+                tc_stat.curentry = NULL;
+                pthread_mutex_lock(&scan.lock);
+            }
+
+            job->state = SCAN_JOB_FREE;
+            scan.write_pos++;
+            pthread_cond_broadcast(&scan.walk_cond);
+            busy = true;
+        }
+
+        if (!scan.walkers && scan.write_pos == scan.walk_pos)
+            break;
+
+#ifndef __PCTOOL__
+        if (check_event_queue())
+        {
+            scan.abort = true;
+            break;
+        }
+#endif
+        scan_wait_main(busy);
+    }
+
+    scan.done = true;
+    pthread_cond_broadcast(&scan.walk_cond);
+    pthread_cond_broadcast(&scan.read_cond);
+    pthread_mutex_unlock(&scan.lock);
+
+    for (i = 0; i < num_walkers; i++)
+        pthread_join(walkers[i], NULL);
+    for (i = 0; i < num_readers; i++)
+        pthread_join(readers[i], NULL);
+
+    while (scan.dirs)
+    {
+        struct scan_dir *next = scan.dirs->next;
+        free(scan.dirs);
+        scan.dirs = next;
+    }
+
+    pthread_cond_destroy(&scan.walk_cond);
+    pthread_cond_destroy(&scan.read_cond);
+#ifdef __PCTOOL__
+    pthread_cond_destroy(&scan.main_cond);
+#endif
+    pthread_mutex_destroy(&scan.lock);
+    free(scan.jobs);
+
+    *success = !scan.abort && !scan.failed;
+
+    return num_walkers && num_readers;
+}
+#endif /* TAGCACHE_PARALLEL_SCAN */
 
 void tagcache_screensync_event(void)
 {
@@ -4504,11 +6023,17 @@ void tagcache_build(const char *path)
     roots_ll.path = path;
     roots_ll.next = NULL;
     struct search_roots_ll * this;
-    /* check_dir might add new roots */
-    for(this = &roots_ll; this; this = this->next)
+#ifdef TAGCACHE_PARALLEL_SCAN
+    if (!scan_parallel(&ret))
+#endif
     {
-        strcpy(curpath, this->path);
-        ret = ret && check_dir(this->path, true);
+        ret = true;
+        /* check_dir might add new roots */
+        for(this = &roots_ll; this; this = this->next)
+        {
+            strcpy(curpath, this->path);
+            ret = ret && check_dir(this->path, true);
+        }
     }
     if (roots_ll.next)
         free_search_roots(roots_ll.next);
@@ -4534,6 +6059,10 @@ void tagcache_build(const char *path)
         return ;
     }
 
+    /* Delete the entries of removed files before committing, so that a
+     * moved or renamed file gets the statistics of its old entry back. */
+    check_deleted_files();
+
     /* Commit changes to the database. */
 #ifdef __PCTOOL__
     allocate_tempbuf();
@@ -4627,6 +6156,12 @@ static void tagcache_thread(void)
         tc_stat.ready = check_all_headers();
         tc_stat.readyvalid = true;
     }
+
+#ifdef TAGCACHE_COLUMNS
+    /* The commit above loaded the columns if it did anything. */
+    if (!columns)
+        load_columns();
+#endif
     
     while (1)
     {
@@ -4651,7 +6186,6 @@ static void tagcache_thread(void)
 #ifdef HAVE_TC_RAMCACHE
                 load_ramcache();
 #endif
-                check_deleted_files();
                 break ;
                 
             case Q_START_SCAN:
@@ -4671,12 +6205,10 @@ static void tagcache_thread(void)
 #endif
                 if (global_settings.tagcache_autoupdate)
                 {
+                    /* Also checks for deleted files. This will be very slow
+                       unless dircache is enabled or target is flash based,
+                       but do it anyway for consistency. */
                     tagcache_build("/");
-                    
-                    /* This will be very slow unless dircache is enabled
-                       or target is flash based, but do it anyway for
-                       consistency. */
-                    check_deleted_files();
                 }
             
                 logf("tagcache check done");
@@ -4825,6 +6357,25 @@ bool tagcache_is_usable(void)
 {
     return tc_stat.initialized && tc_stat.ready;
 }
+long tagcache_get_commitid(void)
+{
+    return current_tcmh.commitid;
+}
+void tagcache_get_master_info(long *serial, long *entry_count,
+                              long *datasize)
+{
+    *serial = current_tcmh.serial;
+    *entry_count = current_tcmh.tch.entry_count;
+    *datasize = current_tcmh.tch.datasize;
+}
+bool tagcache_is_sorted(void)
+{
+    return current_tcmh.fragmented == 0;
+}
+long tagcache_get_change_serial(bool runtime)
+{
+    return runtime ? change_serial + runtime_change_serial : change_serial;
+}
 int tagcache_get_commit_step(void)
 {
     return tc_stat.commit_step;
@@ -34,6 +34,7 @@ enum tag_type { tag_artist = 0, tag_album, tag_genre, tag_title,
     tag_filename, tag_composer, tag_comment, tag_albumartist, tag_grouping, tag_year, 
     tag_discnumber, tag_tracknumber, tag_bitrate, tag_length, tag_playcount, tag_rating,
     tag_playtime, tag_lastplayed, tag_commitid, tag_mtime, tag_lastoffset,
+    tag_filesize,
     /* Real tags end here, count them. */
     TAG_COUNT,
     /* Virtual tags */
@@ -51,10 +52,13 @@ enum tag_type { tag_artist = 0, tag_album, tag_genre, tag_title,
 #define IDX_BUF_DEPTH 64
 
 /* Tag Cache Header version 'TCHxx'. Increment when changing internal structures. */
-#define TAGCACHE_MAGIC  0x5443480e
+#define TAGCACHE_MAGIC  0x54434810
 
 /* Dump store/restore header version 'TCSxx'. */
-#define TAGCACHE_STATEFILE_MAGIC 0x54435301
+#define TAGCACHE_STATEFILE_MAGIC 0x54435304
+
+/* Column file version 'TCCxx'. */
+#define TAGCACHE_COLUMNS_MAGIC 0x54434301
 
 /* How much to allocate extra space for ramcache. */
 #define TAGCACHE_RESERVE 32768
@@ -68,6 +72,13 @@ enum tag_type { tag_artist = 0, tag_album, tag_genre, tag_title,
 /* Used to guess the necessary buffer size at commit. */
 #define TAGFILE_ENTRY_AVG_LENGTH   16
 
+/**
+ * A commit appends new tags to the sorted tag files instead of resorting
+ * them as long as less than 1/TAGCACHE_FRAGMENT_DIV of the entries are out
+ * of order or deleted. Past that the tag files are rebuilt from scratch.
+ */
+#define TAGCACHE_FRAGMENT_DIV 16
+
 /* How many entries to fetch to the seek table at once while searching. */
 #define SEEK_LIST_SIZE 32
 
@@ -82,6 +93,29 @@ enum tag_type { tag_artist = 0, tag_album, tag_genre, tag_title,
 #define TAGCACHE_MAX_FILTERS 4
 #define TAGCACHE_MAX_CLAUSES 32
 
+/* Scan for new files with several threads walking the directories and
+ * reading the metadata. Only where file I/O goes straight to the OS, so
+ * not on the SDL based targets whose file I/O runs through the simulator's
+ * I/O thread. */
+#if !defined(WIN32) && (defined(__PCTOOL__) || \
+    ((CONFIG_PLATFORM & PLATFORM_HOSTED) && \
+     !(CONFIG_PLATFORM & (PLATFORM_SDL|PLATFORM_MAEMO|PLATFORM_PANDORA))))
+#define TAGCACHE_PARALLEL_SCAN
+/* Directory walker threads */
+#define TAGCACHE_SCAN_WALKERS 4
+/* Most metadata reader threads, the default is two per online cpu */
+#define TAGCACHE_SCAN_READERS 16
+/* Files that may be in flight between the walkers and the temp file */
+#define TAGCACHE_SCAN_QUEUE 256
+#endif
+
+/* Hosted targets have no ram cache. Keep the database in a column file
+ * there and serve searches from it mmap()ed. */
+#if (CONFIG_PLATFORM & PLATFORM_HOSTED) && !defined(WIN32) && \
+    !defined(__PCTOOL__) && !defined(HAVE_TC_RAMCACHE)
+#define TAGCACHE_COLUMNS
+#endif
+
 /* Tag database files. */
 
 /* Temporary database containing new tags to be committed to the main db. */
@@ -99,6 +133,12 @@ enum tag_type { tag_artist = 0, tag_album, tag_genre, tag_title,
 /* Serialized DB. */
 #define TAGCACHE_STATEFILE       ROCKBOX_DIR "/database_state.tcd"
 
+/* Master index and tag files in columns, for mapping into memory. */
+#define TAGCACHE_FILE_COLUMNS    ROCKBOX_DIR "/database_col.tcd"
+
+/* Column file while it is being built. */
+#define TAGCACHE_FILE_COLUMNS_TEMP ROCKBOX_DIR "/database_col_tmp.tcd"
+
 /* Tag to be used on untagged files. */
 #define UNTAGGED "<Untagged>"
 
@@ -107,13 +147,22 @@ enum tag_type { tag_artist = 0, tag_album, tag_genre, tag_title,
     (1LU << tag_tracknumber) | (1LU << tag_length) | (1LU << tag_bitrate) | \
     (1LU << tag_playcount) | (1LU << tag_rating) | (1LU << tag_playtime) | \
     (1LU << tag_lastplayed) | (1LU << tag_commitid) | (1LU << tag_mtime) | \
-    (1LU << tag_lastoffset) | (1LU << tag_virt_basename) | \
+    (1LU << tag_lastoffset) | (1LU << tag_filesize) | \
+    (1LU << tag_virt_basename) | \
     (1LU << tag_virt_length_min) | (1LU << tag_virt_length_sec) | \
     (1LU << tag_virt_playtime_min) | (1LU << tag_virt_playtime_sec) | \
     (1LU << tag_virt_entryage) | (1LU << tag_virt_autoscore))
 
 #define TAGCACHE_IS_NUMERIC(tag) (BIT_N(tag) & TAGCACHE_NUMERIC_TAGS)
 
+/* Statistics that change while playing. */
+#define TAGCACHE_RUNTIME_TAGS ((1LU << tag_playcount) | (1LU << tag_rating) | \
+    (1LU << tag_playtime) | (1LU << tag_lastplayed) | \
+    (1LU << tag_lastoffset) | (1LU << tag_virt_playtime_min) | \
+    (1LU << tag_virt_playtime_sec) | (1LU << tag_virt_autoscore))
+
+#define TAGCACHE_IS_RUNTIME(tag) (BIT_N(tag) & TAGCACHE_RUNTIME_TAGS)
+
 /* Flags */
 #define FLAG_DELETED     0x0001  /* Entry has been removed from db */
 #define FLAG_DIRCACHE    0x0002  /* Filename is a dircache pointer */
@@ -252,6 +301,18 @@ void tagcache_init(void) INIT_ATTR;
 bool tagcache_is_initialized(void);
 bool tagcache_is_fully_initialized(void);
 bool tagcache_is_usable(void);
+long tagcache_get_commitid(void);
+/* From the master index header: the serial counts runtime statistics
+ * updates, entry count and data size change with every rebuild. */
+void tagcache_get_master_info(long *serial, long *entry_count,
+                              long *datasize);
+/* False while a merging commit has left new tags appended to the tag files
+ * out of order; unique tags then have to be sorted after reading them. */
+bool tagcache_is_sorted(void);
+/* Counts additions and deletions since boot, and with runtime = true also
+ * changes to the runtime statistics. A search result stays valid as long as
+ * the commit id and this serial do not change. */
+long tagcache_get_change_serial(bool runtime);
 void tagcache_start_scan(void);
 void tagcache_stop_scan(void);
 bool tagcache_update(void);
@@ -54,6 +54,8 @@
 #include "dir.h"
 #include "playback.h"
 #include "panic.h"
+#include "crc32.h"
+#include "lru.h"
 
 #define str_or_empty(x) (x ? x : "(NULL)")
 
@@ -113,6 +115,47 @@ static long uniqbuf[UNIQBUF_SIZE / sizeof(long)];
 #define MAX_TAGS 5
 #define MAX_MENU_ID_SIZE 32
 
+/* Complete search results are kept in a small LRU cache of pages, so going
+ * back to a menu doesn't run the search again. The pages are saved at
+ * shutdown and used after boot as long as the database didn't change. */
+#if MEMORYSIZE >= 32
+#define MENUCACHE_PAGES     8
+#define MENUCACHE_PAGE_SIZE (16*1024)
+#else
+#define MENUCACHE_PAGES     4
+#define MENUCACHE_PAGE_SIZE (4*1024)
+#endif
+
+/* Menu cache file version 'TCMxx'. */
+#define MENUCACHE_MAGIC 0x54434d02
+
+struct menucache_entry {
+    int32_t extraseek;
+    uint16_t name;      /* Offset of the name in data[] */
+    uint16_t newtable;
+};
+
+struct menucache_page {
+    bool valid;
+    bool runtime;       /* Depends on the runtime statistics */
+    int16_t entry_count;
+    uint32_t key;
+    int32_t commitid;
+    int32_t serial;     /* tagcache_get_change_serial() before the search */
+    uint32_t database;  /* menucache_database() before the search */
+    int32_t total_count;
+    int32_t size;       /* Bytes used in data[]: entries, then their names */
+    char data[];
+};
+
+#define MENUCACHE_DATA_SIZE \
+    (MENUCACHE_PAGE_SIZE - (int)sizeof(struct menucache_page))
+
+static long menucache_buf[MENUCACHE_PAGES *
+                          (MENUCACHE_PAGE_SIZE + LRU_SLOT_OVERHEAD) /
+                          sizeof(long)];
+static struct lru menucache_lru;
+
 static bool sort_inverse;
 
 /*
@@ -330,6 +373,7 @@ static int get_tag(int *tag)
         {"rating", tag_rating},
         {"lastplayed", tag_lastplayed},
         {"lastoffset", tag_lastoffset},
+        {"filesize", tag_filesize},
         {"commitid", tag_commitid},
         {"entryage", tag_virt_entryage},
         {"autoscore", tag_virt_autoscore},
@@ -1121,6 +1165,300 @@ static bool parse_menu(const char *filename)
     return true;
 }
 
+static inline struct menucache_page *menucache_page(short handle)
+{
+    return lru_data(&menucache_lru, handle);
+}
+
+/* Identifies the database a page was filled from, so that a page saved at
+ * shutdown isn't used for a database rebuilt or replaced with the same
+ * commit id, or with runtime statistics updated, meanwhile. */
+static unsigned menucache_database(bool runtime)
+{
+    long serial, entry_count, datasize;
+    unsigned crc;
+
+    tagcache_get_master_info(&serial, &entry_count, &datasize);
+    crc = crc_32(&entry_count, sizeof entry_count, 0xffffffff);
+    crc = crc_32(&datasize, sizeof datasize, crc);
+    if (runtime)
+        crc = crc_32(&serial, sizeof serial, crc);
+    return crc;
+}
+
+static bool menucache_page_valid(const struct menucache_page *p)
+{
+    return p->valid && p->commitid == tagcache_get_commitid()
+        && p->serial == tagcache_get_change_serial(p->runtime)
+        && p->database == menucache_database(p->runtime);
+}
+
+static unsigned menucache_hash_clause(unsigned crc,
+                                      const struct tagcache_search_clause *cl,
+                                      bool *runtime)
+{
+    crc = crc_32(&cl->type, sizeof cl->type, crc);
+    if (cl->type == clause_logical_or)
+        return crc;
+
+    if (TAGCACHE_IS_RUNTIME(cl->tag))
+        *runtime = true;
+
+    crc = crc_32(&cl->tag, sizeof cl->tag, crc);
+    if (cl->numeric)
+        return crc_32(&cl->numeric_data, sizeof cl->numeric_data, crc);
+
+    return crc_32(cl->str, strlen(cl->str) + 1, crc);
+}
+
+/* Hash everything the result of retrieve_entries() depends on apart from the
+ * database itself. Clause strings are hashed instead of pointers as they can
+ * come from the current track or a prompt. */
+static unsigned menucache_key(int level, int tag, bool *runtime)
+{
+    const char *untagged = str(LANG_TAGNAVI_UNTAGGED);
+    unsigned crc = 0xffffffff;
+    int i, j;
+
+    *runtime = TAGCACHE_IS_RUNTIME(tag);
+    crc = crc_32(&tag, sizeof tag, crc);
+    crc = crc_32(&level, sizeof level, crc);
+    crc = crc_32(untagged, strlen(untagged), crc);
+
+    for (i = 0; i < level; i++)
+    {
+        if (TAGCACHE_IS_RUNTIME(csi->tagorder[i]))
+            *runtime = true;
+        crc = crc_32(&csi->tagorder[i], sizeof csi->tagorder[i], crc);
+        crc = crc_32(&csi->result_seek[i], sizeof csi->result_seek[i], crc);
+    }
+
+    for (i = 0; i <= level; i++)
+    {
+        crc = crc_32(&csi->clause_count[i], sizeof csi->clause_count[i], crc);
+        for (j = 0; j < csi->clause_count[i]; j++)
+            crc = menucache_hash_clause(crc, csi->clause[i][j], runtime);
+    }
+
+    for (i = 0; i < format_count; i++)
+    {
+        struct display_format *fmt = formats[i];
+
+        if (fmt->group_id != csi->format_id[level])
+            continue;
+
+        crc = crc_32(fmt->formatstr, strlen(fmt->formatstr), crc);
+        for (j = 0; j < fmt->tag_count; j++)
+        {
+            if (TAGCACHE_IS_RUNTIME(fmt->tags[j]))
+                *runtime = true;
+            crc = crc_32(&fmt->tags[j], sizeof fmt->tags[j], crc);
+        }
+        crc = crc_32(&fmt->limit, sizeof fmt->limit, crc);
+        crc = crc_32(&fmt->strip, sizeof fmt->strip, crc);
+        crc = crc_32(&fmt->sort_inverse, sizeof fmt->sort_inverse, crc);
+        for (j = 0; j < fmt->clause_count; j++)
+            crc = menucache_hash_clause(crc, fmt->clause[j], runtime);
+    }
+
+    return crc;
+}
+
+static struct menucache_page *menucache_find(unsigned key)
+{
+    short i;
+
+    for (i = 0; i < MENUCACHE_PAGES; i++)
+    {
+        struct menucache_page *p = menucache_page(i);
+
+        if (!p->valid || p->key != key)
+            continue;
+
+        if (!menucache_page_valid(p))
+        {
+            p->valid = false;
+            return NULL;
+        }
+
+        lru_touch(&menucache_lru, i);
+        return p;
+    }
+
+    return NULL;
+}
+
+/* Put entries[first..count-1] of the tree cache to the least recently used
+ * page unless they don't fit. */
+static void menucache_store(struct tree_context *c, unsigned key,
+                            bool runtime, long serial, unsigned database,
+                            int first, int count, int total_count)
+{
+    struct tagentry *dptr = core_get_data(c->cache.entries_handle);
+    struct menucache_page *p = menucache_page(menucache_lru._head);
+    struct menucache_entry *e = (struct menucache_entry *)p->data;
+    int size = (count - first) * sizeof(struct menucache_entry);
+    int i;
+
+    for (i = first; i < count && size <= MENUCACHE_DATA_SIZE; i++)
+        size += strlen(dptr[i].name) + 1;
+
+    if (size > MENUCACHE_DATA_SIZE)
+        return;
+
+    size = (count - first) * sizeof(struct menucache_entry);
+    for (i = first; i < count; i++, e++)
+    {
+        int len = strlen(dptr[i].name) + 1;
+
+        e->extraseek = dptr[i].extraseek;
+        e->newtable = dptr[i].newtable;
+        e->name = size;
+        memcpy(&p->data[size], dptr[i].name, len);
+        size += len;
+    }
+
+    p->valid = true;
+    p->runtime = runtime;
+    p->entry_count = count - first;
+    p->key = key;
+    p->commitid = tagcache_get_commitid();
+    p->serial = serial;
+    p->database = database;
+    p->total_count = total_count;
+    p->size = size;
+    lru_touch(&menucache_lru, menucache_lru._head);
+}
+
+/* Fill the tree cache from a page. Returns the total entry count or -1 if
+ * the page doesn't fit. */
+static int menucache_restore(struct tree_context *c,
+                             const struct menucache_page *p, bool special)
+{
+    const struct menucache_entry *e = (const struct menucache_entry *)p->data;
+    int names = p->entry_count * sizeof(struct menucache_entry);
+    struct tagentry *dptr;
+    char *namebuf;
+    int i;
+
+    if (p->entry_count + (special ? 2 : 0) > c->cache.max_entries
+        || p->size - names > c->cache.name_buffer_size)
+        return -1;
+
+    dptr = core_get_data(c->cache.entries_handle);
+    namebuf = core_get_data(c->cache.name_buffer_handle);
+    memcpy(namebuf, &p->data[names], p->size - names);
+    current_entry_count = 0;
+
+    if (special)
+    {
+        dptr->newtable = ALLSUBENTRIES;
+        dptr->name = str(LANG_TAGNAVI_ALL_TRACKS);
+        dptr++;
+        dptr->newtable = NAVIBROWSE;
+        dptr->name = str(LANG_TAGNAVI_RANDOM);
+        dptr->extraseek = -1;
+        dptr++;
+        current_entry_count += 2;
+    }
+
+    for (i = 0; i < p->entry_count; i++, e++, dptr++)
+    {
+        dptr->newtable = e->newtable;
+        dptr->extraseek = e->extraseek;
+        dptr->name = namebuf + e->name - names;
+    }
+
+    current_offset = 0;
+    current_entry_count += p->entry_count;
+    c->dirfull = false;
+
+    return p->total_count;
+}
+
+static void menucache_load(void)
+{
+    int32_t hdr[2];
+    int fd;
+    int i;
+
+    lru_create(&menucache_lru, menucache_buf, MENUCACHE_PAGES,
+               MENUCACHE_PAGE_SIZE);
+
+    fd = open(TAGTREE_MENUCACHE_FILE, O_RDONLY);
+    if (fd < 0)
+        return;
+
+    if (read(fd, hdr, sizeof hdr) != sizeof hdr
+        || hdr[0] != MENUCACHE_MAGIC || hdr[1] != MENUCACHE_PAGE_SIZE)
+    {
+        logf("menu cache version mismatch");
+        i = MENUCACHE_PAGES;
+    }
+    else
+        i = 0;
+
+    /* The pages are stored from the least recently used one */
+    for (; i < MENUCACHE_PAGES; i++)
+    {
+        struct menucache_page *p = menucache_page(menucache_lru._head);
+
+        if (read(fd, p, sizeof *p) != sizeof *p
+            || p->size < 0 || p->size > MENUCACHE_DATA_SIZE
+            || read(fd, p->data, p->size) != p->size)
+        {
+            p->valid = false;
+            break;
+        }
+
+        /* Valid until the database changes for the first time after boot */
+        p->serial = 0;
+        lru_touch(&menucache_lru, menucache_lru._head);
+    }
+
+    close(fd);
+
+    /* Don't trust the file after a crash */
+    remove(TAGTREE_MENUCACHE_FILE);
+}
+
+static int menucache_fd;
+
+static void menucache_save_page(void *data)
+{
+    struct menucache_page *p = data;
+    ssize_t len = sizeof *p + p->size;
+
+    if (menucache_fd < 0 || !menucache_page_valid(p))
+        return;
+
+    if (write(menucache_fd, p, len) != len)
+    {
+        close(menucache_fd);
+        menucache_fd = -1;
+        remove(TAGTREE_MENUCACHE_FILE);
+    }
+}
+
+void tagtree_flush(void)
+{
+    int32_t hdr[2] = { MENUCACHE_MAGIC, MENUCACHE_PAGE_SIZE };
+
+    menucache_fd = open(TAGTREE_MENUCACHE_FILE,
+                        O_WRONLY | O_CREAT | O_TRUNC, 0666);
+    if (menucache_fd < 0)
+    {
+        logf("failed to save the menu cache");
+        return;
+    }
+
+    if (write(menucache_fd, hdr, sizeof hdr) == sizeof hdr)
+        lru_traverse(&menucache_lru, menucache_save_page);
+
+    if (menucache_fd >= 0)
+        close(menucache_fd);
+}
+
 void tagtree_init(void)
 {
     format_count = 0;
@@ -1129,6 +1467,7 @@ void tagtree_init(void)
     rootmenu = -1;
     tagtree_handle = core_alloc_maximum("tagtree", &tagtree_bufsize, &ops);
     parse_menu(FILE_SEARCH_INSTRUCTIONS);
+    menucache_load();
 
     /* safety check since tree.c needs to cast tagentry to entry */
     if (sizeof(struct tagentry) != sizeof(struct entry))
@@ -1291,6 +1630,11 @@ static int retrieve_entries(struct tree_context *c, int offset, bool init)
     bool sort = false;
     int sort_limit;
     int strip;
+    bool use_cache = false;
+    bool runtime = false;
+    unsigned key = 0;
+    long serial = 0;
+    unsigned database = 0;
 
     /* Show search progress straight away if the disk needs to spin up,
        otherwise show it after the normal 1/2 second delay */
@@ -1310,13 +1654,39 @@ static int retrieve_entries(struct tree_context *c, int offset, bool init)
     else
         tag = csi->tagorder[level];
 
+    /* Only complete results get cached */
+    if (init && offset == 0
+        && tagcache_is_usable() && !tagcache_get_commit_step())
+    {
+        struct menucache_page *p;
+
+        use_cache = true;
+        tagtree_lock();
+        key = menucache_key(level, tag, &runtime);
+        tagtree_unlock();
+        /* Anything that changes from here on makes the result stale */
+        serial = tagcache_get_change_serial(runtime);
+        database = menucache_database(runtime);
+
+        p = menucache_find(key);
+        if (p)
+        {
+            total_count = menucache_restore(c, p,
+                                    tag != tag_title && tag != tag_filename);
+            if (total_count >= 0)
+                return total_count;
+            total_count = 0;
+        }
+    }
+
     if (!tagcache_search(&tcs, tag))
         return -1;
     
     /* Prevent duplicate entries in the search list. */
     tagcache_search_set_uniqbuf(&tcs, uniqbuf, UNIQBUF_SIZE);
     
-    if (level || csi->clause_count[0] || TAGCACHE_IS_NUMERIC(tag))
+    if (level || csi->clause_count[0] || TAGCACHE_IS_NUMERIC(tag)
+        || !tagcache_is_sorted())
         sort = true;
     
     for (i = 0; i < level; i++)
@@ -1548,7 +1918,7 @@ static int retrieve_entries(struct tree_context *c, int offset, bool init)
     
     if (strip)
     {
-        dptr = get_entries(c);
+        dptr = get_entries(c) + special_entry_count;
         for (i = special_entry_count; i < current_entry_count; i++, dptr++)
         {
             int len = strlen(dptr->name);
@@ -1560,6 +1930,13 @@ static int retrieve_entries(struct tree_context *c, int offset, bool init)
         }
     }
 
+    if (use_cache && !c->dirfull)
+    {
+        menucache_store(c, key, runtime, serial, database,
+                        special_entry_count, current_entry_count,
+                        total_count);
+    }
+
     return total_count;
     
 }
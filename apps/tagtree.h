@@ -31,9 +31,13 @@
 #define TAGMENU_MAX_MENUS  32
 #define TAGMENU_MAX_FMTS   32
 
+/* Search results saved at shutdown. */
+#define TAGTREE_MENUCACHE_FILE ROCKBOX_DIR "/database_menu.tcd"
+
 bool tagtree_export(void);
 bool tagtree_import(void);
 void tagtree_init(void) INIT_ATTR;
+void tagtree_flush(void);
 int tagtree_enter(struct tree_context* c);
 void tagtree_exit(struct tree_context* c);
 int tagtree_load(struct tree_context* c);
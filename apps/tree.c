@@ -1198,6 +1198,7 @@ void tree_flush(void)
 {
 #ifdef HAVE_TAGCACHE
     tagcache_shutdown();
+    tagtree_flush();
 #endif
 
 #ifdef HAVE_TC_RAMCACHE
@@ -1236,6 +1237,9 @@ void tree_restore(void)
 #ifdef HAVE_TC_RAMCACHE
     remove(TAGCACHE_STATEFILE);
 #endif
+#ifdef HAVE_TAGCACHE
+    remove(TAGTREE_MENUCACHE_FILE);
+#endif
     
 #ifdef HAVE_DIRCACHE
     remove(DIRCACHE_FILE);
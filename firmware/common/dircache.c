@@ -47,6 +47,9 @@
 #include "timefuncs.h"
 #endif
 #include "rbpaths.h"
+#ifdef HAVE_DIRCACHE_INDEX
+#include <ctype.h>
+#endif
 
 
 /* Queue commands. */
@@ -61,29 +64,45 @@
 static DIR_CACHED opendirs[MAX_OPEN_DIRS];
 static char       opendir_dnames[MAX_OPEN_DIRS][MAX_PATH];
 
-#define MAX_PENDING_BINDINGS 2
-struct fdbind_queue {
-    char path[MAX_PATH];
+/* Live updates that arrive while the cache is being built are logged
+ * instead of making the caller wait for the scan, and replayed on the new
+ * cache before it is enabled, see replay_updates() */
+#define UPDATE_LOG_SIZE 2048
+/* Scans that may be thrown away for updates that can't be replayed before
+ * giving up on the cache */
+#define MAX_RESCANS 3
+enum {
+    UPDATE_ADD_FILE,    /* path, startcluster */
+    UPDATE_MKDIR,       /* path */
+    UPDATE_RMDIR,       /* path */
+    UPDATE_REMOVE,      /* path */
+    UPDATE_RENAME,      /* path, newpath */
+    UPDATE_BIND,        /* fd, path */
+    UPDATE_FILESIZE,    /* fd, size, startcluster */
+};
+
+struct update_record {
+    short op;
+    short length;       /* of the record including the paths */
+    bool on_disk;       /* logged before a rescan, which saw it on disk */
     int fd;
+    long size;
+    long startcluster;
+    char paths[];       /* path and newpath, if any */
 };
 
-/* Unions with char to make pointer arithmetic simpler and avoid casting */
+/* The cache holds no pointers, so that it can be moved, saved and loaded
+ * as is. Entries refer to each other by their index + 1, 0 meaning none
+ * (see get_link() and set_link()), and d_name is the offset of the name
+ * from the end of the name buffer, 0 meaning an unused entry (see
+ * get_name()). */
 struct dircache_entry {
     struct dirinfo info;
-    union {
-        struct dircache_entry *next;
-        char* next_char;
-    };
-    union {
-        struct dircache_entry *up;
-        char* up_char;
-    };
-    union {
-        struct dircache_entry *down;
-        char* down_char;
-    };
+    int next;
+    int up;
+    int down;
     long startcluster;
-    char *d_name;
+    long d_name;
 };
 
 /* Cache Layout:
@@ -107,14 +126,15 @@ struct dircache_entry {
 static struct dircache_entry *dircache_root;
 /* these point to the start and end of the name buffer (d above) */
 static char                  *d_names_start, *d_names_end;
-/* put "." and ".." into the d_names buffer to enable easy pointer logic */
-static char                  *dot, *dotdot;
+/* "." and ".." are the first names in the d_names buffer */
+#define DOT     ((long)sizeof("."))
+#define DOTDOT  ((long)(sizeof(".") + sizeof("..")))
 #ifdef HAVE_MULTIVOLUME
-static struct dircache_entry *append_position;
+static int append_position;
 #endif
 
 static DIR_CACHED opendirs[MAX_OPEN_DIRS];
-static struct dircache_entry *fd_bindings[MAX_OPEN_FILES];
+static int fd_bindings[MAX_OPEN_FILES]; /* entry links */
 
 static bool dircache_initialized = false;
 static bool dircache_initializing = false;
@@ -130,8 +150,23 @@ static struct event_queue dircache_queue SHAREDBSS_ATTR;
 static long dircache_stack[(DEFAULT_STACK_SIZE + 0x400)/sizeof(long)];
 static const char dircache_thread_name[] = "dircache";
 
-static struct fdbind_queue fdbind_cache[MAX_PENDING_BINDINGS];
-static int fdbind_idx = 0;
+static long update_log[UPDATE_LOG_SIZE/sizeof(long)];
+static size_t update_log_used = 0;
+static bool log_updates = false;
+static bool update_log_overflow = false;
+
+static void dircache_free(void);
+static bool replay_updates(void);
+static void restart_update_log(void);
+
+#ifdef HAVE_DIRCACHE_INDEX
+/* Hash index from the full path of an entry to its link, see
+ * dircache_get_entry() */
+static int index_handle = 0;
+static unsigned long index_slots = 0;
+static unsigned long index_used = 0;  /* slots holding a link or a tombstone */
+static bool use_index = true;
+#endif
 
 /* --- Internal cache structure control functions --- */
 
@@ -140,6 +175,36 @@ static inline struct dircache_entry* get_entry(int id)
     return &dircache_root[id];
 }
 
+/* Returns the entry a link refers to, NULL for none. */
+static inline struct dircache_entry* get_link(int link)
+{
+    return link ? &dircache_root[link - 1] : NULL;
+}
+
+/* Returns the link referring to an entry. */
+static inline int set_link(const struct dircache_entry *ce)
+{
+    return ce ? ce - dircache_root + 1 : 0;
+}
+
+/* Returns the name of an entry, NULL for unused entries. */
+static inline char* get_name(const struct dircache_entry *ce)
+{
+    return ce->d_name ? d_names_end - ce->d_name : NULL;
+}
+
+/* Allocates a name from the name buffer and returns its offset. */
+static long alloc_name(const char *name)
+{
+    size_t size = strlen(name) + 1;
+
+    d_names_start -= size;
+    strcpy(d_names_start, name);
+    dircache_size += size;
+
+    return d_names_end - d_names_start;
+}
+
 /* flag to make sure buffer doesn't move due to other allocs.
  * this is set to true completely during dircache build */
 static bool dont_move = false;
@@ -150,28 +215,12 @@ static int move_callback(int handle, void* current, void* new)
     if (dont_move)
         return BUFLIB_CB_CANNOT_MOVE;
 
-#define UPDATE(x) if (x) { x = PTR_ADD(x, diff); }
-    /* relocate the cache */
+    /* the cache itself holds no pointers */
     ptrdiff_t diff = new - current;
-    for(unsigned i = 0; i < entry_count; i++)
-    {
-        UPDATE(dircache_root[i].d_name);
-        UPDATE(dircache_root[i].next_char);
-        UPDATE(dircache_root[i].up_char);
-        UPDATE(dircache_root[i].down_char);
-    }
     dircache_root = new;
-    UPDATE(d_names_start);
-    UPDATE(d_names_end);
-    UPDATE(dot);
-    UPDATE(dotdot);
-
-    for(unsigned i = 0; i < MAX_OPEN_FILES; i++)
-        UPDATE(fd_bindings[i]);
+    d_names_start += diff;
+    d_names_end += diff;
 
-#ifdef HAVE_MULTIVOLUME
-    UPDATE(append_position);
-#endif
     return BUFLIB_CB_OK;
 }
 
@@ -214,10 +263,10 @@ static struct dircache_entry* allocate_entry(void)
     }
     
     next_entry = &dircache_root[entry_count++];
-    next_entry->d_name = NULL;
-    next_entry->up = NULL;
-    next_entry->down = NULL;
-    next_entry->next = NULL;
+    next_entry->d_name = 0;
+    next_entry->up = 0;
+    next_entry->down = 0;
+    next_entry->next = 0;
 
     dircache_size += sizeof(struct dircache_entry);
 
@@ -235,7 +284,7 @@ static struct dircache_entry* dircache_gen_next(struct dircache_entry *ce)
     if ( (next_entry = allocate_entry()) == NULL)
         return NULL;
     next_entry->up = ce->up;
-    ce->next = next_entry;
+    ce->next = set_link(next_entry);
     
     return next_entry;
 }
@@ -250,8 +299,8 @@ static struct dircache_entry* dircache_gen_down(struct dircache_entry *ce)
 
     if ( (next_entry = allocate_entry()) == NULL)
         return NULL;
-    next_entry->up = ce;
-    ce->down = next_entry;
+    next_entry->up = set_link(ce);
+    ce->down = set_link(next_entry);
     
     return next_entry;
 }
@@ -320,16 +369,12 @@ static int sab_process_dir(unsigned long startcluster, struct dircache_entry *ce
                 !strcmp("..", sab.direntry->name))
             continue;
 
-        size_t size = strlen(sab.direntry->name) + 1;
-        ce->d_name = (d_names_start -= size);
+        ce->d_name = alloc_name(sab.direntry->name);
         ce->startcluster = sab.direntry->firstcluster;
         ce->info.size = sab.direntry->filesize;
         ce->info.attribute = sab.direntry->attr;
         ce->info.wrtdate = sab.direntry->wrtdate;
         ce->info.wrttime = sab.direntry->wrttime;
-
-        strcpy(ce->d_name, sab.direntry->name); 
-        dircache_size += size;
         
         if(ce->info.attribute & FAT_ATTR_DIRECTORY)
             dircache_gen_down(ce);
@@ -349,17 +394,17 @@ static int sab_process_dir(unsigned long startcluster, struct dircache_entry *ce
     }
     
     /* add "." and ".." */
-    ce->d_name = dot;
+    ce->d_name = DOT;
     ce->info.attribute = FAT_ATTR_DIRECTORY;
     ce->startcluster = startcluster;
     ce->info.size = 0;
-    ce->down = first_ce;
+    ce->down = set_link(first_ce);
     
     ce = dircache_gen_next(ce);
     
-    ce->d_name = dotdot;
+    ce->d_name = DOTDOT;
     ce->info.attribute = FAT_ATTR_DIRECTORY;
-    ce->startcluster = (first_ce->up ? first_ce->up->startcluster : 0);
+    ce->startcluster = (first_ce->up ? get_link(first_ce->up)->startcluster : 0);
     ce->info.size = 0;
     ce->down = first_ce->up;
     
@@ -368,11 +413,11 @@ static int sab_process_dir(unsigned long startcluster, struct dircache_entry *ce
     
     while(rc >= 0 && ce)
     {
-        if(ce->d_name != NULL && ce->down != NULL && strcmp(ce->d_name, ".")
-                && strcmp(ce->d_name, ".."))
-            rc = sab_process_dir(ce->startcluster, ce->down);
+        if(ce->d_name != 0 && ce->down != 0 && ce->d_name != DOT
+                && ce->d_name != DOTDOT)
+            rc = sab_process_dir(ce->startcluster, get_link(ce->down));
         
-        ce = ce->next;
+        ce = get_link(ce->next);
     }
     
     return rc;
@@ -391,12 +436,12 @@ static int dircache_scan_and_build(IF_MV2(int volume,) struct dircache_entry *ce
         /* broken for 100+ volumes because the format string is too small
          * and we use that for size calculation */
         const size_t max_len = VOL_ENUM_POS + 3;
-        ce->d_name = (d_names_start -= max_len);
-        snprintf(ce->d_name, max_len, VOL_NAMES, volume);
-        dircache_size += max_len;
+        char name[max_len];
+        snprintf(name, max_len, VOL_NAMES, volume);
+        ce->d_name = alloc_name(name);
         ce->info.attribute = FAT_ATTR_DIRECTORY | FAT_ATTR_VOLUME;
         ce->info.size = 0;
-        append_position = dircache_gen_next(ce);
+        append_position = set_link(dircache_gen_next(ce));
         ce = dircache_gen_down(ce);
     }
 #endif
@@ -430,17 +475,13 @@ static int sab_process_dir(struct dircache_entry *ce)
                 !strcmp("..", entry->d_name))
             continue;
 
-        size_t size = strlen(entry->d_name) + 1;
-        ce->d_name = (d_names_start -= size);
+        ce->d_name = alloc_name(entry->d_name);
         ce->info = entry->info;
-
-        strcpy(ce->d_name, entry->d_name);
-        dircache_size += size;
         
         if(entry->info.attribute & ATTR_DIRECTORY)
         {
             dircache_gen_down(ce);
-            if(ce->down == NULL)
+            if(ce->down == 0)
             {
                 closedir_uncached(dir);
                 return -1;
@@ -451,7 +492,7 @@ static int sab_process_dir(struct dircache_entry *ce)
             strlcpy(&sab_path[pathpos], "/", sizeof(sab_path) - pathpos);
             strlcpy(&sab_path[pathpos+1], entry->d_name, sizeof(sab_path) - pathpos - 1);
             
-            int rc = sab_process_dir(ce->down);
+            int rc = sab_process_dir(get_link(ce->down));
             /* restore path */
             sab_path[pathpos] = '\0';
             
@@ -477,14 +518,14 @@ static int sab_process_dir(struct dircache_entry *ce)
     }
     
     /* add "." and ".." */
-    ce->d_name = dot;
+    ce->d_name = DOT;
     ce->info.attribute = ATTR_DIRECTORY;
     ce->info.size = 0;
-    ce->down = first_ce;
+    ce->down = set_link(first_ce);
     
     ce = dircache_gen_next(ce);
     
-    ce->d_name = dotdot;
+    ce->d_name = DOTDOT;
     ce->info.attribute = ATTR_DIRECTORY;
     ce->info.size = 0;
     ce->down = first_ce->up;
@@ -529,7 +570,7 @@ static int dircache_scan_and_build(IF_MV2(int volume,) struct dircache_entry *ce
  *
  *  NOTE: this functions silently handles double '/'
  */
-static struct dircache_entry* dircache_get_entry(const char *path, bool go_down)
+static struct dircache_entry* dircache_walk_entry(const char *path, bool go_down)
 {
     char namecopy[MAX_PATH];
     char* part;
@@ -548,7 +589,7 @@ static struct dircache_entry* dircache_get_entry(const char *path, bool go_down)
          *
          * NOTE: this is safe even if cache_entry->down is NULL */
         if(!at_root)
-            cache_entry = cache_entry->down;
+            cache_entry = get_link(cache_entry->down);
         else
             at_root = false;
         
@@ -556,16 +597,16 @@ static struct dircache_entry* dircache_get_entry(const char *path, bool go_down)
         while(cache_entry != NULL)
         {
             /* skip unused entries */
-            if(cache_entry->d_name == NULL)
+            if(cache_entry->d_name == 0)
             {
-                cache_entry = cache_entry->next;
+                cache_entry = get_link(cache_entry->next);
                 continue;
             }
             /* compare names */
-            if(!strcasecmp(part, cache_entry->d_name))
+            if(!strcasecmp(part, get_name(cache_entry)))
                 break;
             /* go to next entry */
-            cache_entry = cache_entry->next;
+            cache_entry = get_link(cache_entry->next);
         }
         
         /* handle not found case */
@@ -575,26 +616,325 @@ static struct dircache_entry* dircache_get_entry(const char *path, bool go_down)
 
     /* NOTE: here cache_entry!=NULL so taking ->down is safe */
     if(go_down)
-        return at_root ? cache_entry : cache_entry->down;
+        return at_root ? cache_entry : get_link(cache_entry->down);
     else
         return at_root ? NULL : cache_entry;
 }
 
+#ifdef HAVE_DIRCACHE_INDEX
+/**
+ * The index is an open addressing hash table with linear probing in its own
+ * buflib allocation. A slot holds the link of an entry, 0 if it is empty or
+ * INDEX_TOMBSTONE if its entry was removed. Only links are stored, so the
+ * allocation can move freely.
+ *
+ * The hash covers the path components, case insensitively and ignoring
+ * repeated slashes, like dircache_walk_entry() compares them. "." and ".."
+ * entries aren't indexed, paths containing them are walked.
+ */
+#define INDEX_TOMBSTONE (-1)
+#define HASH_INIT       2166136261u /* FNV-1a */
+#define HASH_PRIME      16777619u
+
+static unsigned long hash_name(unsigned long hash, const char *name)
+{
+    hash = (hash ^ '/') * HASH_PRIME;
+    while (*name)
+        hash = (hash ^ tolower((unsigned char)*name++)) * HASH_PRIME;
+    return hash;
+}
+
+/* Returns false for "/" and for paths containing "." or ".." */
+static bool hash_path(const char *path, unsigned long *hash)
+{
+    bool found = false;
+
+    *hash = HASH_INIT;
+    while (*path)
+    {
+        if (*path == '/')
+        {
+            path++;
+            continue;
+        }
+
+        size_t len = strcspn(path, "/");
+        if (path[0] == '.' && (len == 1 || (len == 2 && path[1] == '.')))
+            return false;
+
+        *hash = (*hash ^ '/') * HASH_PRIME;
+        while (len--)
+            *hash = (*hash ^ tolower((unsigned char)*path++)) * HASH_PRIME;
+        found = true;
+    }
+
+    return found;
+}
+
+static unsigned long hash_entry(const struct dircache_entry *ce)
+{
+    unsigned long hash = ce->up ? hash_entry(get_link(ce->up)) : HASH_INIT;
+    return hash_name(hash, get_name(ce));
+}
+
+static inline int* index_get_slots(void)
+{
+    return core_get_data(index_handle);
+}
+
+static inline unsigned long index_first_slot(unsigned long hash)
+{
+    return (unsigned long)(((uint64_t)(uint32_t)hash * index_slots) >> 32);
+}
+
+/* Checks the path of an entry from the last component up to the root */
+static bool entry_has_path(const struct dircache_entry *ce, const char *path)
+{
+    const char *end = path + strlen(path);
+
+    for (; ce; ce = get_link(ce->up))
+    {
+        while (end > path && end[-1] == '/')
+            end--;
+
+        const char *name = get_name(ce);
+        size_t len = strlen(name);
+        if ((size_t)(end - path) < len || strncasecmp(end - len, name, len))
+            return false;
+
+        end -= len;
+        if (end > path && end[-1] != '/')
+            return false;
+    }
+
+    while (end > path && end[-1] == '/')
+        end--;
+
+    return end == path;
+}
+
+static bool entries_share_path(const struct dircache_entry *a,
+                               const struct dircache_entry *b)
+{
+    for (; a && b; a = get_link(a->up), b = get_link(b->up))
+    {
+        if (a == b)
+            return true;
+        if (strcasecmp(get_name(a), get_name(b)))
+            return false;
+    }
+
+    return a == b;
+}
+
+static struct dircache_entry* index_find(const char *path, unsigned long hash)
+{
+    int *slots = index_get_slots();
+    unsigned long i = index_first_slot(hash);
+
+    for (; slots[i] != 0; i = (i + 1 < index_slots) ? i + 1 : 0)
+    {
+        if (slots[i] != INDEX_TOMBSTONE
+            && entry_has_path(get_link(slots[i]), path))
+            return get_link(slots[i]);
+    }
+
+    return NULL;
+}
+
+/**
+ * Adds an entry. Like dircache_walk_entry() finds the first of several
+ * entries with the same path, the first one added stays in the index.
+ *
+ * Returns false if the index is full.
+ */
+static bool index_insert(const struct dircache_entry *ce, unsigned long hash)
+{
+    int *slots = index_get_slots();
+    unsigned long i = index_first_slot(hash);
+    long free_slot = -1;
+
+    for (; slots[i] != 0; i = (i + 1 < index_slots) ? i + 1 : 0)
+    {
+        if (slots[i] == INDEX_TOMBSTONE)
+        {
+            if (free_slot < 0)
+                free_slot = i;
+        }
+        else if (entries_share_path(get_link(slots[i]), ce))
+            return true;
+    }
+
+    if (free_slot < 0)
+    {
+        /* keep at least 1/8 of the slots empty so probing stays short */
+        if (index_used >= index_slots - index_slots / 8)
+            return false;
+        index_used++;
+        free_slot = i;
+    }
+
+    slots[free_slot] = set_link(ce);
+    return true;
+}
+
+static void index_delete(const struct dircache_entry *ce, unsigned long hash)
+{
+    int *slots = index_get_slots();
+    unsigned long i = index_first_slot(hash);
+    int link = set_link(ce);
+
+    for (; slots[i] != 0; i = (i + 1 < index_slots) ? i + 1 : 0)
+    {
+        if (slots[i] == link)
+        {
+            slots[i] = INDEX_TOMBSTONE;
+            return;
+        }
+    }
+}
+
+/* Adds all entries of a directory and those below it, hash being the one of
+ * the directory. Returns false if the index is full. */
+static bool index_insert_dir(const struct dircache_entry *ce, unsigned long hash)
+{
+    for (; ce; ce = get_link(ce->next))
+    {
+        if (ce->d_name == 0 || ce->d_name == DOT || ce->d_name == DOTDOT)
+            continue;
+
+        unsigned long h = hash_name(hash, get_name(ce));
+        if (!index_insert(ce, h))
+            return false;
+        if (ce->down && !index_insert_dir(get_link(ce->down), h))
+            return false;
+    }
+
+    return true;
+}
+
+/* Counterpart of index_insert_dir() */
+static void index_delete_dir(const struct dircache_entry *ce, unsigned long hash)
+{
+    for (; ce; ce = get_link(ce->next))
+    {
+        if (ce->d_name == 0 || ce->d_name == DOT || ce->d_name == DOTDOT)
+            continue;
+
+        unsigned long h = hash_name(hash, get_name(ce));
+        index_delete(ce, h);
+        if (ce->down)
+            index_delete_dir(get_link(ce->down), h);
+    }
+}
+
+static void index_free(void)
+{
+    if (index_handle > 0)
+        index_handle = core_free(index_handle);
+    index_slots = index_used = 0;
+}
+
+/**
+ * (Re)builds the index of the whole cache, which also gets rid of the
+ * tombstones. It has room for the entries that fit into the reserve, with a
+ * load factor of at most 7/8. Without memory for it, lookups walk the tree.
+ */
+static void index_build(void)
+{
+    if (index_handle <= 0)
+    {
+        unsigned long entries = entry_count
+                              + DIRCACHE_RESERVE/sizeof(struct dircache_entry);
+        index_slots = entries + entries/2;
+        index_handle = core_alloc("dircache idx", index_slots*sizeof(int));
+        if (index_handle <= 0)
+        {
+            index_slots = 0;
+            return;
+        }
+    }
+
+    memset(index_get_slots(), 0, index_slots*sizeof(int));
+    index_used = 0;
+    if (!index_insert_dir(dircache_root, HASH_INIT))
+    {
+        logf("dircache index full");
+        index_free();
+    }
+}
+
+/* Adds an entry and everything below it */
+static void index_add(const struct dircache_entry *ce)
+{
+    if (index_handle <= 0)
+        return;
+
+    unsigned long hash = hash_entry(ce);
+    if (!index_insert(ce, hash)
+        || (ce->down && !index_insert_dir(get_link(ce->down), hash)))
+        index_build();
+}
+
+/* Removes an entry and everything below it, before it is unlinked */
+static void index_remove(const struct dircache_entry *ce)
+{
+    if (index_handle <= 0)
+        return;
+
+    unsigned long hash = hash_entry(ce);
+    index_delete(ce, hash);
+    if (ce->down)
+        index_delete_dir(get_link(ce->down), hash);
+}
+
+/* Another entry with the same path might have been hidden by a removed one */
+static void index_readd(const char *path)
+{
+    struct dircache_entry *ce;
+
+    if (index_handle > 0 && (ce = dircache_walk_entry(path, false)) != NULL)
+        index_add(ce);
+}
+#endif /* HAVE_DIRCACHE_INDEX */
+
+/**
+ * Internal function to get a pointer to dircache_entry for a given filename,
+ * see dircache_walk_entry(). Uses the index when there is one.
+ */
+static struct dircache_entry* dircache_get_entry(const char *path, bool go_down)
+{
+#ifdef HAVE_DIRCACHE_INDEX
+    unsigned long hash;
+
+    if (index_handle > 0 && use_index && hash_path(path, &hash))
+    {
+        struct dircache_entry *ce = index_find(path, hash);
+        if (go_down)
+            return ce ? get_link(ce->down) : NULL;
+        return ce;
+    }
+#endif
+    return dircache_walk_entry(path, go_down);
+}
+
 #ifdef HAVE_EEPROM_SETTINGS
 
-#define DIRCACHE_MAGIC  0x00d0c0a1
+#define DIRCACHE_MAGIC  0x00d0c0a2
 struct dircache_maindata {
     long magic;
     long size;
     long entry_count;
     long appflags;
-    struct dircache_entry *root_entry;
-    char *d_names_start;
 };
 
 /**
  * Function to load the internal cache structure from disk to initialize
  * the dircache really fast and little disk access.
+ *
+ * The file holds the entries followed by the names. As the cache is
+ * position independent, it is read in one go and only the names need to be
+ * moved to the end of the buffer, to make room for the reserve.
  */
 int dircache_load(void)
 {
@@ -614,7 +954,10 @@ int dircache_load(void)
         
     bytes_read = read(fd, &maindata, sizeof(struct dircache_maindata));
     if (bytes_read != sizeof(struct dircache_maindata)
-        || maindata.magic != DIRCACHE_MAGIC || maindata.size <= 0)
+        || maindata.magic != DIRCACHE_MAGIC || maindata.size <= 0
+        || maindata.entry_count <= 0
+        || maindata.size < maindata.entry_count * (long)sizeof(struct dircache_entry)
+                           + DOTDOT)
     {
         logf("Dircache file header error");
         close(fd);
@@ -624,6 +967,12 @@ int dircache_load(void)
     
     allocated_size = maindata.size + DIRCACHE_RESERVE;
     dircache_handle = core_alloc_ex("dircache", allocated_size, &ops);
+    if (dircache_handle <= 0)
+    {
+        close(fd);
+        remove_dircache_file();
+        return -4;
+    }
     /* block movement during upcoming I/O */
     dont_move = true;
     dircache_root = core_get_data(dircache_handle);
@@ -631,60 +980,22 @@ int dircache_load(void)
     entry_count = maindata.entry_count;
     appflags = maindata.appflags;
 
-    /* read the dircache file into memory,
-     * start with the struct dircache_entries */
-    ssize_t bytes_to_read = entry_count*sizeof(struct dircache_entry);
-    bytes_read = read(fd, dircache_root, bytes_to_read);
-    
-    if (bytes_read != bytes_to_read)
-    {
-        logf("Dircache read failed #1");
-        return -6;
-    }
-
-    /* continue with the d_names. Fix up pointers to them if needed */
-    bytes_to_read = maindata.size - bytes_to_read;
-    d_names_start = (char*)dircache_root + allocated_size - bytes_to_read;
-    bytes_read = read(fd, d_names_start, bytes_to_read);
+    bytes_read = read(fd, dircache_root, maindata.size);
     close(fd);
     remove_dircache_file();
-    if (bytes_read != bytes_to_read)
+    if (bytes_read != maindata.size)
     {
-        logf("Dircache read failed #2");
-        return -7;
+        logf("Dircache read failed");
+        dont_move = false;
+        dircache_free();
+        return -6;
     }
 
-    d_names_end = d_names_start + bytes_read;
-    dot = d_names_end - sizeof(".");
-    dotdot = dot - sizeof("..");
-
-    /* d_names are in reverse order, so the last entry points to the first string */
-    ptrdiff_t offset_d_names = maindata.d_names_start - d_names_start;
-    ptrdiff_t offset_entries = maindata.root_entry - dircache_root;
-    offset_entries *= sizeof(struct dircache_entry); /* make it bytes */
-
-    /* offset_entries is less likely to differ, so check if it's 0 in the loop
-     * offset_d_names however is almost always non-zero, since dircache_save()
-     * creates a file which causes the reserve buffer to be used. since
-     * we allocate a new, empty DIRCACHE_RESERVE here, the strings are
-     * farther behind */
-    if (offset_entries != 0 || offset_d_names != 0)
-    {
-        for(unsigned i = 0; i < entry_count; i++)
-        {
-            if (dircache_root[i].d_name)
-                dircache_root[i].d_name -= offset_d_names;
-
-            if (offset_entries == 0)
-                continue;
-            if (dircache_root[i].next_char)
-                dircache_root[i].next_char -= offset_entries;
-            if (dircache_root[i].up_char)
-                dircache_root[i].up_char -= offset_entries;
-            if (dircache_root[i].down_char)
-                dircache_root[i].down_char -= offset_entries;
-        }
-    }
+    /* names go to the end of the buffer, the reserve in between */
+    size_t names_size = maindata.size - entry_count*sizeof(struct dircache_entry);
+    d_names_end = (char*)dircache_root + allocated_size;
+    d_names_start = d_names_end - names_size;
+    memmove(d_names_start, &dircache_root[entry_count], names_size);
 
     /* Cache successfully loaded. */
     dircache_size = maindata.size;
@@ -693,6 +1004,9 @@ int dircache_load(void)
     dircache_initialized = true;
     memset(fd_bindings, 0, sizeof(fd_bindings));
     dont_move = false;
+#ifdef HAVE_DIRCACHE_INDEX
+    index_build();
+#endif
 
     return 0;
 }
@@ -717,9 +1031,8 @@ int dircache_save(void)
     fd = open_dircache_file(O_WRONLY | O_CREAT | O_TRUNC, 0666);
 
     maindata.magic = DIRCACHE_MAGIC;
-    maindata.size = dircache_size;
-    maindata.root_entry = dircache_root;
-    maindata.d_names_start = d_names_start;
+    maindata.size = entry_count*sizeof(struct dircache_entry)
+                  + (d_names_end - d_names_start);
     maindata.entry_count = entry_count;
     maindata.appflags = appflags;
 
@@ -729,6 +1042,7 @@ int dircache_save(void)
     {
         close(fd);
         logf("dircache: write failed #1");
+        dont_move = false;
         return -2;
     }
 
@@ -738,7 +1052,9 @@ int dircache_save(void)
     bytes_written = write(fd, dircache_root, bytes_to_write);
     if (bytes_written != bytes_to_write)
     {
+        close(fd);
         logf("dircache: write failed #2");
+        dont_move = false;
         return -3;
     }
 
@@ -746,17 +1062,23 @@ int dircache_save(void)
     bytes_to_write = d_names_end - d_names_start;
     bytes_written = write(fd, d_names_start, bytes_to_write);
     close(fd);
+    dont_move = false;
     if (bytes_written != bytes_to_write)
     {
         logf("dircache: write failed #3");
         return -4;
     }
 
-    dont_move = false;
     return 0;
 }
 #endif /* HAVE_EEPROM_SETTINGS */
 
+static void generate_dot_d_names(void)
+{
+    alloc_name(".");
+    alloc_name("..");
+}
+
 /**
  * Internal function which scans the disk and creates the dircache structure.
  */
@@ -764,7 +1086,10 @@ static int dircache_do_rebuild(void)
 {
     struct dircache_entry* root_entry;
     unsigned int start_tick;
+    int rescans = 0;
+#ifdef HAVE_MULTIVOLUME
     int i;
+#endif
     
     /* Measure how long it takes build the cache. */
     start_tick = current_tick;
@@ -772,12 +1097,19 @@ static int dircache_do_rebuild(void)
     appflags = 0;
 
     /* reset dircache and alloc root entry */
+#ifdef HAVE_DIRCACHE_INDEX
+    index_free();
+#endif
+    update_log_used = 0;
+    update_log_overflow = false;
+    log_updates = true;
+rescan:
     entry_count = 0;
     root_entry = allocate_entry();
     dont_move = true;
 
 #ifdef HAVE_MULTIVOLUME
-    append_position = root_entry;
+    append_position = set_link(root_entry);
 
     for (i = NUM_VOLUMES; i >= 0; i--)
     {
@@ -786,7 +1118,7 @@ static int dircache_do_rebuild(void)
 #endif
             cpu_boost(true);
 #ifdef HAVE_MULTIVOLUME
-            if (dircache_scan_and_build(IF_MV2(i,) append_position) < 0)
+            if (dircache_scan_and_build(IF_MV2(i,) get_link(append_position)) < 0)
 #else
             if (dircache_scan_and_build(IF_MV2(0,) root_entry) < 0)
 #endif /* HAVE_MULTIVOLUME */
@@ -795,6 +1127,7 @@ static int dircache_do_rebuild(void)
                 cpu_boost(false);
                 dircache_size = 0;
                 dircache_initializing = false;
+                log_updates = false;
                 dont_move = false;
                 return -2;
             }
@@ -804,18 +1137,38 @@ static int dircache_do_rebuild(void)
     }
 #endif
 
+    /* Nothing yields from here on until the cache is enabled, so no update
+     * can slip in between. If the log can't be replayed (it overflowed, or
+     * the scan saw neither name of something renamed meanwhile), scan again:
+     * the new scan finds those updates on disk, and only the fd bindings are
+     * replayed, following the files they name to where they went. Give up
+     * if that keeps failing. */
+    if (!replay_updates())
+    {
+        if (++rescans > MAX_RESCANS)
+        {
+            logf("Live updates lost, giving up");
+            dircache_size = 0;
+            dircache_initializing = false;
+            log_updates = false;
+            dont_move = false;
+            return -3;
+        }
+        logf("Live updates lost, rescanning");
+        restart_update_log();
+        d_names_start = d_names_end;
+        dircache_size = 0;
+        generate_dot_d_names();
+        goto rescan;
+    }
+    log_updates = false;
+
     logf("Done, %ld KiB used", dircache_size / 1024);
     
     dircache_initialized = true;
     dircache_initializing = false;
     cache_build_ticks = current_tick - start_tick;
     
-    /* Initialized fd bindings. */
-    memset(fd_bindings, 0, sizeof(fd_bindings));
-    for (i = 0; i < fdbind_idx; i++)
-        dircache_bind(fdbind_cache[i].fd, fdbind_cache[i].path);
-    fdbind_idx = 0;
-    
     if (thread_enabled)
     {
         if (allocated_size - dircache_size < DIRCACHE_RESERVE)
@@ -830,6 +1183,9 @@ static int dircache_do_rebuild(void)
  * Free all associated resources, if any */
 static void dircache_free(void)
 {
+#ifdef HAVE_DIRCACHE_INDEX
+    index_free();
+#endif
     if (dircache_handle > 0)
         dircache_handle = core_free(dircache_handle);
     dircache_size = allocated_size = 0;
@@ -858,6 +1214,10 @@ static void dircache_thread(void)
                 thread_enabled = true;
                 if (dircache_do_rebuild() < 0)
                     dircache_free();
+#ifdef HAVE_DIRCACHE_INDEX
+                else
+                    index_build();
+#endif
                 thread_enabled = false;
                 break ;
                 
@@ -874,15 +1234,6 @@ static void dircache_thread(void)
     }
 }
 
-static void generate_dot_d_names(void)
-{
-    dot = (d_names_start -= sizeof("."));
-    dotdot = (d_names_start -= sizeof(".."));
-    dircache_size += sizeof(".") + sizeof("..");
-    strcpy(dot, ".");
-    strcpy(dotdot, "..");
-}
-
 /**
  * Start scanning the disk to build the dircache.
  * Either transparent or non-transparent build method is used.
@@ -969,20 +1320,18 @@ int dircache_build(int last_size)
     ptrdiff_t size_to_move = d_names_end - d_names_start;
     memmove(dst, d_names_start, size_to_move);
     
-    /* fix up pointers to the d_names */
-    for(unsigned i = 0; i < entry_count; i++)
-        dircache_root[i].d_name -= offset;
-
+    /* the names keep their offsets from the end */
     d_names_start -= offset;
     d_names_end -= offset;
-    dot -= offset;
-    dotdot -= offset;
     
     /* equivalent to dircache_size + DIRCACHE_RESERVE + align */
     allocated_size = (d_names_end - buf);
     reserve_used = 0;
 
     core_shrink(dircache_handle, dircache_root, allocated_size);
+#ifdef HAVE_DIRCACHE_INDEX
+    index_build();
+#endif
     return res;
 fail:
     dircache_disable();
@@ -1066,6 +1415,24 @@ int dircache_get_cache_size(void)
     return dircache_is_enabled() ? dircache_size : 0;
 }
 
+#ifdef HAVE_DIRCACHE_INDEX
+/**
+ * Returns the size of the path index, 0 if there is none.
+ */
+int dircache_get_index_size(void)
+{
+    return dircache_is_enabled() ? index_slots*sizeof(int) : 0;
+}
+
+/**
+ * Lets lookups bypass the path index, for comparing the two.
+ */
+void dircache_use_index(bool use)
+{
+    use_index = use;
+}
+#endif
+
 /**
  * Returns how many bytes of the reserve allocation for live cache
  * updates have been used.
@@ -1114,6 +1481,9 @@ void dircache_suspend(void)
     
     logf("Cache released");
     entry_count = 0;
+#ifdef HAVE_DIRCACHE_INDEX
+    index_free();
+#endif
 }
 
 /**
@@ -1207,9 +1577,9 @@ static size_t copy_path_helper(const struct dircache_entry *entry, char *buf, si
     int offset = 1;
     /* has parent? */
     if (entry->up)
-        offset += copy_path_helper(entry->up, buf, size);
+        offset += copy_path_helper(get_link(entry->up), buf, size);
 
-    size_t len = strlcpy(buf+offset, entry->d_name, size - offset) + offset;
+    size_t len = strlcpy(buf+offset, get_name(entry), size - offset) + offset;
     if (len < size)
     {
         buf[len++] = '/';
@@ -1284,10 +1654,10 @@ static struct dircache_entry* dircache_new_entry(const char *path, int attribute
         return NULL;
     }
     
-    while (entry->next != NULL)
-        entry = entry->next;
+    while (entry->next != 0)
+        entry = get_link(entry->next);
 
-    if (entry->d_name != NULL)
+    if (entry->d_name != 0)
     {
         entry = dircache_gen_next(entry);
         if (entry == NULL)
@@ -1297,15 +1667,11 @@ static struct dircache_entry* dircache_new_entry(const char *path, int attribute
         }
     }
 
-    size_t size = strlen(new) + 1;
-    entry->d_name = (d_names_start -= size);
+    entry->d_name = alloc_name(new);
     entry->startcluster = 0;
     memset(&entry->info, 0, sizeof(entry->info));
     entry->info.attribute = attribute;
 
-    strcpy(entry->d_name, new);
-    dircache_size += size;
-
     if (attribute & ATTR_DIRECTORY)
     {
         logf("gen_down");
@@ -1313,27 +1679,284 @@ static struct dircache_entry* dircache_new_entry(const char *path, int attribute
     }
         
     reserve_used += dircache_size - last_cache_size;
+#ifdef HAVE_DIRCACHE_INDEX
+    index_add(entry);
+#endif
 
     return entry;
 }
 
-void dircache_bind(int fd, const char *path)
+/**
+ * Logs a live update while the cache is being built. Returns false if the
+ * caller has to wait for the cache instead.
+ */
+static bool log_update(int op, int fd, const char *path, const char *newpath,
+                       long size, long startcluster)
 {
-    struct dircache_entry *entry;
+    if (!log_updates || dircache_initialized)
+        return false;
+
+    size_t pathlen = path ? strlen(path) + 1 : 0;
+    size_t newpathlen = newpath ? strlen(newpath) + 1 : 0;
+    size_t length = ALIGN_UP(sizeof(struct update_record) + pathlen
+                             + newpathlen, sizeof(long));
+    if (update_log_overflow || update_log_used + length > sizeof(update_log))
+    {
+        update_log_overflow = true;
+        return false;
+    }
+
+    struct update_record *u =
+        (struct update_record *)((char *)update_log + update_log_used);
+    u->op = op;
+    u->length = length;
+    u->on_disk = false;
+    u->fd = fd;
+    u->size = size;
+    u->startcluster = startcluster;
+    if (pathlen)
+        memcpy(u->paths, path, pathlen);
+    if (newpathlen)
+        memcpy(u->paths + pathlen, newpath, newpathlen);
+
+    update_log_used += length;
+    return true;
+}
+
+/* Removes an entry found by its path */
+static void remove_entry(struct dircache_entry *entry, const char *path)
+{
+#ifdef HAVE_DIRCACHE_INDEX
+    index_remove(entry);
+#endif
+    entry->down = 0;
+    entry->d_name = 0;
+#ifdef HAVE_DIRCACHE_INDEX
+    index_readd(path);
+#endif
+}
+
+static bool rename_entry(struct dircache_entry *entry, const char *oldpath,
+                         const char *newpath)
+{
+    struct dircache_entry *newentry;
+    struct dircache_entry oldentry;
+    char absolute_path[MAX_PATH*2];
+    char *p;
     
-    /* Queue requests until dircache has been built. */
-    if (!dircache_initialized && dircache_is_initializing())
+    /** If we rename the same filename twice in a row, we need to
+     * save the data, because the entry will be re-used. */
+    oldentry = *entry;
+
+    /* Delete the old entry. */
+    remove_entry(entry, oldpath);
+
+    /* Generate the absolute path for destination if necessary. */
+    if (newpath[0] != '/')
     {
-        if (fdbind_idx >= MAX_PENDING_BINDINGS)
-            return ;
-        strlcpy(fdbind_cache[fdbind_idx].path, path, 
-                sizeof(fdbind_cache[fdbind_idx].path));
-        fdbind_cache[fdbind_idx].fd = fd;
-        fdbind_idx++;
-        return ;
+        strlcpy(absolute_path, oldpath, sizeof(absolute_path));
+        p = strrchr(absolute_path, '/');
+        if (!p)
+        {
+            logf("Invalid path");
+            return false;
+        }
+        
+        *p = '\0';
+        strlcpy(p, absolute_path, sizeof(absolute_path)-strlen(p));
+        newpath = absolute_path;
     }
     
-    if (!dircache_initialized)
+    newentry = dircache_new_entry(newpath, entry->info.attribute);
+    if (newentry == NULL)
+        return false;
+
+    newentry->down = oldentry.down;
+    newentry->startcluster = oldentry.startcluster;
+    newentry->info.size    = oldentry.info.size;
+    newentry->info.wrtdate = oldentry.info.wrtdate;
+    newentry->info.wrttime = oldentry.info.wrttime;
+
+    /* the contents of a renamed directory move along */
+    for (entry = get_link(newentry->down); entry; entry = get_link(entry->next))
+        entry->up = set_link(newentry);
+#ifdef HAVE_DIRCACHE_INDEX
+    index_add(newentry);
+#endif
+    return true;
+}
+
+/**
+ * Follows the path of a binding logged before a rescan through the renames
+ * and removals logged after it up to the rescan, into buf. Returns false if
+ * the file was removed.
+ */
+static bool follow_binding(size_t pos, const char *path, char *buf)
+{
+    strlcpy(buf, path, MAX_PATH);
+
+    while (pos < update_log_used)
+    {
+        struct update_record *u =
+            (struct update_record *)((char *)update_log + pos);
+        const char *newpath = u->paths + strlen(u->paths) + 1;
+        size_t len = strlen(u->paths);
+
+        pos += u->length;
+        if (!u->on_disk
+            || (u->op != UPDATE_RENAME && u->op != UPDATE_REMOVE
+                && u->op != UPDATE_RMDIR)
+            || strncasecmp(buf, u->paths, len)
+            || (buf[len] != '\0' && buf[len] != '/'))
+            continue;
+
+        if (u->op != UPDATE_RENAME)
+            return false;
+
+        /* the file itself or a directory above it was renamed */
+        size_t newlen = strlen(newpath);
+        size_t rest = strlen(buf + len) + 1;
+        if (newlen + rest > MAX_PATH)
+            return false;
+        memmove(buf + newlen, buf + len, rest);
+        memcpy(buf, newpath, newlen);
+    }
+
+    return true;
+}
+
+/**
+ * Applies the updates logged during the scan to the new cache. The scan may
+ * or may not have seen each of them already, depending on when it read the
+ * directories involved, so every update is checked against the cache first.
+ *
+ * Returns false if an update can't be applied and the cache has to be
+ * scanned again.
+ */
+static bool replay_updates(void)
+{
+    struct dircache_entry *entry;
+    char followed[MAX_PATH];
+    size_t pos;
+
+    memset(fd_bindings, 0, sizeof(fd_bindings));
+    if (update_log_overflow)
+        return false;
+
+    for (pos = 0; pos < update_log_used; )
+    {
+        struct update_record *u =
+            (struct update_record *)((char *)update_log + pos);
+        const char *path = u->paths;
+        const char *newpath = path + strlen(path) + 1;
+
+        pos += u->length;
+        switch (u->op)
+        {
+            case UPDATE_ADD_FILE:
+                entry = dircache_get_entry(path, false);
+                if (entry == NULL)
+                    entry = dircache_new_entry(path, 0);
+                if (entry == NULL)
+                    return false;
+                entry->startcluster = u->startcluster;
+                break;
+
+            case UPDATE_MKDIR:
+                if (dircache_get_entry(path, false) == NULL
+                    && dircache_new_entry(path, ATTR_DIRECTORY) == NULL)
+                    return false;
+                break;
+
+            case UPDATE_RMDIR:
+            case UPDATE_REMOVE:
+                if (u->on_disk)
+                    break;
+                entry = dircache_get_entry(path, false);
+                if (entry != NULL)
+                    remove_entry(entry, path);
+                break;
+
+            case UPDATE_RENAME:
+                if (u->on_disk)
+                    break;
+                entry = dircache_get_entry(path, false);
+                if (dircache_get_entry(newpath, false) != NULL)
+                {
+                    /* the scan saw the new name already */
+                    if (entry != NULL)
+                        remove_entry(entry, path);
+                }
+                else if (entry == NULL || !rename_entry(entry, path, newpath))
+                    return false;
+                break;
+
+            case UPDATE_BIND:
+                if (u->on_disk)
+                {
+                    /* the rescan only knows where the file went */
+                    if (!follow_binding(pos, path, followed))
+                    {
+                        fd_bindings[u->fd] = 0;
+                        break;
+                    }
+                    path = followed;
+                }
+                entry = dircache_get_entry(path, false);
+                if (entry == NULL)
+                    return false;
+                fd_bindings[u->fd] = set_link(entry);
+                break;
+
+            case UPDATE_FILESIZE:
+                if (fd_bindings[u->fd] != 0)
+                {
+                    entry = get_link(fd_bindings[u->fd]);
+                    entry->info.size = u->size;
+                    entry->startcluster = u->startcluster;
+                }
+                break;
+        }
+    }
+
+    update_log_used = 0;
+    return true;
+}
+
+/**
+ * Empties the update log for another scan, which sees on disk everything
+ * logged so far except what only lives in memory: the fd bindings and the
+ * sizes of files still open. The removals and renames stay as well, marked
+ * as on disk, so that the bindings can follow them, see follow_binding().
+ */
+static void restart_update_log(void)
+{
+    size_t pos, used = 0;
+
+    for (pos = 0; pos < update_log_used; )
+    {
+        struct update_record *u =
+            (struct update_record *)((char *)update_log + pos);
+        size_t length = u->length;
+
+        pos += length;
+        if (u->op != UPDATE_ADD_FILE && u->op != UPDATE_MKDIR)
+        {
+            u->on_disk = true;
+            memmove((char *)update_log + used, u, length);
+            used += length;
+        }
+    }
+
+    update_log_used = used;
+    update_log_overflow = false;
+}
+
+void dircache_bind(int fd, const char *path)
+{
+    struct dircache_entry *entry;
+    
+    if (log_update(UPDATE_BIND, fd, path, NULL, 0, 0) || block_until_ready())
         return ;
 
     logf("bind: %d/%s", fd, path);
@@ -1345,23 +1968,25 @@ void dircache_bind(int fd, const char *path)
         return ;
     }
 
-    fd_bindings[fd] = entry;
+    fd_bindings[fd] = set_link(entry);
 }
 
 void dircache_update_filesize(int fd, long newsize, long startcluster)
 {
-    if (!dircache_initialized || fd < 0)
+    if (fd < 0
+        || log_update(UPDATE_FILESIZE, fd, NULL, NULL, newsize, startcluster)
+        || !dircache_initialized)
         return ;
 
-    if (fd_bindings[fd] == NULL)
+    if (fd_bindings[fd] == 0)
     {
         logf("dircache fd(%d) access error", fd);
         dircache_initialized = false;
         return ;
     }
     
-    fd_bindings[fd]->info.size = newsize;
-    fd_bindings[fd]->startcluster = startcluster;
+    get_link(fd_bindings[fd])->info.size = newsize;
+    get_link(fd_bindings[fd])->startcluster = startcluster;
 }
 void dircache_update_filetime(int fd)
 {
@@ -1373,25 +1998,26 @@ void dircache_update_filetime(int fd)
     if (!dircache_initialized || fd < 0)
         return ;
 
-    if (fd_bindings[fd] == NULL)
+    if (fd_bindings[fd] == 0)
     {
         logf("dircache fd access error");
         dircache_initialized = false;
         return ;
     }
     year = now->tm_year+1900-1980;
-    fd_bindings[fd]->info.wrtdate = (((year)&0x7f)<<9)           |
-                                    (((now->tm_mon+1)&0xf)<<5)   |
-                                    (((now->tm_mday)&0x1f));
-    fd_bindings[fd]->info.wrttime = (((now->tm_hour)&0x1f)<<11)  |
-                                    (((now->tm_min)&0x3f)<<5)    |
-                                    (((now->tm_sec/2)&0x1f));
+    struct dircache_entry *entry = get_link(fd_bindings[fd]);
+    entry->info.wrtdate = (((year)&0x7f)<<9)           |
+                          (((now->tm_mon+1)&0xf)<<5)   |
+                          (((now->tm_mday)&0x1f));
+    entry->info.wrttime = (((now->tm_hour)&0x1f)<<11)  |
+                          (((now->tm_min)&0x3f)<<5)    |
+                          (((now->tm_sec/2)&0x1f));
 #endif
 }
 
 void dircache_mkdir(const char *path)
 { /* Test ok. */
-    if (block_until_ready())
+    if (log_update(UPDATE_MKDIR, -1, path, NULL, 0, 0) || block_until_ready())
         return ;
         
         
@@ -1403,20 +2029,19 @@ void dircache_rmdir(const char *path)
 { /* Test ok. */
     struct dircache_entry *entry;
     
-    if (block_until_ready())
+    if (log_update(UPDATE_RMDIR, -1, path, NULL, 0, 0) || block_until_ready())
         return ;
         
     logf("rmdir: %s", path);
     entry = dircache_get_entry(path, false);
-    if (entry == NULL || entry->down == NULL)
+    if (entry == NULL || entry->down == 0)
     {
         logf("not found or not a directory!");
         dircache_initialized = false;
         return ;
     }
 
-    entry->down = NULL;
-    entry->d_name = NULL;
+    remove_entry(entry, path);
 }
 
 /* Remove a file from cache */
@@ -1424,7 +2049,7 @@ void dircache_remove(const char *name)
 { /* Test ok. */
     struct dircache_entry *entry;
     
-    if (block_until_ready())
+    if (log_update(UPDATE_REMOVE, -1, name, NULL, 0, 0) || block_until_ready())
         return ;
         
     logf("remove: %s", name);
@@ -1438,17 +2063,15 @@ void dircache_remove(const char *name)
         return ;
     }
     
-    entry->d_name = NULL;
+    remove_entry(entry, name);
 }
 
 void dircache_rename(const char *oldpath, const char *newpath)
 { /* Test ok. */
-    struct dircache_entry *entry, *newentry;
-    struct dircache_entry oldentry;
-    char absolute_path[MAX_PATH*2];
-    char *p;
+    struct dircache_entry *entry;
     
-    if (block_until_ready())
+    if (log_update(UPDATE_RENAME, -1, oldpath, newpath, 0, 0)
+        || block_until_ready())
         return ;
         
     logf("rename: %s->%s", oldpath, newpath);
@@ -1461,49 +2084,16 @@ void dircache_rename(const char *oldpath, const char *newpath)
         return ;
     }
 
-    /* Delete the old entry. */
-    entry->d_name = NULL;
-
-    /** If we rename the same filename twice in a row, we need to
-     * save the data, because the entry will be re-used. */
-    oldentry = *entry;
-
-    /* Generate the absolute path for destination if necessary. */
-    if (newpath[0] != '/')
-    {
-        strlcpy(absolute_path, oldpath, sizeof(absolute_path));
-        p = strrchr(absolute_path, '/');
-        if (!p)
-        {
-            logf("Invalid path");
-            dircache_initialized = false;
-            return ;
-        }
-        
-        *p = '\0';
-        strlcpy(p, absolute_path, sizeof(absolute_path)-strlen(p));
-        newpath = absolute_path;
-    }
-    
-    newentry = dircache_new_entry(newpath, entry->info.attribute);
-    if (newentry == NULL)
-    {
+    if (!rename_entry(entry, oldpath, newpath))
         dircache_initialized = false;
-        return ;
-    }
-
-    newentry->down = oldentry.down;
-    newentry->startcluster = oldentry.startcluster;
-    newentry->info.size    = oldentry.info.size;
-    newentry->info.wrtdate = oldentry.info.wrtdate;
-    newentry->info.wrttime = oldentry.info.wrttime;
 }
 
 void dircache_add_file(const char *path, long startcluster)
 {
     struct dircache_entry *entry;
     
-    if (block_until_ready())
+    if (log_update(UPDATE_ADD_FILE, -1, path, NULL, 0, startcluster)
+        || block_until_ready())
         return ;
     
     logf("add file: %s", path);
@@ -1590,15 +2180,15 @@ struct dirent_cached* readdir_cached(DIR_CACHED* dir)
     /* otherwise, this is is not so we first take the entry's ->next */
     /* NOTE: normal file can't have attribute=-1 */
     if(dir->theent.info.attribute != -1)
-        ce = ce->next;
+        ce = get_link(ce->next);
     /* skip unused entries */
-    while(ce != NULL && ce->d_name == NULL)
-        ce = ce->next;
+    while(ce != NULL && ce->d_name == 0)
+        ce = get_link(ce->next);
     
     if (ce == NULL)
             return NULL;
 
-    strlcpy(dir->theent.d_name, ce->d_name, MAX_PATH);
+    strlcpy(dir->theent.d_name, get_name(ce), MAX_PATH);
     /* Can't do `dir->theent = *ce`
        because that modifies the d_name pointer. */
     dir->theent.startcluster = ce->startcluster;
@@ -198,21 +198,33 @@ static unsigned long find_free_cluster(IF_MV2(struct bpb* fat_bpb,)
 static int transfer(IF_MV2(struct bpb* fat_bpb,) unsigned long start,
                     long count, char* buf, bool write );
 
-#define FAT_CACHE_SIZE 0x20
-#define FAT_CACHE_MASK (FAT_CACHE_SIZE-1)
+/* The FAT cache is set-associative: each of the FAT_CACHE_SETS sets holds
+   FAT_CACHE_WAYS lines and the least recently used line of a set is the one
+   that gets replaced. A line is FAT_CACHE_LINE consecutive FAT sectors which
+   are read with one storage request, so walking a cluster chain or scanning
+   the whole FAT reads ahead instead of fetching one sector at a time. */
+#define FAT_CACHE_LINE  4  /* sectors, at most 8 (size of the dirty mask) */
+#define FAT_CACHE_WAYS  4
+#define FAT_CACHE_SETS  2  /* must be a power of 2 */
+#define FAT_CACHE_LINES (FAT_CACHE_SETS*FAT_CACHE_WAYS)
 
 struct fat_cache_entry
 {
-    long secnum;
+    long secnum;          /* first sector of the line */
+    unsigned long lru;    /* fat_cache_clock at the last access */
+    unsigned char count;  /* sectors in the line, fewer at the end of the FAT */
+    unsigned char dirty;  /* one bit for each sector that needs writing back */
     bool inuse;
-    bool dirty;
 #ifdef HAVE_MULTIVOLUME
     struct bpb* fat_vol ; /* shared cache for all volumes */
 #endif
 };
 
-static char fat_cache_sectors[FAT_CACHE_SIZE][SECTOR_SIZE] CACHEALIGN_ATTR;
-static struct fat_cache_entry fat_cache[FAT_CACHE_SIZE];
+static char fat_cache_sectors[FAT_CACHE_LINES][FAT_CACHE_LINE*SECTOR_SIZE]
+    CACHEALIGN_ATTR;
+static struct fat_cache_entry fat_cache[FAT_CACHE_LINES];
+static unsigned long fat_cache_clock;
+static struct fat_cache_stats fat_cache_stats;
 static struct mutex cache_mutex SHAREDBSS_ATTR;
 static struct mutex tempbuf_mutex;
 static char fat_tempbuf[SECTOR_SIZE] CACHEALIGN_ATTR;
@@ -283,11 +295,12 @@ void fat_init(void)
 #endif
 
     /* mark the FAT cache as unused */
-    for(i = 0;i < FAT_CACHE_SIZE;i++)
+    for(i = 0;i < FAT_CACHE_LINES;i++)
     {
         fat_cache[i].secnum = 8; /* We use a "safe" sector just in case */
+        fat_cache[i].lru = 0;
         fat_cache[i].inuse = false;
-        fat_cache[i].dirty = false;
+        fat_cache[i].dirty = 0;
 #ifdef HAVE_MULTIVOLUME
         fat_cache[i].fat_vol = NULL;
 #endif
@@ -541,7 +554,7 @@ int fat_unmount(int volume, bool flush)
     {   /* volume is not accessible any more, e.g. MMC removed */
         int i;
         mutex_lock(&cache_mutex);
-        for(i = 0;i < FAT_CACHE_SIZE;i++)
+        for(i = 0;i < FAT_CACHE_LINES;i++)
         {
             struct fat_cache_entry *fce = &fat_cache[i];
             if(fce->inuse
@@ -551,7 +564,8 @@ int fat_unmount(int volume, bool flush)
               )
             {
                 fce->inuse = false; /* discard all from that volume */
-                fce->dirty = false;
+                fce->dirty = 0;
+                fce->lru = 0;
             }
         }
         mutex_unlock(&cache_mutex);
@@ -663,26 +677,39 @@ static int bpb_is_sane(IF_MV_NONVOID(struct bpb* fat_bpb))
     return 0;
 }
 
-static void flush_fat_sector(struct fat_cache_entry *fce,
-                             unsigned char *sectorbuf)
+/* Writes the dirty sectors of a line back to all FATs */
+static void flush_fat_line(struct fat_cache_entry *fce,
+                           unsigned char *linebuf)
 {
     int rc;
     long secnum;
+    int first = 0;
+    int last = fce->count - 1;
+    int count;
+
+    /* Write everything from the first to the last dirty sector with one
+       request, clean sectors in between still match what is on disk */
+    while(!(fce->dirty & (1 << first)))
+        first++;
+    while(!(fce->dirty & (1 << last)))
+        last--;
+    count = last - first + 1;
+    linebuf += first * SECTOR_SIZE;
 
     /* With multivolume, use only the FAT info from the cached sector! */
 #ifdef HAVE_MULTIVOLUME
-    secnum = fce->secnum + fce->fat_vol->startsector;
+    secnum = fce->secnum + first + fce->fat_vol->startsector;
 #else
-    secnum = fce->secnum + fat_bpbs[0].startsector;
+    secnum = fce->secnum + first + fat_bpbs[0].startsector;
 #endif
 
     /* Write to the first FAT */
     rc = storage_write_sectors(IF_MD2(fce->fat_vol->drive,)
-                           secnum, 1,
-                           sectorbuf);
+                           secnum, count,
+                           linebuf);
     if(rc < 0)
     {
-        panicf("flush_fat_sector() - Could not write sector %ld"
+        panicf("flush_fat_line() - Could not write sector %ld"
                " (error %d)\n",
                secnum, rc);
     }
@@ -699,15 +726,16 @@ static void flush_fat_sector(struct fat_cache_entry *fce,
         secnum += fat_bpbs[0].fatsize;
 #endif
         rc = storage_write_sectors(IF_MD2(fce->fat_vol->drive,)
-                               secnum, 1, sectorbuf);
+                               secnum, count, linebuf);
         if(rc < 0)
         {
-            panicf("flush_fat_sector() - Could not write sector %ld"
+            panicf("flush_fat_line() - Could not write sector %ld"
                    " (error %d)\n",
                    secnum, rc);
         }
     }
-    fce->dirty = false;
+    fat_cache_stats.writebacks += count;
+    fce->dirty = 0;
 }
 
 /* Note: The returned pointer is only safely valid until the next
@@ -718,52 +746,78 @@ static void *cache_fat_sector(IF_MV2(struct bpb* fat_bpb,)
 #ifndef HAVE_MULTIVOLUME
     struct bpb* fat_bpb = &fat_bpbs[0];
 #endif
-    long secnum = fatsector + fat_bpb->bpb_rsvdseccnt;
-    int cache_index = secnum & FAT_CACHE_MASK;
-    struct fat_cache_entry *fce = &fat_cache[cache_index];
-    unsigned char *sectorbuf = &fat_cache_sectors[cache_index][0];
-    int rc;
+    long linesector = fatsector & ~(FAT_CACHE_LINE-1);
+    long secnum = linesector + fat_bpb->bpb_rsvdseccnt;
+    int offset = fatsector - linesector;
+    int set = (fatsector / FAT_CACHE_LINE) & (FAT_CACHE_SETS-1);
+    struct fat_cache_entry *fce = &fat_cache[set * FAT_CACHE_WAYS];
+    struct fat_cache_entry *victim = fce;
+    unsigned char *linebuf;
+    long count;
+    int i, rc;
 
     mutex_lock(&cache_mutex); /* make changes atomic */
 
-    /* Delete the cache entry if it isn't the sector we want */
-    if(fce->inuse && (fce->secnum != secnum
+    for(i = 0;i < FAT_CACHE_WAYS;i++, fce++)
+    {
+        if(fce->inuse && fce->secnum == secnum
 #ifdef HAVE_MULTIVOLUME
-        || fce->fat_vol != fat_bpb
+            && fce->fat_vol == fat_bpb
 #endif
-    ))
+        )
+            break;
+
+        /* unused lines have lru 0 and go first */
+        if(fce->lru < victim->lru)
+            victim = fce;
+    }
+
+    if(i < FAT_CACHE_WAYS)
+    {
+        fat_cache_stats.hits++;
+        linebuf = fat_cache_sectors[fce - fat_cache];
+    }
+    else
     {
-        /* Write back if it is dirty */
-        if(fce->dirty)
+        fce = victim;
+        linebuf = fat_cache_sectors[fce - fat_cache];
+
+        /* Write back the line we replace if it is dirty */
+        if(fce->inuse && fce->dirty)
         {
-            flush_fat_sector(fce, sectorbuf);
+            flush_fat_line(fce, linebuf);
         }
         fce->inuse = false;
-    }
+        fce->lru = 0;
+
+        /* Load the whole line, but don't read past the end of the FAT */
+        count = fat_bpb->fatsize - linesector;
+        if(count > FAT_CACHE_LINE || count <= offset)
+            count = FAT_CACHE_LINE;
 
-    /* Load the sector if it is not cached */
-    if(!fce->inuse)
-    {
         rc = storage_read_sectors(IF_MD2(fat_bpb->drive,)
-                              secnum + fat_bpb->startsector,1,
-                              sectorbuf);
+                              secnum + fat_bpb->startsector, count,
+                              linebuf);
         if(rc < 0)
         {
             DEBUGF( "cache_fat_sector() - Could not read sector %ld"
-                    " (error %d)\n", secnum, rc);
+                    " (error %d)\n", secnum + offset, rc);
             mutex_unlock(&cache_mutex);
             return NULL;
         }
+        fat_cache_stats.misses++;
         fce->inuse = true;
         fce->secnum = secnum;
+        fce->count = count;
 #ifdef HAVE_MULTIVOLUME
         fce->fat_vol = fat_bpb;
 #endif
     }
+    fce->lru = ++fat_cache_clock;
     if (dirty)
-        fce->dirty = true; /* dirt remains, sticky until flushed */
+        fce->dirty |= 1 << offset; /* dirt remains, sticky until flushed */
     mutex_unlock(&cache_mutex);
-    return sectorbuf;
+    return linebuf + offset * SECTOR_SIZE;
 }
 
 static unsigned long find_free_cluster(IF_MV2(struct bpb* fat_bpb,)
@@ -1037,7 +1091,7 @@ static int flush_fat(IF_MV_NONVOID(struct bpb* fat_bpb))
     LDEBUGF("flush_fat()\n");
 
     mutex_lock(&cache_mutex);
-    for(i = 0;i < FAT_CACHE_SIZE;i++)
+    for(i = 0;i < FAT_CACHE_LINES;i++)
     {
         struct fat_cache_entry *fce = &fat_cache[i];
         if(fce->inuse 
@@ -1047,7 +1101,7 @@ static int flush_fat(IF_MV_NONVOID(struct bpb* fat_bpb))
             && fce->dirty)
         {
             sec = fat_cache_sectors[i];
-            flush_fat_sector(fce, sec);
+            flush_fat_line(fce, sec);
         }
     }
     mutex_unlock(&cache_mutex);
@@ -2656,6 +2710,13 @@ unsigned int fat_get_cluster_size(IF_MV_NONVOID(int volume))
     return fat_bpb->bpb_secperclus * SECTOR_SIZE;
 }
 
+void fat_get_cache_stats(struct fat_cache_stats *stats)
+{
+    mutex_lock(&cache_mutex);
+    *stats = fat_cache_stats;
+    mutex_unlock(&cache_mutex);
+}
+
 #ifdef HAVE_MULTIVOLUME
 bool fat_ismounted(int volume)
 {
@@ -765,6 +765,10 @@ Lyre prototype 1 */
 #ifdef HAVE_TAGCACHE
 #define HAVE_TC_RAMCACHE
 #endif
+/* Hash index for dircache path lookups, it takes 6 bytes per entry */
+#if MEMORYSIZE >= 32
+#define HAVE_DIRCACHE_INDEX
+#endif
 #endif
 
 #if defined(HAVE_TAGCACHE) && defined(HAVE_LCD_BITMAP)
@@ -840,6 +844,11 @@ Lyre prototype 1 */
 #define HAVE_CROSSFADE
 #endif
 
+/* Band-limited resampler, its coefficient tables take about 25KB */
+#if MEMORYSIZE > 2
+#define HAVE_POLYPHASE_RESAMPLER
+#endif
+
 #endif /*  (CONFIG_CODEC == SWCODEC) */
 
 /* Determine if accesses should be strictly long aligned. */
@@ -94,6 +94,13 @@ struct fat_dir
     unsigned char longname[260 * 2];
 } CACHEALIGN_ATTR;
 
+struct fat_cache_stats
+{
+    unsigned long hits;       /* FAT sector lookups served from the cache */
+    unsigned long misses;     /* lines read from the disk */
+    unsigned long writebacks; /* dirty sectors written back to each FAT */
+};
+
 #ifdef HAVE_HOTSWAP
 extern void fat_lock(void);
 extern void fat_unlock(void);
@@ -133,6 +140,7 @@ extern int fat_opendir(IF_MV2(int volume,)
                        const struct fat_dir *parent_dir);
 extern int fat_getnext(struct fat_dir *ent, struct fat_direntry *entry);
 extern unsigned int fat_get_cluster_size(IF_MV_NONVOID(int volume)); /* public for debug info screen */
+extern void fat_get_cache_stats(struct fat_cache_stats *stats); /* public for debug info screen */
 extern bool fat_ismounted(int volume);
 extern void* fat_get_sector_buffer(void);
 extern void fat_release_sector_buffer(void);
@@ -74,6 +74,10 @@ bool dircache_get_appflag(long mask);
 int dircache_get_entry_count(void);
 int dircache_get_cache_size(void);
 int dircache_get_reserve_used(void);
+#ifdef HAVE_DIRCACHE_INDEX
+int dircache_get_index_size(void);
+void dircache_use_index(bool use);
+#endif
 int dircache_get_build_ticks(void);
 void dircache_disable(void);
 void dircache_suspend(void);
@@ -0,0 +1,137 @@
+/***************************************************************************
+ *             __________               __   ___.
+ *   Open      \______   \ ____   ____ |  | _\_ |__   _______  ___
+ *   Source     |       _//  _ \_/ ___\|  |/ /| __ \ /  _ \  \/  /
+ *   Jukebox    |    |   (  <_> )  \___|    < | \_\ (  <_> > <  <
+ *   Firmware   |____|_  /\____/ \___  >__|_ \|___  /\____/__/\_ \
+ *                     \/            \/     \/    \/            \/
+ * $Id$
+ *
+ * Copyright (C) 2012 The Rockbox Project
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This software is distributed on an "AS IS" basis, WITHOUT WARRANTY OF ANY
+ * KIND, either express or implied.
+ *
+ ****************************************************************************/
+
+#ifndef SPSC_QUEUE_H
+#define SPSC_QUEUE_H
+
+#include "config.h"
+#include "gcc_extensions.h"
+
+/*******************************************************************************
+ * Lock-free single producer, single consumer queue of slot numbers
+ *
+ * The queue only hands out slot numbers 0..size-1; the caller owns the
+ * storage behind them. One slot is always left unused so that read == write
+ * means empty.
+ *
+ * The producer fills the slot at spsc_queue_write_slot() and then calls
+ * spsc_queue_publish(). The consumer uses the slot at spsc_queue_read_slot()
+ * once spsc_queue_count() says it is there, and calls spsc_queue_consume()
+ * when it is done with it. The publish/consume stores are release stores and
+ * the loads of the other side's position are acquire loads, so everything
+ * the producer wrote to a slot is visible to the consumer once the slot is
+ * published, and the consumer is done reading a slot before the producer
+ * may reuse it. This holds between real threads on any number of cores, e.g.
+ * a hosted PCM callback thread, not just between a thread and an interrupt.
+ *
+ * Either side may also inspect the queue from another thread as long as it
+ * tolerates the positions moving forward underneath it.
+ ******************************************************************************/
+
+#if defined(__ATOMIC_ACQUIRE)
+/* GCC >= 4.7 and clang */
+#define spsc_load_acquire(p) \
+    __atomic_load_n((p), __ATOMIC_ACQUIRE)
+#define spsc_store_release(p, v) \
+    __atomic_store_n((p), (v), __ATOMIC_RELEASE)
+#else
+#if (CONFIG_PLATFORM & PLATFORM_HOSTED)
+/* The host may have several cores - use a full hardware barrier */
+#define spsc_barrier()  __sync_synchronize()
+#else
+/* Single core: only an interrupt can run in between, which sees memory
+ * in program order, so stopping the compiler from reordering is enough */
+#define spsc_barrier()  asm volatile ("" : : : "memory")
+#endif
+
+static FORCE_INLINE unsigned int spsc_load_acquire(const unsigned int *p)
+{
+    unsigned int v = *(const volatile unsigned int *)p;
+    spsc_barrier();
+    return v;
+}
+
+static FORCE_INLINE void spsc_store_release(unsigned int *p, unsigned int v)
+{
+    spsc_barrier();
+    *(volatile unsigned int *)p = v;
+}
+#endif /* __ATOMIC_ACQUIRE */
+
+struct spsc_queue
+{
+    unsigned int read;  /* Next slot to consume - written by consumer only */
+    unsigned int write; /* Next slot to fill - written by producer only */
+    unsigned int size;  /* Number of slots */
+};
+
+/* Set up an empty queue. Neither side may be using it. */
+static inline void spsc_queue_init(struct spsc_queue *q, unsigned int size)
+{
+    q->size = size;
+    spsc_store_release(&q->read, 0);
+    spsc_store_release(&q->write, 0);
+}
+
+/* Slot following 'slot' */
+static FORCE_INLINE unsigned int spsc_queue_next(const struct spsc_queue *q,
+                                                 unsigned int slot)
+{
+    return ++slot >= q->size ? 0 : slot;
+}
+
+/* Oldest published slot, valid if spsc_queue_count() > 0 */
+static FORCE_INLINE unsigned int spsc_queue_read_slot(const struct spsc_queue *q)
+{
+    return spsc_load_acquire(&q->read);
+}
+
+/* Slot the producer is filling */
+static FORCE_INLINE unsigned int spsc_queue_write_slot(const struct spsc_queue *q)
+{
+    return spsc_load_acquire(&q->write);
+}
+
+/* Number of published slots not yet consumed */
+static FORCE_INLINE unsigned int spsc_queue_count(const struct spsc_queue *q)
+{
+    unsigned int read = spsc_load_acquire(&q->read);
+    unsigned int write = spsc_load_acquire(&q->write);
+
+    if (read > write)
+        write += q->size;
+
+    return write - read;
+}
+
+/* Producer: hand the slot at spsc_queue_write_slot() to the consumer */
+static FORCE_INLINE void spsc_queue_publish(struct spsc_queue *q)
+{
+    spsc_store_release(&q->write, spsc_queue_next(q, q->write));
+}
+
+/* Consumer: give the slot at spsc_queue_read_slot() back to the producer */
+static FORCE_INLINE void spsc_queue_consume(struct spsc_queue *q)
+{
+    spsc_store_release(&q->read, spsc_queue_next(q, q->read));
+}
+
+#endif /* SPSC_QUEUE_H */
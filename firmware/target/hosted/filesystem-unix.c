@@ -105,7 +105,7 @@ struct dirinfo dir_get_info(DIR* _parent, struct dirent *dir)
 {
     struct __dir *parent = (struct __dir*)_parent;
     struct stat s;
-    struct tm *tm = NULL;
+    struct tm buf, *tm = NULL;
     struct dirinfo ret;
     char path[MAX_PATH];
 
@@ -119,7 +119,7 @@ struct dirinfo dir_get_info(DIR* _parent, struct dirent *dir)
             ret.attribute = ATTR_DIRECTORY;
         }
         ret.size = s.st_size;
-        tm = localtime(&(s.st_mtime));
+        tm = localtime_r(&(s.st_mtime), &buf);
     }
 
     if (!lstat(path, &s) && S_ISLNK(s.st_mode))
@@ -7,6 +7,10 @@
 
 static FILE* file;
 
+/* read statistics for the "bench" command */
+long read_requests = 0;
+long read_sectors = 0;
+
 void panicf( const char *fmt, ... );
 
 int storage_read_sectors(unsigned long start, int count, void* buf)
@@ -17,6 +21,9 @@ int storage_read_sectors(unsigned long start, int count, void* buf)
     else
         DEBUGF("[Reading block 0x%lx]\n", start); 
 
+    read_requests++;
+    read_sectors += count;
+
     if(fseek(file,start*BLOCK_SIZE,SEEK_SET)) {
         perror("fseek");
         return -1;
@@ -516,6 +516,85 @@ int dbg_mkdir(char* name)
     return 0;
 }
 
+extern long read_requests;
+extern long read_sectors;
+
+static void bench_report(const char* what, clock_t start,
+                         struct fat_cache_stats* before)
+{
+    struct fat_cache_stats after;
+    fat_get_cache_stats(&after);
+    printf("%-12s %6ld ms  %8lu hits %7lu misses %6lu written back"
+           "  %7ld reads %8ld sectors\n", what,
+           (long)(clock() - start) * 1000 / CLOCKS_PER_SEC,
+           after.hits - before->hits, after.misses - before->misses,
+           after.writebacks - before->writebacks,
+           read_requests, read_sectors);
+    *before = after;
+    read_requests = read_sectors = 0;
+}
+
+/* Times the operations that walk the FAT: counting the free clusters and
+   seeking around in a large file, where each backwards seek follows the
+   cluster chain from the start of the file again */
+int dbg_bench(char* name, int seeks)
+{
+    struct fat_cache_stats stats;
+    clock_t start;
+    char buf[SECTOR_SIZE];
+    long size;
+    int i, fd;
+
+    if (seeks <= 0) {
+        DEBUGF("Invalid number of seeks\n");
+        return -1;
+    }
+
+    fd = open(name, O_RDONLY);
+    if (fd<0) {
+        DEBUGF("Failed opening file\n");
+        return -1;
+    }
+    size = filesize(fd);
+    if (size <= 0) {
+        DEBUGF("File is empty\n");
+        close(fd);
+        return -1;
+    }
+
+    fat_get_cache_stats(&stats);
+    read_requests = read_sectors = 0;
+
+    start = clock();
+    fat_recalc_free(IF_MV(0));
+    bench_report("recalc_free", start, &stats);
+
+    start = clock();
+    for (i=0; i<seeks; i++) {
+        lseek(fd, (long)(((unsigned long)rand() << 16 ^ rand()) % size),
+              SEEK_SET);
+        if (read(fd, buf, 1) != 1) {
+            DEBUGF("Failed reading file\n");
+            close(fd);
+            return -2;
+        }
+    }
+    bench_report("seek", start, &stats);
+
+    start = clock();
+    for (i=0; i<seeks; i++) {
+        lseek(fd, size / seeks * i, SEEK_SET);
+        if (read(fd, buf, 1) != 1) {
+            DEBUGF("Failed reading file\n");
+            close(fd);
+            return -2;
+        }
+    }
+    bench_report("forward seek", start, &stats);
+
+    return close(fd);
+}
+
 int dbg_cmd(int argc, char *argv[])
 {
     char* cmd = NULL;
@@ -550,6 +629,7 @@ int dbg_cmd(int argc, char *argv[])
                " append <file>\n"
                " test <file>\n"
                " ren <file> <newname>\n"
+               " bench <file> <seeks>\n"
             );
         return -1;
     }
@@ -667,6 +747,16 @@ int dbg_cmd(int argc, char *argv[])
             return rename(arg1, arg2);
     }
 
+    if (!strcasecmp(cmd, "bench"))
+    {
+        if (arg1) {
+            if (arg2)
+                return dbg_bench(arg1, strtol(arg2, NULL, 0));
+            else
+                return dbg_bench(arg1, 1000);
+        }
+    }
+
     return 0;
 }
 
@@ -0,0 +1,9 @@
+/* fake autoconf for spsc queue testing */
+
+#ifndef __BUILD_AUTOCONF_H
+#define __BUILD_AUTOCONF_H
+
+/* assume little endian for now */
+#define ROCKBOX_LITTLE_ENDIAN 1
+
+#endif
@@ -0,0 +1,156 @@
+/***************************************************************************
+ *             __________               __   ___.
+ *   Open      \______   \ ____   ____ |  | _\_ |__   _______  ___
+ *   Source     |       _//  _ \_/ ___\|  |/ /| __ \ /  _ \  \/  /
+ *   Jukebox    |    |   (  <_> )  \___|    < | \_\ (  <_> > <  <
+ *   Firmware   |____|_  /\____/ \___  >__|_ \|___  /\____/__/\_ \
+ *                     \/            \/     \/    \/            \/
+ * $Id$
+ *
+ * Copyright (C) 2012 The Rockbox Project
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This software is distributed on an "AS IS" basis, WITHOUT WARRANTY OF ANY
+ * KIND, either express or implied.
+ *
+ ****************************************************************************/
+
+/* Stress test for spsc_queue.h: a producer and a consumer pthread pass
+ * slots through a small queue as fast as they can, the way the codec thread
+ * and a hosted PCM callback thread do in pcmbuf.c. Every slot carries a
+ * sequence number and a block of data derived from it; the consumer checks
+ * that it sees every slot exactly once, in order and completely written. */
+
+#include <pthread.h>
+#include <sched.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "spsc_queue.h"
+
+#define SLOTS       8
+#define SLOT_WORDS  64
+#define DEFAULT_ITEMS 5000000
+
+struct slot
+{
+    unsigned long seq;
+    unsigned long data[SLOT_WORDS];
+};
+
+static struct spsc_queue queue;
+static struct slot slots[SLOTS];
+static unsigned long items = DEFAULT_ITEMS;
+static unsigned long producer_waits, consumer_waits;
+
+static unsigned long mix(unsigned long seq, int i)
+{
+    return (seq * 2654435761ul) ^ (i * 40503ul) ^ (seq >> 7);
+}
+
+static void *producer(void *arg)
+{
+    unsigned long seq;
+    (void)arg;
+
+    for (seq = 0; seq < items; seq++)
+    {
+        struct slot *s;
+        int i;
+
+        /* One slot stays unused, as in pcmbuf */
+        while (spsc_queue_count(&queue) >= SLOTS - 1)
+        {
+            producer_waits++;
+            if ((producer_waits & 63) == 0)
+                sched_yield();
+        }
+
+        s = &slots[spsc_queue_write_slot(&queue)];
+        for (i = 0; i < SLOT_WORDS; i++)
+            s->data[i] = mix(seq, i);
+        s->seq = seq;
+
+        spsc_queue_publish(&queue);
+    }
+
+    return NULL;
+}
+
+static void *consumer(void *arg)
+{
+    unsigned long seq;
+    long errors = 0;
+    (void)arg;
+
+    for (seq = 0; seq < items; seq++)
+    {
+        const struct slot *s;
+        int i;
+
+        while (spsc_queue_count(&queue) == 0)
+        {
+            consumer_waits++;
+            if ((consumer_waits & 63) == 0)
+                sched_yield();
+        }
+
+        s = &slots[spsc_queue_read_slot(&queue)];
+
+        if (s->seq != seq)
+        {
+            if (errors++ < 10)
+                printf("slot %u: expected seq %lu, got %lu\n",
+                       spsc_queue_read_slot(&queue), seq, s->seq);
+        }
+        else
+        {
+            for (i = 0; i < SLOT_WORDS; i++)
+            {
+                if (s->data[i] != mix(seq, i))
+                {
+                    if (errors++ < 10)
+                        printf("seq %lu: word %d not written yet\n", seq, i);
+                    break;
+                }
+            }
+        }
+
+        spsc_queue_consume(&queue);
+    }
+
+    return (void *)errors;
+}
+
+int main(int argc, char *argv[])
+{
+    pthread_t prod, cons;
+    void *errors;
+
+    if (argc > 1)
+        items = strtoul(argv[1], NULL, 0);
+
+    spsc_queue_init(&queue, SLOTS);
+
+    pthread_create(&cons, NULL, consumer, NULL);
+    pthread_create(&prod, NULL, producer, NULL);
+    pthread_join(prod, NULL);
+    pthread_join(cons, &errors);
+
+    printf("%lu items, %lu producer waits, %lu consumer waits\n",
+           items, producer_waits, consumer_waits);
+
+    if (errors || spsc_queue_count(&queue) != 0)
+    {
+        printf("FAILED: %ld errors\n", (long)errors);
+        return 1;
+    }
+
+    printf("OK\n");
+    return 0;
+}
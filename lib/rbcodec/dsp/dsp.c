@@ -29,6 +29,9 @@
 #include "settings.h"
 #include "replaygain.h"
 #include "tdspeed.h"
+#ifdef HAVE_POLYPHASE_RESAMPLER
+#include "polyphase.h"
+#endif
 #include "core_alloc.h"
 #include "fixedpoint.h"
 #include "fracmul.h"
@@ -37,6 +40,10 @@
 /*#define LOGF_ENABLE*/
 #include "logf.h"
 
+#if defined(DSP_PROFILE) && (CONFIG_PLATFORM & PLATFORM_HOSTED)
+#include <time.h>
+#endif
+
 /* 16-bit samples are scaled based on these constants. The shift should be
  * no more than 15.
  */
@@ -145,6 +152,9 @@ struct dsp_config
     channels_process_fn_type     eq_process;
     channels_process_fn_type     channels_process;
     channels_process_dsp_fn_type compressor_process;
+#ifdef DSP_PROFILE
+    struct dsp_profile_stage     profile[DSP_PROFILE_NUM_STAGES];
+#endif
 };
 
 /* General DSP config */
@@ -178,6 +188,9 @@ static int  channels_mode;
        long dsp_sw_gain;
        long dsp_sw_cross;
 static bool dither_enabled;
+#ifdef HAVE_POLYPHASE_RESAMPLER
+static bool resampler_hq;
+#endif
 static long eq_precut;
 static long track_gain;
 static bool new_gain;
@@ -213,6 +226,77 @@ static int32_t *sample_buf[2] = { small_sample_buf[0], small_sample_buf[1] };
 static int resample_buf_count = SMALL_RESAMPLE_BUF_COUNT;
 static int32_t *resample_buf[2] = { small_resample_buf[0], small_resample_buf[1] };
 
+#ifdef DSP_PROFILE
+/* Stage timing for dsp_process(). Each PROFILE_STAGE() charges the time since
+ * the previous mark to one stage and restarts the clock, so only a single
+ * timer read is needed per stage that actually runs. */
+#if (CONFIG_PLATFORM & PLATFORM_HOSTED)
+static inline uint32_t profile_time(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1000000000ul + ts.tv_nsec;
+}
+#define PROFILE_TIME_TO_NS(t)   (t)
+#elif defined(USEC_TIMER)
+#define profile_time()          ((uint32_t)USEC_TIMER)
+#define PROFILE_TIME_TO_NS(t)   ((uint64_t)(t) * 1000)
+#else
+#error DSP_PROFILE needs USEC_TIMER on this target
+#endif
+
+static inline void profile_stage(struct dsp_config *dsp, int stage,
+                                 int count, uint32_t *mark)
+{
+    struct dsp_profile_stage *p = &dsp->profile[stage];
+    uint32_t now = profile_time();
+    p->time += PROFILE_TIME_TO_NS(now - *mark);
+    p->calls++;
+    p->samples += count;
+    *mark = now;
+}
+
+#define PROFILE_MARK(mark) \
+    ((mark) = profile_time())
+#define PROFILE_STAGE(dsp, stage, count, mark) \
+    profile_stage((dsp), DSP_PROFILE_##stage, (count), &(mark))
+
+void dsp_profile_reset(struct dsp_config *dsp)
+{
+    memset(dsp->profile, 0, sizeof (dsp->profile));
+}
+
+const struct dsp_profile_stage * dsp_profile_get(struct dsp_config *dsp)
+{
+    return dsp->profile;
+}
+
+const char * dsp_profile_stage_name(int stage)
+{
+    static const char * const names[DSP_PROFILE_NUM_STAGES] =
+    {
+        [DSP_PROFILE_INPUT]      = "input",
+        [DSP_PROFILE_TDSPEED]    = "tdspeed",
+        [DSP_PROFILE_GAIN]       = "gain",
+        [DSP_PROFILE_RESAMPLE]   = "resample",
+        [DSP_PROFILE_CROSSFEED]  = "crossfeed",
+        [DSP_PROFILE_EQ]         = "eq",
+        [DSP_PROFILE_TONE]       = "tone",
+        [DSP_PROFILE_CHANNELS]   = "channels",
+        [DSP_PROFILE_COMPRESSOR] = "compressor",
+        [DSP_PROFILE_OUTPUT]     = "output",
+    };
+
+    if ((unsigned)stage >= DSP_PROFILE_NUM_STAGES)
+        return "?";
+
+    return names[stage];
+}
+#else
+#define PROFILE_MARK(mark)
+#define PROFILE_STAGE(dsp, stage, count, mark)
+#endif /* DSP_PROFILE */
+
 #ifdef HAVE_PITCHSCREEN
 int32_t sound_get_pitch(void)
 {
@@ -724,6 +808,15 @@ static int dsp_upsample(int count, struct dsp_data *data,
 }
 #endif /* DSP_HAVE_ASM_RESAMPLING */
 
+static void resampler_flush(struct dsp_config *dsp)
+{
+    memset(&dsp->data.resample_data, 0, sizeof (dsp->data.resample_data));
+#ifdef HAVE_POLYPHASE_RESAMPLER
+    if (dsp == &AUDIO_DSP)
+        polyphase_flush();
+#endif
+}
+
 static void resampler_new_delta(struct dsp_config *dsp)
 {
     dsp->data.resample_data.delta = (unsigned long)
@@ -738,13 +831,40 @@ static void resampler_new_delta(struct dsp_config *dsp)
         dsp->data.resample_data.phase = 0;
         dsp->data.resample_data.last_sample[0] = 0;
         dsp->data.resample_data.last_sample[1] = 0;
+#ifdef HAVE_POLYPHASE_RESAMPLER
+        if (dsp == &AUDIO_DSP)
+            polyphase_flush();
+#endif
     }
+#ifdef HAVE_POLYPHASE_RESAMPLER
+    /* The band-limited resampler is for audio only; voice doesn't need it.
+       Ratios beyond its tables fall back to linear interpolation. */
+    else if (dsp == &AUDIO_DSP && resampler_hq &&
+             polyphase_set_frequency(dsp->frequency))
+        dsp->resample = polyphase_resample;
+#endif
     else if (dsp->frequency < NATIVE_FREQUENCY)
         dsp->resample = dsp_upsample;
     else
         dsp->resample = dsp_downsample;
 }
 
+#ifdef HAVE_POLYPHASE_RESAMPLER
+/* Selects the band-limited polyphase resampler (true) or the linear
+ * interpolating one (false) for the audio DSP. */
+void dsp_resampler_hq_enable(bool enable)
+{
+    struct dsp_config *dsp = &AUDIO_DSP;
+
+    if (enable == resampler_hq)
+        return;
+
+    resampler_hq = enable;
+    polyphase_flush();
+    resampler_new_delta(dsp);
+}
+#endif
+
 /* Resample count stereo samples. Updates the src array, if resampling is
  * done, to refer to the resampled data. Returns number of stereo samples
  * for further processing.
@@ -1092,13 +1212,13 @@ static void channels_process_sound_chan_custom(int count, int32_t *buf[])
 static void channels_process_sound_chan_mono_left(int count, int32_t *buf[])
 {
     /* Just copy over the other channel */
-    memcpy(buf[1], buf[0], count * sizeof (*buf));
+    memcpy(buf[1], buf[0], count * sizeof (*buf[0]));
 }
 
 static void channels_process_sound_chan_mono_right(int count, int32_t *buf[])
 {
     /* Just copy over the other channel */
-    memcpy(buf[0], buf[1], count * sizeof (*buf));
+    memcpy(buf[0], buf[1], count * sizeof (*buf[0]));
 }
 
 #ifndef DSP_HAVE_ASM_SOUND_CHAN_KARAOKE
@@ -1208,6 +1328,9 @@ int dsp_process(struct dsp_config *dsp, char *dst, const char *src[], int count)
     static long last_yield;
     long tick;
     int written = 0;
+#ifdef DSP_PROFILE
+    uint32_t mark;
+#endif
 
 #if defined(CPU_COLDFIRE)
     /* set emac unit for dsp processing, and save old macsr, we're running in
@@ -1230,11 +1353,17 @@ int dsp_process(struct dsp_config *dsp, char *dst, const char *src[], int count)
         int samples = MIN(sample_buf_count, count);
         count -= samples;
 
+        PROFILE_MARK(mark);
+
         dsp->input_samples(samples, src, tmp);
+        PROFILE_STAGE(dsp, INPUT, samples, mark);
 
 #ifdef HAVE_PITCHSCREEN
         if (dsp->tdspeed_active)
+        {
             samples = tdspeed_doit(tmp, samples);
+            PROFILE_STAGE(dsp, TDSPEED, samples, mark);
+        }
 #endif
         
         int chunk_offset = 0;
@@ -1249,30 +1378,54 @@ int dsp_process(struct dsp_config *dsp, char *dst, const char *src[], int count)
             samples -= chunk;
 
             if (dsp->apply_gain)
+            {
                 dsp->apply_gain(chunk, &dsp->data, t2);
+                PROFILE_STAGE(dsp, GAIN, chunk, mark);
+            }
 
-            if (dsp->resample && (chunk = resample(dsp, chunk, t2)) <= 0)
-                break; /* I'm pretty sure we're downsampling here */
+            if (dsp->resample)
+            {
+                chunk = resample(dsp, chunk, t2);
+                PROFILE_STAGE(dsp, RESAMPLE, chunk, mark);
+                if (chunk <= 0)
+                    break; /* I'm pretty sure we're downsampling here */
+            }
 
             if (dsp->apply_crossfeed)
+            {
                 dsp->apply_crossfeed(chunk, t2);
+                PROFILE_STAGE(dsp, CROSSFEED, chunk, mark);
+            }
 
             if (dsp->eq_process)
+            {
                 dsp->eq_process(chunk, t2);
+                PROFILE_STAGE(dsp, EQ, chunk, mark);
+            }
 
 #ifdef HAVE_SW_TONE_CONTROLS
             if ((bass | treble) != 0)
+            {
                 eq_filter(t2, &dsp->tone_filter, chunk,
                       dsp->data.num_channels, FILTER_BISHELF_SHIFT);
+                PROFILE_STAGE(dsp, TONE, chunk, mark);
+            }
 #endif
 
             if (dsp->channels_process)
+            {
                 dsp->channels_process(chunk, t2);
+                PROFILE_STAGE(dsp, CHANNELS, chunk, mark);
+            }
             
             if (dsp->compressor_process)
+            {
                 dsp->compressor_process(chunk, &dsp->data, t2);
+                PROFILE_STAGE(dsp, COMPRESSOR, chunk, mark);
+            }
 
             dsp->output_samples(chunk, &dsp->data, (const int32_t **)t2, (int16_t *)dst);
+            PROFILE_STAGE(dsp, OUTPUT, chunk, mark);
 
             written += chunk;
             dst += chunk * sizeof (int16_t) * 2;
@@ -1283,6 +1436,7 @@ int dsp_process(struct dsp_config *dsp, char *dst, const char *src[], int count)
             {
                 last_yield = tick;
                 yield();
+                PROFILE_MARK(mark);
             }
         }
     }
@@ -1348,6 +1502,93 @@ int dsp_input_count(struct dsp_config *dsp, int count)
     return count;
 }
 
+/* Returns the number of bytes one input frame occupies if the codec output
+ * can bypass dsp_process() and be written straight into the PCM buffer,
+ * or 0 if any stage would change the samples. Only native rate
+ * interleaved stereo or mono qualifies; the frame size covers the codec's
+ * own sample format, which dsp_process_direct() narrows in place.
+ */
+int dsp_direct_frame_bytes(struct dsp_config *dsp)
+{
+    if (new_gain)
+        dsp_set_replaygain(); /* Gain has changed */
+
+    if (dsp->resample || dsp->apply_gain || dsp->apply_crossfeed ||
+        dsp->eq_process || dsp->channels_process || dsp->compressor_process)
+        return 0;
+
+#ifdef HAVE_PITCHSCREEN
+    if (dsp->tdspeed_active)
+        return 0;
+#endif
+
+#ifdef HAVE_SW_TONE_CONTROLS
+    if ((bass | treble) != 0)
+        return 0;
+#endif
+
+    if (dsp == &AUDIO_DSP && dither_enabled)
+        return 0;
+
+    if (dsp->stereo_mode == STEREO_INTERLEAVED)
+        return 2 * dsp->sample_bytes;
+
+    if (dsp->stereo_mode == STEREO_MONO)
+        return dsp->sample_bytes;
+
+    return 0;
+}
+
+/* Convert count frames written by the codec at buf into interleaved 16-bit
+ * stereo in place. Only valid while dsp_direct_frame_bytes() is nonzero;
+ * buf must be large enough for whichever of the input or output is bigger.
+ * The output is identical to what dsp_process() would produce.
+ */
+void dsp_process_direct(struct dsp_config *dsp, void *buf, int count)
+{
+    if (dsp->sample_depth <= NATIVE_DEPTH)
+    {
+        /* Interleaved stereo is already in output format */
+        if (dsp->stereo_mode == STEREO_MONO)
+        {
+            /* Expand from the end so nothing is overwritten before use */
+            const int16_t *s = (int16_t *)buf + count;
+            int16_t *d = (int16_t *)buf + 2*count;
+
+            while (d > (int16_t *)buf)
+            {
+                int16_t lr = *--s;
+                *--d = lr;
+                *--d = lr;
+            }
+        }
+    }
+    else
+    {
+        /* Output never gets ahead of the input going forwards */
+        const int32_t *s = buf;
+        int16_t *d = buf;
+        const int scale = dsp->data.output_scale;
+        const int dc_bias = 1 << (scale - 1);
+
+        if (dsp->stereo_mode == STEREO_MONO)
+        {
+            while (count-- > 0)
+            {
+                int32_t lr = clip_sample_16((*s++ + dc_bias) >> scale);
+                *d++ = lr;
+                *d++ = lr;
+            }
+        }
+        else
+        {
+            count *= 2;
+            while (count-- > 0)
+                *d++ = clip_sample_16((*s++ + dc_bias) >> scale);
+        }
+    }
+}
+
 static void dsp_set_gain_var(long *var, long value)
 {
     *var = value;
@@ -1378,7 +1619,7 @@ intptr_t dsp_configure(struct dsp_config *dsp, int setting, intptr_t value)
         }
 
     case DSP_SET_FREQUENCY:
-        memset(&dsp->data.resample_data, 0, sizeof (dsp->data.resample_data));
+        resampler_flush(dsp);
         /* Fall through!!! */
     case DSP_SWITCH_FREQUENCY:
         dsp->codec_frequency = (value == 0) ? NATIVE_FREQUENCY : value;
@@ -1461,8 +1702,7 @@ intptr_t dsp_configure(struct dsp_config *dsp, int setting, intptr_t value)
         break;
 
     case DSP_FLUSH:
-        memset(&dsp->data.resample_data, 0,
-               sizeof (dsp->data.resample_data));
+        resampler_flush(dsp);
         resampler_new_delta(dsp);
         dither_init(dsp);
 #ifdef HAVE_PITCHSCREEN
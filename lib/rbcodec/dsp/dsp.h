@@ -97,10 +97,41 @@ struct dsp_data
 
 struct dsp_config;
 
+#ifdef DSP_PROFILE
+/* Stages of dsp_process() that are timed when DSP_PROFILE is defined */
+enum
+{
+    DSP_PROFILE_INPUT = 0,  /* sample_input_* */
+    DSP_PROFILE_TDSPEED,    /* tdspeed_doit */
+    DSP_PROFILE_GAIN,       /* apply_gain */
+    DSP_PROFILE_RESAMPLE,   /* dsp_up/downsample, polyphase_resample */
+    DSP_PROFILE_CROSSFEED,  /* apply_crossfeed */
+    DSP_PROFILE_EQ,         /* eq_process */
+    DSP_PROFILE_TONE,       /* software bass/treble */
+    DSP_PROFILE_CHANNELS,   /* channels_process */
+    DSP_PROFILE_COMPRESSOR, /* compressor_process */
+    DSP_PROFILE_OUTPUT,     /* sample_output_* */
+    DSP_PROFILE_NUM_STAGES
+};
+
+struct dsp_profile_stage
+{
+    uint64_t time;          /* Total time spent in the stage in ns */
+    unsigned long calls;    /* Number of times the stage ran */
+    unsigned long samples;  /* Number of samples the stage output */
+};
+
+void dsp_profile_reset(struct dsp_config *dsp);
+const struct dsp_profile_stage * dsp_profile_get(struct dsp_config *dsp);
+const char * dsp_profile_stage_name(int stage);
+#endif /* DSP_PROFILE */
+
 int dsp_process(struct dsp_config *dsp, char *dest,
                 const char *src[], int count);
 int dsp_input_count(struct dsp_config *dsp, int count);
 int dsp_output_count(struct dsp_config *dsp, int count);
+int dsp_direct_frame_bytes(struct dsp_config *dsp);
+void dsp_process_direct(struct dsp_config *dsp, void *buf, int count);
 intptr_t dsp_configure(struct dsp_config *dsp, int setting,
                        intptr_t value);
 int get_replaygain_mode(bool have_track_gain, bool have_album_gain);
@@ -113,6 +144,7 @@ void dsp_set_eq(bool enable);
 void dsp_set_eq_precut(int precut);
 void dsp_set_eq_coefs(int band);
 void dsp_dither_enable(bool enable);
+void dsp_resampler_hq_enable(bool enable);
 void dsp_timestretch_enable(bool enable);
 bool dsp_timestretch_available(void);
 void sound_set_pitch(int32_t r);
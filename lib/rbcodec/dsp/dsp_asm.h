@@ -43,7 +43,15 @@
 #define DSP_HAVE_ASM_SOUND_CHAN_KARAOKE
 #define DSP_HAVE_ASM_SAMPLE_OUTPUT_MONO
 #define DSP_HAVE_ASM_SAMPLE_OUTPUT_STEREO
-#endif /* CPU_COLDFIRE */
+#elif (CONFIG_PLATFORM & PLATFORM_HOSTED) && defined(__SSE2__)
+/* dsp_sse2.c */
+#define DSP_HAVE_ASM_APPLY_GAIN
+#define DSP_HAVE_ASM_SOUND_CHAN_MONO
+#define DSP_HAVE_ASM_SOUND_CHAN_CUSTOM
+#define DSP_HAVE_ASM_SOUND_CHAN_KARAOKE
+#define DSP_HAVE_ASM_SAMPLE_OUTPUT_MONO
+#define DSP_HAVE_ASM_SAMPLE_OUTPUT_STEREO
+#endif /* CPU_COLDFIRE / SSE2 */
 
 /* Declare prototypes based upon what's #defined above */
 #ifdef DSP_HAVE_ASM_CROSSFEED
@@ -0,0 +1,233 @@
+/***************************************************************************
+ *             __________               __   ___.
+ *   Open      \______   \ ____   ____ |  | _\_ |__   _______  ___
+ *   Source     |       _//  _ \_/ ___\|  |/ /| __ \ /  _ \  \/  /
+ *   Jukebox    |    |   (  <_> )  \___|    < | \_\ (  <_> > <  <
+ *   Firmware   |____|_  /\____/ \___  >__|_ \|___  /\____/__/\_ \
+ *                     \/            \/     \/    \/            \/
+ * $Id$
+ *
+ * Copyright (C) 2012 The Rockbox Project
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This software is distributed on an "AS IS" basis, WITHOUT WARRANTY OF ANY
+ * KIND, either express or implied.
+ *
+ ****************************************************************************/
+
+/* SSE2 versions of the per-sample DSP routines for hosted x86 builds. These
+ * must produce exactly the same output as the generic C versions in dsp.c;
+ * lib/rbcodec/test/dsptest checks that they do.
+ *
+ * Every routine processes four samples at a time and finishes the remainder
+ * with scalar code. The DSP buffers are not guaranteed to be 16-byte aligned
+ * so only unaligned loads and stores are used.
+ */
+#include <emmintrin.h>
+#include <inttypes.h>
+#include "dsp.h"
+#include "dsp_asm.h"
+
+extern long dsp_sw_gain;
+extern long dsp_sw_cross;
+
+/* Full signed 32x32->64 bit products of the even lanes of a and b. SSE2 only
+ * has an unsigned multiply, so subtract what it adds for negative inputs. */
+static inline __m128i mul_even_epi32(__m128i a, __m128i b)
+{
+    __m128i p = _mm_mul_epu32(a, b);
+    __m128i c = _mm_add_epi32(_mm_and_si128(_mm_srai_epi32(a, 31), b),
+                              _mm_and_si128(_mm_srai_epi32(b, 31), a));
+    return _mm_sub_epi64(p, _mm_slli_epi64(c, 32));
+}
+
+/* Four lanes of (int32_t)(((int64_t)a * b) >> shift), shift <= 32 */
+static inline __m128i mul_shr_epi32(__m128i a, __m128i b, __m128i shift)
+{
+    __m128i even = _mm_srl_epi64(mul_even_epi32(a, b), shift);
+    __m128i odd = _mm_srl_epi64(mul_even_epi32(_mm_srli_epi64(a, 32),
+                                                _mm_srli_epi64(b, 32)),
+                                shift);
+    even = _mm_shuffle_epi32(even, _MM_SHUFFLE(3, 1, 2, 0));
+    odd = _mm_shuffle_epi32(odd, _MM_SHUFFLE(3, 1, 2, 0));
+    return _mm_unpacklo_epi32(even, odd);
+}
+
+static inline int32_t mul_shr(int32_t a, int32_t b, int shift)
+{
+    return (int32_t)(((int64_t)a * b) >> shift);
+}
+
+/* Four lanes of x / 2, rounding towards zero like C division */
+static inline __m128i half_epi32(__m128i x)
+{
+    return _mm_srai_epi32(_mm_add_epi32(x, _mm_srli_epi32(x, 31)), 1);
+}
+
+void dsp_apply_gain(int count, struct dsp_data *data, int32_t *buf[])
+{
+    const int32_t gain = data->gain;
+    const __m128i vgain = _mm_set1_epi32(gain);
+    const __m128i shift = _mm_cvtsi32_si128(23);
+    int ch;
+
+    for (ch = 0; ch < data->num_channels; ch++)
+    {
+        int32_t *d = buf[ch];
+        int i;
+
+        for (i = 0; i < (count & ~3); i += 4)
+        {
+            __m128i x = _mm_loadu_si128((__m128i *)&d[i]);
+            x = mul_shr_epi32(x, vgain, shift);
+            _mm_storeu_si128((__m128i *)&d[i], x);
+        }
+
+        for (; i < count; i++)
+            d[i] = mul_shr(d[i], gain, 23);
+    }
+}
+
+void channels_process_sound_chan_mono(int count, int32_t *buf[])
+{
+    int32_t *sl = buf[0], *sr = buf[1];
+    int i;
+
+    for (i = 0; i < (count & ~3); i += 4)
+    {
+        __m128i l = _mm_loadu_si128((__m128i *)&sl[i]);
+        __m128i r = _mm_loadu_si128((__m128i *)&sr[i]);
+        __m128i lr = _mm_add_epi32(half_epi32(l), half_epi32(r));
+        _mm_storeu_si128((__m128i *)&sl[i], lr);
+        _mm_storeu_si128((__m128i *)&sr[i], lr);
+    }
+
+    for (; i < count; i++)
+    {
+        int32_t lr = sl[i]/2 + sr[i]/2;
+        sl[i] = lr;
+        sr[i] = lr;
+    }
+}
+
+void channels_process_sound_chan_custom(int count, int32_t *buf[])
+{
+    const int32_t gain  = dsp_sw_gain;
+    const int32_t cross = dsp_sw_cross;
+    const __m128i vgain = _mm_set1_epi32(gain);
+    const __m128i vcross = _mm_set1_epi32(cross);
+    const __m128i shift = _mm_cvtsi32_si128(31);
+    int32_t *sl = buf[0], *sr = buf[1];
+    int i;
+
+    for (i = 0; i < (count & ~3); i += 4)
+    {
+        __m128i l = _mm_loadu_si128((__m128i *)&sl[i]);
+        __m128i r = _mm_loadu_si128((__m128i *)&sr[i]);
+        _mm_storeu_si128((__m128i *)&sl[i],
+                         _mm_add_epi32(mul_shr_epi32(l, vgain, shift),
+                                       mul_shr_epi32(r, vcross, shift)));
+        _mm_storeu_si128((__m128i *)&sr[i],
+                         _mm_add_epi32(mul_shr_epi32(r, vgain, shift),
+                                       mul_shr_epi32(l, vcross, shift)));
+    }
+
+    for (; i < count; i++)
+    {
+        int32_t l = sl[i];
+        int32_t r = sr[i];
+        sl[i] = mul_shr(l, gain, 31) + mul_shr(r, cross, 31);
+        sr[i] = mul_shr(r, gain, 31) + mul_shr(l, cross, 31);
+    }
+}
+
+void channels_process_sound_chan_karaoke(int count, int32_t *buf[])
+{
+    int32_t *sl = buf[0], *sr = buf[1];
+    int i;
+
+    for (i = 0; i < (count & ~3); i += 4)
+    {
+        __m128i l = _mm_loadu_si128((__m128i *)&sl[i]);
+        __m128i r = _mm_loadu_si128((__m128i *)&sr[i]);
+        __m128i ch = _mm_sub_epi32(half_epi32(l), half_epi32(r));
+        _mm_storeu_si128((__m128i *)&sl[i], ch);
+        _mm_storeu_si128((__m128i *)&sr[i],
+                         _mm_sub_epi32(_mm_setzero_si128(), ch));
+    }
+
+    for (; i < count; i++)
+    {
+        int32_t ch = sl[i]/2 - sr[i]/2;
+        sl[i] = ch;
+        sr[i] = -ch;
+    }
+}
+
+/* _mm_packs_epi32 saturates exactly like clip_sample_16() */
+static inline int16_t clip16(int32_t sample)
+{
+    if ((int16_t)sample != sample)
+        sample = 0x7fff ^ (sample >> 31);
+    return sample;
+}
+
+void sample_output_mono(int count, struct dsp_data *data,
+                        const int32_t *src[], int16_t *dst)
+{
+    const int32_t *s0 = src[0];
+    const int scale = data->output_scale;
+    const int dc_bias = 1 << (scale - 1);
+    const __m128i vbias = _mm_set1_epi32(dc_bias);
+    const __m128i vscale = _mm_cvtsi32_si128(scale);
+    int i;
+
+    for (i = 0; i < (count & ~3); i += 4)
+    {
+        __m128i x = _mm_loadu_si128((const __m128i *)&s0[i]);
+        x = _mm_sra_epi32(_mm_add_epi32(x, vbias), vscale);
+        _mm_storeu_si128((__m128i *)&dst[2*i],
+                         _mm_packs_epi32(_mm_unpacklo_epi32(x, x),
+                                         _mm_unpackhi_epi32(x, x)));
+    }
+
+    for (; i < count; i++)
+    {
+        int16_t lr = clip16((s0[i] + dc_bias) >> scale);
+        dst[2*i + 0] = lr;
+        dst[2*i + 1] = lr;
+    }
+}
+
+void sample_output_stereo(int count, struct dsp_data *data,
+                          const int32_t *src[], int16_t *dst)
+{
+    const int32_t *s0 = src[0];
+    const int32_t *s1 = src[1];
+    const int scale = data->output_scale;
+    const int dc_bias = 1 << (scale - 1);
+    const __m128i vbias = _mm_set1_epi32(dc_bias);
+    const __m128i vscale = _mm_cvtsi32_si128(scale);
+    int i;
+
+    for (i = 0; i < (count & ~3); i += 4)
+    {
+        __m128i l = _mm_loadu_si128((const __m128i *)&s0[i]);
+        __m128i r = _mm_loadu_si128((const __m128i *)&s1[i]);
+        l = _mm_sra_epi32(_mm_add_epi32(l, vbias), vscale);
+        r = _mm_sra_epi32(_mm_add_epi32(r, vbias), vscale);
+        _mm_storeu_si128((__m128i *)&dst[2*i],
+                         _mm_packs_epi32(_mm_unpacklo_epi32(l, r),
+                                         _mm_unpackhi_epi32(l, r)));
+    }
+
+    for (; i < count; i++)
+    {
+        dst[2*i + 0] = clip16((s0[i] + dc_bias) >> scale);
+        dst[2*i + 1] = clip16((s1[i] + dc_bias) >> scale);
+    }
+}
@@ -249,6 +249,47 @@ void eq_filter(int32_t **x, struct eqfilter *f, unsigned num,
        where y[] is output and x[] is input.
      */
 
+    if (channels == 2)
+    {
+        /* Filter both channels in one pass. The two recursions don't depend
+           on each other, so a superscalar cpu can overlap their multiplies
+           instead of waiting on the previous output of a single channel. */
+        const int32_t b0 = f->coefs[0], b1 = f->coefs[1], b2 = f->coefs[2];
+        const int32_t a1 = f->coefs[3], a2 = f->coefs[4];
+        int32_t *xl = x[0], *xr = x[1];
+        int32_t xl1 = f->history[0][0], xl2 = f->history[0][1];
+        int32_t yl1 = f->history[0][2], yl2 = f->history[0][3];
+        int32_t xr1 = f->history[1][0], xr2 = f->history[1][1];
+        int32_t yr1 = f->history[1][2], yr2 = f->history[1][3];
+
+        for (i = 0; i < num; i++) {
+            long long accl, accr;
+            int32_t xl0 = xl[i], xr0 = xr[i];
+
+            accl  = (long long) xl0 * b0;
+            accr  = (long long) xr0 * b0;
+            accl += (long long) xl1 * b1;
+            accr += (long long) xr1 * b1;
+            accl += (long long) xl2 * b2;
+            accr += (long long) xr2 * b2;
+            accl += (long long) yl1 * a1;
+            accr += (long long) yr1 * a1;
+            accl += (long long) yl2 * a2;
+            accr += (long long) yr2 * a2;
+
+            xl2 = xl1; xl1 = xl0;
+            xr2 = xr1; xr1 = xr0;
+            yl2 = yl1; yl1 = xl[i] = (accl << shift) >> 32;
+            yr2 = yr1; yr1 = xr[i] = (accr << shift) >> 32;
+        }
+
+        f->history[0][0] = xl1; f->history[0][1] = xl2;
+        f->history[0][2] = yl1; f->history[0][3] = yl2;
+        f->history[1][0] = xr1; f->history[1][1] = xr2;
+        f->history[1][2] = yr1; f->history[1][3] = yr2;
+        return;
+    }
+
     for (c = 0; c < channels; c++) {
         for (i = 0; i < num; i++) {
             acc  = (long long) x[c][i] * f->coefs[0];
@@ -265,4 +306,3 @@ void eq_filter(int32_t **x, struct eqfilter *f, unsigned num,
     }
 }
 #endif
-
@@ -0,0 +1,152 @@
+/***************************************************************************
+ *             __________               __   ___.
+ *   Open      \______   \ ____   ____ |  | _\_ |__   _______  ___
+ *   Source     |       _//  _ \_/ ___\|  |/ /| __ \ /  _ \  \/  /
+ *   Jukebox    |    |   (  <_> )  \___|    < | \_\ (  <_> > <  <
+ *   Firmware   |____|_  /\____/ \___  >__|_ \|___  /\____/__/\_ \
+ *                     \/            \/     \/    \/            \/
+ * $Id$
+ *
+ * Copyright (C) 2012 The Rockbox Project
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This software is distributed on an "AS IS" basis, WITHOUT WARRANTY OF ANY
+ * KIND, either express or implied.
+ *
+ ****************************************************************************/
+
+#include <inttypes.h>
+#include <string.h>
+#include "config.h"
+#include "polyphase.h"
+
+/* Band-limited resampler for the audio DSP.
+ *
+ * Each output sample is a FIR filter over the last 'taps' input samples,
+ * using the two coefficient rows nearest to the output's fractional position
+ * and interpolating linearly between their results. It follows the same
+ * 16.16 phase accounting as dsp_upsample()/dsp_downsample() so the sample
+ * counts seen by dsp_process() are identical; the only difference is an
+ * extra delay of taps/2 input samples.
+ *
+ * Input is handled in blocks of at most POLYPHASE_BLOCK samples appended to
+ * the history, so the cost per output sample is always 2 * taps multiplies
+ * per channel no matter how the codec chunks its output.
+ */
+
+#define POLYPHASE_BLOCK 256
+
+struct polyphase_table
+{
+    long frequency;         /* Highest input frequency the table is for */
+    int taps;
+    const int16_t *coefs;   /* [(1 << POLYPHASE_PHASE_BITS) + 1][taps] */
+};
+
+#include "polyphase_coefs.h"
+
+/* Fraction bits of the phase between two coefficient rows */
+#define POLYPHASE_INTERP_BITS (16 - POLYPHASE_PHASE_BITS)
+
+#define NUM_TABLES (sizeof (polyphase_tables) / sizeof (polyphase_tables[0]))
+
+static const struct polyphase_table *cur_table = &polyphase_tables[0];
+
+/* The last POLYPHASE_MAX_TAPS input samples followed by the current block.
+ * Keeping the longest history regardless of the table in use makes switching
+ * tables on a pitch change seamless. */
+static int32_t history[2][POLYPHASE_MAX_TAPS + POLYPHASE_BLOCK];
+
+/* Picks the table for resampling from frequency to NATIVE_FREQUENCY. Returns
+ * false if the ratio is beyond what the tables cover. */
+bool polyphase_set_frequency(long frequency)
+{
+    unsigned i;
+
+    for (i = 0; i < NUM_TABLES; i++)
+    {
+        if (frequency <= polyphase_tables[i].frequency)
+        {
+            cur_table = &polyphase_tables[i];
+            return true;
+        }
+    }
+
+    return false;
+}
+
+void polyphase_flush(void)
+{
+    memset(history, 0, sizeof (history));
+}
+
+int polyphase_resample(int count, struct dsp_data *data,
+                       const int32_t *src[], int32_t *dst[])
+{
+    const int taps = cur_table->taps;
+    const uint32_t delta = data->resample_data.delta;
+    uint32_t phase = data->resample_data.phase;
+    int done = 0, out = 0;
+
+    while (done < count)
+    {
+        int n = count - done;
+        int ch = data->num_channels - 1;
+        uint32_t p, pos;
+        int32_t *d;
+
+        if (n > POLYPHASE_BLOCK)
+            n = POLYPHASE_BLOCK;
+
+        do
+        {
+            int32_t *h = history[ch];
+
+            memcpy(&h[POLYPHASE_MAX_TAPS], &src[ch][done],
+                   n * sizeof (int32_t));
+
+            d = &dst[ch][out];
+            p = phase;
+            pos = p >> 16;
+
+            while (pos < (uint32_t)n)
+            {
+                /* Input sample pos - 1 is the newest one the filter uses */
+                const int32_t *x = &h[POLYPHASE_MAX_TAPS - taps + pos];
+                const int16_t *c0 = cur_table->coefs +
+                    ((p & 0xffff) >> POLYPHASE_INTERP_BITS) * taps;
+                const int16_t *c1 = c0 + taps;
+                int32_t w = p & ((1 << POLYPHASE_INTERP_BITS) - 1);
+                int64_t a = 0, b = 0;
+                int k;
+
+                for (k = 0; k < taps; k++)
+                {
+                    a += (int64_t)x[k] * c0[k];
+                    b += (int64_t)x[k] * c1[k];
+                }
+
+                a += ((b - a) * w) >> POLYPHASE_INTERP_BITS;
+                *d++ = a >> POLYPHASE_COEF_BITS;
+
+                p += delta;
+                pos = p >> 16;
+            }
+
+            memmove(h, &h[n], POLYPHASE_MAX_TAPS * sizeof (int32_t));
+        }
+        while (--ch >= 0);
+
+        /* Wrap phase accumulator back to start of next block. */
+        phase = p - (n << 16);
+        out = d - dst[0];
+        done += n;
+    }
+
+    data->resample_data.phase = phase;
+    return out;
+}
@@ -0,0 +1,1794 @@
+/* Generated by tools/mkpolyphase.py - do not edit */
+
+#define POLYPHASE_PHASE_BITS 5
+#define POLYPHASE_COEF_BITS  14
+#define POLYPHASE_MAX_TAPS   112
+
+/* 44100 Hz, 32 taps, ~52 dB */
+static const int16_t coefs_44100[33][32] =
+{
+    {
+           -27,    44,   -58,    63,   -47,     0,    86,  -217,   393,  -606,
+           843, -1084,  1305, -1484,  1600, 14762,  1600, -1484,  1305, -1084,
+           843,  -606,   393,  -217,    86,     0,   -47,    63,   -58,    44,
+           -27,     0,
+    },
+    {
+           -27,    42,   -54,    54,   -33,   -18,   108,  -240,   413,  -615,
+           831, -1037,  1201, -1275,  1123, 14731,  2093, -1685,  1399, -1121,
+           847,  -591,   369,  -191,    63,    18,   -60,    71,   -63,    46,
+           -28,    13,
+    },
+    {
+           -26,    40,   -49,    45,   -20,   -36,   129,  -261,   429,  -620,
+           814,  -984,  1091, -1065,   666, 14674,  2604, -1881,  1486, -1150,
+           844,  -571,   342,  -164,    39,    37,   -72,    78,   -67,    47,
+           -28,    13,
+    },
+    {
+           -25,    37,   -44,    37,    -7,   -53,   148,  -280,   442,  -620,
+           791,  -925,   975,  -853,   232, 14578,  3130, -2068,  1562, -1172,
+           835,  -547,   312,  -135,    14,    56,   -85,    86,   -70,    48,
+           -28,    13,
+    },
+    {
+           -24,    34,   -38,    28,     6,   -69,   166,  -296,   451,  -615,
+           762,  -859,   854,  -642,  -180, 14443,  3668, -2246,  1629, -1184,
+           819,  -517,   279,  -104,   -11,    74,   -97,    93,   -73,    49,
+           -28,    12,
+    },
+    {
+           -23,    31,   -32,    19,    18,   -84,   183,  -310,   457,  -605,
+           728,  -788,   729,  -431,  -568, 14271,  4216, -2412,  1684, -1188,
+           797,  -484,   243,   -71,   -37,    93,  -109,    99,   -76,    50,
+           -27,    11,
+    },
+    {
+           -21,    28,   -27,    10,    30,   -99,   197,  -321,   459,  -591,
+           689,  -713,   602,  -225,  -930, 14064,  4773, -2565,  1727, -1181,
+           767,  -445,   205,   -38,   -63,   111,  -120,   104,   -78,    50,
+           -26,    11,
+    },
+    {
+           -20,    25,   -21,     1,    42,  -112,   210,  -329,   457,  -572,
+           645,  -633,   473,   -22, -1267, 13822,  5336, -2703,  1757, -1166,
+           731,  -403,   164,    -4,   -89,   128,  -130,   109,   -79,    49,
+           -25,    10,
+    },
+    {
+           -18,    21,   -15,    -8,    53,  -124,   221,  -335,   452,  -549,
+           596,  -550,   343,   174, -1576, 13545,  5903, -2825,  1774, -1141,
+           689,  -356,   121,    31,  -114,   145,  -139,   113,   -80,    48,
+           -24,     9,
+    },
+    {
+           -16,    18,    -9,   -16,    63,  -135,   230,  -338,   443,  -523,
+           544,  -464,   213,   364, -1858, 13235,  6471, -2929,  1778, -1106,
+           640,  -306,    77,    66,  -140,   161,  -148,   116,   -80,    47,
+           -22,     8,
+    },
+    {
+           -14,    15,    -4,   -24,    73,  -145,   237,  -338,   431,  -492,
+           489,  -376,    84,   545, -2112, 12893,  7038, -3013,  1767, -1062,
+           585,  -253,    31,   102,  -164,   176,  -155,   119,   -79,    45,
+           -21,     6,
+    },
+    {
+           -13,    11,     2,   -32,    82,  -154,   242,  -335,   416,  -459,
+           431,  -287,   -42,   716, -2338, 12525,  7602, -3077,  1742, -1008,
+           525,  -197,   -16,   137,  -188,   190,  -162,   120,   -78,    43,
+           -19,     5,
+    },
+    {
+           -11,     8,     7,   -39,    90,  -161,   245,  -330,   398,  -422,
+           370,  -198,  -165,   877, -2535, 12123,  8160, -3118,  1703,  -945,
+           459,  -138,   -63,   171,  -210,   202,  -167,   121,   -76,    41,
+           -17,     4,
+    },
+    {
+            -9,     4,    12,   -45,    97,  -166,   246,  -323,   377,  -383,
+           307,  -108,  -284,  1027, -2703, 11699,  8709, -3136,  1649,  -874,
+           389,   -77,  -111,   205,  -232,   213,  -171,   120,   -74,    38,
+           -14,     2,
+    },
+    {
+            -7,     1,    17,   -52,   104,  -171,   245,  -313,   353,  -341,
+           244,   -20,  -399,  1164, -2844, 11250,  9248, -3130,  1580,  -794,
+           314,   -14,  -159,   238,  -251,   223,  -173,   119,   -71,    34,
+           -11,     0,
+    },
+    {
+            -5,    -3,    22,   -57,   109,  -173,   242,  -300,   327,  -297,
+           179,    68,  -507,  1289, -2956, 10776,  9773, -3099,  1497,  -706,
+           235,    50,  -206,   269,  -270,   231,  -175,   117,   -67,    31,
+            -9,    -1,
+    },
+    {
+            -3,    -6,    27,   -62,   113,  -175,   238,  -286,   299,  -252,
+           114,   153,  -610,  1400, -3041, 10282, 10284, -3041,  1400,  -610,
+           153,   114,  -252,   299,  -286,   238,  -175,   113,   -62,    27,
+            -6,    -3,
+    },
+    {
+            -1,    -9,    31,   -67,   117,  -175,   231,  -270,   269,  -206,
+            50,   235,  -706,  1497, -3099,  9773, 10776, -2956,  1289,  -507,
+            68,   179,  -297,   327,  -300,   242,  -173,   109,   -57,    22,
+            -3,    -5,
+    },
+    {
+             0,   -11,    34,   -71,   119,  -173,   223,  -251,   238,  -159,
+           -14,   314,  -794,  1580, -3130,  9250, 11248, -2844,  1164,  -399,
+           -20,   244,  -341,   353,  -313,   245,  -171,   104,   -52,    17,
+             1,    -7,
+    },
+    {
+             2,   -14,    38,   -74,   120,  -171,   213,  -232,   205,  -111,
+           -77,   389,  -874,  1649, -3136,  8710, 11698, -2703,  1027,  -284,
+          -108,   307,  -383,   377,  -323,   246,  -166,    97,   -45,    12,
+             4,    -9,
+    },
+    {
+             4,   -17,    41,   -76,   121,  -167,   202,  -210,   171,   -63,
+          -138,   459,  -945,  1703, -3118,  8160, 12123, -2535,   877,  -165,
+          -198,   370,  -422,   398,  -330,   245,  -161,    90,   -39,     7,
+             8,   -11,
+    },
+    {
+             5,   -19,    43,   -78,   120,  -162,   190,  -188,   137,   -16,
+          -197,   525, -1008,  1742, -3077,  7604, 12523, -2338,   716,   -42,
+          -287,   431,  -459,   416,  -335,   242,  -154,    82,   -32,     2,
+            11,   -13,
+    },
+    {
+             6,   -21,    45,   -79,   119,  -155,   176,  -164,   102,    31,
+          -253,   585, -1062,  1767, -3013,  7037, 12894, -2112,   545,    84,
+          -376,   489,  -492,   431,  -338,   237,  -145,    73,   -24,    -4,
+            15,   -14,
+    },
+    {
+             8,   -22,    47,   -80,   116,  -148,   161,  -140,    66,    77,
+          -306,   640, -1106,  1778, -2929,  6470, 13236, -1858,   364,   213,
+          -464,   544,  -523,   443,  -338,   230,  -135,    63,   -16,    -9,
+            18,   -16,
+    },
+    {
+             9,   -24,    48,   -80,   113,  -139,   145,  -114,    31,   121,
+          -356,   689, -1141,  1774, -2825,  5903, 13545, -1576,   174,   343,
+          -550,   596,  -549,   452,  -335,   221,  -124,    53,    -8,   -15,
+            21,   -18,
+    },
+    {
+            10,   -25,    49,   -79,   109,  -130,   128,   -89,    -4,   164,
+          -403,   731, -1166,  1757, -2703,  5336, 13822, -1267,   -22,   473,
+          -633,   645,  -572,   457,  -329,   210,  -112,    42,     1,   -21,
+            25,   -20,
+    },
+    {
+            11,   -26,    50,   -78,   104,  -120,   111,   -63,   -38,   205,
+          -445,   767, -1181,  1727, -2565,  4772, 14065,  -930,  -225,   602,
+          -713,   689,  -591,   459,  -321,   197,   -99,    30,    10,   -27,
+            28,   -21,
+    },
+    {
+            11,   -27,    50,   -76,    99,  -109,    93,   -37,   -71,   243,
+          -484,   797, -1188,  1684, -2412,  4214, 14273,  -568,  -431,   729,
+          -788,   728,  -605,   457,  -310,   183,   -84,    18,    19,   -32,
+            31,   -23,
+    },
+    {
+            12,   -28,    49,   -73,    93,   -97,    74,   -11,  -104,   279,
+          -517,   819, -1184,  1629, -2246,  3667, 14444,  -180,  -642,   854,
+          -859,   762,  -615,   451,  -296,   166,   -69,     6,    28,   -38,
+            34,   -24,
+    },
+    {
+            13,   -28,    48,   -70,    86,   -85,    56,    14,  -135,   312,
+          -547,   835, -1172,  1562, -2068,  3130, 14578,   232,  -853,   975,
+          -925,   791,  -620,   442,  -280,   148,   -53,    -7,    37,   -44,
+            37,   -25,
+    },
+    {
+            13,   -28,    47,   -67,    78,   -72,    37,    39,  -164,   342,
+          -571,   844, -1150,  1486, -1881,  2604, 14674,   666, -1065,  1091,
+          -984,   814,  -620,   429,  -261,   129,   -36,   -20,    45,   -49,
+            40,   -26,
+    },
+    {
+            13,   -28,    46,   -63,    71,   -60,    18,    63,  -191,   369,
+          -591,   847, -1121,  1399, -1685,  2092, 14732,  1123, -1275,  1201,
+         -1037,   831,  -615,   413,  -240,   108,   -18,   -33,    54,   -54,
+            42,   -27,
+    },
+    {
+             0,   -27,    44,   -58,    63,   -47,     0,    86,  -217,   393,
+          -606,   843, -1084,  1305, -1484,  1599, 14763,  1600, -1484,  1305,
+         -1084,   843,  -606,   393,  -217,    86,     0,   -47,    63,   -58,
+            44,   -27,
+    },
+};
+
+/* 48000 Hz, 32 taps, ~64 dB */
+static const int16_t coefs_48000[33][32] =
+{
+    {
+            -7,    10,    -7,    -5,    34,   -86,   165,  -275,   414,  -577,
+           754,  -930,  1091, -1219,  1303, 15054,  1303, -1219,  1091,  -930,
+           754,  -577,   414,  -275,   165,   -86,    34,    -5,    -7,    10,
+            -7,     0,
+    },
+    {
+            -6,     8,    -3,   -11,    42,   -96,   176,  -283,   416,  -567,
+           723,  -866,   972, -1001,   821, 15033,  1804, -1435,  1203,  -988,
+           779,  -582,   408,  -264,   153,   -75,    25,     1,   -11,    12,
+            -8,     4,
+    },
+    {
+            -5,     6,     0,   -17,    50,  -105,   185,  -289,   415,  -553,
+           687,  -796,   848,  -782,   363, 14971,  2325, -1646,  1309, -1039,
+           798,  -583,   399,  -250,   139,   -63,    16,     7,   -15,    14,
+            -9,     4,
+    },
+    {
+            -4,     3,     4,   -22,    57,  -113,   192,  -293,   411,  -534,
+           646,  -721,   720,  -564,   -72, 14869,  2863, -1851,  1406, -1083,
+           811,  -578,   386,  -234,   124,   -50,     7,    13,   -19,    16,
+           -10,     4,
+    },
+    {
+            -3,     2,     7,   -27,    63,  -120,   197,  -294,   403,  -512,
+           600,  -641,   590,  -348,  -482, 14726,  3415, -2047,  1495, -1118,
+           817,  -569,   369,  -216,   107,   -37,    -3,    20,   -22,    18,
+           -11,     5,
+    },
+    {
+            -2,     0,    10,   -32,    69,  -125,   201,  -293,   392,  -485,
+           551,  -558,   458,  -137,  -864, 14543,  3980, -2234,  1573, -1145,
+           817,  -555,   349,  -196,    89,   -22,   -13,    26,   -26,    20,
+           -12,     5,
+    },
+    {
+            -1,    -2,    13,   -36,    74,  -130,   203,  -289,   379,  -456,
+           498,  -473,   325,    69, -1220, 14325,  4555, -2409,  1640, -1163,
+           810,  -536,   326,  -174,    70,    -8,   -23,    33,   -30,    21,
+           -12,     5,
+    },
+    {
+            -1,    -4,    16,   -40,    78,  -133,   203,  -283,   362,  -423,
+           442,  -385,   193,   268, -1546, 14067,  5138, -2571,  1695, -1172,
+           796,  -512,   300,  -149,    50,     7,   -33,    39,   -33,    23,
+           -13,     5,
+    },
+    {
+             0,    -6,    19,   -43,    82,  -135,   202,  -275,   343,  -387,
+           383,  -296,    63,   459, -1844, 13771,  5727, -2717,  1738, -1172,
+           776,  -484,   271,  -123,    29,    22,   -44,    45,   -37,    25,
+           -14,     6,
+    },
+    {
+             1,    -7,    21,   -46,    84,  -137,   199,  -265,   321,  -349,
+           323,  -206,   -65,   640, -2111, 13443,  6318, -2847,  1767, -1161,
+           748,  -451,   239,   -96,     8,    38,   -54,    51,   -40,    26,
+           -14,     6,
+    },
+    {
+             2,    -9,    23,   -48,    86,  -136,   195,  -253,   297,  -309,
+           261,  -117,  -189,   811, -2349, 13078,  6910, -2957,  1783, -1141,
+           714,  -413,   204,   -67,   -14,    53,   -64,    57,   -43,    27,
+           -14,     6,
+    },
+    {
+             3,   -10,    25,   -50,    87,  -135,   189,  -239,   271,  -267,
+           198,   -28,  -309,   970, -2557, 12686,  7499, -3048,  1784, -1111,
+           673,  -372,   167,   -37,   -37,    69,   -73,    62,   -45,    28,
+           -15,     6,
+    },
+    {
+             3,   -11,    26,   -52,    88,  -133,   181,  -223,   244,  -223,
+           135,    59,  -424,  1116, -2734, 12262,  8083, -3116,  1770, -1071,
+           626,  -326,   128,    -6,   -59,    84,   -82,    67,   -48,    29,
+           -15,     6,
+    },
+    {
+             4,   -12,    28,   -53,    88,  -130,   173,  -206,   215,  -179,
+            72,   144,  -532,  1250, -2881, 11807,  8659, -3162,  1742, -1021,
+           572,  -277,    87,    26,   -82,    99,   -91,    72,   -49,    30,
+           -15,     6,
+    },
+    {
+             4,   -13,    29,   -53,    87,  -125,   163,  -188,   185,  -134,
+             9,   226,  -634,  1369, -2998, 11330,  9225, -3182,  1698,  -961,
+           513,  -225,    45,    58,  -104,   113,   -99,    76,   -51,    30,
+           -15,     6,
+    },
+    {
+             5,   -13,    29,   -53,    85,  -120,   152,  -168,   154,   -89,
+           -52,   304,  -729,  1474, -3086, 10833,  9778, -3177,  1638,  -893,
+           448,  -170,     1,    90,  -126,   127,  -107,    80,   -52,    30,
+           -14,     5,
+    },
+    {
+             5,   -14,    30,   -53,    83,  -114,   139,  -147,   122,   -44,
+          -112,   378,  -815,  1563, -3146, 10318, 10316, -3146,  1563,  -815,
+           378,  -112,   -44,   122,  -147,   139,  -114,    83,   -53,    30,
+           -14,     5,
+    },
+    {
+             5,   -14,    30,   -52,    80,  -107,   127,  -126,    90,     1,
+          -170,   448,  -893,  1638, -3177,  9776, 10835, -3086,  1474,  -729,
+           304,   -52,   -89,   154,  -168,   152,  -120,    85,   -53,    29,
+           -13,     5,
+    },
+    {
+             6,   -15,    30,   -51,    76,   -99,   113,  -104,    58,    45,
+          -225,   513,  -961,  1698, -3182,  9221, 11334, -2998,  1369,  -634,
+           226,     9,  -134,   185,  -188,   163,  -125,    87,   -53,    29,
+           -13,     4,
+    },
+    {
+             6,   -15,    30,   -49,    72,   -91,    99,   -82,    26,    87,
+          -277,   572, -1021,  1742, -3162,  8656, 11810, -2881,  1250,  -532,
+           144,    72,  -179,   215,  -206,   173,  -130,    88,   -53,    28,
+           -12,     4,
+    },
+    {
+             6,   -15,    29,   -48,    67,   -82,    84,   -59,    -6,   128,
+          -326,   626, -1071,  1770, -3116,  8084, 12261, -2734,  1116,  -424,
+            59,   135,  -223,   244,  -223,   181,  -133,    88,   -52,    26,
+           -11,     3,
+    },
+    {
+             6,   -15,    28,   -45,    62,   -73,    69,   -37,   -37,   167,
+          -372,   673, -1111,  1784, -3048,  7501, 12684, -2557,   970,  -309,
+           -28,   198,  -267,   271,  -239,   189,  -135,    87,   -50,    25,
+           -10,     3,
+    },
+    {
+             6,   -14,    27,   -43,    57,   -64,    53,   -14,   -67,   204,
+          -413,   714, -1141,  1783, -2957,  6910, 13078, -2349,   811,  -189,
+          -117,   261,  -309,   297,  -253,   195,  -136,    86,   -48,    23,
+            -9,     2,
+    },
+    {
+             6,   -14,    26,   -40,    51,   -54,    38,     8,   -96,   239,
+          -451,   748, -1161,  1767, -2847,  6320, 13441, -2111,   640,   -65,
+          -206,   323,  -349,   321,  -265,   199,  -137,    84,   -46,    21,
+            -7,     1,
+    },
+    {
+             6,   -14,    25,   -37,    45,   -44,    22,    29,  -123,   271,
+          -484,   776, -1172,  1738, -2717,  5728, 13770, -1844,   459,    63,
+          -296,   383,  -387,   343,  -275,   202,  -135,    82,   -43,    19,
+            -6,     0,
+    },
+    {
+             5,   -13,    23,   -33,    39,   -33,     7,    50,  -149,   300,
+          -512,   796, -1172,  1695, -2571,  5140, 14065, -1546,   268,   193,
+          -385,   442,  -423,   362,  -283,   203,  -133,    78,   -40,    16,
+            -4,    -1,
+    },
+    {
+             5,   -12,    21,   -30,    33,   -23,    -8,    70,  -174,   326,
+          -536,   810, -1163,  1640, -2409,  4557, 14323, -1220,    69,   325,
+          -473,   498,  -456,   379,  -289,   203,  -130,    74,   -36,    13,
+            -2,    -1,
+    },
+    {
+             5,   -12,    20,   -26,    26,   -13,   -22,    89,  -196,   349,
+          -555,   817, -1145,  1573, -2234,  3979, 14544,  -864,  -137,   458,
+          -558,   551,  -485,   392,  -293,   201,  -125,    69,   -32,    10,
+             0,    -2,
+    },
+    {
+             5,   -11,    18,   -22,    20,    -3,   -37,   107,  -216,   369,
+          -569,   817, -1118,  1495, -2047,  3415, 14726,  -482,  -348,   590,
+          -641,   600,  -512,   403,  -294,   197,  -120,    63,   -27,     7,
+             2,    -3,
+    },
+    {
+             4,   -10,    16,   -19,    13,     7,   -50,   124,  -234,   386,
+          -578,   811, -1083,  1406, -1851,  2863, 14869,   -72,  -564,   720,
+          -721,   646,  -534,   411,  -293,   192,  -113,    57,   -22,     4,
+             3,    -4,
+    },
+    {
+             4,    -9,    14,   -15,     7,    16,   -63,   139,  -250,   399,
+          -583,   798, -1039,  1309, -1646,  2324, 14972,   363,  -782,   848,
+          -796,   687,  -553,   415,  -289,   185,  -105,    50,   -17,     0,
+             6,    -5,
+    },
+    {
+             4,    -8,    12,   -11,     1,    25,   -75,   153,  -264,   408,
+          -582,   779,  -988,  1203, -1435,  1803, 15034,   821, -1001,   972,
+          -866,   723,  -567,   416,  -283,   176,   -96,    42,   -11,    -3,
+             8,    -6,
+    },
+    {
+             0,    -7,    10,    -7,    -5,    34,   -86,   165,  -275,   414,
+          -577,   754,  -930,  1091, -1219,  1299, 15058,  1303, -1219,  1091,
+          -930,   754,  -577,   414,  -275,   165,   -86,    34,    -5,    -7,
+            10,    -7,
+    },
+};
+
+/* 88200 Hz, 48 taps, ~54 dB */
+static const int16_t coefs_88200[33][48] =
+{
+    {
+           -13,     0,    27,     0,   -50,     0,    84,     0,  -131,     0,
+           196,     0,  -288,     0,   417,     0,  -612,     0,   945,     0,
+         -1678,     0,  5197,  8196,  5197,     0, -1678,     0,   945,     0,
+          -612,     0,   417,     0,  -288,     0,   196,     0,  -131,     0,
+            84,     0,   -50,     0,    27,     0,   -13,     0,
+    },
+    {
+           -12,    -1,    27,     2,   -50,    -3,    83,     5,  -130,    -8,
+           195,    12,  -286,   -17,   414,    25,  -608,   -37,   937,    60,
+         -1658,  -124,  5032,  8193,  5359,   128, -1695,   -61,   951,    37,
+          -615,   -25,   419,    17,  -289,   -12,   197,     8,  -132,    -5,
+            84,     3,   -50,    -2,    28,     1,   -13,     0,
+    },
+    {
+           -12,    -2,    27,     4,   -49,    -6,    82,    10,  -128,   -16,
+           193,    23,  -283,   -34,   410,    49,  -602,   -73,   926,   118,
+         -1634,  -244,  4865,  8183,  5520,   260, -1708,  -122,   955,    75,
+          -617,   -50,   420,    34,  -290,   -24,   198,    16,  -132,   -10,
+            84,     7,   -51,    -4,    28,     2,   -13,    -1,
+    },
+    {
+           -12,    -3,    26,     5,   -48,    -9,    81,    15,  -127,   -23,
+           191,    34,  -280,   -50,   405,    73,  -595,  -108,   914,   175,
+         -1606,  -359,  4697,  8166,  5677,   396, -1718,  -185,   956,   113,
+          -617,   -75,   420,    52,  -290,   -36,   198,    24,  -132,   -16,
+            85,    10,   -51,    -6,    28,     3,   -13,    -1,
+    },
+    {
+           -12,    -4,    26,     7,   -47,   -12,    80,    20,  -125,   -31,
+           188,    45,  -276,   -66,   400,    96,  -586,  -143,   900,   231,
+         -1576,  -471,  4526,  8148,  5831,   535, -1723,  -248,   955,   151,
+          -616,  -101,   419,    69,  -289,   -48,   197,    32,  -132,   -21,
+            84,    13,   -51,    -8,    28,     4,   -13,    -2,
+    },
+    {
+           -11,    -4,    25,     9,   -47,   -15,    78,    25,  -123,   -38,
+           185,    56,  -271,   -82,   393,   119,  -576,  -177,   883,   285,
+         -1542,  -577,  4355,  8112,  5982,   678, -1724,  -311,   952,   189,
+          -613,  -126,   417,    87,  -287,   -60,   197,    40,  -131,   -26,
+            84,    17,   -51,   -10,    28,     5,   -13,    -2,
+    },
+    {
+           -11,    -5,    24,    10,   -46,   -18,    76,    29,  -120,   -45,
+           181,    67,  -266,   -97,   385,   141,  -565,  -210,   865,   337,
+         -1505,  -679,  4182,  8079,  6130,   825, -1721,  -375,   946,   228,
+          -609,  -152,   413,   104,  -285,   -72,   195,    49,  -130,   -32,
+            84,    20,   -50,   -12,    28,     6,   -13,    -2,
+    },
+    {
+           -11,    -6,    24,    12,   -44,   -21,    75,    34,  -118,   -52,
+           177,    77,  -260,  -112,   377,   163,  -552,  -242,   845,   388,
+         -1465,  -777,  4008,  8033,  6274,   975, -1713,  -439,   938,   266,
+          -603,  -177,   409,   122,  -282,   -84,   193,    57,  -129,   -37,
+            83,    23,   -50,   -14,    28,     7,   -13,    -3,
+    },
+    {
+           -10,    -7,    23,    13,   -43,   -23,    73,    38,  -115,   -59,
+           173,    87,  -254,  -127,   368,   184,  -538,  -273,   823,   437,
+         -1423,  -870,  3833,  7986,  6414,  1127, -1702,  -504,   928,   304,
+          -595,  -202,   404,   139,  -278,   -96,   191,    65,  -127,   -43,
+            82,    27,   -50,   -15,    27,     8,   -13,    -3,
+    },
+    {
+           -10,    -7,    22,    15,   -42,   -26,    71,    42,  -111,   -65,
+           168,    97,  -247,  -141,   358,   204,  -524,  -303,   799,   485,
+         -1378,  -958,  3658,  7929,  6550,  1283, -1685,  -568,   915,   342,
+          -586,  -227,   398,   156,  -274,  -107,   188,    73,  -126,   -48,
+            81,    30,   -49,   -17,    27,     9,   -13,    -4,
+    },
+    {
+           -10,    -8,    22,    16,   -41,   -28,    68,    46,  -108,   -71,
+           163,   106,  -239,  -154,   347,   224,  -508,  -332,   774,   530,
+         -1330, -1042,  3483,  7868,  6681,  1441, -1664,  -632,   900,   380,
+          -575,  -252,   390,   173,  -269,  -119,   184,    81,  -123,   -53,
+            79,    33,   -48,   -19,    27,    10,   -13,    -4,
+    },
+    {
+            -9,    -9,    21,    17,   -39,   -31,    66,    50,  -104,   -77,
+           158,   115,  -231,  -167,   336,   243,  -491,  -360,   748,   573,
+         -1281, -1120,  3307,  7799,  6809,  1602, -1639,  -696,   882,   418,
+          -563,  -277,   382,   190,  -263,  -131,   180,    89,  -121,   -58,
+            78,    37,   -47,   -21,    26,    11,   -13,    -5,
+    },
+    {
+            -9,    -9,    20,    19,   -38,   -33,    63,    54,  -100,   -83,
+           152,   123,  -223,  -180,   323,   261,  -473,  -387,   720,   614,
+         -1229, -1194,  3132,  7727,  6932,  1766, -1609,  -759,   862,   454,
+          -549,  -301,   372,   206,  -256,  -142,   176,    96,  -118,   -64,
+            76,    40,   -46,   -23,    26,    12,   -12,    -5,
+    },
+    {
+            -8,   -10,    19,    20,   -36,   -35,    61,    57,   -96,   -88,
+           146,   131,  -214,  -191,   311,   278,  -454,  -412,   690,   653,
+         -1175, -1263,  2957,  7646,  7049,  1931, -1574,  -822,   839,   491,
+          -534,  -325,   362,   223,  -249,  -153,   171,   104,  -114,   -69,
+            74,    43,   -45,   -25,    25,    13,   -12,    -6,
+    },
+    {
+            -8,   -10,    18,    21,   -34,   -37,    58,    60,   -92,   -93,
+           139,   139,  -205,  -203,   297,   294,  -434,  -436,   659,   690,
+         -1120, -1327,  2783,  7566,  7162,  2098, -1534,  -884,   814,   526,
+          -517,  -348,   350,   238,  -241,  -164,   165,   112,  -111,   -74,
+            72,    46,   -44,   -27,    24,    14,   -12,    -6,
+    },
+    {
+            -7,   -11,    17,    22,   -33,   -39,    55,    64,   -88,   -98,
+           133,   146,  -195,  -213,   283,   310,  -414,  -458,   628,   725,
+         -1063, -1386,  2610,  7468,  7270,  2268, -1489,  -945,   787,   561,
+          -499,  -370,   338,   254,  -233,  -175,   159,   119,  -107,   -78,
+            69,    49,   -42,   -29,    24,    15,   -11,    -7,
+    },
+    {
+            -7,   -11,    16,    23,   -31,   -41,    52,    66,   -83,  -103,
+           126,   153,  -185,  -223,   269,   324,  -392,  -479,   595,   757,
+         -1004, -1440,  2438,  7371,  7373,  2438, -1440, -1004,   757,   595,
+          -479,  -392,   324,   269,  -223,  -185,   153,   126,  -103,   -83,
+            66,    52,   -41,   -31,    23,    16,   -11,    -7,
+    },
+    {
+            -7,   -11,    15,    24,   -29,   -42,    49,    69,   -78,  -107,
+           119,   159,  -175,  -233,   254,   338,  -370,  -499,   561,   787,
+          -945, -1489,  2268,  7268,  7470,  2610, -1386, -1063,   725,   628,
+          -458,  -414,   310,   283,  -213,  -195,   146,   133,   -98,   -88,
+            64,    55,   -39,   -33,    22,    17,   -11,    -7,
+    },
+    {
+            -6,   -12,    14,    24,   -27,   -44,    46,    72,   -74,  -111,
+           112,   165,  -164,  -241,   238,   350,  -348,  -517,   526,   814,
+          -884, -1534,  2098,  7167,  7561,  2783, -1327, -1120,   690,   659,
+          -436,  -434,   294,   297,  -203,  -205,   139,   139,   -93,   -92,
+            60,    58,   -37,   -34,    21,    18,   -10,    -8,
+    },
+    {
+            -6,   -12,    13,    25,   -25,   -45,    43,    74,   -69,  -114,
+           104,   171,  -153,  -249,   223,   362,  -325,  -534,   491,   839,
+          -822, -1574,  1931,  7048,  7647,  2957, -1263, -1175,   653,   690,
+          -412,  -454,   278,   311,  -191,  -214,   131,   146,   -88,   -96,
+            57,    61,   -35,   -36,    20,    19,   -10,    -8,
+    },
+    {
+            -5,   -12,    12,    26,   -23,   -46,    40,    76,   -64,  -118,
+            96,   176,  -142,  -256,   206,   372,  -301,  -549,   454,   862,
+          -759, -1609,  1766,  6932,  7727,  3132, -1194, -1229,   614,   720,
+          -387,  -473,   261,   323,  -180,  -223,   123,   152,   -83,  -100,
+            54,    63,   -33,   -38,    19,    20,    -9,    -9,
+    },
+    {
+            -5,   -13,    11,    26,   -21,   -47,    37,    78,   -58,  -121,
+            89,   180,  -131,  -263,   190,   382,  -277,  -563,   418,   882,
+          -696, -1639,  1602,  6807,  7801,  3307, -1120, -1281,   573,   748,
+          -360,  -491,   243,   336,  -167,  -231,   115,   158,   -77,  -104,
+            50,    66,   -31,   -39,    17,    21,    -9,    -9,
+    },
+    {
+            -4,   -13,    10,    27,   -19,   -48,    33,    79,   -53,  -123,
+            81,   184,  -119,  -269,   173,   390,  -252,  -575,   380,   900,
+          -632, -1664,  1441,  6680,  7869,  3483, -1042, -1330,   530,   774,
+          -332,  -508,   224,   347,  -154,  -239,   106,   163,   -71,  -108,
+            46,    68,   -28,   -41,    16,    22,    -8,   -10,
+    },
+    {
+            -4,   -13,     9,    27,   -17,   -49,    30,    81,   -48,  -126,
+            73,   188,  -107,  -274,   156,   398,  -227,  -586,   342,   915,
+          -568, -1685,  1283,  6549,  7930,  3658,  -958, -1378,   485,   799,
+          -303,  -524,   204,   358,  -141,  -247,    97,   168,   -65,  -111,
+            42,    71,   -26,   -42,    15,    22,    -7,   -10,
+    },
+    {
+            -3,   -13,     8,    27,   -15,   -50,    27,    82,   -43,  -127,
+            65,   191,   -96,  -278,   139,   404,  -202,  -595,   304,   928,
+          -504, -1702,  1127,  6414,  7986,  3833,  -870, -1423,   437,   823,
+          -273,  -538,   184,   368,  -127,  -254,    87,   173,   -59,  -115,
+            38,    73,   -23,   -43,    13,    23,    -7,   -10,
+    },
+    {
+            -3,   -13,     7,    28,   -14,   -50,    23,    83,   -37,  -129,
+            57,   193,   -84,  -282,   122,   409,  -177,  -603,   266,   938,
+          -439, -1713,   975,  6272,  8035,  4008,  -777, -1465,   388,   845,
+          -242,  -552,   163,   377,  -112,  -260,    77,   177,   -52,  -118,
+            34,    75,   -21,   -44,    12,    24,    -6,   -11,
+    },
+    {
+            -2,   -13,     6,    28,   -12,   -50,    20,    84,   -32,  -130,
+            49,   195,   -72,  -285,   104,   413,  -152,  -609,   228,   946,
+          -375, -1721,   825,  6132,  8077,  4182,  -679, -1505,   337,   865,
+          -210,  -565,   141,   385,   -97,  -266,    67,   181,   -45,  -120,
+            29,    76,   -18,   -46,    10,    24,    -5,   -11,
+    },
+    {
+            -2,   -13,     5,    28,   -10,   -51,    17,    84,   -26,  -131,
+            40,   197,   -60,  -287,    87,   417,  -126,  -613,   189,   952,
+          -311, -1724,   678,  5981,  8113,  4355,  -577, -1542,   285,   883,
+          -177,  -576,   119,   393,   -82,  -271,    56,   185,   -38,  -123,
+            25,    78,   -15,   -47,     9,    25,    -4,   -11,
+    },
+    {
+            -2,   -13,     4,    28,    -8,   -51,    13,    84,   -21,  -132,
+            32,   197,   -48,  -289,    69,   419,  -101,  -616,   151,   955,
+          -248, -1723,   535,  5836,  8143,  4526,  -471, -1576,   231,   900,
+          -143,  -586,    96,   400,   -66,  -276,    45,   188,   -31,  -125,
+            20,    80,   -12,   -47,     7,    26,    -4,   -12,
+    },
+    {
+            -1,   -13,     3,    28,    -6,   -51,    10,    85,   -16,  -132,
+            24,   198,   -36,  -290,    52,   420,   -75,  -617,   113,   956,
+          -185, -1718,   396,  5677,  8166,  4697,  -359, -1606,   175,   914,
+          -108,  -595,    73,   405,   -50,  -280,    34,   191,   -23,  -127,
+            15,    81,    -9,   -48,     5,    26,    -3,   -12,
+    },
+    {
+            -1,   -13,     2,    28,    -4,   -51,     7,    84,   -10,  -132,
+            16,   198,   -24,  -290,    34,   420,   -50,  -617,    75,   955,
+          -122, -1708,   260,  5520,  8183,  4865,  -244, -1634,   118,   926,
+           -73,  -602,    49,   410,   -34,  -283,    23,   193,   -16,  -128,
+            10,    82,    -6,   -49,     4,    27,    -2,   -12,
+    },
+    {
+             0,   -13,     1,    28,    -2,   -50,     3,    84,    -5,  -132,
+             8,   197,   -12,  -289,    17,   419,   -25,  -615,    37,   951,
+           -61, -1695,   128,  5360,  8192,  5032,  -124, -1658,    60,   937,
+           -37,  -608,    25,   414,   -17,  -286,    12,   195,    -8,  -130,
+             5,    83,    -3,   -50,     2,    27,    -1,   -12,
+    },
+    {
+             0,   -13,     0,    27,     0,   -50,     0,    84,     0,  -131,
+             0,   196,     0,  -288,     0,   417,     0,  -612,     0,   945,
+             0, -1678,     0,  5198,  8195,  5197,     0, -1678,     0,   945,
+             0,  -612,     0,   417,     0,  -288,     0,   196,     0,  -131,
+             0,    84,     0,   -50,     0,    27,     0,   -13,
+    },
+};
+
+/* 96000 Hz, 56 taps, ~58 dB */
+static const int16_t coefs_96000[33][56] =
+{
+    {
+             7,    -2,   -16,    -2,    29,    13,   -44,   -34,    57,    70,
+           -64,  -121,    55,   189,   -20,  -271,   -53,   361,   183,  -453,
+          -399,   537,   774,  -606, -1567,   650,  5156,  7526,  5156,   650,
+         -1567,  -606,   774,   537,  -399,  -453,   183,   361,   -53,  -271,
+           -20,   189,    55,  -121,   -64,    70,    57,   -34,   -44,    13,
+            29,    -2,   -16,    -2,     7,     0,
+    },
+    {
+             7,    -1,   -16,    -3,    28,    14,   -43,   -36,    55,    72,
+           -59,  -123,    48,   190,   -10,  -269,   -67,   354,   200,  -437,
+          -419,   508,   793,  -551, -1577,   529,  5022,  7521,  5287,   774,
+         -1554,  -659,   753,   566,  -379,  -467,   165,   368,   -39,  -272,
+           -31,   188,    62,  -119,   -68,    67,    60,   -32,   -45,    11,
+            29,    -1,   -16,    -3,     7,     2,
+    },
+    {
+             7,    -1,   -16,    -4,    28,    16,   -41,   -38,    52,    74,
+           -54,  -125,    40,   190,     0,  -266,   -80,   346,   217,  -421,
+          -437,   479,   811,  -497, -1583,   410,  4887,  7512,  5415,   901,
+         -1538,  -713,   730,   593,  -357,  -481,   147,   373,   -25,  -273,
+           -41,   187,    69,  -117,   -73,    65,    63,   -30,   -46,     9,
+            30,     0,   -16,    -3,     7,     2,
+    },
+    {
+             7,     0,   -16,    -5,    27,    17,   -40,   -40,    49,    76,
+           -50,  -126,    33,   190,    11,  -263,   -94,   338,   232,  -405,
+          -455,   448,   826,  -443, -1585,   294,  4749,  7506,  5541,  1029,
+         -1518,  -766,   705,   620,  -335,  -494,   128,   378,   -10,  -274,
+           -52,   185,    76,  -114,   -77,    62,    65,   -28,   -47,     8,
+            30,     1,   -16,    -4,     7,     3,
+    },
+    {
+             7,     0,   -15,    -5,    26,    18,   -38,   -42,    46,    78,
+           -45,  -128,    26,   189,    21,  -259,  -107,   329,   248,  -387,
+          -471,   418,   840,  -388, -1585,   181,  4610,  7481,  5665,  1161,
+         -1494,  -818,   678,   645,  -311,  -506,   109,   383,     4,  -274,
+           -62,   183,    83,  -111,   -81,    59,    67,   -25,   -48,     6,
+            31,     2,   -16,    -4,     7,     3,
+    },
+    {
+             7,     1,   -15,    -6,    26,    20,   -37,   -43,    43,    79,
+           -40,  -128,    19,   189,    31,  -255,  -119,   319,   262,  -369,
+          -486,   386,   852,  -334, -1581,    71,  4469,  7460,  5785,  1294,
+         -1467,  -869,   649,   670,  -287,  -518,    90,   386,    19,  -273,
+           -73,   180,    90,  -107,   -86,    56,    69,   -23,   -49,     4,
+            31,     3,   -16,    -5,     7,     3,
+    },
+    {
+             7,     1,   -15,    -7,    25,    21,   -35,   -45,    40,    81,
+           -35,  -129,    11,   187,    40,  -250,  -131,   309,   276,  -350,
+          -500,   355,   861,  -280, -1574,   -36,  4327,  7431,  5903,  1429,
+         -1436,  -920,   619,   694,  -261,  -528,    70,   389,    34,  -272,
+           -83,   177,    97,  -104,   -90,    53,    71,   -20,   -50,     3,
+            31,     4,   -16,    -5,     7,     3,
+    },
+    {
+             7,     1,   -15,    -8,    24,    22,   -33,   -46,    37,    82,
+           -30,  -129,     4,   186,    50,  -245,  -143,   298,   289,  -331,
+          -512,   323,   869,  -226, -1564,  -140,  4183,  7398,  6017,  1566,
+         -1401,  -969,   587,   716,  -235,  -537,    49,   391,    49,  -270,
+           -94,   173,   104,  -100,   -93,    49,    73,   -17,   -51,     1,
+            31,     6,   -16,    -6,     7,     3,
+    },
+    {
+             7,     2,   -14,    -9,    23,    23,   -31,   -47,    34,    83,
+           -25,  -129,    -3,   184,    59,  -239,  -154,   287,   302,  -312,
+          -524,   290,   875,  -173, -1551,  -240,  4038,  7359,  6128,  1705,
+         -1363, -1018,   553,   737,  -208,  -545,    29,   393,    64,  -268,
+          -104,   169,   110,   -96,   -97,    46,    75,   -15,   -52,    -1,
+            31,     7,   -16,    -6,     7,     4,
+    },
+    {
+             7,     2,   -14,   -10,    22,    24,   -30,   -48,    31,    84,
+           -21,  -129,   -10,   181,    68,  -233,  -165,   275,   314,  -292,
+          -534,   258,   880,  -120, -1536,  -337,  3893,  7318,  6236,  1845,
+         -1320, -1065,   518,   757,  -180,  -553,     8,   393,    79,  -265,
+          -114,   165,   117,   -92,  -101,    42,    77,   -12,   -52,    -3,
+            31,     8,   -16,    -7,     6,     4,
+    },
+    {
+             6,     3,   -13,   -10,    21,    25,   -28,   -49,    28,    84,
+           -16,  -129,   -17,   179,    77,  -227,  -176,   263,   325,  -271,
+          -543,   225,   882,   -68, -1517,  -431,  3746,  7272,  6340,  1987,
+         -1274, -1111,   481,   776,  -152,  -559,   -14,   393,    94,  -262,
+          -124,   160,   123,   -87,  -104,    38,    78,    -9,   -53,    -5,
+            31,     9,   -16,    -7,     6,     4,
+    },
+    {
+             6,     3,   -13,   -11,    21,    26,   -26,   -50,    25,    85,
+           -11,  -128,   -23,   175,    86,  -220,  -186,   251,   335,  -251,
+          -551,   193,   882,   -16, -1496,  -521,  3599,  7217,  6440,  2130,
+         -1225, -1155,   442,   793,  -123,  -564,   -35,   392,   109,  -257,
+          -134,   155,   129,   -82,  -107,    34,    80,    -6,   -53,    -7,
+            31,    10,   -16,    -8,     6,     4,
+    },
+    {
+             6,     3,   -13,   -12,    20,    27,   -24,   -51,    22,    85,
+            -6,  -127,   -30,   172,    94,  -213,  -195,   238,   344,  -230,
+          -558,   160,   881,    34, -1472,  -608,  3452,  7159,  6537,  2275,
+         -1171, -1198,   402,   809,   -93,  -568,   -57,   390,   124,  -253,
+          -144,   150,   135,   -77,  -110,    30,    81,    -3,   -53,    -9,
+            31,    11,   -15,    -9,     6,     5,
+    },
+    {
+             6,     4,   -12,   -12,    19,    28,   -22,   -52,    19,    85,
+            -1,  -126,   -36,   168,   102,  -205,  -204,   224,   353,  -208,
+          -563,   128,   878,    84, -1445,  -692,  3304,  7094,  6629,  2420,
+         -1114, -1239,   360,   824,   -63,  -571,   -78,   387,   139,  -248,
+          -153,   144,   140,   -72,  -113,    26,    82,     0,   -53,   -11,
+            31,    12,   -15,    -9,     6,     5,
+    },
+    {
+             6,     4,   -12,   -13,    18,    28,   -20,   -52,    15,    85,
+             3,  -124,   -43,   164,   110,  -197,  -213,   211,   360,  -187,
+          -568,    95,   873,   133, -1416,  -771,  3156,  7035,  6718,  2566,
+         -1053, -1279,   318,   837,   -32,  -572,  -100,   383,   154,  -242,
+          -163,   138,   145,   -67,  -116,    21,    83,     3,   -53,   -13,
+            30,    13,   -15,   -10,     5,     5,
+    },
+    {
+             6,     5,   -11,   -13,    16,    29,   -18,   -53,    12,    85,
+             8,  -122,   -49,   160,   118,  -189,  -221,   197,   367,  -165,
+          -571,    63,   867,   181, -1385,  -847,  3008,  6956,  6802,  2713,
+          -988, -1316,   273,   848,    -1,  -573,  -122,   379,   169,  -235,
+          -172,   132,   151,   -61,  -118,    17,    84,     6,   -53,   -15,
+            30,    14,   -14,   -10,     5,     5,
+    },
+    {
+             5,     5,   -11,   -14,    15,    29,   -16,   -53,     9,    84,
+            13,  -120,   -55,   155,   125,  -181,  -228,   183,   373,  -144,
+          -572,    31,   858,   228, -1352,  -919,  2860,  6885,  6883,  2860,
+          -919, -1352,   228,   858,    31,  -572,  -144,   373,   183,  -228,
+          -181,   125,   155,   -55,  -120,    13,    84,     9,   -53,   -16,
+            29,    15,   -14,   -11,     5,     5,
+    },
+    {
+             5,     5,   -10,   -14,    14,    30,   -15,   -53,     6,    84,
+            17,  -118,   -61,   151,   132,  -172,  -235,   169,   379,  -122,
+          -573,    -1,   848,   273, -1316,  -988,  2713,  6800,  6958,  3008,
+          -847, -1385,   181,   867,    63,  -571,  -165,   367,   197,  -221,
+          -189,   118,   160,   -49,  -122,     8,    85,    12,   -53,   -18,
+            29,    16,   -13,   -11,     5,     6,
+    },
+    {
+             5,     5,   -10,   -15,    13,    30,   -13,   -53,     3,    83,
+            21,  -116,   -67,   145,   138,  -163,  -242,   154,   383,  -100,
+          -572,   -32,   837,   318, -1279, -1053,  2566,  6723,  7030,  3156,
+          -771, -1416,   133,   873,    95,  -568,  -187,   360,   211,  -213,
+          -197,   110,   164,   -43,  -124,     3,    85,    15,   -52,   -20,
+            28,    18,   -13,   -12,     4,     6,
+    },
+    {
+             5,     6,    -9,   -15,    12,    31,   -11,   -53,     0,    82,
+            26,  -113,   -72,   140,   144,  -153,  -248,   139,   387,   -78,
+          -571,   -63,   824,   360, -1239, -1114,  2420,  6626,  7097,  3304,
+          -692, -1445,    84,   878,   128,  -563,  -208,   353,   224,  -204,
+          -205,   102,   168,   -36,  -126,    -1,    85,    19,   -52,   -22,
+            28,    19,   -12,   -12,     4,     6,
+    },
+    {
+             5,     6,    -9,   -15,    11,    31,    -9,   -53,    -3,    81,
+            30,  -110,   -77,   135,   150,  -144,  -253,   124,   390,   -57,
+          -568,   -93,   809,   402, -1198, -1171,  2275,  6537,  7159,  3452,
+          -608, -1472,    34,   881,   160,  -558,  -230,   344,   238,  -195,
+          -213,    94,   172,   -30,  -127,    -6,    85,    22,   -51,   -24,
+            27,    20,   -12,   -13,     3,     6,
+    },
+    {
+             4,     6,    -8,   -16,    10,    31,    -7,   -53,    -6,    80,
+            34,  -107,   -82,   129,   155,  -134,  -257,   109,   392,   -35,
+          -564,  -123,   793,   442, -1155, -1225,  2130,  6440,  7217,  3599,
+          -521, -1496,   -16,   882,   193,  -551,  -251,   335,   251,  -186,
+          -220,    86,   175,   -23,  -128,   -11,    85,    25,   -50,   -26,
+            26,    21,   -11,   -13,     3,     6,
+    },
+    {
+             4,     6,    -7,   -16,     9,    31,    -5,   -53,    -9,    78,
+            38,  -104,   -87,   123,   160,  -124,  -262,    94,   393,   -14,
+          -559,  -152,   776,   481, -1111, -1274,  1987,  6342,  7270,  3746,
+          -431, -1517,   -68,   882,   225,  -543,  -271,   325,   263,  -176,
+          -227,    77,   179,   -17,  -129,   -16,    84,    28,   -49,   -28,
+            25,    21,   -10,   -13,     3,     6,
+    },
+    {
+             4,     6,    -7,   -16,     8,    31,    -3,   -52,   -12,    77,
+            42,  -101,   -92,   117,   165,  -114,  -265,    79,   393,     8,
+          -553,  -180,   757,   518, -1065, -1320,  1845,  6236,  7318,  3893,
+          -337, -1536,  -120,   880,   258,  -534,  -292,   314,   275,  -165,
+          -233,    68,   181,   -10,  -129,   -21,    84,    31,   -48,   -30,
+            24,    22,   -10,   -14,     2,     7,
+    },
+    {
+             4,     7,    -6,   -16,     7,    31,    -1,   -52,   -15,    75,
+            46,   -97,   -96,   110,   169,  -104,  -268,    64,   393,    29,
+          -545,  -208,   737,   553, -1018, -1363,  1705,  6126,  7361,  4038,
+          -240, -1551,  -173,   875,   290,  -524,  -312,   302,   287,  -154,
+          -239,    59,   184,    -3,  -129,   -25,    83,    34,   -47,   -31,
+            23,    23,    -9,   -14,     2,     7,
+    },
+    {
+             3,     7,    -6,   -16,     6,    31,     1,   -51,   -17,    73,
+            49,   -93,  -100,   104,   173,   -94,  -270,    49,   391,    49,
+          -537,  -235,   716,   587,  -969, -1401,  1566,  6016,  7399,  4183,
+          -140, -1564,  -226,   869,   323,  -512,  -331,   289,   298,  -143,
+          -245,    50,   186,     4,  -129,   -30,    82,    37,   -46,   -33,
+            22,    24,    -8,   -15,     1,     7,
+    },
+    {
+             3,     7,    -5,   -16,     4,    31,     3,   -50,   -20,    71,
+            53,   -90,  -104,    97,   177,   -83,  -272,    34,   389,    70,
+          -528,  -261,   694,   619,  -920, -1436,  1429,  5902,  7432,  4327,
+           -36, -1574,  -280,   861,   355,  -500,  -350,   276,   309,  -131,
+          -250,    40,   187,    11,  -129,   -35,    81,    40,   -45,   -35,
+            21,    25,    -7,   -15,     1,     7,
+    },
+    {
+             3,     7,    -5,   -16,     3,    31,     4,   -49,   -23,    69,
+            56,   -86,  -107,    90,   180,   -73,  -273,    19,   386,    90,
+          -518,  -287,   670,   649,  -869, -1467,  1294,  5785,  7460,  4469,
+            71, -1581,  -334,   852,   386,  -486,  -369,   262,   319,  -119,
+          -255,    31,   189,    19,  -128,   -40,    79,    43,   -43,   -37,
+            20,    26,    -6,   -15,     1,     7,
+    },
+    {
+             3,     7,    -4,   -16,     2,    31,     6,   -48,   -25,    67,
+            59,   -81,  -111,    83,   183,   -62,  -274,     4,   383,   109,
+          -506,  -311,   645,   678,  -818, -1494,  1161,  5662,  7484,  4610,
+           181, -1585,  -388,   840,   418,  -471,  -387,   248,   329,  -107,
+          -259,    21,   189,    26,  -128,   -45,    78,    46,   -42,   -38,
+            18,    26,    -5,   -15,     0,     7,
+    },
+    {
+             3,     7,    -4,   -16,     1,    30,     8,   -47,   -28,    65,
+            62,   -77,  -114,    76,   185,   -52,  -274,   -10,   378,   128,
+          -494,  -335,   620,   705,  -766, -1518,  1029,  5545,  7502,  4749,
+           294, -1585,  -443,   826,   448,  -455,  -405,   232,   338,   -94,
+          -263,    11,   190,    33,  -126,   -50,    76,    49,   -40,   -40,
+            17,    27,    -5,   -16,     0,     7,
+    },
+    {
+             2,     7,    -3,   -16,     0,    30,     9,   -46,   -30,    63,
+            65,   -73,  -117,    69,   187,   -41,  -273,   -25,   373,   147,
+          -481,  -357,   593,   730,  -713, -1538,   901,  5412,  7515,  4887,
+           410, -1583,  -497,   811,   479,  -437,  -421,   217,   346,   -80,
+          -266,     0,   190,    40,  -125,   -54,    74,    52,   -38,   -41,
+            16,    28,    -4,   -16,    -1,     7,
+    },
+    {
+             2,     7,    -3,   -16,    -1,    29,    11,   -45,   -32,    60,
+            67,   -68,  -119,    62,   188,   -31,  -272,   -39,   368,   165,
+          -467,  -379,   566,   753,  -659, -1554,   774,  5286,  7522,  5022,
+           529, -1577,  -551,   793,   508,  -419,  -437,   200,   354,   -67,
+          -269,   -10,   190,    48,  -123,   -59,    72,    55,   -36,   -43,
+            14,    28,    -3,   -16,    -1,     7,
+    },
+    {
+             0,     7,    -2,   -16,    -2,    29,    13,   -44,   -34,    57,
+            70,   -64,  -121,    55,   189,   -20,  -271,   -53,   361,   183,
+          -453,  -399,   537,   774,  -606, -1567,   650,  5156,  7526,  5156,
+           650, -1567,  -606,   774,   537,  -399,  -453,   183,   361,   -53,
+          -271,   -20,   189,    55,  -121,   -64,    70,    57,   -34,   -44,
+            13,    29,    -2,   -16,    -2,     7,
+    },
+};
+
+/* 176400 Hz, 96 taps, ~55 dB */
+static const int16_t coefs_176400[33][96] =
+{
+    {
+            -3,    -6,    -5,     0,     8,    13,    11,     0,   -15,   -25,
+           -20,     0,    26,    41,    33,     0,   -41,   -65,   -51,     0,
+            62,    97,    76,     0,   -92,  -143,  -111,     0,   134,   208,
+           161,     0,  -196,  -305,  -239,     0,   297,   472,   378,     0,
+          -502,  -839,  -720,     0,  1219,  2598,  3686,  4100,  3686,  2598,
+          1219,     0,  -720,  -839,  -502,     0,   378,   472,   297,     0,
+          -239,  -305,  -196,     0,   161,   208,   134,     0,  -111,  -143,
+           -92,     0,    76,    97,    62,     0,   -51,   -65,   -41,     0,
+            33,    41,    26,     0,   -20,   -25,   -15,     0,    11,    13,
+             8,     0,    -5,    -6,    -3,     0,
+    },
+    {
+            -3,    -6,    -5,     0,     8,    13,    11,     0,   -15,   -24,
+           -20,    -1,    25,    41,    33,     1,   -40,   -64,   -52,    -2,
+            61,    97,    78,     3,   -89,  -142,  -113,    -4,   130,   207,
+           165,     6,  -190,  -304,  -244,    -9,   289,   470,   386,    15,
+          -487,  -834,  -732,   -31,  1176,  2557,  3661,  4092,  3710,  2639,
+          1262,    32,  -706,  -843,  -517,   -15,   370,   474,   305,     9,
+          -234,  -306,  -201,    -6,   158,   208,   137,     4,  -109,  -143,
+           -94,    -3,    74,    98,    64,     2,   -50,   -65,   -42,    -1,
+            32,    41,    26,     1,   -19,   -25,   -15,     0,    11,    13,
+             8,     0,    -5,    -6,    -3,     0,
+    },
+    {
+            -3,    -6,    -5,     0,     7,    13,    11,     1,   -14,   -24,
+           -21,    -2,    24,    41,    34,     3,   -39,   -64,   -53,    -4,
+            59,    97,    79,     6,   -87,  -142,  -116,    -8,   126,   206,
+           168,    12,  -185,  -303,  -249,   -18,   280,   468,   393,    30,
+          -472,  -829,  -744,   -62,  1134,  2516,  3635,  4096,  3734,  2680,
+          1305,    64,  -693,  -847,  -531,   -30,   362,   475,   313,    19,
+          -229,  -307,  -206,   -12,   154,   209,   141,     9,  -106,  -144,
+           -97,    -6,    73,    98,    66,     4,   -49,   -65,   -43,    -3,
+            31,    41,    27,     2,   -19,   -25,   -16,    -1,    11,    13,
+             8,     0,    -5,    -6,    -4,     0,
+    },
+    {
+            -3,    -6,    -6,    -1,     7,    13,    12,     1,   -14,   -24,
+           -21,    -2,    23,    41,    35,     4,   -37,   -64,   -54,    -6,
+            57,    96,    81,     9,   -84,  -141,  -118,   -13,   122,   205,
+           171,    18,  -179,  -302,  -254,   -27,   271,   465,   400,    44,
+          -457,  -823,  -756,   -92,  1091,  2475,  3608,  4096,  3758,  2720,
+          1348,    97,  -678,  -851,  -545,   -46,   353,   476,   321,    28,
+          -223,  -308,  -211,   -19,   150,   209,   145,    13,  -103,  -144,
+           -99,    -9,    71,    98,    67,     6,   -47,   -65,   -44,    -4,
+            31,    41,    28,     2,   -19,   -25,   -16,    -1,    10,    13,
+             9,     1,    -5,    -6,    -4,     0,
+    },
+    {
+            -3,    -6,    -6,    -1,     7,    13,    12,     2,   -13,   -24,
+           -21,    -3,    23,    40,    35,     5,   -36,   -63,   -55,    -8,
+            55,    96,    82,    11,   -82,  -141,  -120,   -17,   119,   204,
+           174,    24,  -173,  -300,  -258,   -36,   263,   463,   407,    59,
+          -442,  -817,  -767,  -122,  1049,  2433,  3581,  4091,  3780,  2760,
+          1391,   130,  -663,  -854,  -560,   -61,   345,   477,   329,    37,
+          -217,  -308,  -216,   -25,   147,   209,   148,    17,  -101,  -144,
+          -102,   -12,    69,    98,    69,     8,   -46,   -65,   -45,    -5,
+            30,    42,    29,     3,   -18,   -25,   -17,    -2,    10,    13,
+             9,     1,    -5,    -6,    -4,     0,
+    },
+    {
+            -3,    -6,    -6,    -1,     7,    13,    12,     2,   -13,   -24,
+           -22,    -4,    22,    40,    36,     6,   -35,   -63,   -56,   -10,
+            53,    95,    83,    14,   -79,  -140,  -122,   -21,   115,   203,
+           177,    30,  -168,  -298,  -262,   -45,   254,   460,   413,    73,
+          -426,  -810,  -777,  -151,  1007,  2391,  3553,  4089,  3802,  2799,
+          1435,   164,  -647,  -856,  -574,   -77,   336,   477,   337,    47,
+          -212,  -308,  -221,   -31,   143,   209,   151,    21,   -98,  -144,
+          -104,   -15,    67,    98,    71,    10,   -45,   -65,   -47,    -6,
+            29,    42,    29,     4,   -18,   -25,   -17,    -2,    10,    14,
+             9,     1,    -5,    -6,    -4,     0,
+    },
+    {
+            -3,    -6,    -6,    -1,     6,    13,    12,     3,   -12,   -24,
+           -22,    -5,    21,    40,    36,     7,   -34,   -63,   -57,   -11,
+            52,    95,    85,    17,   -76,  -139,  -124,   -25,   111,   202,
+           180,    36,  -162,  -297,  -266,   -54,   245,   456,   419,    87,
+          -411,  -803,  -786,  -180,   965,  2348,  3524,  4089,  3823,  2838,
+          1478,   198,  -631,  -859,  -587,   -92,   326,   477,   345,    56,
+          -205,  -308,  -226,   -38,   138,   209,   155,    26,   -95,  -144,
+          -106,   -18,    65,    98,    72,    12,   -44,   -65,   -48,    -8,
+            28,    42,    30,     5,   -17,   -25,   -18,    -3,    10,    14,
+             9,     1,    -5,    -6,    -4,    -1,
+    },
+    {
+            -3,    -6,    -6,    -2,     6,    13,    12,     3,   -12,   -23,
+           -22,    -5,    20,    39,    37,     9,   -33,   -62,   -57,   -13,
+            50,    94,    86,    20,   -73,  -138,  -126,   -29,   107,   201,
+           183,    42,  -156,  -294,  -270,   -63,   236,   453,   425,   101,
+          -395,  -795,  -796,  -208,   924,  2306,  3495,  4077,  3843,  2877,
+          1522,   233,  -614,  -860,  -601,  -108,   317,   477,   352,    66,
+          -199,  -308,  -231,   -44,   134,   209,   158,    30,   -92,  -144,
+          -109,   -21,    63,    98,    74,    14,   -42,   -65,   -49,    -9,
+            27,    42,    31,     6,   -17,   -25,   -18,    -3,     9,    14,
+             9,     2,    -5,    -6,    -4,    -1,
+    },
+    {
+            -2,    -6,    -6,    -2,     6,    12,    12,     3,   -11,   -23,
+           -23,    -6,    20,    39,    37,    10,   -31,   -62,   -58,   -15,
+            48,    93,    87,    23,   -71,  -137,  -128,   -33,   103,   199,
+           185,    48,  -150,  -292,  -274,   -71,   227,   449,   430,   115,
+          -379,  -787,  -804,  -235,   883,  2263,  3465,  4073,  3863,  2915,
+          1566,   268,  -597,  -861,  -614,  -124,   307,   477,   359,    75,
+          -193,  -307,  -236,   -50,   130,   209,   161,    34,   -89,  -144,
+          -111,   -24,    61,    98,    75,    16,   -41,   -65,   -50,   -10,
+            26,    42,    31,     6,   -16,   -25,   -18,    -4,     9,    14,
+            10,     2,    -4,    -6,    -4,    -1,
+    },
+    {
+            -2,    -6,    -6,    -2,     6,    12,    13,     4,   -11,   -23,
+           -23,    -7,    19,    39,    38,    11,   -30,   -61,   -59,   -17,
+            46,    92,    88,    25,   -68,  -136,  -129,   -37,    99,   197,
+           188,    54,  -144,  -290,  -278,   -80,   218,   445,   436,   129,
+          -364,  -779,  -812,  -262,   842,  2220,  3435,  4067,  3882,  2953,
+          1610,   303,  -579,  -862,  -627,  -140,   297,   476,   366,    85,
+          -186,  -307,  -240,   -57,   125,   208,   164,    39,   -86,  -143,
+          -113,   -27,    59,    98,    77,    18,   -40,   -65,   -51,   -12,
+            26,    41,    32,     7,   -16,   -25,   -19,    -4,     9,    14,
+            10,     2,    -4,    -6,    -4,    -1,
+    },
+    {
+            -2,    -5,    -6,    -2,     5,    12,    13,     4,   -10,   -23,
+           -23,    -7,    18,    38,    38,    12,   -29,   -61,   -60,   -19,
+            44,    92,    89,    28,   -65,  -135,  -131,   -41,    94,   196,
+           190,    59,  -138,  -287,  -281,   -88,   208,   441,   441,   142,
+          -348,  -771,  -819,  -289,   801,  2177,  3404,  4063,  3900,  2991,
+          1653,   339,  -560,  -862,  -640,  -155,   286,   475,   373,    95,
+          -180,  -306,  -245,   -63,   121,   208,   167,    43,   -83,  -143,
+          -115,   -30,    57,    97,    78,    20,   -38,   -65,   -51,   -13,
+            25,    41,    32,     8,   -15,   -25,   -19,    -5,     8,    14,
+            10,     2,    -4,    -6,    -4,    -1,
+    },
+    {
+            -2,    -5,    -6,    -2,     5,    12,    13,     5,   -10,   -23,
+           -23,    -8,    17,    38,    39,    13,   -28,   -60,   -60,   -21,
+            42,    91,    90,    31,   -62,  -133,  -132,   -45,    90,   194,
+           192,    65,  -132,  -284,  -284,   -97,   199,   437,   445,   156,
+          -332,  -761,  -826,  -314,   761,  2134,  3373,  4046,  3917,  3028,
+          1697,   376,  -541,  -861,  -653,  -171,   276,   474,   380,   104,
+          -173,  -305,  -249,   -69,   116,   207,   170,    47,   -80,  -142,
+          -117,   -33,    55,    97,    79,    22,   -37,   -65,   -52,   -14,
+            24,    41,    33,     9,   -15,   -25,   -19,    -5,     8,    14,
+            10,     3,    -4,    -6,    -4,    -1,
+    },
+    {
+            -2,    -5,    -6,    -2,     5,    12,    13,     5,    -9,   -22,
+           -24,    -9,    16,    38,    39,    14,   -26,   -59,   -61,   -22,
+            40,    90,    91,    33,   -59,  -132,  -134,   -48,    86,   192,
+           194,    70,  -126,  -282,  -287,  -105,   190,   432,   449,   169,
+          -316,  -752,  -832,  -340,   721,  2091,  3340,  4038,  3934,  3065,
+          1741,   412,  -521,  -860,  -665,  -187,   265,   473,   387,   114,
+          -166,  -304,  -253,   -76,   112,   206,   173,    52,   -77,  -142,
+          -119,   -36,    52,    97,    81,    24,   -35,   -64,   -53,   -16,
+            23,    41,    34,    10,   -14,   -25,   -20,    -6,     8,    14,
+            10,     3,    -4,    -6,    -5,    -1,
+    },
+    {
+            -2,    -5,    -6,    -3,     5,    12,    13,     5,    -9,   -22,
+           -24,   -10,    16,    37,    39,    16,   -25,   -59,   -61,   -24,
+            38,    89,    92,    36,   -56,  -131,  -135,   -52,    82,   190,
+           196,    76,  -120,  -279,  -290,  -113,   180,   427,   453,   181,
+          -300,  -742,  -837,  -364,   681,  2047,  3308,  4027,  3950,  3101,
+          1785,   450,  -500,  -858,  -677,  -203,   254,   471,   393,   123,
+          -159,  -302,  -257,   -82,   107,   205,   176,    56,   -73,  -141,
+          -121,   -39,    50,    96,    82,    26,   -34,   -64,   -54,   -17,
+            22,    41,    34,    11,   -13,   -25,   -20,    -6,     8,    13,
+            11,     3,    -4,    -6,    -5,    -1,
+    },
+    {
+            -2,    -5,    -6,    -3,     4,    12,    13,     6,    -9,   -22,
+           -24,   -10,    15,    37,    40,    17,   -24,   -58,   -62,   -26,
+            36,    88,    93,    38,   -53,  -129,  -136,   -56,    78,   188,
+           198,    81,  -113,  -275,  -292,  -121,   171,   422,   457,   194,
+          -284,  -732,  -842,  -388,   641,  2004,  3275,  4015,  3965,  3137,
+          1829,   487,  -479,  -856,  -688,  -220,   242,   469,   399,   133,
+          -151,  -301,  -261,   -88,   102,   204,   178,    60,   -70,  -140,
+          -123,   -42,    48,    96,    83,    28,   -32,   -64,   -55,   -18,
+            21,    41,    35,    11,   -13,   -25,   -20,    -7,     7,    13,
+            11,     3,    -4,    -6,    -5,    -1,
+    },
+    {
+            -2,    -5,    -6,    -3,     4,    11,    13,     6,    -8,   -21,
+           -24,   -11,    14,    36,    40,    18,   -22,   -57,   -63,   -27,
+            34,    87,    94,    41,   -50,  -128,  -137,   -59,    73,   185,
+           200,    86,  -107,  -272,  -295,  -129,   161,   416,   460,   206,
+          -268,  -722,  -847,  -412,   602,  1960,  3241,  4008,  3979,  3172,
+          1873,   525,  -457,  -854,  -700,  -236,   230,   466,   405,   142,
+          -144,  -299,  -265,   -95,    97,   203,   181,    65,   -66,  -139,
+          -124,   -45,    46,    95,    84,    30,   -31,   -63,   -56,   -20,
+            20,    41,    35,    12,   -12,   -24,   -21,    -7,     7,    13,
+            11,     4,    -3,    -6,    -5,    -1,
+    },
+    {
+            -2,    -5,    -6,    -3,     4,    11,    13,     6,    -8,   -21,
+           -24,   -11,    13,    36,    40,    19,   -21,   -57,   -63,   -29,
+            32,    86,    94,    43,   -47,  -126,  -138,   -63,    69,   183,
+           201,    92,  -101,  -268,  -297,  -136,   152,   411,   463,   219,
+          -252,  -711,  -850,  -435,   564,  1916,  3207,  3991,  3993,  3207,
+          1916,   564,  -435,  -850,  -711,  -252,   219,   463,   411,   152,
+          -136,  -297,  -268,  -101,    92,   201,   183,    69,   -63,  -138,
+          -126,   -47,    43,    94,    86,    32,   -29,   -63,   -57,   -21,
+            19,    40,    36,    13,   -11,   -24,   -21,    -8,     6,    13,
+            11,     4,    -3,    -6,    -5,    -2,
+    },
+    {
+            -1,    -5,    -6,    -3,     4,    11,    13,     7,    -7,   -21,
+           -24,   -12,    12,    35,    41,    20,   -20,   -56,   -63,   -31,
+            30,    84,    95,    46,   -45,  -124,  -139,   -66,    65,   181,
+           203,    97,   -95,  -265,  -299,  -144,   142,   405,   466,   230,
+          -236,  -700,  -854,  -457,   525,  1873,  3172,  3982,  4005,  3241,
+          1960,   602,  -412,  -847,  -722,  -268,   206,   460,   416,   161,
+          -129,  -295,  -272,  -107,    86,   200,   185,    73,   -59,  -137,
+          -128,   -50,    41,    94,    87,    34,   -27,   -63,   -57,   -22,
+            18,    40,    36,    14,   -11,   -24,   -21,    -8,     6,    13,
+            11,     4,    -3,    -6,    -5,    -2,
+    },
+    {
+            -1,    -5,    -6,    -4,     3,    11,    13,     7,    -7,   -20,
+           -25,   -13,    11,    35,    41,    21,   -18,   -55,   -64,   -32,
+            28,    83,    96,    48,   -42,  -123,  -140,   -70,    60,   178,
+           204,   102,   -88,  -261,  -301,  -151,   133,   399,   469,   242,
+          -220,  -688,  -856,  -479,   487,  1829,  3137,  3963,  4017,  3275,
+          2004,   641,  -388,  -842,  -732,  -284,   194,   457,   422,   171,
+          -121,  -292,  -275,  -113,    81,   198,   188,    78,   -56,  -136,
+          -129,   -53,    38,    93,    88,    36,   -26,   -62,   -58,   -24,
+            17,    40,    37,    15,   -10,   -24,   -22,    -9,     6,    13,
+            12,     4,    -3,    -6,    -5,    -2,
+    },
+    {
+            -1,    -5,    -6,    -4,     3,    11,    13,     8,    -6,   -20,
+           -25,   -13,    11,    34,    41,    22,   -17,   -54,   -64,   -34,
+            26,    82,    96,    50,   -39,  -121,  -141,   -73,    56,   176,
+           205,   107,   -82,  -257,  -302,  -159,   123,   393,   471,   254,
+          -203,  -677,  -858,  -500,   450,  1785,  3101,  3949,  4028,  3308,
+          2047,   681,  -364,  -837,  -742,  -300,   181,   453,   427,   180,
+          -113,  -290,  -279,  -120,    76,   196,   190,    82,   -52,  -135,
+          -131,   -56,    36,    92,    89,    38,   -24,   -61,   -59,   -25,
+            16,    39,    37,    16,   -10,   -24,   -22,    -9,     5,    13,
+            12,     5,    -3,    -6,    -5,    -2,
+    },
+    {
+            -1,    -5,    -6,    -4,     3,    10,    14,     8,    -6,   -20,
+           -25,   -14,    10,    34,    41,    23,   -16,   -53,   -64,   -35,
+            24,    81,    97,    52,   -36,  -119,  -142,   -77,    52,   173,
+           206,   112,   -76,  -253,  -304,  -166,   114,   387,   473,   265,
+          -187,  -665,  -860,  -521,   412,  1741,  3065,  3933,  4039,  3340,
+          2091,   721,  -340,  -832,  -752,  -316,   169,   449,   432,   190,
+          -105,  -287,  -282,  -126,    70,   194,   192,    86,   -48,  -134,
+          -132,   -59,    33,    91,    90,    40,   -22,   -61,   -59,   -26,
+            14,    39,    38,    16,    -9,   -24,   -22,    -9,     5,    13,
+            12,     5,    -2,    -6,    -5,    -2,
+    },
+    {
+            -1,    -4,    -6,    -4,     3,    10,    14,     8,    -5,   -19,
+           -25,   -15,     9,    33,    41,    24,   -14,   -52,   -65,   -37,
+            22,    79,    97,    55,   -33,  -117,  -142,   -80,    47,   170,
+           207,   116,   -69,  -249,  -305,  -173,   104,   380,   474,   276,
+          -171,  -653,  -861,  -541,   376,  1697,  3028,  3915,  4048,  3373,
+          2134,   761,  -314,  -826,  -761,  -332,   156,   445,   437,   199,
+           -97,  -284,  -284,  -132,    65,   192,   194,    90,   -45,  -132,
+          -133,   -62,    31,    90,    91,    42,   -21,   -60,   -60,   -28,
+            13,    39,    38,    17,    -8,   -23,   -23,   -10,     5,    13,
+            12,     5,    -2,    -6,    -5,    -2,
+    },
+    {
+            -1,    -4,    -6,    -4,     2,    10,    14,     8,    -5,   -19,
+           -25,   -15,     8,    32,    41,    25,   -13,   -51,   -65,   -38,
+            20,    78,    97,    57,   -30,  -115,  -143,   -83,    43,   167,
+           208,   121,   -63,  -245,  -306,  -180,    95,   373,   475,   286,
+          -155,  -640,  -862,  -560,   339,  1653,  2991,  3906,  4057,  3404,
+          2177,   801,  -289,  -819,  -771,  -348,   142,   441,   441,   208,
+           -88,  -281,  -287,  -138,    59,   190,   196,    94,   -41,  -131,
+          -135,   -65,    28,    89,    92,    44,   -19,   -60,   -61,   -29,
+            12,    38,    38,    18,    -7,   -23,   -23,   -10,     4,    13,
+            12,     5,    -2,    -6,    -5,    -2,
+    },
+    {
+            -1,    -4,    -6,    -4,     2,    10,    14,     9,    -4,   -19,
+           -25,   -16,     7,    32,    41,    26,   -12,   -51,   -65,   -40,
+            18,    77,    98,    59,   -27,  -113,  -143,   -86,    39,   164,
+           208,   125,   -57,  -240,  -307,  -186,    85,   366,   476,   297,
+          -140,  -627,  -862,  -579,   303,  1610,  2953,  3884,  4065,  3435,
+          2220,   842,  -262,  -812,  -779,  -364,   129,   436,   445,   218,
+           -80,  -278,  -290,  -144,    54,   188,   197,    99,   -37,  -129,
+          -136,   -68,    25,    88,    92,    46,   -17,   -59,   -61,   -30,
+            11,    38,    39,    19,    -7,   -23,   -23,   -11,     4,    13,
+            12,     6,    -2,    -6,    -6,    -2,
+    },
+    {
+            -1,    -4,    -6,    -4,     2,    10,    14,     9,    -4,   -18,
+           -25,   -16,     6,    31,    42,    26,   -10,   -50,   -65,   -41,
+            16,    75,    98,    61,   -24,  -111,  -144,   -89,    34,   161,
+           209,   130,   -50,  -236,  -307,  -193,    75,   359,   477,   307,
+          -124,  -614,  -861,  -597,   268,  1566,  2915,  3864,  4072,  3465,
+          2263,   883,  -235,  -804,  -787,  -379,   115,   430,   449,   227,
+           -71,  -274,  -292,  -150,    48,   185,   199,   103,   -33,  -128,
+          -137,   -71,    23,    87,    93,    48,   -15,   -58,   -62,   -31,
+            10,    37,    39,    20,    -6,   -23,   -23,   -11,     3,    12,
+            12,     6,    -2,    -6,    -6,    -2,
+    },
+    {
+            -1,    -4,    -6,    -5,     2,     9,    14,     9,    -3,   -18,
+           -25,   -17,     6,    31,    42,    27,    -9,   -49,   -65,   -42,
+            14,    74,    98,    63,   -21,  -109,  -144,   -92,    30,   158,
+           209,   134,   -44,  -231,  -308,  -199,    66,   352,   477,   317,
+          -108,  -601,  -860,  -614,   233,  1522,  2877,  3842,  4078,  3495,
+          2306,   924,  -208,  -796,  -795,  -395,   101,   425,   453,   236,
+           -63,  -270,  -294,  -156,    42,   183,   201,   107,   -29,  -126,
+          -138,   -73,    20,    86,    94,    50,   -13,   -57,   -62,   -33,
+             9,    37,    39,    20,    -5,   -22,   -23,   -12,     3,    12,
+            13,     6,    -2,    -6,    -6,    -3,
+    },
+    {
+            -1,    -4,    -6,    -5,     1,     9,    14,    10,    -3,   -18,
+           -25,   -17,     5,    30,    42,    28,    -8,   -48,   -65,   -44,
+            12,    72,    98,    65,   -18,  -106,  -144,   -95,    26,   155,
+           209,   138,   -38,  -226,  -308,  -205,    56,   345,   477,   326,
+           -92,  -587,  -859,  -631,   198,  1478,  2838,  3829,  4083,  3524,
+          2348,   965,  -180,  -786,  -803,  -411,    87,   419,   456,   245,
+           -54,  -266,  -297,  -162,    36,   180,   202,   111,   -25,  -124,
+          -139,   -76,    17,    85,    95,    52,   -11,   -57,   -63,   -34,
+             7,    36,    40,    21,    -5,   -22,   -24,   -12,     3,    12,
+            13,     6,    -1,    -6,    -6,    -3,
+    },
+    {
+             0,    -4,    -6,    -5,     1,     9,    14,    10,    -2,   -17,
+           -25,   -18,     4,    29,    42,    29,    -6,   -47,   -65,   -45,
+            10,    71,    98,    67,   -15,  -104,  -144,   -98,    21,   151,
+           209,   143,   -31,  -221,  -308,  -212,    47,   337,   477,   336,
+           -77,  -574,  -856,  -647,   164,  1435,  2799,  3803,  4088,  3553,
+          2391,  1007,  -151,  -777,  -810,  -426,    73,   413,   460,   254,
+           -45,  -262,  -298,  -168,    30,   177,   203,   115,   -21,  -122,
+          -140,   -79,    14,    83,    95,    53,   -10,   -56,   -63,   -35,
+             6,    36,    40,    22,    -4,   -22,   -24,   -13,     2,    12,
+            13,     7,    -1,    -6,    -6,    -3,
+    },
+    {
+             0,    -4,    -6,    -5,     1,     9,    13,    10,    -2,   -17,
+           -25,   -18,     3,    29,    42,    30,    -5,   -45,   -65,   -46,
+             8,    69,    98,    69,   -12,  -102,  -144,  -101,    17,   148,
+           209,   147,   -25,  -216,  -308,  -217,    37,   329,   477,   345,
+           -61,  -560,  -854,  -663,   130,  1391,  2760,  3780,  4091,  3581,
+          2433,  1049,  -122,  -767,  -817,  -442,    59,   407,   463,   263,
+           -36,  -258,  -300,  -173,    24,   174,   204,   119,   -17,  -120,
+          -141,   -82,    11,    82,    96,    55,    -8,   -55,   -63,   -36,
+             5,    35,    40,    23,    -3,   -21,   -24,   -13,     2,    12,
+            13,     7,    -1,    -6,    -6,    -3,
+    },
+    {
+             0,    -4,    -6,    -5,     1,     9,    13,    10,    -1,   -16,
+           -25,   -19,     2,    28,    41,    31,    -4,   -44,   -65,   -47,
+             6,    67,    98,    71,    -9,   -99,  -144,  -103,    13,   145,
+           209,   150,   -19,  -211,  -308,  -223,    28,   321,   476,   353,
+           -46,  -545,  -851,  -678,    97,  1348,  2720,  3760,  4094,  3608,
+          2475,  1091,   -92,  -756,  -823,  -457,    44,   400,   465,   271,
+           -27,  -254,  -302,  -179,    18,   171,   205,   122,   -13,  -118,
+          -141,   -84,     9,    81,    96,    57,    -6,   -54,   -64,   -37,
+             4,    35,    41,    23,    -2,   -21,   -24,   -14,     1,    12,
+            13,     7,    -1,    -6,    -6,    -3,
+    },
+    {
+             0,    -4,    -6,    -5,     0,     8,    13,    11,    -1,   -16,
+           -25,   -19,     2,    27,    41,    31,    -3,   -43,   -65,   -49,
+             4,    66,    98,    73,    -6,   -97,  -144,  -106,     9,   141,
+           209,   154,   -12,  -206,  -307,  -229,    19,   313,   475,   362,
+           -30,  -531,  -847,  -693,    64,  1305,  2680,  3734,  4096,  3635,
+          2516,  1134,   -62,  -744,  -829,  -472,    30,   393,   468,   280,
+           -18,  -249,  -303,  -185,    12,   168,   206,   126,    -8,  -116,
+          -142,   -87,     6,    79,    97,    59,    -4,   -53,   -64,   -39,
+             3,    34,    41,    24,    -2,   -21,   -24,   -14,     1,    11,
+            13,     7,     0,    -5,    -6,    -3,
+    },
+    {
+             0,    -3,    -6,    -5,     0,     8,    13,    11,     0,   -15,
+           -25,   -19,     1,    26,    41,    32,    -1,   -42,   -65,   -50,
+             2,    64,    98,    74,    -3,   -94,  -143,  -109,     4,   137,
+           208,   158,    -6,  -201,  -306,  -234,     9,   305,   474,   370,
+           -15,  -517,  -843,  -706,    32,  1262,  2639,  3704,  4098,  3661,
+          2557,  1176,   -31,  -732,  -834,  -487,    15,   386,   470,   289,
+            -9,  -244,  -304,  -190,     6,   165,   207,   130,    -4,  -113,
+          -142,   -89,     3,    78,    97,    61,    -2,   -52,   -64,   -40,
+             1,    33,    41,    25,    -1,   -20,   -24,   -15,     0,    11,
+            13,     8,     0,    -5,    -6,    -3,
+    },
+    {
+             0,    -3,    -6,    -5,     0,     8,    13,    11,     0,   -15,
+           -25,   -20,     0,    26,    41,    33,     0,   -41,   -65,   -51,
+             0,    62,    97,    76,     0,   -92,  -143,  -111,     0,   134,
+           208,   161,     0,  -196,  -305,  -239,     0,   297,   472,   378,
+             0,  -502,  -839,  -720,     0,  1219,  2598,  3688,  4098,  3686,
+          2598,  1219,     0,  -720,  -839,  -502,     0,   378,   472,   297,
+             0,  -239,  -305,  -196,     0,   161,   208,   134,     0,  -111,
+          -143,   -92,     0,    76,    97,    62,     0,   -51,   -65,   -41,
+             0,    33,    41,    26,     0,   -20,   -25,   -15,     0,    11,
+            13,     8,     0,    -5,    -6,    -3,
+    },
+};
+
+/* 192000 Hz, 112 taps, ~58 dB */
+static const int16_t coefs_192000[33][112] =
+{
+    {
+             3,     3,     2,    -1,    -5,    -8,    -7,    -1,     8,    14,
+            14,     6,    -8,   -22,   -26,   -17,     4,    28,    42,    34,
+             6,   -32,   -60,   -60,   -27,    27,    77,    94,    62,   -10,
+           -90,  -135,  -114,   -26,    91,   180,   186,    91,   -72,  -226,
+          -286,  -199,    15,   268,   429,   387,   114,  -303,  -676,  -783,
+          -460,   325,  1430,  2578,  3442,  3772,  3442,  2578,  1430,   325,
+          -460,  -783,  -676,  -303,   114,   387,   429,   268,    15,  -199,
+          -286,  -226,   -72,    91,   186,   180,    91,   -26,  -114,  -135,
+           -90,   -10,    62,    94,    77,    27,   -27,   -60,   -60,   -32,
+             6,    34,    42,    28,     4,   -17,   -26,   -22,    -8,     6,
+            14,    14,     8,    -1,    -7,    -8,    -5,    -1,     2,     3,
+             3,     0,
+    },
+    {
+             3,     3,     2,    -1,    -5,    -8,    -7,    -1,     7,    14,
+            15,     7,    -8,   -21,   -26,   -17,     4,    28,    42,    35,
+             7,   -30,   -59,   -61,   -29,    25,    76,    94,    64,    -7,
+           -88,  -134,  -115,   -30,    88,   178,   188,    96,   -66,  -222,
+          -286,  -204,     8,   261,   426,   392,   125,  -289,  -667,  -786,
+          -477,   294,  1393,  2544,  3422,  3761,  3461,  2611,  1467,   356,
+          -442,  -780,  -684,  -316,   102,   381,   431,   275,    23,  -194,
+          -285,  -230,   -77,    87,   185,   182,    95,   -23,  -112,  -135,
+           -92,   -13,    60,    94,    78,    29,   -26,   -60,   -60,   -33,
+             5,    34,    42,    29,     5,   -16,   -26,   -22,    -9,     6,
+            14,    14,     8,    -1,    -7,    -8,    -5,    -1,     2,     3,
+             3,     1,
+    },
+    {
+             3,     3,     2,    -1,    -5,    -8,    -7,    -1,     7,    14,
+            15,     7,    -7,   -21,   -26,   -18,     3,    27,    41,    36,
+             8,   -29,   -59,   -61,   -30,    24,    75,    94,    65,    -5,
+           -85,  -134,  -117,   -33,    84,   176,   189,   100,   -61,  -218,
+          -286,  -209,     0,   254,   424,   396,   137,  -276,  -658,  -788,
+          -494,   264,  1356,  2511,  3401,  3764,  3479,  2643,  1504,   387,
+          -423,  -777,  -692,  -330,    90,   376,   433,   282,    31,  -189,
+          -285,  -233,   -82,    82,   183,   183,    98,   -19,  -110,  -136,
+           -94,   -15,    58,    93,    79,    31,   -24,   -59,   -61,   -34,
+             4,    33,    42,    30,     6,   -16,   -26,   -22,    -9,     5,
+            14,    14,     8,     0,    -6,    -8,    -5,    -1,     2,     3,
+             3,     1,
+    },
+    {
+             2,     3,     3,    -1,    -5,    -8,    -7,    -2,     7,    14,
+            15,     7,    -7,   -21,   -26,   -18,     2,    26,    41,    36,
+            10,   -28,   -58,   -62,   -32,    22,    73,    94,    67,    -2,
+           -83,  -133,  -119,   -37,    80,   174,   190,   104,   -55,  -214,
+          -286,  -214,    -8,   246,   421,   401,   148,  -262,  -649,  -790,
+          -510,   234,  1320,  2477,  3380,  3763,  3498,  2675,  1541,   418,
+          -405,  -773,  -700,  -343,    79,   370,   435,   289,    39,  -184,
+          -284,  -237,   -88,    78,   181,   185,   102,   -16,  -108,  -136,
+           -96,   -18,    57,    93,    81,    33,   -23,   -58,   -61,   -35,
+             3,    33,    42,    30,     7,   -15,   -26,   -22,   -10,     5,
+            14,    15,     8,     0,    -6,    -8,    -6,    -1,     2,     3,
+             3,     1,
+    },
+    {
+             2,     3,     3,     0,    -5,    -8,    -7,    -2,     6,    14,
+            15,     8,    -6,   -20,   -26,   -19,     1,    26,    41,    37,
+            11,   -27,   -57,   -62,   -33,    20,    72,    94,    69,     0,
+           -81,  -132,  -120,   -40,    77,   172,   191,   108,   -50,  -210,
+          -286,  -218,   -16,   239,   418,   405,   159,  -248,  -639,  -791,
+          -526,   205,  1283,  2443,  3359,  3752,  3515,  2707,  1578,   450,
+          -386,  -769,  -708,  -356,    67,   365,   436,   296,    47,  -178,
+          -283,  -240,   -93,    73,   180,   186,   105,   -12,  -106,  -136,
+           -98,   -20,    55,    93,    82,    34,   -21,   -58,   -61,   -36,
+             2,    32,    42,    31,     8,   -15,   -26,   -23,   -10,     5,
+            14,    15,     9,     0,    -6,    -8,    -6,    -1,     2,     3,
+             3,     1,
+    },
+    {
+             2,     3,     3,     0,    -5,    -8,    -7,    -2,     6,    13,
+            15,     8,    -6,   -20,   -26,   -19,     1,    25,    41,    37,
+            12,   -26,   -57,   -62,   -34,    18,    71,    94,    70,     3,
+           -79,  -132,  -122,   -43,    73,   170,   192,   112,   -44,  -206,
+          -285,  -223,   -24,   231,   415,   409,   169,  -235,  -629,  -792,
+          -542,   176,  1246,  2409,  3337,  3759,  3532,  2739,  1615,   482,
+          -366,  -764,  -715,  -369,    54,   358,   437,   303,    56,  -173,
+          -282,  -243,   -99,    69,   178,   187,   108,    -9,  -104,  -136,
+          -100,   -23,    53,    92,    83,    36,   -20,   -57,   -62,   -37,
+             1,    31,    42,    31,     8,   -14,   -26,   -23,   -10,     4,
+            14,    15,     9,     0,    -6,    -8,    -6,    -2,     2,     3,
+             3,     1,
+    },
+    {
+             2,     3,     3,     0,    -4,    -8,    -7,    -2,     6,    13,
+            15,     8,    -5,   -19,   -26,   -20,     0,    24,    41,    38,
+            13,   -25,   -56,   -63,   -36,    16,    70,    94,    72,     5,
+           -76,  -131,  -123,   -47,    69,   168,   193,   116,   -39,  -202,
+          -285,  -227,   -31,   224,   412,   413,   180,  -221,  -619,  -792,
+          -557,   147,  1210,  2374,  3315,  3747,  3549,  2771,  1652,   515,
+          -346,  -759,  -722,  -383,    42,   352,   439,   309,    64,  -167,
+          -281,  -247,  -104,    64,   176,   189,   112,    -5,  -102,  -136,
+          -102,   -26,    51,    92,    84,    38,   -18,   -56,   -62,   -38,
+            -1,    31,    42,    32,     9,   -14,   -26,   -23,   -11,     4,
+            14,    15,     9,     1,    -6,    -8,    -6,    -2,     2,     3,
+             3,     1,
+    },
+    {
+             2,     3,     3,     0,    -4,    -8,    -7,    -2,     6,    13,
+            15,     9,    -5,   -19,   -26,   -20,    -1,    24,    40,    38,
+            14,   -23,   -55,   -63,   -37,    15,    68,    94,    73,     8,
+           -74,  -130,  -125,   -50,    66,   166,   194,   120,   -34,  -198,
+          -284,  -231,   -39,   216,   408,   416,   191,  -208,  -609,  -793,
+          -571,   119,  1174,  2340,  3292,  3744,  3564,  2802,  1689,   547,
+          -325,  -753,  -729,  -396,    30,   345,   439,   316,    72,  -161,
+          -280,  -250,  -109,    59,   174,   190,   115,    -1,  -100,  -136,
+          -104,   -28,    49,    91,    85,    40,   -16,   -56,   -63,   -39,
+            -2,    30,    42,    33,    10,   -13,   -25,   -24,   -11,     3,
+            13,    15,     9,     1,    -6,    -8,    -6,    -2,     2,     3,
+             3,     1,
+    },
+    {
+             2,     3,     3,     0,    -4,    -7,    -7,    -3,     5,    13,
+            15,     9,    -4,   -19,   -26,   -20,    -2,    23,    40,    38,
+            15,   -22,   -55,   -63,   -38,    13,    67,    94,    75,    10,
+           -72,  -129,  -126,   -53,    62,   164,   194,   124,   -28,  -193,
+          -283,  -235,   -46,   209,   404,   420,   201,  -194,  -599,  -792,
+          -585,    90,  1137,  2305,  3268,  3741,  3580,  2832,  1726,   580,
+          -304,  -747,  -736,  -409,    17,   339,   440,   322,    80,  -155,
+          -278,  -253,  -115,    54,   172,   191,   118,     2,   -97,  -136,
+          -106,   -31,    47,    91,    85,    41,   -15,   -55,   -63,   -40,
+            -3,    29,    42,    33,    11,   -12,   -25,   -24,   -12,     3,
+            13,    15,    10,     1,    -6,    -8,    -6,    -2,     2,     3,
+             3,     1,
+    },
+    {
+             2,     3,     3,     0,    -4,    -7,    -7,    -3,     5,    13,
+            15,     9,    -4,   -18,   -26,   -21,    -2,    22,    40,    39,
+            16,   -21,   -54,   -63,   -40,    11,    65,    94,    76,    13,
+           -69,  -128,  -127,   -56,    58,   161,   195,   127,   -23,  -189,
+          -282,  -239,   -54,   201,   400,   423,   211,  -180,  -588,  -791,
+          -599,    63,  1101,  2270,  3245,  3733,  3594,  2863,  1763,   613,
+          -283,  -740,  -742,  -422,     5,   332,   441,   328,    88,  -149,
+          -277,  -256,  -120,    50,   169,   192,   122,     6,   -95,  -136,
+          -108,   -34,    45,    90,    86,    43,   -13,   -54,   -63,   -41,
+            -4,    28,    42,    34,    11,   -12,   -25,   -24,   -12,     3,
+            13,    15,    10,     1,    -5,    -8,    -6,    -2,     2,     3,
+             3,     1,
+    },
+    {
+             2,     3,     3,     0,    -4,    -7,    -8,    -3,     5,    13,
+            15,    10,    -3,   -18,   -26,   -21,    -3,    21,    39,    39,
+            17,   -20,   -53,   -64,   -41,     9,    64,    94,    77,    15,
+           -67,  -127,  -128,   -59,    54,   159,   195,   131,   -17,  -184,
+          -281,  -243,   -61,   193,   396,   425,   221,  -167,  -577,  -790,
+          -612,    35,  1065,  2234,  3220,  3728,  3608,  2893,  1799,   647,
+          -261,  -733,  -748,  -434,    -8,   324,   441,   335,    96,  -143,
+          -275,  -258,  -125,    45,   167,   193,   125,    10,   -93,  -136,
+          -109,   -36,    43,    89,    87,    45,   -12,   -53,   -63,   -42,
+            -5,    28,    42,    34,    12,   -11,   -25,   -24,   -13,     2,
+            13,    15,    10,     2,    -5,    -8,    -6,    -2,     2,     3,
+             3,     1,
+    },
+    {
+             2,     3,     3,     0,    -4,    -7,    -8,    -3,     5,    12,
+            15,    10,    -3,   -18,   -26,   -22,    -4,    21,    39,    40,
+            18,   -19,   -52,   -64,   -42,     7,    62,    93,    79,    18,
+           -64,  -126,  -129,   -62,    51,   156,   196,   134,   -12,  -179,
+          -280,  -246,   -69,   185,   392,   428,   231,  -153,  -566,  -789,
+          -625,     9,  1029,  2199,  3195,  3723,  3622,  2922,  1836,   681,
+          -238,  -726,  -753,  -447,   -21,   317,   441,   341,   104,  -137,
+          -273,  -261,  -130,    40,   164,   193,   128,    13,   -90,  -136,
+          -111,   -39,    41,    89,    88,    46,   -10,   -52,   -64,   -43,
+            -7,    27,    42,    35,    13,   -11,   -25,   -25,   -13,     2,
+            13,    15,    10,     2,    -5,    -8,    -6,    -2,     1,     3,
+             3,     2,
+    },
+    {
+             2,     3,     3,     0,    -4,    -7,    -8,    -4,     4,    12,
+            15,    10,    -2,   -17,   -26,   -22,    -4,    20,    39,    40,
+            19,   -17,   -52,   -64,   -43,     6,    61,    93,    80,    20,
+           -62,  -124,  -130,   -65,    47,   154,   196,   138,    -7,  -175,
+          -279,  -249,   -76,   177,   388,   430,   240,  -140,  -555,  -787,
+          -637,   -18,   994,  2163,  3170,  3717,  3635,  2951,  1873,   714,
+          -216,  -718,  -758,  -460,   -34,   309,   441,   346,   113,  -130,
+          -271,  -263,  -135,    35,   162,   194,   131,    17,   -88,  -135,
+          -113,   -41,    38,    88,    89,    48,    -8,   -51,   -64,   -44,
+            -8,    26,    42,    35,    14,   -10,   -24,   -25,   -14,     1,
+            12,    15,    10,     2,    -5,    -8,    -7,    -3,     1,     3,
+             3,     2,
+    },
+    {
+             2,     3,     3,     1,    -4,    -7,    -8,    -4,     4,    12,
+            15,    10,    -2,   -17,   -26,   -22,    -5,    19,    38,    40,
+            20,   -16,   -51,   -64,   -44,     4,    59,    93,    81,    22,
+           -59,  -123,  -131,   -68,    43,   151,   196,   141,    -1,  -170,
+          -277,  -253,   -83,   169,   383,   432,   250,  -126,  -544,  -785,
+          -649,   -44,   958,  2127,  3144,  3709,  3647,  2980,  1910,   749,
+          -192,  -709,  -763,  -472,   -47,   301,   440,   352,   121,  -124,
+          -269,  -266,  -140,    30,   159,   195,   134,    21,   -85,  -135,
+          -115,   -44,    36,    87,    89,    50,    -6,   -51,   -64,   -45,
+            -9,    25,    42,    36,    15,    -9,   -24,   -25,   -14,     1,
+            12,    15,    11,     2,    -5,    -8,    -7,    -3,     1,     3,
+             3,     2,
+    },
+    {
+             2,     3,     3,     1,    -3,    -7,    -8,    -4,     4,    12,
+            15,    11,    -1,   -16,   -26,   -23,    -6,    18,    38,    40,
+            21,   -15,   -50,   -64,   -45,     2,    58,    92,    82,    25,
+           -57,  -122,  -132,   -71,    39,   149,   196,   144,     4,  -165,
+          -276,  -256,   -90,   161,   378,   434,   259,  -113,  -532,  -782,
+          -660,   -70,   923,  2091,  3118,  3706,  3659,  3008,  1946,   783,
+          -169,  -700,  -768,  -484,   -60,   293,   439,   358,   129,  -117,
+          -267,  -268,  -146,    25,   156,   195,   137,    24,   -82,  -135,
+          -116,   -47,    34,    86,    90,    51,    -5,   -50,   -64,   -46,
+           -10,    24,    41,    36,    15,    -9,   -24,   -25,   -15,     0,
+            12,    15,    11,     3,    -5,    -8,    -7,    -3,     1,     3,
+             3,     2,
+    },
+    {
+             2,     3,     3,     1,    -3,    -7,    -8,    -4,     4,    12,
+            15,    11,    -1,   -16,   -26,   -23,    -7,    18,    38,    41,
+            22,   -14,   -49,   -64,   -47,     0,    56,    92,    83,    27,
+           -54,  -121,  -133,   -74,    36,   146,   196,   147,     9,  -160,
+          -274,  -259,   -97,   153,   373,   436,   268,  -100,  -521,  -779,
+          -671,   -95,   887,  2055,  3091,  3696,  3670,  3036,  1983,   818,
+          -145,  -691,  -772,  -497,   -73,   285,   438,   363,   137,  -111,
+          -264,  -270,  -151,    19,   153,   195,   140,    28,   -80,  -134,
+          -118,   -49,    32,    85,    91,    53,    -3,   -49,   -64,   -47,
+           -11,    23,    41,    37,    16,    -8,   -24,   -25,   -15,     0,
+            12,    15,    11,     3,    -4,    -8,    -7,    -3,     1,     3,
+             3,     2,
+    },
+    {
+             2,     3,     3,     1,    -3,    -7,    -8,    -4,     3,    11,
+            15,    11,    -1,   -15,   -25,   -23,    -7,    17,    37,    41,
+            23,   -13,   -48,   -64,   -48,    -1,    55,    91,    84,    29,
+           -52,  -119,  -133,   -77,    32,   143,   196,   151,    14,  -155,
+          -272,  -262,  -104,   145,   368,   437,   276,   -86,  -509,  -775,
+          -681,  -120,   852,  2019,  3064,  3682,  3680,  3064,  2019,   852,
+          -120,  -681,  -775,  -509,   -86,   276,   437,   368,   145,  -104,
+          -262,  -272,  -155,    14,   151,   196,   143,    32,   -77,  -133,
+          -119,   -52,    29,    84,    91,    55,    -1,   -48,   -64,   -48,
+           -13,    23,    41,    37,    17,    -7,   -23,   -25,   -15,    -1,
+            11,    15,    11,     3,    -4,    -8,    -7,    -3,     1,     3,
+             3,     2,
+    },
+    {
+             2,     3,     3,     1,    -3,    -7,    -8,    -4,     3,    11,
+            15,    12,     0,   -15,   -25,   -24,    -8,    16,    37,    41,
+            23,   -11,   -47,   -64,   -49,    -3,    53,    91,    85,    32,
+           -49,  -118,  -134,   -80,    28,   140,   195,   153,    19,  -151,
+          -270,  -264,  -111,   137,   363,   438,   285,   -73,  -497,  -772,
+          -691,  -145,   818,  1983,  3036,  3676,  3690,  3091,  2055,   887,
+           -95,  -671,  -779,  -521,  -100,   268,   436,   373,   153,   -97,
+          -259,  -274,  -160,     9,   147,   196,   146,    36,   -74,  -133,
+          -121,   -54,    27,    83,    92,    56,     0,   -47,   -64,   -49,
+           -14,    22,    41,    38,    18,    -7,   -23,   -26,   -16,    -1,
+            11,    15,    12,     4,    -4,    -8,    -7,    -3,     1,     3,
+             3,     2,
+    },
+    {
+             2,     3,     3,     1,    -3,    -7,    -8,    -5,     3,    11,
+            15,    12,     0,   -15,   -25,   -24,    -9,    15,    36,    41,
+            24,   -10,   -46,   -64,   -50,    -5,    51,    90,    86,    34,
+           -47,  -116,  -135,   -82,    24,   137,   195,   156,    25,  -146,
+          -268,  -267,  -117,   129,   358,   439,   293,   -60,  -484,  -768,
+          -700,  -169,   783,  1946,  3008,  3666,  3699,  3118,  2091,   923,
+           -70,  -660,  -782,  -532,  -113,   259,   434,   378,   161,   -90,
+          -256,  -276,  -165,     4,   144,   196,   149,    39,   -71,  -132,
+          -122,   -57,    25,    82,    92,    58,     2,   -45,   -64,   -50,
+           -15,    21,    40,    38,    18,    -6,   -23,   -26,   -16,    -1,
+            11,    15,    12,     4,    -4,    -8,    -7,    -3,     1,     3,
+             3,     2,
+    },
+    {
+             2,     3,     3,     1,    -3,    -7,    -8,    -5,     2,    11,
+            15,    12,     1,   -14,   -25,   -24,    -9,    15,    36,    42,
+            25,    -9,   -45,   -64,   -51,    -6,    50,    89,    87,    36,
+           -44,  -115,  -135,   -85,    21,   134,   195,   159,    30,  -140,
+          -266,  -269,  -124,   121,   352,   440,   301,   -47,  -472,  -763,
+          -709,  -192,   749,  1910,  2980,  3648,  3708,  3144,  2127,   958,
+           -44,  -649,  -785,  -544,  -126,   250,   432,   383,   169,   -83,
+          -253,  -277,  -170,    -1,   141,   196,   151,    43,   -68,  -131,
+          -123,   -59,    22,    81,    93,    59,     4,   -44,   -64,   -51,
+           -16,    20,    40,    38,    19,    -5,   -22,   -26,   -17,    -2,
+            10,    15,    12,     4,    -4,    -8,    -7,    -4,     1,     3,
+             3,     2,
+    },
+    {
+             2,     3,     3,     1,    -3,    -7,    -8,    -5,     2,    10,
+            15,    12,     1,   -14,   -25,   -24,   -10,    14,    35,    42,
+            26,    -8,   -44,   -64,   -51,    -8,    48,    89,    88,    38,
+           -41,  -113,  -135,   -88,    17,   131,   194,   162,    35,  -135,
+          -263,  -271,  -130,   113,   346,   441,   309,   -34,  -460,  -758,
+          -718,  -216,   714,  1873,  2951,  3636,  3716,  3170,  2163,   994,
+           -18,  -637,  -787,  -555,  -140,   240,   430,   388,   177,   -76,
+          -249,  -279,  -175,    -7,   138,   196,   154,    47,   -65,  -130,
+          -124,   -62,    20,    80,    93,    61,     6,   -43,   -64,   -52,
+           -17,    19,    40,    39,    20,    -4,   -22,   -26,   -17,    -2,
+            10,    15,    12,     4,    -4,    -8,    -7,    -4,     0,     3,
+             3,     2,
+    },
+    {
+             2,     3,     3,     1,    -2,    -6,    -8,    -5,     2,    10,
+            15,    13,     2,   -13,   -25,   -25,   -11,    13,    35,    42,
+            27,    -7,   -43,   -64,   -52,   -10,    46,    88,    89,    41,
+           -39,  -111,  -136,   -90,    13,   128,   193,   164,    40,  -130,
+          -261,  -273,  -137,   104,   341,   441,   317,   -21,  -447,  -753,
+          -726,  -238,   681,  1836,  2922,  3622,  3723,  3195,  2199,  1029,
+             9,  -625,  -789,  -566,  -153,   231,   428,   392,   185,   -69,
+          -246,  -280,  -179,   -12,   134,   196,   156,    51,   -62,  -129,
+          -126,   -64,    18,    79,    93,    62,     7,   -42,   -64,   -52,
+           -19,    18,    40,    39,    21,    -4,   -22,   -26,   -18,    -3,
+            10,    15,    12,     5,    -3,    -8,    -7,    -4,     0,     3,
+             3,     2,
+    },
+    {
+             1,     3,     3,     2,    -2,    -6,    -8,    -5,     2,    10,
+            15,    13,     2,   -13,   -24,   -25,   -11,    12,    34,    42,
+            28,    -5,   -42,   -63,   -53,   -12,    45,    87,    89,    43,
+           -36,  -109,  -136,   -93,    10,   125,   193,   167,    45,  -125,
+          -258,  -275,  -143,    96,   335,   441,   324,    -8,  -434,  -748,
+          -733,  -261,   647,  1799,  2893,  3606,  3730,  3220,  2234,  1065,
+            35,  -612,  -790,  -577,  -167,   221,   425,   396,   193,   -61,
+          -243,  -281,  -184,   -17,   131,   195,   159,    54,   -59,  -128,
+          -127,   -67,    15,    77,    94,    64,     9,   -41,   -64,   -53,
+           -20,    17,    39,    39,    21,    -3,   -21,   -26,   -18,    -3,
+            10,    15,    13,     5,    -3,    -8,    -7,    -4,     0,     3,
+             3,     2,
+    },
+    {
+             1,     3,     3,     2,    -2,    -6,    -8,    -5,     1,    10,
+            15,    13,     3,   -12,   -24,   -25,   -12,    11,    34,    42,
+            28,    -4,   -41,   -63,   -54,   -13,    43,    86,    90,    45,
+           -34,  -108,  -136,   -95,     6,   122,   192,   169,    50,  -120,
+          -256,  -277,  -149,    88,   328,   441,   332,     5,  -422,  -742,
+          -740,  -283,   613,  1763,  2863,  3591,  3736,  3245,  2270,  1101,
+            63,  -599,  -791,  -588,  -180,   211,   423,   400,   201,   -54,
+          -239,  -282,  -189,   -23,   127,   195,   161,    58,   -56,  -127,
+          -128,   -69,    13,    76,    94,    65,    11,   -40,   -63,   -54,
+           -21,    16,    39,    40,    22,    -2,   -21,   -26,   -18,    -4,
+             9,    15,    13,     5,    -3,    -7,    -7,    -4,     0,     3,
+             3,     2,
+    },
+    {
+             1,     3,     3,     2,    -2,    -6,    -8,    -6,     1,    10,
+            15,    13,     3,   -12,   -24,   -25,   -12,    11,    33,    42,
+            29,    -3,   -40,   -63,   -55,   -15,    41,    85,    91,    47,
+           -31,  -106,  -136,   -97,     2,   118,   191,   172,    54,  -115,
+          -253,  -278,  -155,    80,   322,   440,   339,    17,  -409,  -736,
+          -747,  -304,   580,  1726,  2832,  3579,  3742,  3268,  2305,  1137,
+            90,  -585,  -792,  -599,  -194,   201,   420,   404,   209,   -46,
+          -235,  -283,  -193,   -28,   124,   194,   164,    62,   -53,  -126,
+          -129,   -72,    10,    75,    94,    67,    13,   -38,   -63,   -55,
+           -22,    15,    38,    40,    23,    -2,   -20,   -26,   -19,    -4,
+             9,    15,    13,     5,    -3,    -7,    -7,    -4,     0,     3,
+             3,     2,
+    },
+    {
+             1,     3,     3,     2,    -2,    -6,    -8,    -6,     1,     9,
+            15,    13,     3,   -11,   -24,   -25,   -13,    10,    33,    42,
+            30,    -2,   -39,   -63,   -56,   -16,    40,    85,    91,    49,
+           -28,  -104,  -136,  -100,    -1,   115,   190,   174,    59,  -109,
+          -250,  -280,  -161,    72,   316,   439,   345,    30,  -396,  -729,
+          -753,  -325,   547,  1689,  2802,  3561,  3747,  3292,  2340,  1174,
+           119,  -571,  -793,  -609,  -208,   191,   416,   408,   216,   -39,
+          -231,  -284,  -198,   -34,   120,   194,   166,    66,   -50,  -125,
+          -130,   -74,     8,    73,    94,    68,    15,   -37,   -63,   -55,
+           -23,    14,    38,    40,    24,    -1,   -20,   -26,   -19,    -5,
+             9,    15,    13,     6,    -2,    -7,    -8,    -4,     0,     3,
+             3,     2,
+    },
+    {
+             1,     3,     3,     2,    -2,    -6,    -8,    -6,     1,     9,
+            15,    14,     4,   -11,   -23,   -26,   -14,     9,    32,    42,
+            31,    -1,   -38,   -62,   -56,   -18,    38,    84,    92,    51,
+           -26,  -102,  -136,  -102,    -5,   112,   189,   176,    64,  -104,
+          -247,  -281,  -167,    64,   309,   439,   352,    42,  -383,  -722,
+          -759,  -346,   515,  1652,  2771,  3545,  3751,  3315,  2374,  1210,
+           147,  -557,  -792,  -619,  -221,   180,   413,   412,   224,   -31,
+          -227,  -285,  -202,   -39,   116,   193,   168,    69,   -47,  -123,
+          -131,   -76,     5,    72,    94,    70,    16,   -36,   -63,   -56,
+           -25,    13,    38,    41,    24,     0,   -20,   -26,   -19,    -5,
+             8,    15,    13,     6,    -2,    -7,    -8,    -4,     0,     3,
+             3,     2,
+    },
+    {
+             1,     3,     3,     2,    -2,    -6,    -8,    -6,     0,     9,
+            15,    14,     4,   -10,   -23,   -26,   -14,     8,    31,    42,
+            31,     1,   -37,   -62,   -57,   -20,    36,    83,    92,    53,
+           -23,  -100,  -136,  -104,    -9,   108,   187,   178,    69,   -99,
+          -243,  -282,  -173,    56,   303,   437,   358,    54,  -369,  -715,
+          -764,  -366,   482,  1615,  2739,  3537,  3754,  3337,  2409,  1246,
+           176,  -542,  -792,  -629,  -235,   169,   409,   415,   231,   -24,
+          -223,  -285,  -206,   -44,   112,   192,   170,    73,   -43,  -122,
+          -132,   -79,     3,    70,    94,    71,    18,   -34,   -62,   -57,
+           -26,    12,    37,    41,    25,     1,   -19,   -26,   -20,    -6,
+             8,    15,    13,     6,    -2,    -7,    -8,    -5,     0,     3,
+             3,     2,
+    },
+    {
+             1,     3,     3,     2,    -1,    -6,    -8,    -6,     0,     9,
+            15,    14,     5,   -10,   -23,   -26,   -15,     8,    31,    42,
+            32,     2,   -36,   -61,   -58,   -21,    34,    82,    93,    55,
+           -20,   -98,  -136,  -106,   -12,   105,   186,   180,    73,   -93,
+          -240,  -283,  -178,    47,   296,   436,   365,    67,  -356,  -708,
+          -769,  -386,   450,  1578,  2707,  3510,  3757,  3359,  2443,  1283,
+           205,  -526,  -791,  -639,  -248,   159,   405,   418,   239,   -16,
+          -218,  -286,  -210,   -50,   108,   191,   172,    77,   -40,  -120,
+          -132,   -81,     0,    69,    94,    72,    20,   -33,   -62,   -57,
+           -27,    11,    37,    41,    26,     1,   -19,   -26,   -20,    -6,
+             8,    15,    14,     6,    -2,    -7,    -8,    -5,     0,     3,
+             3,     2,
+    },
+    {
+             1,     3,     3,     2,    -1,    -6,    -8,    -6,     0,     8,
+            15,    14,     5,   -10,   -22,   -26,   -15,     7,    30,    42,
+            33,     3,   -35,   -61,   -58,   -23,    33,    81,    93,    57,
+           -18,   -96,  -136,  -108,   -16,   102,   185,   181,    78,   -88,
+          -237,  -284,  -184,    39,   289,   435,   370,    79,  -343,  -700,
+          -773,  -405,   418,  1541,  2675,  3502,  3759,  3380,  2477,  1320,
+           234,  -510,  -790,  -649,  -262,   148,   401,   421,   246,    -8,
+          -214,  -286,  -214,   -55,   104,   190,   174,    80,   -37,  -119,
+          -133,   -83,    -2,    67,    94,    73,    22,   -32,   -62,   -58,
+           -28,    10,    36,    41,    26,     2,   -18,   -26,   -21,    -7,
+             7,    15,    14,     7,    -2,    -7,    -8,    -5,    -1,     3,
+             3,     2,
+    },
+    {
+             1,     3,     3,     2,    -1,    -5,    -8,    -6,     0,     8,
+            14,    14,     5,    -9,   -22,   -26,   -16,     6,    30,    42,
+            33,     4,   -34,   -61,   -59,   -24,    31,    79,    93,    58,
+           -15,   -94,  -136,  -110,   -19,    98,   183,   183,    82,   -82,
+          -233,  -285,  -189,    31,   282,   433,   376,    90,  -330,  -692,
+          -777,  -423,   387,  1504,  2643,  3482,  3761,  3401,  2511,  1356,
+           264,  -494,  -788,  -658,  -276,   137,   396,   424,   254,     0,
+          -209,  -286,  -218,   -61,   100,   189,   176,    84,   -33,  -117,
+          -134,   -85,    -5,    65,    94,    75,    24,   -30,   -61,   -59,
+           -29,     8,    36,    41,    27,     3,   -18,   -26,   -21,    -7,
+             7,    15,    14,     7,    -1,    -7,    -8,    -5,    -1,     2,
+             3,     3,
+    },
+    {
+             1,     3,     3,     2,    -1,    -5,    -8,    -7,    -1,     8,
+            14,    14,     6,    -9,   -22,   -26,   -16,     5,    29,    42,
+            34,     5,   -33,   -60,   -60,   -26,    29,    78,    94,    60,
+           -13,   -92,  -135,  -112,   -23,    95,   182,   185,    87,   -77,
+          -230,  -285,  -194,    23,   275,   431,   381,   102,  -316,  -684,
+          -780,  -442,   356,  1467,  2611,  3460,  3762,  3422,  2544,  1393,
+           294,  -477,  -786,  -667,  -289,   125,   392,   426,   261,     8,
+          -204,  -286,  -222,   -66,    96,   188,   178,    88,   -30,  -115,
+          -134,   -88,    -7,    64,    94,    76,    25,   -29,   -61,   -59,
+           -30,     7,    35,    42,    28,     4,   -17,   -26,   -21,    -8,
+             7,    15,    14,     7,    -1,    -7,    -8,    -5,    -1,     2,
+             3,     3,
+    },
+    {
+             0,     3,     3,     2,    -1,    -5,    -8,    -7,    -1,     8,
+            14,    14,     6,    -8,   -22,   -26,   -17,     4,    28,    42,
+            34,     6,   -32,   -60,   -60,   -27,    27,    77,    94,    62,
+           -10,   -90,  -135,  -114,   -26,    91,   180,   186,    91,   -72,
+          -226,  -286,  -199,    15,   268,   429,   387,   114,  -303,  -676,
+          -783,  -460,   325,  1430,  2578,  3451,  3763,  3442,  2578,  1430,
+           325,  -460,  -783,  -676,  -303,   114,   387,   429,   268,    15,
+          -199,  -286,  -226,   -72,    91,   186,   180,    91,   -26,  -114,
+          -135,   -90,   -10,    62,    94,    77,    27,   -27,   -60,   -60,
+           -32,     6,    34,    42,    28,     4,   -17,   -26,   -22,    -8,
+             6,    14,    14,     8,    -1,    -7,    -8,    -5,    -1,     2,
+             3,     3,
+    },
+};
+
+static const struct polyphase_table polyphase_tables[] =
+{
+    {  44100,  32, &coefs_44100[0][0] },
+    {  48000,  32, &coefs_48000[0][0] },
+    {  88200,  48, &coefs_88200[0][0] },
+    {  96000,  56, &coefs_96000[0][0] },
+    { 176400,  96, &coefs_176400[0][0] },
+    { 192000, 112, &coefs_192000[0][0] },
+};
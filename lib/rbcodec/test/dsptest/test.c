@@ -0,0 +1,470 @@
+/***************************************************************************
+ *             __________               __   ___.
+ *   Open      \______   \ ____   ____ |  | _\_ |__   _______  ___
+ *   Source     |       _//  _ \_/ ___\|  |/ /| __ \ /  _ \  \/  /
+ *   Jukebox    |    |   (  <_> )  \___|    < | \_\ (  <_> > <  <
+ *   Firmware   |____|_  /\____/ \___  >__|_ \|___  /\____/__/\_ \
+ *                     \/            \/     \/    \/            \/
+ * $Id$
+ *
+ * Copyright (C) 2012 The Rockbox Project
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This software is distributed on an "AS IS" basis, WITHOUT WARRANTY OF ANY
+ * KIND, either express or implied.
+ *
+ ****************************************************************************/
+
+/* Checks that the hosted DSP kernels give bit-exact results compared to the
+ * generic C code in dsp.c and eq.c. The ref_* functions are copies of the
+ * generic versions and must be kept in sync with them.
+ *
+ * Also checks the polyphase resampler: it must produce as many samples as the
+ * linear one, not depend on how the input is split up, and actually remove
+ * content above the output Nyquist frequency. */
+
+#include <inttypes.h>
+#include <math.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "dsp.h"
+#include "dsp_asm.h"
+#include "eq.h"
+#include "polyphase.h"
+
+#define MAX_COUNT 1031
+#define ITERATIONS 2000
+
+long dsp_sw_gain;
+long dsp_sw_cross;
+
+static int failures = 0;
+
+/***************** reference versions from dsp.c *****************/
+
+static inline int32_t ref_fracmul(int32_t x, int32_t y)
+{
+    return (int32_t) (((int64_t)x * y) >> 31);
+}
+
+static inline int32_t ref_fracmul_shl(int32_t x, int32_t y, int z)
+{
+    return (int32_t) (((int64_t)x * y) >> (31 - z));
+}
+
+static inline int32_t ref_clip_sample_16(int32_t sample)
+{
+    if ((int16_t)sample != sample)
+        sample = 0x7fff ^ (sample >> 31);
+    return sample;
+}
+
+static void ref_apply_gain(int count, struct dsp_data *data, int32_t *buf[])
+{
+    const int32_t gain = data->gain;
+    int ch;
+
+    for (ch = 0; ch < data->num_channels; ch++)
+    {
+        int32_t *d = buf[ch];
+        int i;
+
+        for (i = 0; i < count; i++)
+            d[i] = ref_fracmul_shl(d[i], gain, 8);
+    }
+}
+
+static void ref_chan_mono(int count, int32_t *buf[])
+{
+    int32_t *sl = buf[0], *sr = buf[1];
+
+    while (count-- > 0)
+    {
+        int32_t lr = *sl/2 + *sr/2;
+        *sl++ = lr;
+        *sr++ = lr;
+    }
+}
+
+static void ref_chan_custom(int count, int32_t *buf[])
+{
+    const int32_t gain  = dsp_sw_gain;
+    const int32_t cross = dsp_sw_cross;
+    int32_t *sl = buf[0], *sr = buf[1];
+
+    while (count-- > 0)
+    {
+        int32_t l = *sl;
+        int32_t r = *sr;
+        *sl++ = ref_fracmul(l, gain) + ref_fracmul(r, cross);
+        *sr++ = ref_fracmul(r, gain) + ref_fracmul(l, cross);
+    }
+}
+
+static void ref_chan_karaoke(int count, int32_t *buf[])
+{
+    int32_t *sl = buf[0], *sr = buf[1];
+
+    while (count-- > 0)
+    {
+        int32_t ch = *sl/2 - *sr/2;
+        *sl++ = ch;
+        *sr++ = -ch;
+    }
+}
+
+static void ref_output_mono(int count, struct dsp_data *data,
+                            const int32_t *src[], int16_t *dst)
+{
+    const int32_t *s0 = src[0];
+    const int scale = data->output_scale;
+    const int dc_bias = 1 << (scale - 1);
+
+    while (count-- > 0)
+    {
+        int32_t lr = ref_clip_sample_16((*s0++ + dc_bias) >> scale);
+        *dst++ = lr;
+        *dst++ = lr;
+    }
+}
+
+static void ref_output_stereo(int count, struct dsp_data *data,
+                              const int32_t *src[], int16_t *dst)
+{
+    const int32_t *s0 = src[0];
+    const int32_t *s1 = src[1];
+    const int scale = data->output_scale;
+    const int dc_bias = 1 << (scale - 1);
+
+    while (count-- > 0)
+    {
+        *dst++ = ref_clip_sample_16((*s0++ + dc_bias) >> scale);
+        *dst++ = ref_clip_sample_16((*s1++ + dc_bias) >> scale);
+    }
+}
+
+/* Number of samples dsp_upsample()/dsp_downsample() output for count input
+ * samples, updating the phase the same way */
+static int ref_resample_count(int count, struct resample_data *r)
+{
+    uint32_t phase = r->phase;
+    int n = 0;
+
+    while ((phase >> 16) < (uint32_t)count)
+    {
+        phase += r->delta;
+        n++;
+    }
+
+    r->phase = phase - (count << 16);
+    return n;
+}
+
+/***************** test helpers *****************/
+
+static int32_t rand32(void)
+{
+    /* Mix in the extremes, which is where the vector code can go wrong */
+    switch (rand() % 16)
+    {
+    case 0:  return INT32_MIN;
+    case 1:  return INT32_MAX;
+    case 2:  return -1;
+    case 3:  return 0;
+    case 4:  return (rand() % 0x20000) - 0x10000;
+    default: return (int32_t)(((uint32_t)rand() << 16) ^ (uint32_t)rand());
+    }
+}
+
+static void fill(int32_t *buf, int count)
+{
+    int i;
+    for (i = 0; i < count; i++)
+        buf[i] = rand32();
+}
+
+static void check(const char *name, const void *a, const void *b, size_t size,
+                  int count)
+{
+    if (memcmp(a, b, size))
+    {
+        if (failures++ < 10)
+            printf("FAIL: %s, count %d\n", name, count);
+    }
+}
+
+/***************** tests *****************/
+
+typedef void (*chan_fn)(int count, int32_t *buf[]);
+
+static void test_channels(const char *name, chan_fn fn, chan_fn ref, int count)
+{
+    static int32_t a[2][MAX_COUNT], b[2][MAX_COUNT];
+    int32_t *abuf[2] = { a[0], a[1] }, *bbuf[2] = { b[0], b[1] };
+
+    fill(a[0], count);
+    fill(a[1], count);
+    memcpy(b, a, sizeof(a));
+    dsp_sw_gain = rand32();
+    dsp_sw_cross = rand32();
+
+    fn(count, abuf);
+    ref(count, bbuf);
+    check(name, a, b, sizeof(a), count);
+}
+
+static void test_apply_gain(int count)
+{
+    static int32_t a[2][MAX_COUNT], b[2][MAX_COUNT];
+    int32_t *abuf[2] = { a[0], a[1] }, *bbuf[2] = { b[0], b[1] };
+    struct dsp_data data;
+
+    fill(a[0], count);
+    fill(a[1], count);
+    memcpy(b, a, sizeof(a));
+    data.num_channels = 1 + rand() % 2;
+    data.gain = rand32();
+
+    dsp_apply_gain(count, &data, abuf);
+    ref_apply_gain(count, &data, bbuf);
+    check("dsp_apply_gain", a, b, sizeof(a), count);
+}
+
+static void test_output(int count)
+{
+    static int32_t src[2][MAX_COUNT];
+    static int16_t a[2*MAX_COUNT], b[2*MAX_COUNT];
+    const int32_t *s[2] = { src[0], src[1] };
+    struct dsp_data data;
+
+    fill(src[0], count);
+    fill(src[1], count);
+    /* WORD_FRACBITS (27) and 24..31 bit codec depths */
+    data.output_scale = 12 + rand() % 17;
+
+    memset(a, 0, sizeof(a));
+    memset(b, 0, sizeof(b));
+    sample_output_mono(count, &data, s, a);
+    ref_output_mono(count, &data, s, b);
+    check("sample_output_mono", a, b, sizeof(a), count);
+
+    memset(a, 0, sizeof(a));
+    memset(b, 0, sizeof(b));
+    sample_output_stereo(count, &data, s, a);
+    ref_output_stereo(count, &data, s, b);
+    check("sample_output_stereo", a, b, sizeof(a), count);
+}
+
+/* eq_filter() runs stereo in one interleaved pass; it must match running
+ * each channel separately. Coefficients are kept in the ranges eq.c uses so
+ * the filter stays stable over several blocks. */
+static void test_eq_filter(int count)
+{
+    static const unsigned shifts[] =
+        { EQ_SHELF_SHIFT, EQ_PEAK_SHIFT, FILTER_BISHELF_SHIFT };
+    static int32_t a[2][MAX_COUNT], b[2][MAX_COUNT];
+    int32_t *abuf[2] = { a[0], a[1] };
+    int32_t *bl[1] = { b[0] }, *br[1] = { b[1] };
+    struct eqfilter fa, fl, fr;
+    unsigned shift = shifts[rand() % 3];
+    int i, block;
+
+    eq_pk_coefs(0xffffffff / 44100 * (20 + rand() % 20000),
+                1 + rand() % 64, (rand() % 481) - 240, fa.coefs);
+    memset(fa.history, 0, sizeof(fa.history));
+    fl = fr = fa;
+
+    for (block = 0; block < 4; block++)
+    {
+        for (i = 0; i < count; i++)
+        {
+            a[0][i] = (rand() % 0x2000000) - 0x1000000;
+            a[1][i] = (rand() % 0x2000000) - 0x1000000;
+        }
+        memcpy(b, a, sizeof(a));
+
+        /* mono filtering only uses history[0], so fr tracks the right
+           channel there */
+        eq_filter(abuf, &fa, count, 2, shift);
+        eq_filter(bl, &fl, count, 1, shift);
+        eq_filter(br, &fr, count, 1, shift);
+
+        check("eq_filter", a, b, sizeof(a), count);
+        check("eq_filter history", fa.history[0], fl.history[0],
+              sizeof(fa.history[0]), count);
+        check("eq_filter history", fa.history[1], fr.history[0],
+              sizeof(fa.history[1]), count);
+    }
+}
+
+/* Resampling a signal in random chunks must give the same samples as doing
+ * it in one go, and as many as the linear resampler would. */
+static void test_polyphase_chunks(long frequency)
+{
+    enum { LEN = 4096 };
+    static int32_t in[2][LEN], a[2][LEN * 4], b[2][LEN * 4];
+    struct dsp_data data;
+    struct resample_data ref;
+    int32_t *dst[2];
+    const int32_t *src[2];
+    int done, na, nb, n, count;
+
+    fill(in[0], LEN);
+    fill(in[1], LEN);
+    for (done = 0; done < LEN; done++)
+    {
+        in[0][done] >>= 4;
+        in[1][done] >>= 4;
+    }
+
+    memset(&data, 0, sizeof (data));
+    data.num_channels = 2;
+    data.resample_data.delta = frequency * 65536LL / NATIVE_FREQUENCY;
+    if (!polyphase_set_frequency(frequency))
+    {
+        if (failures++ < 10)
+            printf("FAIL: polyphase_set_frequency(%ld)\n", frequency);
+        return;
+    }
+
+    polyphase_flush();
+    src[0] = in[0];
+    src[1] = in[1];
+    dst[0] = a[0];
+    dst[1] = a[1];
+    na = polyphase_resample(LEN, &data, src, dst);
+
+    polyphase_flush();
+    ref = data.resample_data;
+    ref.phase = data.resample_data.phase = 0;
+    nb = 0;
+    for (done = 0; done < LEN; done += count)
+    {
+        count = 1 + rand() % 700;
+        if (count > LEN - done)
+            count = LEN - done;
+        src[0] = &in[0][done];
+        src[1] = &in[1][done];
+        dst[0] = &b[0][nb];
+        dst[1] = &b[1][nb];
+        n = polyphase_resample(count, &data, src, dst);
+        if (n != ref_resample_count(count, &ref))
+        {
+            if (failures++ < 10)
+                printf("FAIL: polyphase count, %ld Hz\n", frequency);
+            return;
+        }
+        nb += n;
+    }
+
+    if (na != nb)
+    {
+        if (failures++ < 10)
+            printf("FAIL: polyphase chunked count, %ld Hz\n", frequency);
+        return;
+    }
+
+    check("polyphase chunks", a[0], b[0], na * sizeof (int32_t), na);
+    check("polyphase chunks", a[1], b[1], na * sizeof (int32_t), na);
+}
+
+/* Level in dB of the frequency f component of x relative to amplitude amp */
+static double tone_level(const int32_t *x, int n, double f, double amp)
+{
+    double re = 0, im = 0;
+    int i;
+
+    for (i = 0; i < n; i++)
+    {
+        re += x[i] * cos(2 * M_PI * f * i / NATIVE_FREQUENCY);
+        im += x[i] * sin(2 * M_PI * f * i / NATIVE_FREQUENCY);
+    }
+
+    return 20 * log10(sqrt(re * re + im * im) * 2 / n / amp);
+}
+
+/* A 1 kHz tone must pass unchanged, a tone between the output Nyquist
+ * frequency and the input one must not alias back */
+static void test_polyphase_alias(long frequency, double alias_freq)
+{
+    enum { LEN = 16384 };
+    static int32_t in[LEN], out[LEN];
+    const double amp = 1 << 26;
+    struct dsp_data data;
+    const int32_t *src[1] = { in };
+    int32_t *dst[1] = { out };
+    double pass, alias;
+    int i, n;
+
+    for (i = 0; i < LEN; i++)
+        in[i] = amp * (sin(2 * M_PI * 1000 * i / frequency) +
+                       sin(2 * M_PI * alias_freq * i / frequency)) / 2;
+
+    memset(&data, 0, sizeof (data));
+    data.num_channels = 1;
+    data.resample_data.delta = frequency * 65536LL / NATIVE_FREQUENCY;
+    polyphase_set_frequency(frequency);
+    polyphase_flush();
+    n = polyphase_resample(LEN, &data, src, dst);
+
+    /* skip the filter's start-up */
+    pass = tone_level(out + 256, n - 256, 1000, amp / 2);
+    alias = tone_level(out + 256, n - 256,
+                       fabs(NATIVE_FREQUENCY - alias_freq), amp / 2);
+
+    if (fabs(pass) > 0.1 || alias > -55)
+    {
+        if (failures++ < 10)
+            printf("FAIL: polyphase %ld Hz: 1 kHz %.2f dB, alias %.1f dB\n",
+                   frequency, pass, alias);
+    }
+}
+
+int main(void)
+{
+    int i;
+
+    srand(1);
+
+    for (i = 0; i < ITERATIONS; i++)
+    {
+        /* every tail length, then longer blocks */
+        int count = i < 64 ? i : rand() % MAX_COUNT;
+
+        test_apply_gain(count);
+        test_channels("sound_chan_mono", channels_process_sound_chan_mono,
+                      ref_chan_mono, count);
+        test_channels("sound_chan_custom", channels_process_sound_chan_custom,
+                      ref_chan_custom, count);
+        test_channels("sound_chan_karaoke",
+                      channels_process_sound_chan_karaoke,
+                      ref_chan_karaoke, count);
+        test_output(count);
+        test_eq_filter(count);
+    }
+
+    test_polyphase_chunks(11025);
+    test_polyphase_chunks(22050);
+    test_polyphase_chunks(48000);
+    test_polyphase_chunks(96000);
+    test_polyphase_chunks(192000);
+    test_polyphase_alias(88200, 30000);
+    test_polyphase_alias(96000, 30000);
+    test_polyphase_alias(176400, 60000);
+    test_polyphase_alias(192000, 80000);
+
+    if (failures)
+    {
+        printf("%d failures\n", failures);
+        return 1;
+    }
+
+    printf("OK\n");
+    return 0;
+}
@@ -0,0 +1,194 @@
+/***************************************************************************
+ *             __________               __   ___.
+ *   Open      \______   \ ____   ____ |  | _\_ |__   _______  ___
+ *   Source     |       _//  _ \_/ ___\|  |/ /| __ \ /  _ \  \/  /
+ *   Jukebox    |    |   (  <_> )  \___|    < | \_\ (  <_> > <  <
+ *   Firmware   |____|_  /\____/ \___  >__|_ \|___  /\____/__/\_ \
+ *                     \/            \/     \/    \/            \/
+ * $Id$
+ *
+ * Copyright (C) 2012 The Rockbox Project
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This software is distributed on an "AS IS" basis, WITHOUT WARRANTY OF ANY
+ * KIND, either express or implied.
+ *
+ ****************************************************************************/
+
+/* Checks that the transforms in apps/codecs/lib as built for this host give
+ * bit-exact results compared to the generic C code, for every FFT and IMDCT
+ * size the codecs use. The ref_* functions are the same sources built
+ * without the host's SIMD back end (see the Makefile).
+ *
+ * With -b, also times both versions of every size. */
+
+#include <inttypes.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "fft.h"
+#include "mdct.h"
+
+#define ITERATIONS 50
+#define MAX_FFT_BITS 12
+#define MIN_MDCT_BITS 6
+#define MAX_MDCT_BITS 13
+
+void ref_fft_calc_c(int nbits, FFTComplex *z);
+void ref_imdct_half(unsigned int nbits, fixed32 *output, const fixed32 *input);
+void ref_imdct_calc(unsigned int nbits, fixed32 *output, const fixed32 *input);
+
+static int failures = 0;
+
+static fixed32 input[1 << MAX_MDCT_BITS];
+static fixed32 out[1 << MAX_MDCT_BITS];
+static fixed32 ref_out[1 << MAX_MDCT_BITS];
+
+static int32_t rand32(void)
+{
+    return (int32_t)(((uint32_t)rand() << 16) ^ (uint32_t)rand());
+}
+
+/* Random samples of at most +-2^bits, so the transforms can't overflow */
+static void fill(int32_t *buf, int count, int bits)
+{
+    int i;
+    for (i = 0; i < count; i++)
+        buf[i] = rand32() >> (31 - bits);
+}
+
+static void check(const char *name, const void *a, const void *b, size_t size,
+                  int nbits)
+{
+    if (memcmp(a, b, size))
+    {
+        if (failures++ < 10)
+            printf("FAIL: %s, %d bits\n", name, nbits);
+    }
+}
+
+static void test_fft(int nbits)
+{
+    int count = 2 << nbits;
+
+    fill(input, count, 30 - nbits);
+    memcpy(out, input, count * sizeof(fixed32));
+    memcpy(ref_out, input, count * sizeof(fixed32));
+
+    ff_fft_calc_c(nbits, (FFTComplex *)out);
+    ref_fft_calc_c(nbits, (FFTComplex *)ref_out);
+    check("ff_fft_calc_c", out, ref_out, count * sizeof(fixed32), nbits);
+}
+
+static void test_imdct(int nbits)
+{
+    int n = 1 << nbits;
+
+    fill(input, n / 2, 29 - nbits);
+
+    ff_imdct_half(nbits, out, input);
+    ref_imdct_half(nbits, ref_out, input);
+    check("ff_imdct_half", out, ref_out, n / 2 * sizeof(fixed32), nbits);
+
+    ff_imdct_calc(nbits, out, input);
+    ref_imdct_calc(nbits, ref_out, input);
+    check("ff_imdct_calc", out, ref_out, n * sizeof(fixed32), nbits);
+}
+
+static double now(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+/* Nanoseconds per transform, over about the same amount of data for every
+ * size */
+static double time_fft(void (*fft)(int, FFTComplex *), int nbits)
+{
+    int i, iterations = (1 << 24) >> nbits;
+    double start;
+
+    fill(input, 2 << nbits, 30 - nbits);
+    start = now();
+    for (i = 0; i < iterations; i++)
+    {
+        /* transforming the output again keeps it in range since the test
+         * signal is small enough, and it doesn't need a copy */
+        if ((i & 15) == 0)
+            memcpy(out, input, (2 << nbits) * sizeof(fixed32));
+        fft(nbits, (FFTComplex *)out);
+    }
+    return (now() - start) * 1e9 / iterations;
+}
+
+static double time_imdct(void (*imdct)(unsigned int, fixed32 *,
+                                       const fixed32 *), int nbits)
+{
+    int i, iterations = (1 << 24) >> nbits;
+    double start;
+
+    fill(input, 1 << (nbits - 1), 29 - nbits);
+    start = now();
+    for (i = 0; i < iterations; i++)
+        imdct(nbits, out, input);
+    return (now() - start) * 1e9 / iterations;
+}
+
+static void bench(void)
+{
+    int nbits;
+
+    printf("%-14s %5s %10s %10s %7s\n", "", "size", "ref ns", "ns", "speedup");
+
+    for (nbits = 2; nbits <= MAX_FFT_BITS; nbits++)
+    {
+        double ref = time_fft(ref_fft_calc_c, nbits);
+        double opt = time_fft(ff_fft_calc_c, nbits);
+        printf("%-14s %5d %10.0f %10.0f %6.2fx\n", "ff_fft_calc_c",
+               1 << nbits, ref, opt, ref / opt);
+    }
+
+    for (nbits = MIN_MDCT_BITS; nbits <= MAX_MDCT_BITS; nbits++)
+    {
+        double ref = time_imdct(ref_imdct_half, nbits);
+        double opt = time_imdct(ff_imdct_half, nbits);
+        printf("%-14s %5d %10.0f %10.0f %6.2fx\n", "ff_imdct_half",
+               1 << nbits, ref, opt, ref / opt);
+    }
+}
+
+int main(int argc, char *argv[])
+{
+    int i, nbits;
+
+    srand(1);
+
+    for (i = 0; i < ITERATIONS; i++)
+    {
+        for (nbits = 2; nbits <= MAX_FFT_BITS; nbits++)
+            test_fft(nbits);
+
+        for (nbits = MIN_MDCT_BITS; nbits <= MAX_MDCT_BITS; nbits++)
+            test_imdct(nbits);
+    }
+
+    if (failures)
+    {
+        printf("%d failures\n", failures);
+        return 1;
+    }
+
+    printf("OK\n");
+
+    if (argc > 1 && !strcmp(argv[1], "-b"))
+        bench();
+
+    return 0;
+}
@@ -0,0 +1,236 @@
+/***************************************************************************
+ *             __________               __   ___.
+ *   Open      \______   \ ____   ____ |  | _\_ |__   _______  ___
+ *   Source     |       _//  _ \_/ ___\|  |/ /| __ \ /  _ \  \/  /
+ *   Jukebox    |    |   (  <_> )  \___|    < | \_\ (  <_> > <  <
+ *   Firmware   |____|_  /\____/ \___  >__|_ \|___  /\____/__/\_ \
+ *                     \/            \/     \/    \/            \/
+ * $Id$
+ *
+ * Copyright (C) 2012 The Rockbox Project
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This software is distributed on an "AS IS" basis, WITHOUT WARRANTY OF ANY
+ * KIND, either express or implied.
+ *
+ ****************************************************************************/
+
+/* Checks the codec heap (codec_malloc() and friends) as the codecs see it,
+ * with a codec buffer about the size of a small target's. */
+
+#include <stdarg.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "codeclib.h"
+
+#define BUFFER_SIZE (512 * 1024)
+#define MAX_BLOCKS 64
+#define ITERATIONS 20000
+#define TRACKS 1000
+
+struct codec_api *ci;
+
+static int failures = 0;
+
+static char buffer[BUFFER_SIZE] __attribute__((aligned(CACHEALIGN_SIZE)));
+
+static struct {
+    unsigned char *ptr;
+    size_t size;
+    unsigned char fill;
+} blocks[MAX_BLOCKS];
+
+static void *ci_codec_get_buffer(size_t *size)
+{
+    *size = sizeof(buffer);
+    return buffer;
+}
+
+static void ci_debugf(const char *fmt, ...)
+{
+    va_list ap;
+    va_start(ap, fmt);
+    vprintf(fmt, ap);
+    va_end(ap);
+}
+
+static struct codec_api api;
+
+static void check(bool ok, const char *what, int i)
+{
+    if (!ok && failures++ < 10)
+        printf("FAIL: %s (%d)\n", what, i);
+}
+
+static bool filled(const unsigned char *p, size_t size, unsigned char fill)
+{
+    size_t i;
+    for (i = 0; i < size; i++)
+        if (p[i] != fill)
+            return false;
+    return true;
+}
+
+static size_t random_size(void)
+{
+    /* mostly small blocks, some large ones */
+    return rand() % 8 ? rand() % 512 : rand() % (32 * 1024);
+}
+
+static size_t live_size(void)
+{
+    size_t total = 0;
+    int i;
+    for (i = 0; i < MAX_BLOCKS; i++)
+        if (blocks[i].ptr)
+            total += blocks[i].size;
+    return total;
+}
+
+/* Random mallocs, callocs, reallocs and frees, checking that no block ever
+ * overlaps another */
+static void test_random(void)
+{
+    size_t peak = 0;
+    int i;
+
+    codec_init();
+    memset(blocks, 0, sizeof(blocks));
+
+    for (i = 0; i < ITERATIONS; i++)
+    {
+        int k = rand() % MAX_BLOCKS;
+        size_t size = random_size();
+        unsigned char fill = rand();
+
+        if (blocks[k].ptr)
+        {
+            check(filled(blocks[k].ptr, blocks[k].size, blocks[k].fill),
+                  "block contents", i);
+            if (rand() % 2)
+            {
+                unsigned char *p = codec_realloc(blocks[k].ptr, size);
+                check(p != NULL, "realloc", i);
+                check(filled(p, MIN(size, blocks[k].size), blocks[k].fill),
+                      "realloc contents", i);
+                blocks[k].ptr = p;
+            }
+            else
+            {
+                codec_free(blocks[k].ptr);
+                blocks[k].ptr = NULL;
+                continue;
+            }
+        }
+        else if (rand() % 2)
+        {
+            blocks[k].ptr = codec_calloc(1, size);
+            check(blocks[k].ptr != NULL, "calloc", i);
+            check(filled(blocks[k].ptr, size, 0), "calloc contents", i);
+        }
+        else
+        {
+            blocks[k].ptr = codec_malloc(size);
+            check(blocks[k].ptr != NULL, "malloc", i);
+        }
+
+        if (blocks[k].ptr == NULL)
+            continue;
+
+        check(((uintptr_t)blocks[k].ptr & (CACHEALIGN_SIZE - 1)) == 0,
+              "alignment", i);
+        memset(blocks[k].ptr, fill, size);
+        blocks[k].size = size;
+        blocks[k].fill = fill;
+
+        peak = MAX(peak, live_size());
+        check(codec_heap_used() == live_size(), "used size", i);
+    }
+
+    check(codec_heap_peak() >= peak, "peak", 0);
+
+    for (i = 0; i < MAX_BLOCKS; i++)
+    {
+        if (blocks[i].ptr)
+            check(filled(blocks[i].ptr, blocks[i].size, blocks[i].fill),
+                  "block contents at end", i);
+        codec_free(blocks[i].ptr);
+    }
+    check(codec_heap_used() == 0, "used size at end", 0);
+}
+
+/* A codec that allocates its stream state for every track and frees it again
+ * must be able to do so forever without codec_init() in between */
+static void test_gapless(void)
+{
+    int track, i;
+
+    codec_init();
+    for (track = 0; track < TRACKS; track++)
+    {
+        void *state = codec_calloc(1, 100 * 1024);
+        void *tables[8];
+        check(state != NULL, "stream state", track);
+        for (i = 0; i < 8; i++)
+        {
+            tables[i] = codec_malloc(4096 + track % 1000);
+            check(tables[i] != NULL, "stream tables", track);
+        }
+        for (i = 7; i >= 0; i--)
+            codec_free(tables[i]);
+        codec_free(state);
+    }
+    check(codec_heap_used() == 0, "used size after tracks", 0);
+}
+
+/* codec_init() starts every track with an empty heap */
+static void test_init(void)
+{
+    void *p;
+
+    codec_init();
+    p = codec_malloc(BUFFER_SIZE / 2);
+    check(p != NULL, "half the buffer", 0);
+    check(codec_malloc(BUFFER_SIZE / 2) == NULL, "more than the buffer", 0);
+
+    codec_init();
+    check(codec_heap_used() == 0, "used size after init", 0);
+    check(codec_malloc(BUFFER_SIZE / 2) != NULL, "half the buffer again", 0);
+    check(codec_malloc(BUFFER_SIZE) == NULL, "all of the buffer", 0);
+}
+
+int main(void)
+{
+    api.codec_get_buffer = ci_codec_get_buffer;
+    api.memset = memset;
+    api.memcpy = memcpy;
+    api.debugf = ci_debugf;
+    ci = &api;
+
+    srand(1);
+
+    test_random();
+    test_gapless();
+    test_init();
+
+    /* a dump with a few blocks left over */
+    codec_init();
+    codec_malloc(1000);
+    codec_calloc(10, 100);
+    codec_heap_dump();
+
+    if (failures)
+    {
+        printf("%d failures\n", failures);
+        return 1;
+    }
+
+    printf("OK\n");
+    return 0;
+}
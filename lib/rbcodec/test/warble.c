@@ -29,11 +29,23 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <sys/mman.h>
+#include <sys/resource.h>
 #include <sys/stat.h>
+#include <sys/wait.h>
+#include <time.h>
 #include <unistd.h>
+#ifdef __linux__
+#include <linux/perf_event.h>
+#include <sys/syscall.h>
+#endif
+#if defined(__i386__) || defined(__x86_64__)
+#include <x86intrin.h>
+#endif
 #include "buffering.h" /* TYPE_PACKET_AUDIO */
 #include "codecs.h"
 #include "core_alloc.h" /* core_allocator_init */
+#include "crc32.h"
 #include "debug.h"
 #include "dsp.h"
 #include "metadata.h"
@@ -67,8 +79,12 @@ void mutex_unlock(struct mutex *m)
 {
 }
 
+static bool quiet = false;
+
 void debugf(const char *fmt, ...)
 {
+    if (quiet)
+        return;
     va_list ap;
     va_start(ap, fmt);
     vfprintf(stderr, fmt, ap);
@@ -77,8 +93,9 @@ void debugf(const char *fmt, ...)
 
 /***************** INTERNAL *****************/
 
-static enum { MODE_PLAY, MODE_WRITE } mode;
+static enum { MODE_PLAY, MODE_WRITE, MODE_BATCH } mode;
 static bool use_dsp = true;
+static bool show_profile = false;
 static bool enable_loop = false;
 static const char *config = "";
 
@@ -326,6 +343,324 @@ static void playback_pcm(int16_t *pcm, int count)
     }
 }
 
+/***** MODE_BATCH *****/
+
+/* MODE_BATCH decodes a list of files using several worker processes. Each
+ * file is decoded by a freshly forked child, so every file gets its own codec
+ * instance and DSP state no matter how much global state they keep. The output
+ * is checksummed instead of written, and the children report back through a
+ * shared anonymous mapping. The parent collects resource usage with wait4(). */
+
+struct batch_result {
+    bool ok;
+    unsigned long samples;     /* samples output by the codec */
+    unsigned long out_samples; /* samples after the DSP (or raw samples) */
+    unsigned long freq;        /* codec output frequency */
+    uint64_t wall_ns;          /* wall clock time spent decoding */
+    uint64_t cpu_us;           /* user + system time of the worker */
+    long maxrss_kb;            /* peak resident set size of the worker */
+    uint64_t cycles;           /* CPU cycles spent decoding, 0 if unknown */
+    unsigned long codec_kb;    /* peak use of the codec's heap */
+    uint32_t crc;              /* CRC32 of the little-endian output */
+#ifdef DSP_PROFILE
+    struct dsp_profile_stage profile[DSP_PROFILE_NUM_STAGES];
+#endif
+};
+
+static char **batch_files;
+static int batch_num_files = 0;
+static int batch_jobs = 0;
+static struct batch_result *batch_results;
+static struct batch_result *batch_cur;
+static int batch_cycles_fd = -1;
+
+static void batch_read_list(const char *list_fn)
+{
+    FILE *f = strcmp(list_fn, "-") ? fopen(list_fn, "r") : stdin;
+    if (!f) {
+        perror(list_fn);
+        exit(1);
+    }
+
+    int alloc = 0;
+    char *line = NULL;
+    size_t line_size = 0;
+    ssize_t len;
+    while ((len = getline(&line, &line_size, f)) != -1) {
+        while (len > 0 && (line[len-1] == '\n' || line[len-1] == '\r'))
+            line[--len] = '\0';
+        if (len == 0 || line[0] == '#')
+            continue;
+        if (batch_num_files == alloc) {
+            alloc = alloc ? 2 * alloc : 64;
+            batch_files = realloc(batch_files, alloc * sizeof(*batch_files));
+        }
+        batch_files[batch_num_files++] = strdup(line);
+    }
+    free(line);
+    if (f != stdin)
+        fclose(f);
+
+    if (batch_num_files == 0) {
+        fprintf(stderr, "error: no files in %s\n", list_fn);
+        exit(1);
+    }
+}
+
+static void batch_init(const char *list_fn)
+{
+    mode = MODE_BATCH;
+    batch_read_list(list_fn);
+    if (batch_jobs <= 0)
+        batch_jobs = sysconf(_SC_NPROCESSORS_ONLN);
+    if (batch_jobs <= 0)
+        batch_jobs = 1;
+
+    batch_results = mmap(NULL, batch_num_files * sizeof(*batch_results),
+                         PROT_READ | PROT_WRITE, MAP_SHARED | MAP_ANONYMOUS,
+                         -1, 0);
+    if (batch_results == MAP_FAILED) {
+        perror("mmap");
+        exit(1);
+    }
+    memset(batch_results, 0, batch_num_files * sizeof(*batch_results));
+}
+
+/* The cycle counter of the CPU, if the kernel lets us use it. Otherwise x86
+ * falls back to the time stamp counter, which ticks at a fixed rate and keeps
+ * going while the worker is descheduled, so it is less exact. */
+static uint64_t batch_cycles(void)
+{
+#ifdef __linux__
+    if (batch_cycles_fd >= 0) {
+        uint64_t count;
+        if (read(batch_cycles_fd, &count, sizeof(count)) == sizeof(count))
+            return count;
+        return 0;
+    }
+#endif
+#if defined(__i386__) || defined(__x86_64__)
+    return __rdtsc();
+#else
+    return 0;
+#endif
+}
+
+static void batch_cycles_init(void)
+{
+#ifdef __linux__
+    struct perf_event_attr attr;
+    memset(&attr, 0, sizeof(attr));
+    attr.size = sizeof(attr);
+    attr.type = PERF_TYPE_HARDWARE;
+    attr.config = PERF_COUNT_HW_CPU_CYCLES;
+    attr.exclude_kernel = 1;
+    attr.exclude_hv = 1;
+    attr.inherit = 1; /* count codec threads too */
+    batch_cycles_fd = syscall(__NR_perf_event_open, &attr, 0, -1, -1, 0);
+#endif
+}
+
+static void batch_pcm(const void *pcm, int size, int count)
+{
+    batch_cur->crc = crc_32(pcm, size, batch_cur->crc);
+    batch_cur->out_samples += count;
+}
+
+static void batch_pcm16(int16_t *pcm, int count)
+{
+    int i;
+    for (i = 0; i < 2 * count; i++)
+        pcm[i] = htole16(pcm[i]);
+    batch_pcm(pcm, 4 * count, count);
+}
+
+static void batch_pcm_raw(int32_t *pcm, int count)
+{
+    int i;
+    for (i = 0; i < count; i++)
+        pcm[i] = htole32(pcm[i]);
+    batch_pcm(pcm, count * sizeof(*pcm), count / format.channels);
+}
+
+static uint64_t timespec_ns(const struct timespec *ts)
+{
+    return ts->tv_sec * 1000000000ull + ts->tv_nsec;
+}
+
+static uint64_t timeval_us(const struct timeval *tv)
+{
+    return tv->tv_sec * 1000000ull + tv->tv_usec;
+}
+
+static bool decode_file(const char *input_fn);
+
+#ifdef DSP_PROFILE
+static void print_profile(const struct dsp_profile_stage *p, FILE *f)
+{
+    uint64_t total = 0;
+    int i;
+
+    for (i = 0; i < DSP_PROFILE_NUM_STAGES; i++)
+        total += p[i].time;
+
+    fprintf(f, "DSP profile: %.3f ms total\n", total / 1e6);
+    for (i = 0; i < DSP_PROFILE_NUM_STAGES; i++) {
+        if (p[i].calls == 0)
+            continue;
+        fprintf(f, "  %-10s %10.3f ms %5.1f%% %8.2f ns/smp "
+                   "%10lu samples %8lu calls\n",
+                dsp_profile_stage_name(i), p[i].time / 1e6,
+                total ? p[i].time * 100.0 / total : 0.0,
+                p[i].samples ? (double)p[i].time / p[i].samples : 0.0,
+                p[i].samples, p[i].calls);
+    }
+}
+#endif
+
+static void batch_worker(int index)
+{
+    struct timespec start, end;
+    uint64_t cycles;
+    bool ok;
+
+    batch_cur = &batch_results[index];
+    batch_cur->crc = 0xffffffff;
+    batch_cycles_init();
+    cycles = batch_cycles();
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    ok = decode_file(batch_files[index]);
+    clock_gettime(CLOCK_MONOTONIC, &end);
+    cycles = batch_cycles() - cycles;
+
+    batch_cur->samples = num_output_samples;
+    batch_cur->freq = format.freq;
+#ifdef DSP_PROFILE
+    if (use_dsp)
+        memcpy(batch_cur->profile, dsp_profile_get(ci.dsp),
+               sizeof(batch_cur->profile));
+#endif
+    batch_cur->wall_ns = timespec_ns(&end) - timespec_ns(&start);
+    batch_cur->cycles = cycles;
+    batch_cur->ok = ok;
+    exit(ok ? 0 : 1);
+}
+
+static void batch_print(const char *fn, const struct batch_result *r)
+{
+    double secs = r->wall_ns / 1e9;
+    double rate = secs > 0 ? r->samples / secs : 0;
+    double realtime = r->freq ? rate / r->freq : 0;
+    double cycles = r->samples ? (double)r->cycles / r->samples : 0;
+
+    printf("%-4s %10lu samples %10.0f smp/s %8.1fx realtime %8.1f cyc/smp "
+           "%8lu KiB %6lu KiB codec crc %08x %s\n",
+           r->ok ? "OK" : "FAIL", r->samples, rate, realtime, cycles,
+           r->maxrss_kb, r->codec_kb, (unsigned)r->crc, fn);
+    fflush(stdout);
+}
+
+static int batch_run(void)
+{
+    pid_t pids[batch_num_files];
+    int next = 0, running = 0, failed = 0;
+    struct timespec start, end;
+
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    while (next < batch_num_files || running > 0) {
+        while (running < batch_jobs && next < batch_num_files) {
+            fflush(stdout);
+            pid_t pid = fork();
+            if (pid == -1) {
+                perror("fork");
+                exit(1);
+            } else if (pid == 0) {
+                batch_worker(next);
+            }
+            pids[next++] = pid;
+            running++;
+        }
+
+        int status, i;
+        struct rusage ru;
+        pid_t pid = wait4(-1, &status, 0, &ru);
+        if (pid == -1) {
+            perror("wait4");
+            exit(1);
+        }
+        for (i = 0; i < next && pids[i] != pid; i++);
+        if (i == next)
+            continue;
+        running--;
+
+        struct batch_result *r = &batch_results[i];
+        r->ok = r->ok && WIFEXITED(status) && WEXITSTATUS(status) == 0;
+        r->cpu_us = timeval_us(&ru.ru_utime) + timeval_us(&ru.ru_stime);
+        r->maxrss_kb = ru.ru_maxrss;
+        if (!r->ok)
+            failed++;
+        batch_print(batch_files[i], r);
+    }
+    clock_gettime(CLOCK_MONOTONIC, &end);
+
+    /* Aggregate */
+    unsigned long long total_samples = 0;
+    unsigned long long total_cycles = 0;
+    double total_audio = 0, total_decode = 0, total_cpu = 0;
+    long maxrss_kb = 0;
+    unsigned long codec_kb = 0;
+    int i;
+#ifdef DSP_PROFILE
+    struct dsp_profile_stage profile[DSP_PROFILE_NUM_STAGES];
+    memset(profile, 0, sizeof(profile));
+#endif
+    for (i = 0; i < batch_num_files; i++) {
+        const struct batch_result *r = &batch_results[i];
+        if (!r->ok)
+            continue;
+#ifdef DSP_PROFILE
+        int j;
+        for (j = 0; j < DSP_PROFILE_NUM_STAGES; j++) {
+            profile[j].time += r->profile[j].time;
+            profile[j].calls += r->profile[j].calls;
+            profile[j].samples += r->profile[j].samples;
+        }
+#endif
+        total_samples += r->samples;
+        if (r->freq)
+            total_audio += (double)r->samples / r->freq;
+        total_decode += r->wall_ns / 1e9;
+        total_cpu += r->cpu_us / 1e6;
+        total_cycles += r->cycles;
+        maxrss_kb = MAX(maxrss_kb, r->maxrss_kb);
+        codec_kb = MAX(codec_kb, r->codec_kb);
+    }
+    double wall = (timespec_ns(&end) - timespec_ns(&start)) / 1e9;
+
+    printf("\n%d files, %d failed, %d jobs\n",
+           batch_num_files, failed, batch_jobs);
+    printf("Decoded: %llu samples, %.1f s of audio\n",
+           total_samples, total_audio);
+    printf("Time: %.3f s wall, %.3f s decoding, %.3f s CPU\n",
+           wall, total_decode, total_cpu);
+    if (total_decode > 0)
+        printf("Per worker: %.0f smp/s, %.1fx realtime\n",
+               total_samples / total_decode, total_audio / total_decode);
+    if (wall > 0)
+        printf("Aggregate: %.0f smp/s, %.1fx realtime\n",
+               total_samples / wall, total_audio / wall);
+    if (total_cycles && total_samples)
+        printf("Cycles: %.1f per sample\n",
+               (double)total_cycles / total_samples);
+    printf("Peak RSS: %ld KiB, codec buffer %lu KiB\n", maxrss_kb, codec_kb);
+#ifdef DSP_PROFILE
+    if (show_profile && use_dsp)
+        print_profile(profile, stdout);
+#endif
+
+    return failed ? 1 : 0;
+}
+
 /***** ALL MODES *****/
 
 static void perform_config(void)
@@ -344,6 +679,10 @@ static void perform_config(void)
                 return;
         } else if (!strncmp(name, "dither=", 7)) {
             dsp_dither_enable(atoi(val) ? true : false);
+#ifdef HAVE_POLYPHASE_RESAMPLER
+        } else if (!strncmp(name, "hqresample=", 11)) {
+            dsp_resampler_hq_enable(atoi(val) ? true : false);
+#endif
         } else if (!strncmp(name, "halt=", 5)) {
             if (atoi(val))
                 codec_action = CODEC_ACTION_HALT;
@@ -401,6 +740,8 @@ static void ci_pcmbuf_insert(const void *ch1, const void *ch2, int count)
                 write_pcm(buf, out_count);
             else if (mode == MODE_PLAY)
                 playback_pcm(buf, out_count);
+            else if (mode == MODE_BATCH)
+                batch_pcm16(buf, out_count);
             count -= in_count;
         }
     } else {
@@ -432,11 +773,49 @@ static void ci_pcmbuf_insert(const void *ch1, const void *ch2, int count)
 
         if (mode == MODE_WRITE)
             write_pcm_raw(buf, count);
+        else if (mode == MODE_BATCH)
+            batch_pcm_raw(buf, count);
     }
 
     perform_config();
 }
 
+/* Zero-copy output, used only when the DSP would not change the samples.
+ * The codec decodes into direct_buf and the result goes out exactly as
+ * ci_pcmbuf_insert() would have sent it. */
+static int32_t direct_buf[16 * 1024];
+
+static void *ci_pcmbuf_request_direct(int *count)
+{
+    int frame_bytes;
+
+    if (!use_dsp || (frame_bytes = dsp_direct_frame_bytes(ci.dsp)) == 0)
+        return NULL;
+
+    if (frame_bytes < 4)
+        frame_bytes = 4;
+
+    *count = MIN(*count, (int)sizeof(direct_buf) / frame_bytes);
+    return direct_buf;
+}
+
+static void ci_pcmbuf_commit_direct(int count)
+{
+    int16_t *buf = (int16_t *)direct_buf;
+
+    num_output_samples += count;
+    dsp_process_direct(ci.dsp, buf, count);
+
+    if (mode == MODE_WRITE)
+        write_pcm(buf, count);
+    else if (mode == MODE_PLAY)
+        playback_pcm(buf, count);
+    else if (mode == MODE_BATCH)
+        batch_pcm16(buf, count);
+
+    perform_config();
+}
+
 static void ci_set_elapsed(unsigned long value)
 {
     //debugf("Time elapsed: %lu\n", value);
@@ -528,19 +907,18 @@ static void ci_set_offset(size_t value)
 
 static void ci_configure(int setting, intptr_t value)
 {
-    if (use_dsp) {
-        dsp_configure(ci.dsp, setting, value);
-    } else {
-        if (setting == DSP_SET_FREQUENCY
-                || setting == DSP_SWITCH_FREQUENCY)
-            format.freq = value;
-        else if (setting == DSP_SET_SAMPLE_DEPTH)
-            format.depth = value;
-        else if (setting == DSP_SET_STEREO_MODE) {
-            format.stereo_mode = value;
-            format.channels = (value == STEREO_MONO) ? 1 : 2;
-        }
+    if (setting == DSP_SET_FREQUENCY
+            || setting == DSP_SWITCH_FREQUENCY)
+        format.freq = value;
+    else if (setting == DSP_SET_SAMPLE_DEPTH)
+        format.depth = value;
+    else if (setting == DSP_SET_STEREO_MODE) {
+        format.stereo_mode = value;
+        format.channels = (value == STEREO_MONO) ? 1 : 2;
     }
+
+    if (use_dsp)
+        dsp_configure(ci.dsp, setting, value);
 }
 
 static enum codec_command_action ci_get_command(intptr_t *param)
@@ -565,10 +943,20 @@ static void ci_cpucache_flush(void)
 {
 }
 
+static void ci_commit_discard_idcache(void)
+{
+}
+
 static void ci_cpucache_invalidate(void)
 {
 }
 
+static void ci_report_heap_peak(size_t bytes)
+{
+    if (mode == MODE_BATCH)
+        batch_cur->codec_kb = (bytes + 1023) / 1024;
+}
+
 static struct codec_api ci = {
 
     0,                   /* filesize */
@@ -578,6 +966,8 @@ static struct codec_api ci = {
     NULL,                /* struct dsp_config *dsp */
     ci_codec_get_buffer,
     ci_pcmbuf_insert,
+    ci_pcmbuf_request_direct,
+    ci_pcmbuf_commit_direct,
     ci_set_elapsed,
     ci_read_filebuf,
     ci_request_buffer,
@@ -603,6 +993,7 @@ static struct codec_api ci = {
 
     ci_cpucache_flush,
     ci_cpucache_invalidate,
+    ci_commit_discard_idcache,
 
     /* strings and memory */
     strcpy,
@@ -623,6 +1014,13 @@ static struct codec_api ci = {
 
     qsort,
 
+    /* file */
+    open,
+    close,
+    read,
+    lseek,
+    write,
+
 #ifdef HAVE_RECORDING
     ci_enc_get_inputs,
     ci_enc_set_parameters,
@@ -630,16 +1028,10 @@ static struct codec_api ci = {
     ci_enc_finish_chunk,
     ci_enc_get_pcm_data,
     ci_enc_unget_pcm_data,
-
-    /* file */
-    open,
-    close,
-    read,
-    lseek,
-    write,
     ci_round_value_to_list32,
-
 #endif /* HAVE_RECORDING */
+
+    ci_report_heap_peak,
 };
 
 static void print_mp3entry(const struct mp3entry *id3, FILE *f)
@@ -679,8 +1071,10 @@ static void print_mp3entry(const struct mp3entry *id3, FILE *f)
     if (id3->mb_track_id) fprintf(f, "Musicbrainz track ID: %s\n", id3->mb_track_id);
 }
 
-static void decode_file(const char *input_fn)
+static bool decode_file(const char *input_fn)
 {
+    bool ok = true;
+
     /* Set up global settings */
     memset(&global_settings, 0, sizeof(global_settings));
     global_settings.timestretch_enabled = true;
@@ -704,7 +1098,8 @@ static void decode_file(const char *input_fn)
         fprintf(stderr, "error: metadata parsing failed\n");
         exit(1);
     }
-    print_mp3entry(&id3, stderr);
+    if (!quiet)
+        print_mp3entry(&id3, stderr);
     ci.filesize = filesize(input_fd);
     ci.id3 = &id3;
     if (use_dsp) {
@@ -746,13 +1141,20 @@ static void decode_file(const char *input_fn)
     }
     if (c_hdr->run_proc() != CODEC_OK) {
         fprintf(stderr, "error: codec error\n");
+        ok = false;
     }
     c_hdr->entry_point(CODEC_UNLOAD);
 
+#ifdef DSP_PROFILE
+    if (show_profile && use_dsp && mode != MODE_BATCH)
+        print_profile(dsp_profile_get(ci.dsp), stderr);
+#endif
+
     /* Close */
     dlclose(dlcodec);
     if (input_fd != STDIN_FILENO)
         close(input_fd);
+    return ok;
 }
 
 static void print_help(const char *progname)
@@ -760,10 +1162,21 @@ static void print_help(const char *progname)
     fprintf(stderr, "Usage:\n"
                     "        Play: %s [options] INPUTFILE\n"
                     "Write to WAV: %s [options] INPUTFILE OUTPUTFILE\n"
+                    "       Batch: %s [options] -b LISTFILE\n"
                     "\n"
                     "general options:\n"
                     "  -c a=1:b=2    Configuration (see below)\n"
                     "  -h            Show this help\n"
+#ifdef DSP_PROFILE
+                    "  -p            Show time spent in each DSP stage\n"
+#endif
+                    "\n"
+                    "batch options:\n"
+                    "  -b LISTFILE   Decode every file listed (one per line, - for\n"
+                    "                stdin) and report speed, cycles per sample,\n"
+                    "                peak RSS, codec buffer use and CRC32 of the\n"
+                    "                output instead of writing it\n"
+                    "  -j <n>        Decode <n> files in parallel [number of CPUs]\n"
                     "\n"
                     "write to WAV options:\n"
                     "  -f            Write raw codec output converted to 64-bit float\n"
@@ -772,6 +1185,10 @@ static void print_help(const char *progname)
                     "configuration:\n"
                     "  dither=<0|1>  Enable/disable dithering [0]\n"
                     "  halt=<0|1>    Stop decoding if 1 [0]\n"
+#ifdef HAVE_POLYPHASE_RESAMPLER
+                    "  hqresample=<0|1>\n"
+                    "                Band-limited instead of linear resampling [0]\n"
+#endif
                     "  loop=<0|1>    Enable/disable looping [0]\n"
                     "  offset=<n>    Start at byte offset within the file [0]\n"
                     "  rate=<n>      Multiply rate by <n> [1.0]\n"
@@ -788,14 +1205,35 @@ static void print_help(const char *progname)
                     "  %s in.adx -c loop=1:wait=44100:halt=1\n"
                     "  # Lower pitch 1 octave and write to out.wav\n"
                     "  %s in.ogg -c rate=0.5:tempo=2 out.wav\n"
-                    , progname, progname, progname, progname);
+                    "  # Checksum the raw codec output of a corpus using 4 workers\n"
+                    "  %s -r -j 4 -b files.txt\n"
+#if defined(DSP_PROFILE) && defined(HAVE_POLYPHASE_RESAMPLER)
+                    "  # Time the band-limited resampler (compare with hqresample=0)\n"
+                    "  %s -p -j 1 -c hqresample=1 -b hires.txt\n"
+#endif
+                    , progname, progname, progname, progname, progname, progname
+#if defined(DSP_PROFILE) && defined(HAVE_POLYPHASE_RESAMPLER)
+                    , progname
+#endif
+                    );
 }
 
 int main(int argc, char **argv)
 {
     int opt;
-    while ((opt = getopt(argc, argv, "c:fhr")) != -1) {
+    const char *batch_list = NULL;
+    while ((opt = getopt(argc, argv, "b:c:fhj:pr")) != -1) {
         switch (opt) {
+        case 'b':
+            batch_list = optarg;
+            quiet = true;
+            break;
+        case 'j':
+            batch_jobs = atoi(optarg);
+            break;
+        case 'p':
+            show_profile = true;
+            break;
         case 'c':
             config = optarg;
             break;
@@ -814,7 +1252,15 @@ int main(int argc, char **argv)
     }
 
     core_allocator_init();
-    if (argc == optind + 2) {
+    if (batch_list) {
+        if (argc != optind) {
+            fprintf(stderr, "error: -b doesn't take INPUTFILE\n");
+            print_help(argv[0]);
+            exit(1);
+        }
+        batch_init(batch_list);
+        return batch_run();
+    } else if (argc == optind + 2) {
         write_init(argv[optind + 1]);
     } else if (argc == optind + 1) {
         if (!use_dsp) {
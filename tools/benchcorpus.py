@@ -0,0 +1,639 @@
+#!/usr/bin/env python3
+#             __________               __   ___.
+#   Open      \______   \ ____   ____ |  | _\_ |__   _______  ___
+#   Source     |       _//  _ \_/ ___\|  |/ /| __ \ /  _ \  \/  /
+#   Jukebox    |    |   (  <_> )  \___|    < | \_\ (  <_> > <  <
+#   Firmware   |____|_  /\____/ \___  >__|_ \|___  /\____/__/\_ \
+#                     \/            \/     \/    \/            \/
+# $Id$
+#
+# Creates the fixed corpus that tools/codecbench.py decodes for
+# "make benchmark": one file per codec and bitrate or profile, named
+# <codec>-<variant>.<ext>.
+#
+# Everything is generated from the same seeded test signal, so the corpus is
+# the same on every host. The formats this script can write itself (PCM in
+# WAV/AIFF/AU, IMA ADPCM, FLAC, MPEG layer I, Monkey's Audio, MOD and VGM)
+# are always there. The lossy ones are made of valid but random data, which
+# is enough to exercise every decoding step at a realistic rate. Everything
+# else needs an encoder on the PATH; entries whose encoder is missing are
+# listed as skipped and left out. Different encoder versions give different
+# files, so only compare CRCs against a baseline made on the same host.
+#
+# Files that already exist are kept, so the corpus is only made once per
+# build directory unless CORPUS_VERSION changes.
+#
+# Usage: benchcorpus.py [-l] [-s SECONDS] DIR
+
+import argparse
+import array
+import math
+import os
+import random
+import shutil
+import struct
+import subprocess
+import sys
+
+CORPUS_VERSION = 1
+SEED = 1234
+
+
+def warn(msg):
+    print("benchcorpus: " + msg, file=sys.stderr)
+
+
+# Test signal: a few voices per channel playing random decaying notes, with
+# some noise so the lossless coders can't do too well. Interleaved 16-bit
+# samples.
+def make_signal(rate, channels, seconds, seed=SEED):
+    rnd = random.Random(seed)
+    table_bits = 12
+    table_size = 1 << table_bits
+    # one cycle with a few harmonics
+    table = [sum(math.sin(2 * math.pi * h * i / table_size) / h
+                 for h in (1, 2, 3, 5)) * 0.5 for i in range(table_size)]
+    count = int(rate * seconds)
+    out = array.array("h", bytes(2 * count * channels))
+    note_len = rate // 4
+    voices = 3
+    for ch in range(channels):
+        for v in range(voices):
+            phase = 0.0
+            pos = 0
+            while pos < count:
+                length = note_len * rnd.choice((1, 1, 2, 4))
+                freq = 110.0 * 2 ** (rnd.randrange(36) / 12.0)
+                amp = rnd.uniform(2000, 6000)
+                inc = freq * table_size / rate
+                decay = math.exp(-3.0 / length)
+                end = min(pos + length, count)
+                for i in range(pos, end):
+                    k = i * channels + ch
+                    out[k] += int(table[int(phase) & (table_size - 1)] * amp)
+                    phase += inc
+                    amp *= decay
+                pos = end
+        for i in range(count):
+            k = i * channels + ch
+            out[k] += rnd.randint(-64, 64)
+    return out
+
+
+def pcm_bytes(samples, big_endian=False, bits=16):
+    if bits == 16:
+        a = array.array("h", samples)
+        if big_endian != (sys.byteorder == "big"):
+            a.byteswap()
+        return a.tobytes()
+    # 24 bits: the 16-bit signal with extra low bits
+    rnd = random.Random(SEED + 24)
+    out = bytearray()
+    for s in samples:
+        v = ((s << 8) | rnd.randrange(256)) & 0xffffff
+        out += v.to_bytes(3, "big" if big_endian else "little")
+    return bytes(out)
+
+
+def write(path, data):
+    with open(path, "wb") as f:
+        f.write(data)
+
+
+# WAV, AIFF and AU
+
+def wav_file(fmt, data, extra_chunks=b""):
+    chunks = b"fmt " + struct.pack("<I", len(fmt)) + fmt + extra_chunks
+    chunks += b"data" + struct.pack("<I", len(data)) + data
+    if len(data) & 1:
+        chunks += b"\0"
+    return b"RIFF" + struct.pack("<I", 4 + len(chunks)) + b"WAVE" + chunks
+
+
+def gen_wav(path, samples, rate, channels, bits=16):
+    data = pcm_bytes(samples, bits=bits)
+    align = channels * bits // 8
+    fmt = struct.pack("<HHIIHH", 1, channels, rate, rate * align, align, bits)
+    write(path, wav_file(fmt, data))
+
+
+IMA_INDEX = [-1, -1, -1, -1, 2, 4, 6, 8]
+IMA_STEP = [
+    7, 8, 9, 10, 11, 12, 13, 14, 16, 17, 19, 21, 23, 25, 28, 31, 34, 37, 41,
+    45, 50, 55, 60, 66, 73, 80, 88, 97, 107, 118, 130, 143, 157, 173, 190, 209,
+    230, 253, 279, 307, 337, 371, 408, 449, 494, 544, 598, 658, 724, 796, 876,
+    963, 1060, 1166, 1282, 1411, 1552, 1707, 1878, 2066, 2272, 2499, 2749,
+    3024, 3327, 3660, 4026, 4428, 4871, 5358, 5894, 6484, 7132, 7845, 8630,
+    9493, 10442, 11487, 12635, 13899, 15289, 16818, 18500, 20350, 22385,
+    24623, 27086, 29794, 32767]
+
+
+def ima_encode(samples, pred, index):
+    codes = []
+    for s in samples:
+        step = IMA_STEP[index]
+        diff = s - pred
+        code = 0
+        if diff < 0:
+            code = 8
+            diff = -diff
+        delta = step >> 3
+        if diff >= step:
+            code |= 4
+            diff -= step
+            delta += step
+        if diff >= step >> 1:
+            code |= 2
+            diff -= step >> 1
+            delta += step >> 1
+        if diff >= step >> 2:
+            code |= 1
+            delta += step >> 2
+        pred = max(-32768, min(32767, pred - delta if code & 8 else
+                               pred + delta))
+        index = max(0, min(88, index + IMA_INDEX[code & 7]))
+        codes.append(code)
+    return codes, pred, index
+
+
+def gen_wav_ima(path, samples, rate, channels):
+    block_align = 1024 * channels
+    per_block = (block_align - 4 * channels) * 2 // channels + 1
+    frames = len(samples) // channels
+    state = [(0, 0)] * channels
+    data = bytearray()
+    for start in range(0, frames, per_block):
+        n = min(per_block, frames - start)
+        header = bytearray()
+        body = []
+        for ch in range(channels):
+            chan = samples[start * channels + ch:
+                           (start + n) * channels:channels]
+            pred, index = chan[0], state[ch][1]
+            header += struct.pack("<hBB", pred, index, 0)
+            codes, pred, index = ima_encode(chan[1:], pred, index)
+            codes += [0] * (per_block - len(codes) - 1)
+            body.append(codes)
+            state[ch] = (pred, index)
+        data += header
+        for i in range(0, per_block - 1, 8):
+            for ch in range(channels):
+                c = body[ch][i:i + 8]
+                data += bytes(c[j] | (c[j + 1] << 4) for j in range(0, 8, 2))
+    fmt = struct.pack("<HHIIHHHH", 0x11, channels, rate,
+                      rate * block_align // per_block, block_align, 4,
+                      2, per_block)
+    fact = b"fact" + struct.pack("<II", 4, frames)
+    write(path, wav_file(fmt, bytes(data), fact))
+
+
+def ieee_extended(value):
+    exponent = 16383 + 63
+    mantissa = int(value)
+    while mantissa < (1 << 63):
+        mantissa <<= 1
+        exponent -= 1
+    return struct.pack(">HQ", exponent, mantissa)
+
+
+def gen_aiff(path, samples, rate, channels):
+    data = pcm_bytes(samples, big_endian=True)
+    comm = struct.pack(">hIh", channels, len(samples) // channels, 16)
+    comm += ieee_extended(rate)
+    chunks = b"COMM" + struct.pack(">I", len(comm)) + comm
+    chunks += b"SSND" + struct.pack(">III", len(data) + 8, 0, 0) + data
+    write(path, b"FORM" + struct.pack(">I", 4 + len(chunks)) + b"AIFF" +
+          chunks)
+
+
+def mulaw(s):
+    sign = 0x80 if s < 0 else 0
+    s = min(abs(s), 32635) + 0x84
+    exponent = max(0, s.bit_length() - 8)
+    mantissa = (s >> (exponent + 3)) & 0x0f
+    return ~(sign | (exponent << 4) | mantissa) & 0xff
+
+
+def gen_au(path, samples, rate, channels):
+    table = bytes(mulaw(s) for s in range(-32768, 32768))
+    data = bytes(table[s + 32768] for s in samples)
+    write(path, b".snd" + struct.pack(">IIIII", 24, len(data), 1, rate,
+                                      channels) + data)
+
+
+# FLAC: fixed second order predictor, one Rice partition per subframe
+
+def crc8(data):
+    crc = 0
+    for b in data:
+        crc ^= b
+        for _ in range(8):
+            crc = ((crc << 1) ^ 0x07) & 0xff if crc & 0x80 else crc << 1
+    return crc
+
+
+CRC16_TABLE = []
+for _i in range(256):
+    _c = _i << 8
+    for _ in range(8):
+        _c = ((_c << 1) ^ 0x8005) & 0xffff if _c & 0x8000 else _c << 1
+    CRC16_TABLE.append(_c)
+
+
+def crc16(data):
+    crc = 0
+    for b in data:
+        crc = ((crc << 8) & 0xffff) ^ CRC16_TABLE[(crc >> 8) ^ b]
+    return crc
+
+
+def bits(value, n):
+    return format(value & ((1 << n) - 1), "0%db" % n) if n else ""
+
+
+def flac_subframe(chan):
+    out = ["0", "001010", "0"]          # fixed, order 2, no wasted bits
+    out += [bits(s, 16) for s in chan[:2]]
+    res = [((r << 1) ^ (r >> 31)) & 0xffffffff for r in
+           (chan[i] - 2 * chan[i - 1] + chan[i - 2]
+            for i in range(2, len(chan)))]
+    mean = sum(res) // max(1, len(res))
+    k = min(14, max(0, mean.bit_length() - 1))
+    out += ["00", "0000", bits(k, 4)]  # Rice, partition order 0
+    fmt = "0%db" % k
+    for u in res:
+        out.append("0" * (u >> k) + "1" + (format(u & ((1 << k) - 1), fmt)
+                                           if k else ""))
+    return "".join(out)
+
+
+def utf8_number(n):
+    if n < 0x80:
+        return bytes([n])
+    chars = []
+    while n >= (0x40 >> len(chars)):
+        chars.append(0x80 | (n & 0x3f))
+        n >>= 6
+    first = (0xff00 >> (len(chars) + 1)) & 0xff
+    return bytes([first | n] + chars[::-1])
+
+
+def gen_flac(path, samples, rate, channels):
+    assert rate == 44100
+    block = 4096
+    frames = len(samples) // channels
+    info = struct.pack(">HH", block, block) + bytes(6)
+    info += ((rate << 44) | ((channels - 1) << 41) | (15 << 36) |
+             frames).to_bytes(8, "big") + bytes(16)
+    out = bytearray(b"fLaC" + bytes([0x80]) + len(info).to_bytes(3, "big") +
+                    info)
+    for num, start in enumerate(range(0, frames, block)):
+        n = min(block, frames - start)
+        header = bytearray(b"\xff\xf8")
+        header.append((0xc if n == block else 0x7) << 4 | 0x9)
+        header.append((channels - 1) << 4 | 0x4 << 1)
+        header += utf8_number(num)
+        if n != block:
+            header += struct.pack(">H", n - 1)
+        header.append(crc8(header))
+        body = "".join(flac_subframe(samples[start * channels + ch:
+                                             (start + n) * channels:channels])
+                       for ch in range(channels))
+        body += "0" * (-len(body) % 8)
+        frame = bytes(header) + int(body, 2).to_bytes(len(body) // 8, "big")
+        out += frame + struct.pack(">H", crc16(frame))
+    write(path, bytes(out))
+
+
+# MPEG-1 layer I with random bit allocations, scalefactors and samples at
+# every bitrate
+
+MP1_BITRATES = [0, 32, 64, 96, 128, 160, 192, 224, 256, 288, 320, 352, 384,
+                416, 448]
+
+
+def gen_mp1(path, rate, channels, seconds, bitrate=None):
+    rnd = random.Random(SEED + 1)
+    assert rate == 44100
+    out = bytearray()
+    for n in range(int(seconds * rate / 384)):
+        bi = (MP1_BITRATES.index(bitrate) if bitrate else
+              rnd.randint(4 if channels == 2 else 1, 14))
+        padding = rnd.randint(0, 1)
+        nbytes = (12 * MP1_BITRATES[bi] * 1000 // rate + padding) * 4
+        mode = 0 if channels == 2 else 3
+        head = (0xfff << 20) | (1 << 19) | (3 << 17) | (1 << 16) | \
+            (bi << 12) | (padding << 9) | (mode << 6)
+        room = nbytes * 8 - 32 - 32 * 4 * channels
+        alloc = [[0] * channels for _ in range(32)]
+        for sb in range(32):
+            for ch in range(channels):
+                nb = rnd.randint(2, 8)
+                if 6 + 12 * nb <= room and rnd.random() < 0.7:
+                    alloc[sb][ch] = nb - 1
+                    room -= 6 + 12 * nb
+        s = [bits(head, 32)]
+        s += [bits(a, 4) for sb in alloc for a in sb]
+        s += [bits(rnd.randint(0, 40), 6) for sb in alloc for a in sb if a]
+        for _ in range(12):
+            s += [bits(rnd.randint(0, (1 << (a + 1)) - 2), a + 1)
+                  for sb in alloc for a in sb if a]
+        frame = "".join(s)
+        frame += "0" * (nbytes * 8 - len(frame))
+        out += int(frame, 2).to_bytes(nbytes, "big")
+    write(path, bytes(out))
+
+
+# Monkey's Audio: valid headers and seek table around random frame data
+
+def gen_ape(path, rate, channels, seconds, compression):
+    rnd = random.Random(SEED + compression)
+    blocks = 73728 if compression < 4000 else 294912
+    total = int(rate * seconds)
+    nframes = (total + blocks - 1) // blocks
+    final = total - (nframes - 1) * blocks
+    desc_len, hdr_len, seek_len = 52, 24, nframes * 4
+    first = desc_len + hdr_len + seek_len
+    data = bytearray()
+    seek = []
+    for f in range(nframes):
+        seek.append(first + len(data))
+        n = blocks if f < nframes - 1 else final
+        data += rnd.getrandbits(8 * n * channels * 2).to_bytes(
+            n * channels * 2, "little")
+    desc = b"MAC " + struct.pack("<hhIIIIIII", 3990, 0, desc_len, hdr_len,
+                                 seek_len, 0, len(data), 0, 0) + bytes(16)
+    hdr = struct.pack("<HHIIIHHI", compression, 0, blocks, final, nframes, 16,
+                      channels, rate)
+    write(path, desc + hdr + b"".join(struct.pack("<I", s) for s in seek) +
+          data)
+
+
+# ProTracker module: four channels of random notes on four instruments
+
+MOD_PERIODS = [856, 808, 762, 720, 678, 640, 604, 570, 538, 508, 480, 453,
+               428, 404, 381, 360, 339, 320, 302, 285, 269, 254, 240, 226,
+               214, 202, 190, 180, 170, 160, 151, 143, 135, 127, 120, 113]
+
+
+def gen_mod(path, seconds):
+    rnd = random.Random(SEED + 2)
+    waves = [
+        bytes(int(100 * math.sin(2 * math.pi * i / 64)) & 0xff
+              for i in range(64)),                                # lead
+        bytes((90 if i < 32 else -90) & 0xff for i in range(64)),  # bass
+        bytes(rnd.randint(-100, 100) & 0xff for _ in range(4000)),  # snare
+        bytes(int(120 * math.exp(-i / 800) *
+                  math.sin(2 * math.pi * i / (40 + i / 50))) & 0xff
+              for i in range(4000)),                              # kick
+    ]
+    looped = [True, True, False, False]
+    head = bytearray(b"benchcorpus".ljust(20, b"\0"))
+    for i in range(31):
+        if i < len(waves):
+            rep = (0, len(waves[i]) // 2) if looped[i] else (0, 1)
+            head += b"".ljust(22, b"\0") + struct.pack(
+                ">HBBHH", len(waves[i]) // 2, 0, 64, *rep)
+        else:
+            head += bytes(22) + struct.pack(">HBBHH", 0, 0, 0, 0, 1)
+    npatterns = 4
+    positions = max(1, int(seconds / 7.68 + 0.5))  # 64 rows at speed 6
+    head.append(positions)
+    head.append(127)
+    head += bytes(i % npatterns for i in range(positions)).ljust(128, b"\0")
+    head += b"M.K."
+    for p in range(npatterns):
+        for row in range(64):
+            for ch in range(4):
+                inst, note = 0, None
+                if ch == 0 and rnd.random() < 0.5:
+                    inst, note = 1, rnd.randrange(12, 36)
+                elif ch == 1 and row % 4 == 0:
+                    inst, note = 2, rnd.randrange(0, 12)
+                elif ch == 2 and row % 8 == 4:
+                    inst, note = 3, 24
+                elif ch == 3 and row % 8 == 0:
+                    inst, note = 4, 12
+                if note is None:
+                    head += bytes(4)
+                    continue
+                period = MOD_PERIODS[note]
+                head += bytes([(inst & 0xf0) | (period >> 8), period & 0xff,
+                               (inst & 0x0f) << 4, 0])
+    write(path, bytes(head) + b"".join(waves))
+
+
+# VGM: SN76489 and YM2612 playing random notes
+
+def gen_vgm(path, seconds):
+    rnd = random.Random(SEED + 3)
+    rate = 44100
+    cmds = bytearray()
+
+    def fm(port, reg, val):
+        cmds.extend((0x52 + port, reg, val))
+
+    for port in range(2):
+        for ch in range(3):
+            fm(port, 0xb0 + ch, 0x32)       # feedback 6, algorithm 2
+            fm(port, 0xb4 + ch, 0xc0)       # both speakers
+            for op in range(4):
+                r = op * 4 + ch
+                fm(port, 0x30 + r, 0x01 + op)
+                fm(port, 0x40 + r, 0x00 if op == 3 else 0x20)
+                fm(port, 0x50 + r, 0x1f)
+                fm(port, 0x60 + r, 0x08)
+                fm(port, 0x70 + r, 0x04)
+                fm(port, 0x80 + r, 0x46)
+    total = int(rate * seconds)
+    step = rate // 8
+    for t in range(0, total, step):
+        for slot in range(6):
+            port, ch = divmod(slot, 3)
+            if rnd.random() < 0.5:
+                continue
+            fm(0, 0x28, (port << 2) | ch)
+            fnum = rnd.randint(600, 1200)
+            fm(port, 0xa4 + ch, (rnd.randint(2, 5) << 3) | (fnum >> 8))
+            fm(port, 0xa0 + ch, fnum & 0xff)
+            fm(0, 0x28, 0xf0 | (port << 2) | ch)
+        for ch in range(3):
+            tone = rnd.randint(100, 1000)
+            cmds += bytes((0x50, 0x80 | (ch << 5) | (tone & 0x0f),
+                           0x50, tone >> 4,
+                           0x50, 0x90 | (ch << 5) | rnd.randint(2, 8)))
+        wait = min(step, total - t)
+        cmds += bytes([0x61]) + struct.pack("<H", wait)
+    cmds.append(0x66)
+    head = bytearray(0x40)
+    struct.pack_into("<4sIIIIIIIII", head, 0, b"Vgm ", 0x40 + len(cmds) - 4,
+                     0x150, 3579545, 0, 0, total, 0, 0, 60)
+    struct.pack_into("<HBB", head, 0x28, 0x0009, 16, 0)
+    struct.pack_into("<III", head, 0x2c, 7670453, 0, 0x40 - 0x34)
+    write(path, bytes(head) + bytes(cmds))
+
+
+# The corpus. Native entries are (name, ext, function, args), where the
+# function gets the path first; encoder entries are (name, ext, source,
+# command), where source is one of SOURCES and command is run with {in} and
+# {out} replaced.
+
+SOURCES = {
+    "cd": (44100, 2),
+    "hires": (96000, 2),
+    "wb": (16000, 1),
+}
+
+NATIVE = [
+    ("wav-16bit", "wav", gen_wav, "cd", {}),
+    ("wav-24bit-96k", "wav", gen_wav, "hires", {"bits": 24}),
+    ("wav-ima", "wav", gen_wav_ima, "cd", {}),
+    ("aiff-16bit", "aiff", gen_aiff, "cd", {}),
+    ("au-mulaw", "au", gen_au, "cd", {}),
+    ("flac-fixed2", "flac", gen_flac, "cd", {}),
+]
+
+SYNTH = [
+    ("mpa-mp1-vbr", "mp1", gen_mp1, {"rate": 44100, "channels": 2}),
+    ("mpa-mp1-384", "mp1", gen_mp1,
+     {"rate": 44100, "channels": 2, "bitrate": 384}),
+    ("ape-1000", "ape", gen_ape,
+     {"rate": 44100, "channels": 2, "compression": 1000}),
+    ("ape-2000", "ape", gen_ape,
+     {"rate": 44100, "channels": 2, "compression": 2000}),
+    ("ape-3000", "ape", gen_ape,
+     {"rate": 44100, "channels": 2, "compression": 3000}),
+    ("ape-4000", "ape", gen_ape,
+     {"rate": 44100, "channels": 2, "compression": 4000}),
+    ("ape-5000", "ape", gen_ape,
+     {"rate": 44100, "channels": 2, "compression": 5000}),
+    ("mod-4ch", "mod", gen_mod, {}),
+    ("vgm-psg-fm", "vgm", gen_vgm, {}),
+]
+
+FFMPEG = ["ffmpeg", "-nostdin", "-loglevel", "error", "-y", "-i", "{in}"]
+
+ENCODED = [
+    ("mpa-mp3-128", "mp3", "cd", ["lame", "--quiet", "-b", "128", "{in}",
+                                  "{out}"]),
+    ("mpa-mp3-320", "mp3", "cd", ["lame", "--quiet", "-b", "320", "{in}",
+                                  "{out}"]),
+    ("mpa-mp3-v2", "mp3", "cd", ["lame", "--quiet", "-V", "2", "{in}",
+                                 "{out}"]),
+    ("mpa-mp2-192", "mp2", "cd", FFMPEG + ["-c:a", "mp2", "-b:a", "192k",
+                                           "{out}"]),
+    ("vorbis-q2", "ogg", "cd", ["oggenc", "-Q", "-q", "2", "-o", "{out}",
+                                "{in}"]),
+    ("vorbis-q6", "ogg", "cd", ["oggenc", "-Q", "-q", "6", "-o", "{out}",
+                                "{in}"]),
+    ("speex-wb", "spx", "wb", ["speexenc", "--quiet", "-w", "{in}",
+                               "{out}"]),
+    ("flac-8", "flac", "cd", ["flac", "-s", "-8", "-o", "{out}", "{in}"]),
+    ("flac-8-24bit-96k", "flac", "hires", ["flac", "-s", "-8", "-o", "{out}",
+                                           "{in}"]),
+    ("wavpack-normal", "wv", "cd", ["wavpack", "-q", "-y", "{in}", "-o",
+                                    "{out}"]),
+    ("wavpack-hh", "wv", "cd", ["wavpack", "-q", "-y", "-hh", "{in}", "-o",
+                                "{out}"]),
+    ("wavpack-lossy-256", "wv", "cd", ["wavpack", "-q", "-y", "-b256",
+                                       "{in}", "-o", "{out}"]),
+    ("ape-mac-c2000", "ape", "cd", ["mac", "{in}", "{out}", "-c2000"]),
+    ("ape-mac-c4000", "ape", "cd", ["mac", "{in}", "{out}", "-c4000"]),
+    ("mpc-standard", "mpc", "cd", ["mpcenc", "--silent", "--standard",
+                                   "{in}", "{out}"]),
+    ("aac-lc-128", "mp4", "cd", FFMPEG + ["-c:a", "aac", "-b:a", "128k",
+                                          "{out}"]),
+    ("alac", "m4a", "cd", FFMPEG + ["-c:a", "alac", "{out}"]),
+    ("wma-v2-128", "wma", "cd", FFMPEG + ["-c:a", "wmav2", "-b:a", "128k",
+                                          "{out}"]),
+    ("a52-ac3-192", "ac3", "cd", FFMPEG + ["-c:a", "ac3", "-b:a", "192k",
+                                           "{out}"]),
+    ("tta", "tta", "cd", FFMPEG + ["-c:a", "tta", "{out}"]),
+    ("adx", "adx", "cd", FFMPEG + ["-c:a", "adpcm_adx", "{out}"]),
+    ("shorten", "shn", "cd", ["shorten", "{in}", "{out}"]),
+]
+
+
+def main():
+    parser = argparse.ArgumentParser(
+        description="Create the codec benchmark corpus.")
+    parser.add_argument("-l", "--list", action="store_true",
+                        help="only list the files the corpus would have")
+    parser.add_argument("-s", "--seconds", type=float, default=30,
+                        help="length of every file [30]")
+    parser.add_argument("dir")
+    args = parser.parse_args()
+
+    stamp = os.path.join(args.dir, ".version")
+    version = "%d %g\n" % (CORPUS_VERSION, args.seconds)
+    if not args.list:
+        os.makedirs(args.dir, exist_ok=True)
+        try:
+            with open(stamp) as f:
+                stale = f.read() != version
+        except OSError:
+            stale = True
+        if stale:
+            for fn in os.listdir(args.dir):
+                if not fn.startswith("."):
+                    os.remove(os.path.join(args.dir, fn))
+            with open(stamp, "w") as f:
+                f.write(version)
+
+    signals = {}
+
+    def signal(source):
+        if source not in signals:
+            signals[source] = make_signal(*SOURCES[source], args.seconds)
+        return signals[source]
+
+    def source_wav(source):
+        path = os.path.join(args.dir, ".source-%s.wav" % source)
+        if not os.path.exists(path):
+            gen_wav(path, signal(source), *SOURCES[source])
+        return path
+
+    files = []
+    for name, ext, func, source, kw in NATIVE:
+        path = os.path.join(args.dir, "%s.%s" % (name, ext))
+        if not args.list and not os.path.exists(path):
+            func(path + ".tmp", signal(source), *SOURCES[source], **kw)
+            os.rename(path + ".tmp", path)
+        files.append(path)
+
+    for name, ext, func, kw in SYNTH:
+        path = os.path.join(args.dir, "%s.%s" % (name, ext))
+        if not args.list and not os.path.exists(path):
+            func(path + ".tmp", seconds=args.seconds, **kw)
+            os.rename(path + ".tmp", path)
+        files.append(path)
+
+    missing = {}
+    for name, ext, source, cmd in ENCODED:
+        path = os.path.join(args.dir, "%s.%s" % (name, ext))
+        if not shutil.which(cmd[0]):
+            missing.setdefault(cmd[0], []).append(name)
+            continue
+        if not args.list and not os.path.exists(path):
+            tmp = os.path.join(args.dir, ".tmp-" + os.path.basename(path))
+            argv = [a.replace("{in}", source_wav(source))
+                     .replace("{out}", tmp) for a in cmd]
+            try:
+                subprocess.run(argv, check=True, stdout=subprocess.DEVNULL)
+                os.rename(tmp, path)
+            except (OSError, subprocess.CalledProcessError) as e:
+                warn("skipped %s: %s" % (name, e))
+                if os.path.exists(tmp):
+                    os.remove(tmp)
+                continue
+        files.append(path)
+
+    for tool, names in sorted(missing.items()):
+        warn("%s not found, skipped %s" % (tool, " ".join(names)))
+
+    for path in files:
+        print(path)
+
+
+if __name__ == "__main__":
+    main()
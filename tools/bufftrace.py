@@ -0,0 +1,146 @@
+#!/usr/bin/env python3
+#             __________               __   ___.
+#   Open      \______   \ ____   ____ |  | _\_ |__   _______  ___
+#   Source     |       _//  _ \_/ ___\|  |/ /| __ \ /  _ \  \/  /
+#   Jukebox    |    |   (  <_> )  \___|    < | \_\ (  <_> > <  <
+#   Firmware   |____|_  /\____/ \___  >__|_ \|___  /\____/__/\_ \
+#                     \/            \/     \/    \/            \/
+# $Id$
+#
+# Turns a buffering event trace (Debug menu -> "Dump buffering trace" on
+# hosted builds, see buffering_trace_dump() in apps/buffering.c) into a
+# timeline with one row per handle, followed by read statistics and the
+# events leading up to every rebuffer.
+#
+# Timeline symbols:
+#   [  handle added           ]  handle closed
+#   =  data read              R  rebuffer
+#   E  read error or early end of file
+#   s  seek                   m  handle moved or shrunk
+#   !  BUFFER_EVENT_BUFFER_LOW sent at the watermark (in the "watermark" row)
+#
+# Usage: bufftrace.py [-w WIDTH] [-c CONTEXT] buffering_trace.txt
+
+import argparse
+import sys
+
+TYPES = ["unknown", "id3", "codec", "audio", "atomic", "cuesheet", "bitmap"]
+
+SYMBOLS = {"read": "=", "move": "m", "shrink": "m", "seek": "s",
+           "watermark": "!", "readfail": "E", "rebuffer": "R", "add": "[",
+           "close": "]"}
+# When several events fall in the same column the one furthest right here
+# is shown: routine reads least, then handle housekeeping, seeks and the
+# events worth looking at, with the start and end of a handle on top
+RANK = "=ms!ER[]"
+
+
+def parse(f):
+    events = []
+    for line in f:
+        line = line.strip()
+        if not line or line.startswith("#"):
+            continue
+        t, ev, hid, a, b = line.split()
+        # seconds.microseconds, so that long traces don't wrap
+        s, _, us = t.partition(".")
+        events.append((int(s) * 1000000 + int(us or 0), ev, int(hid), int(a),
+                       int(b)))
+    return events
+
+
+def fmt_time(us):
+    return "%.3fs" % (us / 1e6)
+
+
+def timeline(events, width, out):
+    t0, t1 = events[0][0], events[-1][0]
+    span = max(t1 - t0, 1)
+    rows = {}
+    order = []
+    types = {}
+
+    for t, ev, hid, a, b in events:
+        key = "watermark" if ev == "watermark" else hid
+        if key not in rows:
+            rows[key] = [" "] * width
+            order.append(key)
+        if ev == "add":
+            types[hid] = TYPES[a] if a < len(TYPES) else str(a)
+        col = min((t - t0) * width // span, width - 1)
+        cur = rows[key][col]
+        sym = SYMBOLS.get(ev, "?")
+        if cur == " " or RANK.find(sym) >= RANK.find(cur):
+            rows[key][col] = sym
+
+    out.write("%-16s|%*s|\n" % (fmt_time(t0), width, fmt_time(t1)))
+    for key in order:
+        if key == "watermark":
+            label = "watermark"
+        else:
+            label = "%d %s" % (key, types.get(key, "?"))
+        out.write("%-16s|%s|\n" % (label[:16], "".join(rows[key])))
+
+
+def read_stats(events, out):
+    reads = [(a, b) for t, ev, hid, a, b in events if ev == "read" and a > 0]
+    fails = [b for t, ev, hid, a, b in events if ev == "readfail"]
+    if fails:
+        out.write("\nfailed reads: %d on error, %d at end of file\n"
+                  % (sum(fails), len(fails) - sum(fails)))
+    if not reads:
+        out.write("\nno reads\n")
+        return
+
+    total = sum(a for a, b in reads)
+    busy = sum(b for a, b in reads)
+    lat = sorted(b for a, b in reads)
+    sizes = {}
+    for a, b in reads:
+        sizes[a] = sizes.get(a, 0) + 1
+
+    out.write("\nreads: %d, %d KiB, %.0f KiB/s while reading\n"
+              % (len(reads), total // 1024,
+                 total / 1024 / max(busy / 1e6, 1e-6)))
+    out.write("latency: min %dus, median %dus, 95%% %dus, max %dus\n"
+              % (lat[0], lat[len(lat) // 2], lat[len(lat) * 95 // 100],
+                 lat[-1]))
+    out.write("sizes: %s\n" % ", ".join(
+        "%dx%d" % (n, size) for size, n in
+        sorted(sizes.items(), key=lambda x: -x[1])[:6]))
+
+
+def rebuffers(events, context, out):
+    found = [i for i, e in enumerate(events) if e[1] == "rebuffer"]
+    out.write("\nrebuffers: %d\n" % len(found))
+
+    for i in found:
+        t, ev, hid, a, b = events[i]
+        out.write("\n%s handle %d to file position %d (buffered data "
+                  "started at %d)\n" % (fmt_time(t), hid, a, b))
+        for e in events[max(i - context, 0):i + 1]:
+            out.write("  %-10s %-9s %4d %10d %10d\n"
+                      % (fmt_time(e[0]), e[1], e[2], e[3], e[4]))
+
+
+def main():
+    parser = argparse.ArgumentParser(
+        description="Show a buffering trace as a timeline")
+    parser.add_argument("trace", type=argparse.FileType("r"))
+    parser.add_argument("-w", "--width", type=int, default=100,
+                        help="timeline width in columns [100]")
+    parser.add_argument("-c", "--context", type=int, default=12,
+                        help="events to show before each rebuffer [12]")
+    args = parser.parse_args()
+
+    events = parse(args.trace)
+    if not events:
+        sys.exit("no events in trace")
+
+    timeline(events, args.width, sys.stdout)
+    read_stats(events, sys.stdout)
+    rebuffers(events, args.context, sys.stdout)
+
+
+if __name__ == "__main__":
+    main()
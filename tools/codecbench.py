@@ -0,0 +1,223 @@
+#!/usr/bin/env python3
+#             __________               __   ___.
+#   Open      \______   \ ____   ____ |  | _\_ |__   _______  ___
+#   Source     |       _//  _ \_/ ___\|  |/ /| __ \ /  _ \  \/  /
+#   Jukebox    |    |   (  <_> )  \___|    < | \_\ (  <_> > <  <
+#   Firmware   |____|_  /\____/ \___  >__|_ \|___  /\____/__/\_ \
+#                     \/            \/     \/    \/            \/
+# $Id$
+#
+# Codec decode benchmark, run by "make benchmark" in a warble build directory.
+# Decodes the corpus from tools/benchcorpus.py with warble's batch mode, one
+# file at a time, and reports per file:
+#
+#   realtime  decoding speed as a multiple of the playback speed
+#   cyc/smp   CPU cycles per output sample (see batch_cycles() in warble.c)
+#   codec     peak KiB used by codec_malloc() and friends
+#   crc       CRC32 of the raw codec output
+#
+# Every file is decoded several times and the best time is kept. The results
+# are compared against a baseline saved earlier with --save ("make
+# benchmark-baseline"): slowdowns over the threshold, codec buffer growth,
+# changed output and files of the baseline that weren't decoded are reported
+# and make the exit status 1. Save the baseline on the same host and build as
+# the runs it is compared with.
+#
+# Usage: codecbench.py -w WARBLE -d DIR [-n RUNS] [-t PERCENT]
+#                      [-b BASELINE] [--save]
+
+import argparse
+import os
+import re
+import subprocess
+import sys
+
+# Formats whose codec plays forever; they are stopped after this many seconds
+# of output at 44.1 kHz
+ENDLESS = (".mod",)
+ENDLESS_SECONDS = 30
+
+LINE = re.compile(r"^(OK|FAIL)\s+(\d+) samples\s+(\d+) smp/s\s+([\d.]+)x "
+                  r"realtime\s+([\d.]+) cyc/smp\s+(\d+) KiB\s+(\d+) KiB "
+                  r"codec crc ([0-9a-f]{8}) (.*)$")
+
+
+class Result:
+    def __init__(self, name, realtime, cycles, codec_kb, rss_kb, crc):
+        self.name = name
+        self.realtime = realtime
+        self.cycles = cycles
+        self.codec_kb = codec_kb
+        self.rss_kb = rss_kb
+        self.crc = crc
+
+
+def name_of(path):
+    return os.path.splitext(os.path.basename(path))[0]
+
+
+def run_warble(warble, files, listfn, config=None):
+    with open(listfn, "w") as f:
+        f.write("".join(fn + "\n" for fn in files))
+    argv = [warble, "-r", "-j", "1"]
+    if config:
+        argv += ["-c", config]
+    argv += ["-b", listfn]
+    proc = subprocess.run(argv, stdout=subprocess.PIPE,
+                          universal_newlines=True)
+    results = {}
+    for line in proc.stdout.splitlines():
+        m = LINE.match(line)
+        if not m:
+            continue
+        if m.group(1) != "OK":
+            print("FAIL: %s" % m.group(9), file=sys.stderr)
+            continue
+        name = name_of(m.group(9))
+        results[name] = Result(name, float(m.group(4)), float(m.group(5)),
+                               int(m.group(7)), int(m.group(6)), m.group(8))
+    return results
+
+
+def benchmark(args, files):
+    listfn = os.path.join(args.dir, ".list")
+    endless = [fn for fn in files if fn.endswith(ENDLESS)]
+    normal = [fn for fn in files if fn not in endless]
+    best = {}
+    for run in range(args.runs):
+        results = {}
+        if normal:
+            results.update(run_warble(args.warble, normal, listfn))
+        if endless:
+            results.update(run_warble(args.warble, endless, listfn,
+                                      "wait=%d:halt=1" %
+                                      (ENDLESS_SECONDS * 44100)))
+        for name, r in results.items():
+            b = best.get(name)
+            if b is None:
+                best[name] = r
+                continue
+            if b.crc != r.crc:
+                print("warning: %s: output differs between runs" % name,
+                      file=sys.stderr)
+            b.realtime = max(b.realtime, r.realtime)
+            if r.cycles:
+                b.cycles = min(b.cycles, r.cycles) if b.cycles else r.cycles
+            b.codec_kb = max(b.codec_kb, r.codec_kb)
+            b.rss_kb = max(b.rss_kb, r.rss_kb)
+    os.remove(listfn)
+    return best
+
+
+def read_baseline(fn):
+    base = {}
+    with open(fn) as f:
+        for line in f:
+            if line.startswith("#") or not line.strip():
+                continue
+            name, realtime, cycles, codec_kb, rss_kb, crc = line.split()
+            base[name] = Result(name, float(realtime), float(cycles),
+                                int(codec_kb), int(rss_kb), crc)
+    return base
+
+
+def write_baseline(fn, results):
+    with open(fn, "w") as f:
+        f.write("# name realtime cyc/smp codec-KiB rss-KiB crc\n")
+        for r in sorted(results.values(), key=lambda r: r.name):
+            f.write("%s %.1f %.1f %d %d %s\n" % (r.name, r.realtime, r.cycles,
+                                                r.codec_kb, r.rss_kb, r.crc))
+
+
+def percent(new, old):
+    return (new - old) * 100.0 / old if old else 0.0
+
+
+# Compares one result against the baseline; returns the problems found
+def compare(r, b, threshold):
+    problems = []
+    # Cycles are less affected by frequency scaling than wall clock time
+    if r.cycles and b.cycles:
+        slower = percent(r.cycles, b.cycles)
+    else:
+        slower = -percent(r.realtime, b.realtime)
+    if slower > threshold:
+        problems.append("%.1f%% slower" % slower)
+    if r.codec_kb > b.codec_kb:
+        problems.append("codec buffer %d -> %d KiB" % (b.codec_kb,
+                                                       r.codec_kb))
+    if r.crc != b.crc:
+        problems.append("output changed")
+    return problems, slower
+
+
+def main():
+    parser = argparse.ArgumentParser(
+        description="Benchmark the codecs with warble.")
+    parser.add_argument("-w", "--warble", required=True,
+                        help="warble binary")
+    parser.add_argument("-d", "--dir", required=True,
+                        help="directory for the corpus")
+    parser.add_argument("-n", "--runs", type=int, default=3,
+                        help="decode every file this many times [3]")
+    parser.add_argument("-t", "--threshold", type=float, default=5,
+                        help="slowdown in %% reported as a regression [5]")
+    parser.add_argument("-b", "--baseline",
+                        help="baseline file [DIR/baseline.txt]")
+    parser.add_argument("--save", action="store_true",
+                        help="save the results as the new baseline")
+    args = parser.parse_args()
+    baseline = args.baseline or os.path.join(args.dir, "baseline.txt")
+
+    corpus = subprocess.run([sys.executable,
+                             os.path.join(os.path.dirname(__file__),
+                                          "benchcorpus.py"), args.dir],
+                            stdout=subprocess.PIPE, universal_newlines=True,
+                            check=True)
+    files = corpus.stdout.split()
+    results = benchmark(args, files)
+
+    base = {}
+    if not args.save:
+        try:
+            base = read_baseline(baseline)
+        except OSError:
+            print("no baseline in %s, run with --save to make one" %
+                  baseline)
+
+    regressions = 0
+    print("%-20s %9s %9s %9s %8s  %s" % ("file", "realtime", "cyc/smp",
+                                         "codec KiB", "crc", "vs. baseline"))
+    for fn in files:
+        name = name_of(fn)
+        r = results.get(name)
+        if r is None:
+            print("%-20s %9s" % (name, "FAIL"))
+            regressions += 1
+            continue
+        note = ""
+        b = base.get(name)
+        if b:
+            problems, slower = compare(r, b, args.threshold)
+            note = "%+.1f%%" % -slower
+            if problems:
+                note += "  REGRESSION: " + ", ".join(problems)
+                regressions += 1
+        print("%-20s %8.1fx %9.1f %9d %8s  %s" %
+              (name, r.realtime, r.cycles, r.codec_kb, r.crc, note))
+    # e.g. an encoder for the corpus went missing
+    for name in sorted(set(base) - set(name_of(fn) for fn in files)):
+        print("%-20s %9s  REGRESSION: in baseline only" % (name, "-"))
+        regressions += 1
+
+    if args.save:
+        write_baseline(baseline, results)
+        print("saved baseline to %s" % baseline)
+    elif base:
+        print("%d regressions against %s" % (regressions, baseline))
+
+    sys.exit(1 if regressions else 0)
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,124 @@
+#!/usr/bin/env python3
+#             __________               __   ___.
+#   Open      \______   \ ____   ____ |  | _\_ |__   _______  ___
+#   Source     |       _//  _ \_/ ___\|  |/ /| __ \ /  _ \  \/  /
+#   Jukebox    |    |   (  <_> )  \___|    < | \_\ (  <_> > <  <
+#   Firmware   |____|_  /\____/ \___  >__|_ \|___  /\____/__/\_ \
+#                     \/            \/     \/    \/            \/
+# $Id$
+#
+# Generates lib/rbcodec/dsp/polyphase_coefs.h, the coefficient tables used by
+# the band-limited resampler in lib/rbcodec/dsp/polyphase.c.
+#
+# Each table is a Kaiser windowed sinc sampled at PHASES + 1 fractional
+# positions, one row of TAPS coefficients per position. Rows are normalised to
+# unity DC gain and stored as Q14 so a full scale coefficient fits an int16_t.
+#
+# Usage: mkpolyphase.py > lib/rbcodec/dsp/polyphase_coefs.h
+
+import math
+import sys
+
+NATIVE_FREQUENCY = 44100
+PHASE_BITS = 5
+PHASES = 1 << PHASE_BITS
+COEF_BITS = 14
+PASSBAND = 19000     # Hz, flat up to here
+STOPBAND = 25100     # Hz, aliases land above PASSBAND at NATIVE_FREQUENCY
+
+# (input frequency the table is designed for, number of taps). Every table is
+# used for all ratios up to its own, so the cutoff never exceeds the output
+# Nyquist. The first one covers upsampling.
+TABLES = [
+    (NATIVE_FREQUENCY, 32),
+    (48000,            32),
+    (88200,            48),
+    (96000,            56),
+    (176400,           96),
+    (192000,          112),
+]
+
+
+def bessel_i0(x):
+    s, t, k = 1.0, 1.0, 1
+    while t > 1e-12 * s:
+        t *= (x / (2 * k)) ** 2
+        s += t
+        k += 1
+    return s
+
+
+def kaiser_beta(atten):
+    if atten > 50:
+        return 0.1102 * (atten - 8.7)
+    return 0.5842 * (atten - 21) ** 0.4 + 0.07886 * (atten - 21)
+
+
+def design(freq, taps):
+    if freq <= NATIVE_FREQUENCY:
+        # Upsampling: images of the input band must go, there is no aliasing
+        pass_f, stop_f = 0.40 * freq, 0.50 * freq
+    else:
+        pass_f, stop_f = PASSBAND, STOPBAND
+
+    fc = (pass_f + stop_f) / 2 / freq       # cycles per input sample
+    tw = (stop_f - pass_f) / freq
+    # Attenuation the tap count allows (inverse of Kaiser's estimate)
+    atten = 2.285 * 2 * math.pi * tw * (taps - 1) + 8
+    beta = kaiser_beta(atten)
+    half = taps / 2
+    rows = []
+
+    for p in range(PHASES + 1):
+        frac = p / PHASES
+        row = []
+        for k in range(taps):
+            # Distance of tap k from the output instant, see polyphase.c
+            x = k - taps // 2 - frac + 1
+            w = x / half
+            if abs(w) >= 1:
+                row.append(0.0)
+                continue
+            sinc = 2 * fc * (math.sin(2 * math.pi * fc * x) /
+                             (2 * math.pi * fc * x) if x else 1.0)
+            row.append(sinc * bessel_i0(beta * math.sqrt(1 - w * w)) /
+                       bessel_i0(beta))
+        dc = sum(row)
+        row = [round(c / dc * (1 << COEF_BITS)) for c in row]
+        # Put any rounding error on the centre tap so DC gain is exact
+        row[taps // 2 - 1] += (1 << COEF_BITS) - sum(row)
+        rows.append(row)
+
+    return rows, atten
+
+
+def main():
+    out = sys.stdout
+    out.write("/* Generated by tools/mkpolyphase.py - do not edit */\n\n")
+    out.write("#define POLYPHASE_PHASE_BITS %d\n" % PHASE_BITS)
+    out.write("#define POLYPHASE_COEF_BITS  %d\n" % COEF_BITS)
+    out.write("#define POLYPHASE_MAX_TAPS   %d\n\n"
+              % max(taps for freq, taps in TABLES))
+
+    for freq, taps in TABLES:
+        rows, atten = design(freq, taps)
+        out.write("/* %d Hz, %d taps, ~%d dB */\n" % (freq, taps, atten))
+        out.write("static const int16_t coefs_%d[%d][%d] =\n{\n"
+                  % (freq, PHASES + 1, taps))
+        for row in rows:
+            out.write("    {")
+            for i, c in enumerate(row):
+                if i % 10 == 0:
+                    out.write("\n        ")
+                out.write("%6d," % c)
+            out.write("\n    },\n")
+        out.write("};\n\n")
+
+    out.write("static const struct polyphase_table polyphase_tables[] =\n{\n")
+    for freq, taps in TABLES:
+        out.write("    { %6d, %3d, &coefs_%d[0][0] },\n" % (freq, taps, freq))
+    out.write("};\n")
+
+
+if __name__ == "__main__":
+    main()
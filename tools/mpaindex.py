@@ -0,0 +1,205 @@
+#!/usr/bin/env python3
+#             __________               __   ___.
+#   Open      \______   \ ____   ____ |  | _\_ |__   _______  ___
+#   Source     |       _//  _ \_/ ___\|  |/ /| __ \ /  _ \  \/  /
+#   Jukebox    |    |   (  <_> )  \___|    < | \_\ (  <_> > <  <
+#   Firmware   |____|_  /\____/ \___  >__|_ \|___  /\____/__/\_ \
+#                     \/            \/     \/    \/            \/
+# $Id$
+#
+# Creates the seek index sidecars (<track>.idx) that the MPEG audio codec
+# otherwise records while a long track plays through (see apps/codecs/mpa.c).
+# With an index, seeking and resuming in VBR files are exact from the first
+# play on.
+#
+# The first frame is found the way lib/rbcodec/metadata/mp3data.c finds it.
+# Should the two ever disagree the codec rejects the sidecar, so nothing
+# worse than a wasted file can happen.
+#
+# Usage: mpaindex.py [-f] [-m MINUTES] file_or_dir...
+
+import argparse
+import os
+import struct
+import sys
+
+MAGIC = 0x5849504d
+SUFFIX = ".idx"
+ENTRIES = 4096
+MIN_STRIDE = 16
+EXTENSIONS = (".mp1", ".mp2", ".mp3", ".mpa")
+
+BITRATES = [
+    [[0, 32, 64, 96, 128, 160, 192, 224, 256, 288, 320, 352, 384, 416, 448],
+     [0, 32, 48, 56, 64, 80, 96, 112, 128, 160, 192, 224, 256, 320, 384],
+     [0, 32, 40, 48, 56, 64, 80, 96, 112, 128, 160, 192, 224, 256, 320]],
+    [[0, 32, 48, 56, 64, 80, 96, 112, 128, 144, 160, 176, 192, 224, 256],
+     [0, 8, 16, 24, 32, 40, 48, 56, 64, 80, 96, 112, 128, 144, 160],
+     [0, 8, 16, 24, 32, 40, 48, 56, 64, 80, 96, 112, 128, 144, 160]]]
+FREQS = [44100, 48000, 32000]
+
+
+def header_info(h):
+    """Returns (frame length, samples per frame, frequency) for a frame
+    header, or None if it isn't valid."""
+    version = (h >> 19) & 3
+    layer = 4 - ((h >> 17) & 3)
+    bitrate = (h >> 12) & 15
+    freq = (h >> 10) & 3
+    padding = (h >> 9) & 1
+    lsf = 1 if version != 3 else 0
+
+    if ((h & 0xffe00000) != 0xffe00000 or version == 1 or layer == 4 or
+            bitrate == 0 or bitrate == 15 or freq == 3):
+        return None
+
+    bitrate = BITRATES[lsf][layer - 1][bitrate] * 1000
+    freq = FREQS[freq] >> (lsf + (version == 0))
+
+    if layer == 1:
+        return (12 * bitrate // freq + padding) * 4, 384, freq
+    elif layer == 3 and lsf:
+        return 72 * bitrate // freq + padding, 576, freq
+    else:
+        return 144 * bitrate // freq + padding, 1152, freq
+
+
+def same_type(h1, h2):
+    mask = 0xffe00000 | (3 << 19) | (3 << 17) | (3 << 10)
+    return (h1 & mask) == (h2 & mask) if h1 else True
+
+
+def be32(data, pos):
+    if pos + 4 > len(data):
+        return 0
+    return struct.unpack_from(">I", data, pos)[0]
+
+
+def find_frame(data, start, single):
+    """Returns the offset of the first frame header from start on, for
+    single=False one followed by a header of the same type."""
+    h = 0
+    for pos in range(start, min(len(data), start + 0x20000)):
+        h = ((h << 8) | data[pos]) & 0xffffffff
+        info = header_info(h)
+        if info is None:
+            continue
+        if single:
+            return pos - 3
+        if same_type(h, be32(data, pos - 3 + info[0])):
+            return pos - 3
+    return None
+
+
+def first_frame_offset(data):
+    start = 0
+    if data[:3] == b"ID3" and len(data) >= 10:
+        b = data[6:10]
+        start = (((b[0] & 0x7f) << 21) | ((b[1] & 0x7f) << 14) |
+                 ((b[2] & 0x7f) << 7) | (b[3] & 0x7f)) + 10
+
+    first = find_frame(data, start, True)
+    if first is None:
+        return None
+
+    h = be32(data, first)
+    size = header_info(h)[0]
+    frame = data[first + 4:first + 4 + min(size - 4, 180)].ljust(180, b"\0")
+    mono = (h >> 6) & 3 == 3
+    if (h >> 19) & 3 == 3:
+        vbr = 17 if mono else 32
+    else:
+        vbr = 9 if mono else 17
+
+    if frame[vbr:vbr + 4] in (b"Xing", b"Info", b"VBRI"):
+        return find_frame(data, first + size, False)
+    return find_frame(data, first, False)
+
+
+def build_index(data, first):
+    offsets = []
+    stride = MIN_STRIDE
+    frames = 0
+    samples = freq = None
+    pos = first
+
+    while True:
+        info = header_info(be32(data, pos))
+        if info is None or pos + info[0] > len(data):
+            break
+        if samples is None:
+            samples, freq = info[1], info[2]
+        if frames % stride == 0:
+            if len(offsets) == ENTRIES:
+                offsets = offsets[::2]
+                stride *= 2
+            offsets.append(pos)
+        frames += 1
+        pos += info[0]
+
+    return offsets, stride, frames, samples, freq
+
+
+def index_file(path, args):
+    with open(path, "rb") as f:
+        data = f.read()
+
+    first = first_frame_offset(data)
+    if first is None:
+        return "no MPEG audio frames"
+
+    side = path + SUFFIX
+    if not args.force and os.path.exists(side):
+        with open(side, "rb") as f:
+            hdr = f.read(24)
+        if (len(hdr) == 24 and
+                struct.unpack("<3I", hdr[:12]) == (MAGIC, len(data), first)):
+            return "up to date"
+
+    offsets, stride, frames, samples, freq = build_index(data, first)
+    if frames == 0:
+        return "no MPEG audio frames"
+    length = frames * samples / freq
+    if length < args.minutes * 60:
+        return "%d:%02d, too short" % (length // 60, length % 60)
+
+    with open(side, "wb") as f:
+        f.write(struct.pack("<6I", MAGIC, len(data), first, samples,
+                            stride, frames))
+        f.write(struct.pack("<%dI" % len(offsets), *offsets))
+    return "%d frames, indexed every %d" % (frames, stride)
+
+
+def walk(paths):
+    for p in paths:
+        if os.path.isdir(p):
+            for root, dirs, files in os.walk(p):
+                dirs.sort()
+                for name in sorted(files):
+                    if name.lower().endswith(EXTENSIONS):
+                        yield os.path.join(root, name)
+        else:
+            yield p
+
+
+def main():
+    parser = argparse.ArgumentParser(
+        description="Create seek indexes for MPEG audio files")
+    parser.add_argument("paths", nargs="+", help="files or directories")
+    parser.add_argument("-f", "--force", action="store_true",
+                        help="rewrite indexes that are up to date")
+    parser.add_argument("-m", "--minutes", type=float, default=10,
+                        help="skip shorter tracks, the codec doesn't look "
+                             "for their indexes [10]")
+    args = parser.parse_args()
+
+    for path in walk(args.paths):
+        try:
+            result = index_file(path, args)
+        except OSError as e:
+            result = e.strerror
+        print("%s: %s" % (path, result))
+
+
+if __name__ == "__main__":
+    main()
@@ -182,6 +182,7 @@ struct dirstruct {
 struct mydir {
     DIR_T *dir;
     char *name;
+    struct sim_dirent entry; /* Returned by sim_readdir() */
 };
 
 typedef struct mydir MYDIR;
@@ -326,7 +327,7 @@ static inline struct tm* localtime_r (const time_t *clock, struct tm *result) {
 struct sim_dirent *sim_readdir(MYDIR *dir)
 {
     char buffer[MAX_PATH]; /* sufficiently big */
-    static struct sim_dirent secret;
+    struct sim_dirent *entry = &dir->entry;
     STAT_T s;
     struct tm tm;
     DIRENT_T *x11;
@@ -339,11 +340,11 @@ read_next:
     if(!x11)
         return (struct sim_dirent *)0;
 
-    strcpy((char *)secret.d_name, OS_TO_UTF8(x11->d_name));
+    strcpy((char *)entry->d_name, OS_TO_UTF8(x11->d_name));
 
     /* build file name */
     snprintf(buffer, sizeof(buffer), "%s/%s", 
-        get_sim_pathname(dir->name), secret.d_name);
+        get_sim_pathname(dir->name), entry->d_name);
 
     if (STAT(buffer, &s)) /* get info */
     {
@@ -361,19 +362,19 @@ read_next:
 
 #define ATTR_DIRECTORY 0x10
 
-    secret.info.attribute = 0;
+    entry->info.attribute = 0;
 
     if (S_ISDIR(s.st_mode))
-        secret.info.attribute = ATTR_DIRECTORY;
+        entry->info.attribute = ATTR_DIRECTORY;
 
-    secret.info.size = s.st_size;
+    entry->info.size = s.st_size;
     
     if (localtime_r(&(s.st_mtime), &tm) == NULL)
         return NULL;
-    secret.info.wrtdate = ((tm.tm_year - 80) << 9) |
+    entry->info.wrtdate = ((tm.tm_year - 80) << 9) |
                         ((tm.tm_mon + 1) << 5) |
                         tm.tm_mday;
-    secret.info.wrttime = (tm.tm_hour << 11) |
+    entry->info.wrttime = (tm.tm_hour << 11) |
                         (tm.tm_min << 5) |
                         (tm.tm_sec >> 1);
 
@@ -381,11 +382,11 @@ read_next:
 #define ATTR_LINK      0x80
     if (!lstat(buffer, &s) && S_ISLNK(s.st_mode))
     {
-        secret.info.attribute |= ATTR_LINK;
+        entry->info.attribute |= ATTR_LINK;
     }
 #endif
 
-    return &secret;
+    return entry;
 }
 
 void sim_closedir(MYDIR *dir)